@@ -0,0 +1,355 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (ensemble_metric_thread_scaling.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file apps/pilot/vmullig/ensemble_metric_thread_scaling.cc
+/// @brief A benchmark for measuring how the generation of an ensemble by an EnsembleMetric's ensemble-generating
+/// protocol scales with the number of threads.
+/// @details This drives EnsembleMetric::apply() (and, through it, generate_ensemble_and_apply_to_poses()) with
+/// a synthetic mover of configurable CPU cost, memory footprint, failure rate, and duration variance, and with a
+/// synthetic real-valued simple metric of configurable CPU cost.  The ensemble generation is repeated for each thread
+/// count in a list, and the speedup, parallel efficiency, and fraction of thread time spent waiting for locks are
+/// reported for each.
+/// @note Only meaningful in multi-threaded builds (extras=cxx11thread).  Per-pose output from the ensemble metric can
+/// be silenced with -mute protocols.ensemble_metrics.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Devel headers
+#include <devel/init.hh>
+
+// Protocols headers
+#include <protocols/ensemble_metrics/EnsembleMetric.hh>
+#include <protocols/ensemble_metrics/metrics/CentralTendencyEnsembleMetric.hh>
+#include <protocols/moves/Mover.hh>
+
+// Core headers
+#include <core/pose/Pose.hh>
+#include <core/pose/annotated_sequence.hh>
+#include <core/simple_metrics/RealMetric.hh>
+
+// Numeric headers
+#include <numeric/random/random.hh>
+
+// Basic headers
+#include <basic/options/option.hh>
+#include <basic/options/option_macros.hh>
+#include <basic/Tracer.hh>
+#include <basic/datacache/DataMap.hh>
+
+// Utility headers
+#include <utility/excn/Exceptions.hh>
+#include <utility/pointer/memory.hh>
+#include <utility/tag/Tag.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+static basic::Tracer TR( "apps.pilot.vmullig.ensemble_metric_thread_scaling" );
+
+OPT_KEY( Integer, ensemble_size )
+OPT_KEY( IntegerVector, thread_counts )
+OPT_KEY( Integer, repeats )
+OPT_KEY( Real, mover_cost_ms )
+OPT_KEY( Real, mover_cost_stddev_fraction )
+OPT_KEY( Integer, mover_memory_kb )
+OPT_KEY( Real, mover_failure_rate )
+OPT_KEY( Real, metric_cost_ms )
+
+/// @brief Indicate which options are relevant.
+void
+register_options() {
+	utility::vector1< int > default_thread_counts;
+	default_thread_counts.push_back( 1 );
+	default_thread_counts.push_back( 2 );
+	default_thread_counts.push_back( 4 );
+	default_thread_counts.push_back( 8 );
+
+	NEW_OPT( ensemble_size, "The number of times that the ensemble-generating protocol is applied (the ensemble_generating_protocol_repeats setting).  Defaults to 200.", 200 );
+	NEW_OPT( thread_counts, "The list of thread counts to sweep.  A single-threaded run is always carried out first, as the baseline against which speedup is measured.  Defaults to 1 2 4 8.", default_thread_counts );
+	NEW_OPT( repeats, "The number of times that each thread count is benchmarked.  The fastest wall time is reported.  Defaults to 3.", 3 );
+	NEW_OPT( mover_cost_ms, "The mean CPU time, in milliseconds, consumed by each application of the synthetic mover.  Defaults to 10.", 10.0 );
+	NEW_OPT( mover_cost_stddev_fraction, "The standard deviation of the synthetic mover's CPU time, as a fraction of its mean.  Defaults to 0.", 0.0 );
+	NEW_OPT( mover_memory_kb, "The memory, in kilobytes, that the synthetic mover allocates and touches on each application.  Defaults to 0.", 0 );
+	NEW_OPT( mover_failure_rate, "The probability, from 0 to 1, that an application of the synthetic mover fails.  Defaults to 0.", 0.0 );
+	NEW_OPT( metric_cost_ms, "The CPU time, in milliseconds, consumed by each evaluation of the synthetic simple metric.  Defaults to 1.", 1.0 );
+}
+
+/// @brief Spin on the CPU for the given number of milliseconds.
+/// @details Busy-waits rather than sleeping, so that the thread occupies a core for the duration, as real work would.
+void
+burn_cpu(
+	core::Real const milliseconds
+) {
+	if ( milliseconds <= 0.0 ) return;
+	std::chrono::steady_clock::time_point const start( std::chrono::steady_clock::now() );
+	core::Real accumulator( 0.0 );
+	core::Size counter( 0 );
+	while ( std::chrono::duration< core::Real, std::milli >( std::chrono::steady_clock::now() - start ).count() < milliseconds ) {
+		++counter;
+		accumulator += std::sqrt( static_cast< core::Real >( counter ) );
+	}
+	if ( accumulator < 0.0 ) TR << "This should not happen." << std::endl; // Prevents the loop from being optimized out.
+}
+
+/// @brief A synthetic mover that consumes a configurable amount of CPU time and memory, and that fails with a
+/// configurable probability.  It does not alter the pose.
+class SyntheticLoadMover : public protocols::moves::Mover {
+
+public:
+
+	SyntheticLoadMover(
+		core::Real const cost_ms,
+		core::Real const cost_stddev_fraction,
+		core::Size const memory_kb,
+		core::Real const failure_rate
+	) :
+		protocols::moves::Mover( "SyntheticLoadMover" ),
+		cost_ms_( cost_ms ),
+		cost_stddev_fraction_( cost_stddev_fraction ),
+		memory_kb_( memory_kb ),
+		failure_rate_( failure_rate )
+	{}
+
+	SyntheticLoadMover( SyntheticLoadMover const & ) = default;
+
+	~SyntheticLoadMover() override = default;
+
+	protocols::moves::MoverOP
+	clone() const override {
+		return utility::pointer::make_shared< SyntheticLoadMover >( *this );
+	}
+
+	std::string
+	get_name() const override {
+		return "SyntheticLoadMover";
+	}
+
+	void
+	apply(
+		core::pose::Pose &
+	) override {
+		// Allocate memory.  Zero-initialization touches every page, so the pages are actually mapped:
+		utility::vector1< char > scratch( memory_kb_ * 1024, 0 );
+
+		core::Real cost( cost_ms_ );
+		if ( cost_stddev_fraction_ > 0.0 ) {
+			cost *= 1.0 + cost_stddev_fraction_ * numeric::random::gaussian();
+		}
+		burn_cpu( cost );
+		if ( !scratch.empty() ) scratch[ scratch.size() ] = 1; // Keep the allocation alive until the work is done.
+
+		if ( failure_rate_ > 0.0 && numeric::random::uniform() < failure_rate_ ) {
+			set_last_move_status( protocols::moves::FAIL_RETRY );
+		} else {
+			set_last_move_status( protocols::moves::MS_SUCCESS );
+		}
+	}
+
+private:
+
+	/// @brief The mean CPU cost of an application of this mover, in milliseconds.
+	core::Real cost_ms_ = 0.0;
+
+	/// @brief The standard deviation of the CPU cost, as a fraction of the mean.
+	core::Real cost_stddev_fraction_ = 0.0;
+
+	/// @brief The memory allocated and touched by each application of this mover, in kilobytes.
+	core::Size memory_kb_ = 0;
+
+	/// @brief The probability of failure.
+	core::Real failure_rate_ = 0.0;
+
+};
+
+/// @brief A synthetic real-valued simple metric that consumes a configurable amount of CPU time and returns the
+/// number of residues in the pose.
+class SyntheticCostRealMetric : public core::simple_metrics::RealMetric {
+
+public:
+
+	SyntheticCostRealMetric(
+		core::Real const cost_ms
+	) :
+		core::simple_metrics::RealMetric(),
+		cost_ms_( cost_ms )
+	{}
+
+	SyntheticCostRealMetric( SyntheticCostRealMetric const & ) = default;
+
+	~SyntheticCostRealMetric() override = default;
+
+	core::simple_metrics::SimpleMetricOP
+	clone() const override {
+		return utility::pointer::make_shared< SyntheticCostRealMetric >( *this );
+	}
+
+	std::string
+	name() const override {
+		return "SyntheticCostRealMetric";
+	}
+
+	std::string
+	metric() const override {
+		return "synthetic_cost";
+	}
+
+	void
+	parse_my_tag(
+		utility::tag::TagCOP,
+		basic::datacache::DataMap &
+	) override {
+		utility_exit_with_message( "The SyntheticCostRealMetric cannot be configured from RosettaScripts." );
+	}
+
+	core::Real
+	calculate(
+		core::pose::Pose const & pose
+	) const override {
+		burn_cpu( cost_ms_ );
+		return static_cast< core::Real >( pose.total_residue() );
+	}
+
+private:
+
+	/// @brief The CPU cost of an evaluation of this metric, in milliseconds.
+	core::Real cost_ms_ = 0.0;
+
+};
+
+/// @brief Generate one ensemble with the given number of threads, and return the timings.
+protocols::ensemble_metrics::EnsembleGenerationTimings
+run_one_trial(
+	core::pose::Pose const & pose,
+	core::Size const n_threads
+) {
+	using namespace basic::options;
+	using namespace basic::options::OptionKeys;
+
+	protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric ensemble_metric;
+	ensemble_metric.set_real_metric( utility::pointer::make_shared< SyntheticCostRealMetric >( option[ metric_cost_ms ]() ) );
+	ensemble_metric.set_ensemble_generating_protocol(
+		utility::pointer::make_shared< SyntheticLoadMover >(
+		option[ mover_cost_ms ](),
+		option[ mover_cost_stddev_fraction ](),
+		static_cast< core::Size >( option[ mover_memory_kb ]() ),
+		option[ mover_failure_rate ]()
+		)
+	);
+	ensemble_metric.set_ensemble_generating_protocol_repeats( static_cast< core::Size >( option[ ensemble_size ]() ) );
+	ensemble_metric.set_n_threads( n_threads );
+	ensemble_metric.set_collect_ensemble_generation_timings( true );
+	ensemble_metric.apply( pose );
+	return ensemble_metric.ensemble_generation_timings();
+}
+
+/// @brief Benchmark the given thread count, returning the timings of the trial with the shortest wall time.
+protocols::ensemble_metrics::EnsembleGenerationTimings
+benchmark_thread_count(
+	core::pose::Pose const & pose,
+	core::Size const n_threads
+) {
+	using namespace basic::options;
+	using namespace basic::options::OptionKeys;
+
+	core::Size const ntrials( std::max( 1, option[ repeats ]() ) );
+	protocols::ensemble_metrics::EnsembleGenerationTimings best;
+	for ( core::Size i(1); i <= ntrials; ++i ) {
+		protocols::ensemble_metrics::EnsembleGenerationTimings const curtimings( run_one_trial( pose, n_threads ) );
+		if ( i == 1 || curtimings.wall_time < best.wall_time ) {
+			best = curtimings;
+		}
+	}
+	return best;
+}
+
+/// @brief Entry point for program execution.
+int
+main( int argc, char * argv [] ) {
+	try {
+		using namespace basic::options;
+		using namespace basic::options::OptionKeys;
+
+		register_options();
+		devel::init( argc, argv );
+
+		runtime_assert_string_msg( option[ ensemble_size ]() > 0, "The -ensemble_size option must be set to a positive value." );
+		runtime_assert_string_msg( option[ mover_failure_rate ]() >= 0.0 && option[ mover_failure_rate ]() < 1.0, "The -mover_failure_rate option must be in the range [0, 1)." );
+		runtime_assert_string_msg( option[ mover_memory_kb ]() >= 0, "The -mover_memory_kb option cannot be negative." );
+
+		// The thread counts to sweep, with the single-threaded baseline first:
+		utility::vector1< core::Size > thread_count_list{ 1 };
+		for ( int const count : option[ thread_counts ]() ) {
+			runtime_assert_string_msg( count > 0, "All values passed to the -thread_counts option must be positive." );
+#ifndef MULTI_THREADED
+			if ( count > 1 ) {
+				TR.Warning << "Skipping thread count " << count << ", since this is not a multi-threaded build of Rosetta.  (Build with extras=cxx11thread to benchmark multiple threads.)" << std::endl;
+				continue;
+			}
+#endif
+			if ( !thread_count_list.has_value( static_cast< core::Size >( count ) ) ) {
+				thread_count_list.push_back( static_cast< core::Size >( count ) );
+			}
+		}
+
+		core::pose::Pose pose;
+		core::pose::make_pose_from_sequence( pose, "ACDEFGHIKLMNPQRSTVWY", "fa_standard" );
+
+		utility::vector1< protocols::ensemble_metrics::EnsembleGenerationTimings > results;
+		for ( core::Size const n_threads : thread_count_list ) {
+			TR << "Benchmarking ensemble generation with " << n_threads << " thread(s)." << std::endl;
+			results.push_back( benchmark_thread_count( pose, n_threads ) );
+		}
+
+		core::Real const baseline_wall_time( results[1].wall_time );
+		TR << "\nEnsemble generation thread scaling (ensemble size " << option[ ensemble_size ]() << ", mover cost "
+			<< option[ mover_cost_ms ]() << " ms, metric cost " << option[ metric_cost_ms ]() << " ms):\n";
+		TR << std::setw(10) << "REQUESTED" << std::setw(10) << "ASSIGNED" << std::setw(14) << "WALL_TIME(s)"
+			<< std::setw(10) << "SPEEDUP" << std::setw(12) << "EFFICIENCY" << std::setw(14) << "POSE_WAIT" << std::setw(14)
+			<< "PROTOCOL_WAIT" << std::setw(14) << "METRIC_WAIT" << std::setw(14) << "TOTAL_WAIT" << "\n";
+		for ( core::Size i(1), imax( results.size() ); i <= imax; ++i ) {
+			protocols::ensemble_metrics::EnsembleGenerationTimings const & curtimings( results[i] );
+			core::Real const speedup( curtimings.wall_time > 0.0 ? baseline_wall_time / curtimings.wall_time : 0.0 );
+			core::Real const efficiency( speedup / static_cast< core::Real >( std::max< core::Size >( 1, curtimings.assigned_threads ) ) );
+			core::Real const thread_time( curtimings.thread_time > 0.0 ? curtimings.thread_time : 1.0 );
+			TR << std::setw(10) << thread_count_list[i] << std::setw(10) << curtimings.assigned_threads << std::setw(14)
+				<< curtimings.wall_time << std::setw(10) << speedup << std::setw(12) << efficiency << std::setw(14)
+				<< curtimings.pose_lock_wait_time / thread_time << std::setw(14) << curtimings.protocol_lock_wait_time / thread_time
+				<< std::setw(14) << curtimings.ensemble_metric_lock_wait_time / thread_time << std::setw(14)
+				<< curtimings.total_lock_wait_time() / thread_time << "\n";
+		}
+		TR << "(Lock wait columns are fractions of total thread time spent waiting for each mutex.)" << std::endl;
+
+	} catch ( utility::excn::Exception const & e ) {
+		e.display();
+		return -1;
+	}
+	return 0;
+}
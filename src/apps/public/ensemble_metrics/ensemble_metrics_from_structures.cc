@@ -0,0 +1,573 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (ensemble_metrics_from_structures.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file apps/public/ensemble_metrics/ensemble_metrics_from_structures.cc
+/// @brief An application that computes EnsembleMetrics over an existing set of structures (PDB or silent files),
+/// reading and measuring in parallel, and writing only the final reports.
+/// @details The EnsembleMetrics are defined in a RosettaScripts-style XML file, whose data-loader sections (e.g.
+/// RESIDUE_SELECTORS, SIMPLE_METRICS, and ENSEMBLE_METRICS) are loaded in the order in which they appear.  Every
+/// EnsembleMetric defined in the ENSEMBLE_METRICS section is computed over all input structures.  Reader threads claim
+/// structure files one at a time and push the poses that they read into a bounded prefetch queue; measurement threads
+/// pop poses from the queue and apply their own copies of the EnsembleMetrics to them.  When all structures have been
+/// measured, the copies are merged, and each EnsembleMetric produces its report once.  This avoids the per-job
+/// overhead of driving RosettaScripts with one job per structure, and keeps the disk busy while poses are measured.
+/// Silent files are parsed one structure at a time, so a large silent file is never held in memory.  A structure file
+/// that cannot be read is skipped, but an error measuring a pose stops the run.
+/// @note EnsembleMetrics that do not support summary merging are measured by a single thread.  EnsembleMetrics with an
+/// ensemble-generating protocol, or that use the additional output of a previous mover, cannot be used.  Without
+/// multi-threading (extras=cxx11thread), structures are read and measured in turn.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Devel headers
+#include <devel/init.hh>
+
+// Protocols headers
+#include <protocols/ensemble_metrics/EnsembleMetric.hh>
+#include <protocols/parser/DataLoader.hh>
+#include <protocols/parser/DataLoaderFactory.hh>
+
+// Core headers
+#include <core/import_pose/import_pose.hh>
+#include <core/io/silent/SilentFileData.hh>
+#include <core/io/silent/SilentFileOptions.hh>
+#include <core/io/silent/SilentStruct.hh>
+#include <core/pose/Pose.hh>
+
+// Basic headers
+#include <basic/datacache/DataMap.hh>
+#include <basic/options/option.hh>
+#include <basic/options/option_macros.hh>
+#include <basic/Tracer.hh>
+
+// Utility headers
+#include <utility/excn/Exceptions.hh>
+#include <utility/exit.hh>
+#include <utility/file/FileName.hh>
+#include <utility/io/izstream.hh>
+#include <utility/pointer/memory.hh>
+#include <utility/tag/Tag.hh>
+#include <utility/vector0.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef MULTI_THREADED
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+static basic::Tracer TR( "apps.public.ensemble_metrics.ensemble_metrics_from_structures" );
+
+OPT_KEY( String, ensemble_metrics_xml )
+OPT_KEY( StringVector, structure_files )
+OPT_KEY( String, structure_file_list )
+OPT_KEY( Integer, reader_threads )
+OPT_KEY( Integer, measurement_threads )
+OPT_KEY( Integer, prefetch_depth )
+
+/// @brief Indicate which options are relevant.
+void
+register_options() {
+	NEW_OPT( ensemble_metrics_xml, "A RosettaScripts-style XML file defining the ensemble metrics to compute (in an ENSEMBLE_METRICS section), plus any residue selectors, simple metrics, etc. that they use.  Sections are loaded in the order in which they appear.  Required.", "" );
+	NEW_OPT( structure_files, "The structure files to analyse.  Files ending in .silent or .out are read as silent files (all structures in each are analysed); others are read as PDB or mmCIF files.", utility::vector1< std::string >() );
+	NEW_OPT( structure_file_list, "A file listing structure files to analyse, one per line.  May be combined with -structure_files.", "" );
+	NEW_OPT( reader_threads, "The number of threads reading structure files.  Only used in multi-threaded builds (extras=cxx11thread).  Defaults to 2.", 2 );
+	NEW_OPT( measurement_threads, "The number of threads applying ensemble metrics to poses.  Only used in multi-threaded builds (extras=cxx11thread).  A value of 0 means to use all available hardware threads not used for reading.  Defaults to 0.", 0 );
+	NEW_OPT( prefetch_depth, "The maximum number of poses read but not yet measured.  This bounds memory use.  Defaults to 64.", 64 );
+}
+
+/// @brief Get the list of structure files from the -structure_files and -structure_file_list options.
+utility::vector1< std::string >
+get_structure_filenames() {
+	using namespace basic::options;
+	using namespace basic::options::OptionKeys;
+
+	utility::vector1< std::string > filenames;
+	if ( option[ structure_files ].user() ) {
+		for ( std::string const & filename : option[ structure_files ]() ) {
+			filenames.push_back( filename );
+		}
+	}
+	if ( option[ structure_file_list ].user() ) {
+		utility::io::izstream listfile( option[ structure_file_list ]() );
+		runtime_assert_string_msg( listfile.good(), "Could not open the structure file list \"" + option[ structure_file_list ]() + "\"." );
+		std::string line;
+		while ( listfile.getline( line ) ) {
+			std::string::size_type const first( line.find_first_not_of( " \t\r" ) );
+			if ( first == std::string::npos ) continue;
+			std::string::size_type const last( line.find_last_not_of( " \t\r" ) );
+			filenames.push_back( line.substr( first, last - first + 1 ) );
+		}
+		listfile.close();
+	}
+	return filenames;
+}
+
+/// @brief Load the data-loader sections of the XML file into a DataMap, and return the EnsembleMetrics defined.
+utility::vector1< protocols::ensemble_metrics::EnsembleMetricOP >
+load_ensemble_metrics(
+	std::string const & xml_filename,
+	basic::datacache::DataMap & datamap
+) {
+	std::ifstream xmlfile( xml_filename );
+	runtime_assert_string_msg( xmlfile.good(), "Could not open the ensemble metric definition file \"" + xml_filename + "\"." );
+	utility::tag::TagCOP const root_tag( utility::tag::Tag::create( xmlfile ) );
+
+	utility::vector1< std::string > ensemble_metric_names;
+	for ( utility::tag::TagCOP const & subtag : root_tag->getTags() ) {
+		protocols::parser::DataLoaderOP const loader( protocols::parser::DataLoaderFactory::get_instance()->newDataLoader( subtag->getName() ) );
+		loader->load_data( subtag, datamap );
+		if ( subtag->getName() == "ENSEMBLE_METRICS" ) {
+			for ( utility::tag::TagCOP const & metric_tag : subtag->getTags() ) {
+				ensemble_metric_names.push_back( metric_tag->getOption< std::string >( "name", metric_tag->getName() ) );
+			}
+		}
+	}
+	runtime_assert_string_msg( !ensemble_metric_names.empty(), "No ensemble metrics were defined in an ENSEMBLE_METRICS section of \"" + xml_filename + "\"." );
+
+	utility::vector1< protocols::ensemble_metrics::EnsembleMetricOP > metrics;
+	for ( std::string const & name : ensemble_metric_names ) {
+		protocols::ensemble_metrics::EnsembleMetricOP const metric( datamap.get_ptr< protocols::ensemble_metrics::EnsembleMetric >( "EnsembleMetric", name ) );
+		runtime_assert_string_msg( metric->reports_at_end(), "The ensemble metric \"" + name + "\" has an ensemble-generating protocol or uses the additional output of a previous mover, so it cannot be computed over a set of existing structures." );
+		metrics.push_back( metric );
+	}
+	return metrics;
+}
+
+/// @brief Is a silent file line the SCORE line that names the score columns (rather than one that starts a structure)?
+bool
+is_silent_column_header(
+	std::string const & line
+) {
+	std::string::size_type const last( line.find_last_not_of( " \t\r" ) );
+	return line.compare( 0, 6, "SCORE:" ) == 0 && last != std::string::npos && last >= 10 && line.compare( last - 10, 11, "description" ) == 0;
+}
+
+/// @brief Read a silent file one structure at a time, passing each pose to a function as it is read.
+/// @details SilentFileData::read_file() would hold every structure in the file in memory at once.  Instead, the lines
+/// of each structure (from the SCORE line that starts it to the next) are collected, prefixed with the header lines in
+/// effect (the SEQUENCE line, the SCORE column header, and any lines between them and the first structure), and parsed
+/// on their own.
+template< class PoseFunction >
+void
+read_silent_file(
+	std::string const & filename,
+	PoseFunction && fxn
+) {
+	utility::io::izstream infile( filename );
+	runtime_assert_string_msg( infile.good(), "Could not open silent file \"" + filename + "\"." );
+	core::io::silent::SilentFileOptions opts;
+	std::string sequence_line, column_header_line, header_remarks, structure;
+	bool in_header( true );
+	core::Size n_structures( 0 );
+
+	auto const parse_structure = [&]() {
+		if ( structure.empty() ) return;
+		++n_structures;
+		std::istringstream data( sequence_line + column_header_line + header_remarks + structure );
+		structure.clear();
+		core::io::silent::SilentFileData sfd( opts );
+		runtime_assert_string_msg( sfd.read_stream( data, utility::vector1< std::string >(), true, filename ), "Could not read structure " + std::to_string( n_structures ) + " of silent file \"" + filename + "\"." );
+		for ( core::io::silent::SilentFileData::iterator it( sfd.begin() ), it_end( sfd.end() ); it != it_end; ++it ) {
+			core::pose::PoseOP pose( utility::pointer::make_shared< core::pose::Pose >() );
+			it->fill_pose( *pose );
+			fxn( pose );
+		}
+	};
+
+	std::string line;
+	while ( infile.getline( line ) ) {
+		if ( line.compare( 0, 9, "SEQUENCE:" ) == 0 ) {
+			// A new header (e.g. in concatenated silent files).
+			parse_structure();
+			sequence_line = line + "\n";
+			header_remarks.clear();
+			in_header = true;
+		} else if ( is_silent_column_header( line ) ) {
+			parse_structure();
+			column_header_line = line + "\n";
+			header_remarks.clear();
+			in_header = true;
+		} else if ( line.compare( 0, 6, "SCORE:" ) == 0 ) {
+			parse_structure();
+			structure = line + "\n";
+			in_header = false;
+		} else if ( in_header ) {
+			header_remarks += line + "\n";
+		} else {
+			structure += line + "\n";
+		}
+	}
+	parse_structure();
+	infile.close();
+	runtime_assert_string_msg( n_structures > 0, "No structures were found in silent file \"" + filename + "\"." );
+}
+
+/// @brief Read all of the poses in a structure file, passing each to a function as it is read.
+/// @details Silent files (ending in .silent or .out) may contain many structures, and are read one structure at a
+/// time; other files are read as one pose.
+template< class PoseFunction >
+void
+read_structure_file(
+	std::string const & filename,
+	PoseFunction && fxn
+) {
+	std::string const extension( utility::file::FileName( filename ).ext() );
+	if ( extension == "silent" || extension == "out" ) {
+		read_silent_file( filename, fxn );
+	} else {
+		core::pose::PoseOP pose( utility::pointer::make_shared< core::pose::Pose >() );
+		core::import_pose::pose_from_file( *pose, filename, core::import_pose::PDB_file );
+		fxn( pose );
+	}
+}
+
+/// @brief Apply each EnsembleMetric to a pose.
+void
+measure_pose(
+	utility::vector1< protocols::ensemble_metrics::EnsembleMetricOP > const & metrics,
+	core::pose::Pose const & pose
+) {
+	for ( protocols::ensemble_metrics::EnsembleMetricOP const & metric : metrics ) {
+		metric->apply( pose );
+	}
+}
+
+/// @brief Merge the data accumulated by one set of EnsembleMetrics into another.
+/// @details The merged-from EnsembleMetrics are reset afterward, so that they do not report on destruction.
+void
+merge_ensemble_metrics(
+	utility::vector1< protocols::ensemble_metrics::EnsembleMetricOP > const & partial_metrics,
+	utility::vector1< protocols::ensemble_metrics::EnsembleMetricOP > const & merged_metrics
+) {
+	for ( core::Size i( 1 ); i <= merged_metrics.size(); ++i ) {
+		if ( merged_metrics[i]->supports_ensemble_metric_data_merging() ) {
+			merged_metrics[i]->merge_ensemble_metric_data( *partial_metrics[i] );
+		} else {
+			merged_metrics[i]->merge_summary( partial_metrics[i]->pack_summary() );
+		}
+		partial_metrics[i]->reset();
+	}
+}
+
+#ifdef MULTI_THREADED
+
+/// @brief A bounded, blocking queue of poses read but not yet measured, fed by several reader threads.
+class PosePrefetchQueue {
+
+public:
+
+	/// @brief Constructor.
+	PosePrefetchQueue(
+		core::Size const capacity,
+		core::Size const n_readers
+	) :
+		capacity_( capacity ),
+		n_readers_remaining_( n_readers )
+	{}
+
+	/// @brief Add a pose, waiting while the queue is full.  The pose is discarded if the queue has been aborted.
+	void
+	push(
+		core::pose::PoseOP const & pose
+	) {
+		std::unique_lock< std::mutex > lock( mutex_ );
+		not_full_.wait( lock, [this]{ return queue_.size() < capacity_ || aborted_; } );
+		if ( aborted_ ) return;
+		queue_.push_back( pose );
+		not_empty_.notify_one();
+	}
+
+	/// @brief Take a pose, waiting while the queue is empty.  Returns nullptr once the queue is empty and every
+	/// reader has finished, or once the queue has been aborted.
+	core::pose::PoseOP
+	pop() {
+		std::unique_lock< std::mutex > lock( mutex_ );
+		not_empty_.wait( lock, [this]{ return !queue_.empty() || n_readers_remaining_ == 0 || aborted_; } );
+		if ( queue_.empty() || aborted_ ) return nullptr;
+		core::pose::PoseOP const pose( queue_.front() );
+		queue_.pop_front();
+		not_full_.notify_one();
+		return pose;
+	}
+
+	/// @brief Called by each reader when it has no more poses.
+	void
+	reader_finished() {
+		std::lock_guard< std::mutex > lock( mutex_ );
+		--n_readers_remaining_;
+		if ( n_readers_remaining_ == 0 ) not_empty_.notify_all();
+	}
+
+	/// @brief Stop all readers and measurers: discard the queued poses, and release any thread that is waiting.
+	void
+	abort() {
+		std::lock_guard< std::mutex > lock( mutex_ );
+		aborted_ = true;
+		queue_.clear();
+		not_empty_.notify_all();
+		not_full_.notify_all();
+	}
+
+	/// @brief Has the queue been aborted?
+	bool
+	aborted() const {
+		std::lock_guard< std::mutex > lock( mutex_ );
+		return aborted_;
+	}
+
+private:
+
+	/// @brief The maximum number of poses in the queue.
+	core::Size const capacity_;
+
+	/// @brief The number of readers that have not finished.
+	core::Size n_readers_remaining_;
+
+	/// @brief The poses waiting to be measured.
+	std::deque< core::pose::PoseOP > queue_;
+
+	/// @brief Has the queue been aborted?
+	bool aborted_ = false;
+
+	/// @brief Protects the queue.
+	mutable std::mutex mutex_;
+
+	/// @brief Signalled when a pose is added or the last reader finishes.
+	std::condition_variable not_empty_;
+
+	/// @brief Signalled when a pose is removed.
+	std::condition_variable not_full_;
+
+};
+
+/// @brief Read structure files, claiming the next unread one from the shared counter each time, and push their
+/// poses into the prefetch queue.
+/// @details A file that cannot be read is reported and counted, and the run continues.  Stops early if the queue is
+/// aborted.
+void
+read_structures_in_thread(
+	utility::vector1< std::string > const & filenames,
+	std::atomic< core::Size > & next_file_index,
+	std::atomic< core::Size > & n_failed_files,
+	PosePrefetchQueue & queue
+) {
+	for ( core::Size i( next_file_index++ ); i <= filenames.size() && !queue.aborted(); i = next_file_index++ ) {
+		try {
+			read_structure_file( filenames[i], [&queue]( core::pose::PoseOP const & pose ){ queue.push( pose ); } );
+		} catch ( utility::excn::Exception const & e ) {
+			TR.Error << "Could not read structure file \"" << filenames[i] << "\": " << e.msg() << std::endl;
+			++n_failed_files;
+		} catch ( std::exception const & e ) {
+			TR.Error << "Could not read structure file \"" << filenames[i] << "\": " << e.what() << std::endl;
+			++n_failed_files;
+		}
+	}
+	queue.reader_finished();
+}
+
+/// @brief Pop poses from the prefetch queue and measure them with this thread's EnsembleMetrics until the queue is
+/// exhausted.
+/// @details An exception thrown while measuring would otherwise terminate the program from this thread.  It is caught
+/// and stored in error_message (so that it can be reported after all threads are joined), and the queue is aborted to
+/// stop the other threads.
+void
+measure_structures_in_thread(
+	PosePrefetchQueue & queue,
+	utility::vector1< protocols::ensemble_metrics::EnsembleMetricOP > const & metrics,
+	std::atomic< core::Size > & n_poses_measured,
+	std::string & error_message
+) {
+	try {
+		for ( core::pose::PoseOP pose( queue.pop() ); pose != nullptr; pose = queue.pop() ) {
+			measure_pose( metrics, *pose );
+			++n_poses_measured;
+		}
+	} catch ( utility::excn::Exception const & e ) {
+		error_message = "Error measuring a pose: " + e.msg();
+	} catch ( std::exception const & e ) {
+		error_message = "Error measuring a pose: " + std::string( e.what() );
+	}
+	if ( !error_message.empty() ) queue.abort();
+}
+
+#endif //MULTI_THREADED
+
+/// @brief Entry point for program execution.
+int
+main( int argc, char * argv [] ) {
+	try {
+		using namespace basic::options;
+		using namespace basic::options::OptionKeys;
+		using protocols::ensemble_metrics::EnsembleMetricOP;
+
+		register_options();
+		devel::init( argc, argv );
+
+		runtime_assert_string_msg( option[ ensemble_metrics_xml ].user(), "No ensemble metric definitions were provided.  Use the -ensemble_metrics_xml option." );
+		utility::vector1< std::string > const filenames( get_structure_filenames() );
+		runtime_assert_string_msg( !filenames.empty(), "No structure files were provided.  Use the -structure_files or -structure_file_list option." );
+		runtime_assert_string_msg( option[ reader_threads ]() > 0, "The -reader_threads option must be positive." );
+		runtime_assert_string_msg( option[ measurement_threads ]() >= 0, "The -measurement_threads option cannot be negative." );
+		runtime_assert_string_msg( option[ prefetch_depth ]() > 0, "The -prefetch_depth option must be positive." );
+
+		basic::datacache::DataMap datamap;
+		utility::vector1< EnsembleMetricOP > const metrics( load_ensemble_metrics( option[ ensemble_metrics_xml ](), datamap ) );
+
+		std::chrono::steady_clock::time_point const start_time( std::chrono::steady_clock::now() );
+		std::atomic< core::Size > n_poses_measured( 0 );
+		std::atomic< core::Size > n_failed_files( 0 );
+
+#ifdef MULTI_THREADED
+		core::Size const n_readers( std::min( static_cast< core::Size >( option[ reader_threads ]() ), filenames.size() ) );
+		core::Size n_measurers( static_cast< core::Size >( option[ measurement_threads ]() ) );
+		if ( n_measurers == 0 ) {
+			core::Size const hardware_threads( std::thread::hardware_concurrency() );
+			n_measurers = hardware_threads > n_readers ? hardware_threads - n_readers : 1;
+		}
+		bool all_mergeable( true );
+		for ( EnsembleMetricOP const & metric : metrics ) {
+			if ( !metric->supports_summary_merging() ) {
+				TR.Warning << "The " << metric->get_ensemble_metric_label() << " ensemble metric does not support summary merging, so poses will be measured by a single thread." << std::endl;
+				all_mergeable = false;
+			}
+		}
+		if ( !all_mergeable ) n_measurers = 1;
+		TR << "Analysing " << filenames.size() << " structure file(s) with " << n_readers << " reader thread(s) and " << n_measurers << " measurement thread(s)." << std::endl;
+
+		// Each measurement thread other than the first gets its own copies of the ensemble metrics.
+		utility::vector1< utility::vector1< EnsembleMetricOP > > thread_metrics( n_measurers );
+		thread_metrics[1] = metrics;
+		for ( core::Size i( 2 ); i <= n_measurers; ++i ) {
+			for ( EnsembleMetricOP const & metric : metrics ) {
+				thread_metrics[i].push_back( metric->clone() );
+			}
+		}
+
+		PosePrefetchQueue queue( static_cast< core::Size >( option[ prefetch_depth ]() ), n_readers );
+		std::atomic< core::Size > next_file_index( 1 );
+		utility::vector1< std::string > error_messages( n_measurers );
+		utility::vector1< std::thread > threads;
+		for ( core::Size i( 1 ); i <= n_readers; ++i ) {
+			threads.push_back( std::thread( read_structures_in_thread, std::cref( filenames ), std::ref( next_file_index ), std::ref( n_failed_files ), std::ref( queue ) ) );
+		}
+		for ( core::Size i( 1 ); i <= n_measurers; ++i ) {
+			threads.push_back( std::thread( measure_structures_in_thread, std::ref( queue ), std::cref( thread_metrics[i] ), std::ref( n_poses_measured ), std::ref( error_messages[i] ) ) );
+		}
+		for ( std::thread & thread : threads ) {
+			thread.join();
+		}
+
+		bool measurement_failed( false );
+		for ( std::string const & error_message : error_messages ) {
+			if ( error_message.empty() ) continue;
+			TR.Error << error_message << std::endl;
+			measurement_failed = true;
+		}
+		if ( measurement_failed ) {
+			// The partial data must not be reported.
+			for ( utility::vector1< EnsembleMetricOP > const & partial_metrics : thread_metrics ) {
+				for ( EnsembleMetricOP const & metric : partial_metrics ) {
+					metric->reset();
+				}
+			}
+			utility_exit_with_message( "Ensemble metrics could not be measured.  See the errors above." );
+		}
+
+		for ( core::Size i( 2 ); i <= n_measurers; ++i ) {
+			merge_ensemble_metrics( thread_metrics[i], metrics );
+		}
+#else
+		if ( option[ reader_threads ]() > 1 || option[ measurement_threads ]() > 1 ) {
+			TR.Warning << "Ignoring the -reader_threads and -measurement_threads options, since this is not a multi-threaded build of Rosetta.  (Build with extras=cxx11thread to read and measure with multiple threads.)" << std::endl;
+		}
+		TR << "Analysing " << filenames.size() << " structure file(s)." << std::endl;
+		for ( std::string const & filename : filenames ) {
+			// Errors reading a file skip it, but errors measuring a pose stop the run, as in the multi-threaded case.
+			std::string measurement_error;
+			try {
+				read_structure_file( filename, [&metrics, &n_poses_measured, &measurement_error]( core::pose::PoseOP const & pose ){
+					try {
+						measure_pose( metrics, *pose );
+					} catch ( utility::excn::Exception const & e ) {
+						measurement_error = e.msg();
+						throw;
+					} catch ( std::exception const & e ) {
+						measurement_error = e.what();
+						throw;
+					}
+					++n_poses_measured;
+				} );
+			} catch ( utility::excn::Exception const & e ) {
+				if ( measurement_error.empty() ) {
+					TR.Error << "Could not read structure file \"" << filename << "\": " << e.msg() << std::endl;
+					++n_failed_files;
+				}
+			} catch ( std::exception const & e ) {
+				if ( measurement_error.empty() ) {
+					TR.Error << "Could not read structure file \"" << filename << "\": " << e.what() << std::endl;
+					++n_failed_files;
+				}
+			}
+			if ( !measurement_error.empty() ) {
+				// The partial data must not be reported.
+				for ( EnsembleMetricOP const & metric : metrics ) {
+					metric->reset();
+				}
+				utility_exit_with_message( "Error measuring a pose from \"" + filename + "\": " + measurement_error );
+			}
+		}
+#endif
+
+		core::Real const elapsed_seconds( std::chrono::duration< core::Real >( std::chrono::steady_clock::now() - start_time ).count() );
+		TR << "Measured " << n_poses_measured.load() << " poses in " << elapsed_seconds << " seconds (" << ( elapsed_seconds > 0.0 ? static_cast< core::Real >( n_poses_measured.load() ) / elapsed_seconds : 0.0 ) << " poses per second)." << std::endl;
+		if ( n_failed_files.load() > 0 ) {
+			TR.Warning << n_failed_files.load() << " structure file(s) could not be read, and were skipped." << std::endl;
+		}
+		runtime_assert_string_msg( n_poses_measured.load() > 0, "No poses were measured." );
+
+		for ( EnsembleMetricOP const & metric : metrics ) {
+			metric->produce_final_report();
+		}
+
+	} catch ( utility::excn::Exception const & e ) {
+		e.display();
+		return -1;
+	}
+	return 0;
+}
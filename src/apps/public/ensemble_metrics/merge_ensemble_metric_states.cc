@@ -0,0 +1,265 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (merge_ensemble_metric_states.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file apps/public/ensemble_metrics/merge_ensemble_metric_states.cc
+/// @brief An application that merges the states saved by EnsembleMetrics in independent runs (e.g. the tasks of a
+/// cluster array job), and produces the reports that the combined ensembles would have produced.
+/// @details Each EnsembleMetric configured with the state_dump_filename option saves its accumulated data to a binary
+/// state file when it produces its report.  This application reads any number of these files, groups them by
+/// ensemble metric label, and merges each group into one EnsembleMetric of the type that wrote it.  Files are read one
+/// at a time by each thread, so memory use is bounded by the merged data plus one file per thread.  In multi-threaded
+/// builds, threads merge disjoint subsets of the files, and the partial results are then merged.
+/// @note State files use native byte order, so they must be merged on the same architecture that wrote them.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Devel headers
+#include <devel/init.hh>
+
+// Protocols headers
+#include <protocols/ensemble_metrics/EnsembleMetric.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricFactory.hh>
+
+// Basic headers
+#include <basic/options/option.hh>
+#include <basic/options/option_macros.hh>
+#include <basic/Tracer.hh>
+
+// Utility headers
+#include <utility/excn/Exceptions.hh>
+#include <utility/exit.hh>
+#include <utility/io/izstream.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <string>
+
+#ifdef MULTI_THREADED
+#include <thread>
+#endif
+
+static basic::Tracer TR( "apps.public.ensemble_metrics.merge_ensemble_metric_states" );
+
+OPT_KEY( StringVector, state_files )
+OPT_KEY( String, state_file_list )
+OPT_KEY( Integer, merge_threads )
+OPT_KEY( String, report_file )
+OPT_KEY( String, merged_state_file )
+
+/// @brief The merged EnsembleMetrics, by label.
+typedef std::map< std::string, protocols::ensemble_metrics::EnsembleMetricOP > MergedEnsembleMetricMap;
+
+/// @brief Indicate which options are relevant.
+void
+register_options() {
+	NEW_OPT( state_files, "The ensemble metric state files to merge (written by ensemble metrics configured with the state_dump_filename option).", utility::vector1< std::string >() );
+	NEW_OPT( state_file_list, "A file listing ensemble metric state files to merge, one per line.  May be combined with -state_files.", "" );
+	NEW_OPT( merge_threads, "The number of threads to use for reading and merging state files.  Only used in multi-threaded builds (extras=cxx11thread).  A value of 0 means to use all available hardware threads.  Defaults to 1.", 1 );
+	NEW_OPT( report_file, "If provided, each merged report is written to this file (prefixed with the ensemble metric label if states from more than one ensemble metric are merged).  Otherwise, reports are written to the tracer.", "" );
+	NEW_OPT( merged_state_file, "If provided, the merged state of each ensemble metric is saved to this file (prefixed with the ensemble metric label if states from more than one ensemble metric are merged), so that merges can themselves be merged later.", "" );
+}
+
+/// @brief Get the list of state files from the -state_files and -state_file_list options.
+utility::vector1< std::string >
+get_state_filenames() {
+	using namespace basic::options;
+	using namespace basic::options::OptionKeys;
+
+	utility::vector1< std::string > filenames;
+	if ( option[ state_files ].user() ) {
+		for ( std::string const & filename : option[ state_files ]() ) {
+			filenames.push_back( filename );
+		}
+	}
+	if ( option[ state_file_list ].user() ) {
+		utility::io::izstream listfile( option[ state_file_list ]() );
+		runtime_assert_string_msg( listfile.good(), "Could not open the state file list \"" + option[ state_file_list ]() + "\"." );
+		std::string line;
+		while ( listfile.getline( line ) ) {
+			std::string::size_type const first( line.find_first_not_of( " \t\r" ) );
+			if ( first == std::string::npos ) continue;
+			std::string::size_type const last( line.find_last_not_of( " \t\r" ) );
+			filenames.push_back( line.substr( first, last - first + 1 ) );
+		}
+		listfile.close();
+	}
+	return filenames;
+}
+
+/// @brief Read state files, claiming the next unread one from the shared counter each time, and merge each into the
+/// EnsembleMetric for its label in this thread's map (creating it if necessary).
+/// @details Each thread has its own map, so no locking is needed.  Only one file is held in memory at a time.  Errors
+/// are caught and stored in error_message (so that they can be reported after all threads are joined), and stop all
+/// threads from claiming more files.
+void
+merge_state_files_in_thread(
+	utility::vector1< std::string > const & filenames,
+	std::atomic< core::Size > & next_file_index,
+	MergedEnsembleMetricMap & merged_metrics,
+	std::string & error_message
+) {
+	core::Size i(0);
+	try {
+		for ( i = next_file_index++; i <= filenames.size(); i = next_file_index++ ) {
+			std::string label;
+			std::string const summary( protocols::ensemble_metrics::EnsembleMetric::read_state_file( filenames[i], label ) );
+			MergedEnsembleMetricMap::iterator it( merged_metrics.find( label ) );
+			if ( it == merged_metrics.end() ) {
+				protocols::ensemble_metrics::EnsembleMetricOP new_metric( protocols::ensemble_metrics::EnsembleMetricFactory::get_instance()->new_ensemble_metric(
+					protocols::ensemble_metrics::EnsembleMetric::ensemble_metric_name_from_summary( summary )
+					) );
+				// The factory knows only the type, so the label options are recovered from the label itself.
+				new_metric->set_label_prefix_and_suffix_from_label( label );
+				it = merged_metrics.emplace( label, new_metric ).first;
+			}
+			it->second->merge_summary( summary );
+			TR.Debug << "Merged \"" << filenames[i] << "\" (" << label << ")." << std::endl;
+		}
+	} catch ( utility::excn::Exception const & e ) {
+		error_message = "Error merging \"" + filenames[i] + "\": " + e.msg();
+	} catch ( std::exception const & e ) {
+		error_message = "Error merging \"" + filenames[i] + "\": " + e.what();
+	}
+	if ( !error_message.empty() ) {
+		// Stop the other threads.
+		next_file_index = filenames.size() + 1;
+	}
+}
+
+/// @brief Merge the EnsembleMetrics in one thread's map into the final map.
+/// @details The partial EnsembleMetrics are reset afterward, so that they do not report on destruction.
+void
+merge_partial_results(
+	MergedEnsembleMetricMap & partial_metrics,
+	MergedEnsembleMetricMap & merged_metrics
+) {
+	for ( MergedEnsembleMetricMap::value_type & entry : partial_metrics ) {
+		MergedEnsembleMetricMap::iterator const it( merged_metrics.find( entry.first ) );
+		if ( it == merged_metrics.end() ) {
+			merged_metrics[ entry.first ] = entry.second;
+			continue;
+		}
+		if ( it->second->supports_ensemble_metric_data_merging() ) {
+			it->second->merge_ensemble_metric_data( *entry.second );
+		} else {
+			it->second->merge_summary( entry.second->pack_summary() );
+		}
+		entry.second->reset();
+	}
+	partial_metrics.clear();
+}
+
+/// @brief Entry point for program execution.
+int
+main( int argc, char * argv [] ) {
+	try {
+		using namespace basic::options;
+		using namespace basic::options::OptionKeys;
+
+		register_options();
+		devel::init( argc, argv );
+
+		utility::vector1< std::string > const filenames( get_state_filenames() );
+		runtime_assert_string_msg( !filenames.empty(), "No ensemble metric state files were provided.  Use the -state_files or -state_file_list option." );
+		runtime_assert_string_msg( option[ merge_threads ]() >= 0, "The -merge_threads option cannot be negative." );
+
+		core::Size n_threads( 1 );
+#ifdef MULTI_THREADED
+		n_threads = static_cast< core::Size >( option[ merge_threads ]() );
+		if ( n_threads == 0 ) n_threads = std::max< core::Size >( 1, std::thread::hardware_concurrency() );
+		n_threads = std::min( n_threads, filenames.size() );
+#else
+		if ( option[ merge_threads ]() > 1 ) {
+			TR.Warning << "Ignoring the -merge_threads option, since this is not a multi-threaded build of Rosetta.  (Build with extras=cxx11thread to merge with multiple threads.)" << std::endl;
+		}
+#endif
+		TR << "Merging " << filenames.size() << " ensemble metric state files using " << n_threads << " thread(s)." << std::endl;
+
+		// Each thread merges into its own map.  The main thread does its share of the work, too.
+		std::atomic< core::Size > next_file_index( 1 );
+		utility::vector1< MergedEnsembleMetricMap > partial_metrics( n_threads );
+		utility::vector1< std::string > error_messages( n_threads );
+#ifdef MULTI_THREADED
+		utility::vector1< std::thread > threads;
+		for ( core::Size i(2); i <= n_threads; ++i ) {
+			threads.push_back( std::thread( merge_state_files_in_thread, std::cref( filenames ), std::ref( next_file_index ), std::ref( partial_metrics[i] ), std::ref( error_messages[i] ) ) );
+		}
+#endif
+		merge_state_files_in_thread( filenames, next_file_index, partial_metrics[1], error_messages[1] );
+#ifdef MULTI_THREADED
+		for ( std::thread & thread : threads ) {
+			thread.join();
+		}
+#endif
+
+		core::Size n_errors(0);
+		for ( std::string const & error_message : error_messages ) {
+			if ( error_message.empty() ) continue;
+			TR.Error << error_message << std::endl;
+			++n_errors;
+		}
+		if ( n_errors > 0 ) {
+			// The partial results are incomplete, so they are discarded without reporting.
+			for ( MergedEnsembleMetricMap & partial : partial_metrics ) {
+				for ( MergedEnsembleMetricMap::value_type & entry : partial ) {
+					entry.second->reset();
+				}
+			}
+			utility_exit_with_message( "Merging failed in " + std::to_string( n_errors ) + " thread(s).  See the errors above." );
+		}
+
+		MergedEnsembleMetricMap merged_metrics;
+		for ( MergedEnsembleMetricMap & partial : partial_metrics ) {
+			merge_partial_results( partial, merged_metrics );
+		}
+
+		// Report, and save the merged states if requested.
+		bool const prefix_labels( merged_metrics.size() > 1 );
+		for ( MergedEnsembleMetricMap::value_type const & entry : merged_metrics ) {
+			std::string const prefix( prefix_labels ? entry.first + "_" : "" );
+			TR << "Merged " << entry.second->poses_in_ensemble() << " poses for the " << entry.first << " ensemble metric." << std::endl;
+			if ( option[ merged_state_file ].user() ) {
+				entry.second->save_state_to_file( prefix + option[ merged_state_file ]() );
+			}
+			if ( option[ report_file ].user() ) {
+				entry.second->set_output_mode( protocols::ensemble_metrics::EnsembleMetricOutputMode::FILE );
+				entry.second->set_output_filename( prefix + option[ report_file ]() );
+			}
+			entry.second->produce_final_report();
+		}
+
+	} catch ( utility::excn::Exception const & e ) {
+		e.display();
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,113 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (reanalyse_ensemble_metric_dumps.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file apps/public/ensemble_metrics/reanalyse_ensemble_metric_dumps.cc
+/// @brief An application that reloads the per-pose values dumped by EnsembleMetrics (with the columnar_dump_filename
+/// option) and recomputes the central tendency statistics of the combined ensemble, plus any requested quantiles,
+/// without rerunning Rosetta.
+/// @details Each dump file is memory-mapped, and one column of values is fed, block by block, straight from the
+/// mapping into a CentralTendencyEnsembleMetric.  Dumps written without compression are read in place, without
+/// copying; compressed dumps are decompressed one block at a time.
+/// @note Dumps use native byte order, so they must be read on the same architecture that wrote them.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Devel headers
+#include <devel/init.hh>
+
+// Protocols headers
+#include <protocols/ensemble_metrics/EnsembleMetricColumnarDumpReader.hh>
+#include <protocols/ensemble_metrics/metrics/CentralTendencyEnsembleMetric.hh>
+#include <protocols/ensemble_metrics/metrics/CentralTendencyStatistics.hh>
+
+// Basic headers
+#include <basic/options/option.hh>
+#include <basic/options/option_macros.hh>
+#include <basic/Tracer.hh>
+
+// Utility headers
+#include <utility/excn/Exceptions.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <string>
+
+static basic::Tracer TR( "apps.public.ensemble_metrics.reanalyse_ensemble_metric_dumps" );
+
+OPT_KEY( StringVector, dump_files )
+OPT_KEY( String, column )
+OPT_KEY( RealVector, quantiles )
+OPT_KEY( String, report_file )
+
+/// @brief Indicate which options are relevant.
+void
+register_options() {
+	NEW_OPT( dump_files, "The columnar dump files to reanalyse (written by ensemble metrics configured with the columnar_dump_filename option).  The values in all files are combined into one ensemble.", utility::vector1< std::string >() );
+	NEW_OPT( column, "The name of the value column to analyse.  If not provided, the first column is used.", "" );
+	NEW_OPT( quantiles, "Quantiles to compute, in addition to the central tendency statistics, given as fractions between 0 and 1 (e.g. 0.05 0.95).", utility::vector1< core::Real >() );
+	NEW_OPT( report_file, "If provided, the central tendency report is written to this file.  Otherwise, it is written to the tracer.", "" );
+}
+
+/// @brief Entry point for program execution.
+int
+main( int argc, char * argv [] ) {
+	try {
+		using namespace basic::options;
+		using namespace basic::options::OptionKeys;
+		using namespace protocols::ensemble_metrics;
+
+		register_options();
+		devel::init( argc, argv );
+
+		runtime_assert_string_msg( option[ dump_files ].user() && !option[ dump_files ]().empty(), "No columnar dump files were provided.  Use the -dump_files option." );
+
+		metrics::CentralTendencyEnsembleMetric ctmetric;
+		for ( std::string const & filename : option[ dump_files ]() ) {
+			EnsembleMetricColumnarDumpReader const reader( filename );
+			core::Size const column_index( option[ column ]().empty() ? 1 : reader.column_index( option[ column ]() ) );
+			reader.add_column_to_metric( ctmetric, column_index );
+			TR << "Read " << reader.n_records() << " values of " << reader.column_names()[ column_index ] << " from " << reader.job_names().size() << " job(s) in \"" << filename << "\" (" << reader.n_compressed_blocks() << " of " << reader.n_blocks() << " blocks compressed)." << std::endl;
+		}
+		runtime_assert_string_msg( ctmetric.poses_in_ensemble() > 0, "The columnar dump files contained no values." );
+
+		for ( core::Real const fraction : option[ quantiles ]() ) {
+			TR << "Quantile " << fraction << ":\t" << ctmetric.statistics().quantile( fraction ) << std::endl;
+		}
+
+		if ( option[ report_file ].user() ) {
+			ctmetric.set_output_mode( EnsembleMetricOutputMode::FILE );
+			ctmetric.set_output_filename( option[ report_file ]() );
+		}
+		ctmetric.produce_final_report();
+
+	} catch ( utility::excn::Exception const & e ) {
+		e.display();
+		return -1;
+	}
+	return 0;
+}
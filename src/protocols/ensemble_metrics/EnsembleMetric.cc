@@ -36,6 +36,13 @@
 
 // Project headers:
 #include <protocols/ensemble_metrics/EnsembleMetric.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricObserver.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricPerformanceCounters.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryIO.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricSharedMemoryAggregator.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricReportFileManager.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricReportWriter.hh>
+#include <protocols/ensemble_metrics/observers/ColumnarDumpEnsembleMetricObserver.hh>
 #include <protocols/ensemble_metrics/util.hh>
 
 // Core headers:
@@ -43,6 +50,10 @@
 
 // Protocols headers:
 #include <protocols/jd2/util.hh>
+#ifdef USEMPI
+#include <protocols/jd2/JobDistributor.hh>
+#include <protocols/jd2/MPIWorkPoolJobDistributor.hh>
+#endif
 #include <protocols/moves/Mover.hh>
 #include <protocols/rosetta_scripts/util.hh>
 
@@ -60,6 +71,24 @@
 
 //STL headers:
 #include <functional>
+#include <fstream>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <set>
+
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#define ENSEMBLE_METRIC_POSIX_STATE_FILES
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #ifdef    SERIALIZATION
 // Utility serialization headers
@@ -71,10 +100,178 @@
 
 static basic::Tracer TR( "protocols.ensemble_metrics.EnsembleMetric" );
 
+/// @brief Magic number at the start of every ensemble metric summary ("EMSM" in ASCII).
+static std::uint32_t const ensemble_metric_summary_magic( 0x454D534D );
+
+/// @brief Version of the ensemble metric summary header.  Increment this if the header format changes.
+static std::uint32_t const ensemble_metric_summary_version( 1 );
+
+/// @brief Magic number at the start of every ensemble metric state file ("EMST" in ASCII).
+static std::uint32_t const ensemble_metric_state_file_magic( 0x454D5354 );
+
+/// @brief Version of the ensemble metric state file format.  Increment this if the format changes.
+static std::uint32_t const ensemble_metric_state_file_version( 1 );
+
+/// @brief Magic number at the start of every binary ensemble metric report record ("EMRP" in ASCII).
+static std::uint32_t const ensemble_metric_binary_report_magic( 0x454D5250 );
+
+/// @brief Version of the binary ensemble metric report record.  Increment this if the format changes.
+static std::uint32_t const ensemble_metric_binary_report_version( 2 );
+
+#ifdef SERIALIZATION
+/// @brief Is this thread serializing an EnsembleMetric into a summary?  If so, save() leaves out the movers, which
+/// are configuration rather than accumulated data, and which can be large.
+static thread_local bool serializing_ensemble_metric_summary( false );
+
+/// @brief Sets serializing_ensemble_metric_summary for its lifetime.
+class EnsembleMetricSummarySerializationScope {
+public:
+	EnsembleMetricSummarySerializationScope() { serializing_ensemble_metric_summary = true; }
+	~EnsembleMetricSummarySerializationScope() { serializing_ensemble_metric_summary = false; }
+	EnsembleMetricSummarySerializationScope( EnsembleMetricSummarySerializationScope const & ) = delete;
+	EnsembleMetricSummarySerializationScope & operator=( EnsembleMetricSummarySerializationScope const & ) = delete;
+};
+#endif // SERIALIZATION
+
+/// @brief Write a string to a JSON record, quoted and escaped.
+static
+void
+write_json_string(
+	std::ostream & out,
+	std::string const & str
+) {
+	out << '"';
+	for ( char const c : str ) {
+		switch( c ) {
+		case '"' :
+			out << "\\\"";
+			break;
+		case '\\' :
+			out << "\\\\";
+			break;
+		case '\n' :
+			out << "\\n";
+			break;
+		case '\t' :
+			out << "\\t";
+			break;
+		default :
+			if ( static_cast< unsigned char >( c ) < 0x20 ) {
+				static char const * const hex_digits( "0123456789abcdef" );
+				out << "\\u00" << hex_digits[ ( c >> 4 ) & 0xF ] << hex_digits[ c & 0xF ];
+			} else {
+				out << c;
+			}
+		}
+	}
+	out << '"';
+}
+
+/// @brief Write a real number to a JSON record.  JSON has no representation for NaN or infinity, so these are
+/// written as null.
+static
+void
+write_json_number(
+	std::ostream & out,
+	core::Real const value
+) {
+	if ( std::isfinite( value ) ) {
+		out << value;
+	} else {
+		out << "null";
+	}
+}
+
+/// @brief Write a real number to a CSV record.  NaN and infinity are written as empty fields, so that CSV and JSON
+/// records both represent them as missing values.
+static
+void
+write_csv_number(
+	std::ostream & out,
+	core::Real const value
+) {
+	if ( std::isfinite( value ) ) out << value;
+}
+
+/// @brief Write a string to a CSV record, quoted (with embedded quotes doubled) only if it contains a delimiter,
+/// quote, or line break.
+static
+void
+write_csv_string(
+	std::ostream & out,
+	std::string const & str
+) {
+	if ( str.find_first_of( ",\"\n\r" ) == std::string::npos ) {
+		out << str;
+		return;
+	}
+	out << '"';
+	for ( char const c : str ) {
+		if ( c == '"' ) out << '"';
+		out << c;
+	}
+	out << '"';
+}
+
+/// @brief Write a fixed-size value to a binary record, in native byte order.
+template< typename T >
+static
+void
+write_binary_value(
+	std::ostream & out,
+	T const value
+) {
+	out.write( reinterpret_cast< char const * >( &value ), sizeof( T ) );
+}
+
+/// @brief Write a string to a binary record, as a std::uint64_t length followed by the characters.
+static
+void
+write_binary_string(
+	std::ostream & out,
+	std::string const & str
+) {
+	write_binary_value< std::uint64_t >( out, static_cast< std::uint64_t >( str.size() ) );
+	out.write( str.data(), static_cast< std::streamsize >( str.size() ) );
+}
+
+/// @brief Is this the first time that this CSV header is written to the tracer for ensemble metrics with this name?
+/// @details Reports to the tracer are one continuous stream, so each header is written once per process, however many
+/// copies of the ensemble metric report.  (Ensemble metrics with performance counters have a different header.)
+static
+bool
+first_csv_header_for_tracer(
+	std::string const & metric_name,
+	std::string const & header
+) {
+	static std::set< std::string > headers_written;
+#ifdef MULTI_THREADED
+	static std::mutex headers_written_mutex;
+	std::lock_guard< std::mutex > lock( headers_written_mutex );
+#endif
+	return headers_written.insert( metric_name + "\n" + header ).second;
+}
 
 namespace protocols {
 namespace ensemble_metrics {
 
+/// @brief Given the observers of an ensemble metric, get the observers that a copy of it should use.
+/// @details Each observer's observer_for_metric_copy() function decides whether the copy shares it or uses
+/// another observer.
+static
+utility::vector1< EnsembleMetricObserverOP >
+observers_for_copy(
+	utility::vector1< EnsembleMetricObserverOP > const & observers
+) {
+	utility::vector1< EnsembleMetricObserverOP > copied_observers;
+	copied_observers.reserve( observers.size() );
+	for ( EnsembleMetricObserverOP const & observer : observers ) {
+		EnsembleMetricObserverOP const observer_for_copy( observer->observer_for_metric_copy() );
+		copied_observers.push_back( observer_for_copy == nullptr ? observer : observer_for_copy );
+	}
+	return copied_observers;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // CONSTRUCTOR AND DESTRUCTOR
 ////////////////////////////////////////////////////////////////////////////////
@@ -89,17 +286,35 @@ EnsembleMetric::EnsembleMetric(
 ) :
 	VirtualBase( src ),
 	finalized_( src.finalized_ ),
+	generation_( src.generation_ ),
 	use_additional_output_from_last_mover_( src.use_additional_output_from_last_mover_ ),
 	output_mode_( src.output_mode_ ),
 	output_filename_( src.output_filename_ ),
+	report_format_( src.report_format_ ),
+	single_report_file_( src.single_report_file_ ),
+	write_reports_in_background_( src.write_reports_in_background_ ),
 	label_prefix_( src.label_prefix_ ),
 	label_suffix_( src.label_suffix_ ),
 	last_mover_( src.last_mover_ == nullptr ? nullptr : src.last_mover_->clone() ),
 	ensemble_generating_protocol_( src.ensemble_generating_protocol_ == nullptr ? nullptr : src.ensemble_generating_protocol_->clone() ),
 	ensemble_generating_protocol_repeats_( src.ensemble_generating_protocol_repeats_ ),
 	poses_in_ensemble_( src.poses_in_ensemble_ ),
-	n_threads_( src.n_threads_ )
-{}
+	poses_packed_in_summary_deltas_( src.poses_packed_in_summary_deltas_ ),
+	n_threads_( src.n_threads_ ),
+	collect_ensemble_generation_timings_( src.collect_ensemble_generation_timings_ ),
+	distribute_ensemble_generation_with_mpi_( src.distribute_ensemble_generation_with_mpi_ ),
+	ensemble_generation_timings_( src.ensemble_generation_timings_ ),
+	performance_counters_( src.performance_counters_ == nullptr ? nullptr : src.performance_counters_->clone() ),
+	observers_( observers_for_copy( src.observers_ ) ),
+	shared_memory_aggregator_( src.shared_memory_aggregator_ ),
+	state_dump_filename_( src.state_dump_filename_ ),
+	current_attempt_index_( src.current_attempt_index_ )
+{
+	if ( shared_memory_aggregator_ != nullptr ) {
+		shared_memory_aggregator_->register_local_copy();
+		shared_memory_contribution_pending_ = true;
+	}
+}
 
 /// @brief Assignment operator.
 /// @details Has to be explicit because std::mutex has a deleted assignment operator.
@@ -111,23 +326,60 @@ EnsembleMetric::operator=(
 		return *this; //Do nothing if we're copying from ourself.
 	}
 	finalized_ = src.finalized_;
+	++generation_;
 	use_additional_output_from_last_mover_ = src.use_additional_output_from_last_mover_;
 	output_mode_ = src.output_mode_;
 	output_filename_ = src.output_filename_;
+	report_format_ = src.report_format_;
+	single_report_file_ = src.single_report_file_;
+	write_reports_in_background_ = src.write_reports_in_background_;
 	label_prefix_ = src.label_prefix_;
 	label_suffix_ = src.label_suffix_;
 	last_mover_ = ( src.last_mover_ == nullptr ? nullptr : src.last_mover_->clone() );
 	ensemble_generating_protocol_ = ( src.ensemble_generating_protocol_ == nullptr ? nullptr : src.ensemble_generating_protocol_->clone() );
 	ensemble_generating_protocol_repeats_ = src.ensemble_generating_protocol_repeats_;
 	poses_in_ensemble_ = src.poses_in_ensemble_;
+	poses_packed_in_summary_deltas_ = src.poses_packed_in_summary_deltas_;
 	n_threads_ = src.n_threads_;
+	collect_ensemble_generation_timings_ = src.collect_ensemble_generation_timings_;
+	distribute_ensemble_generation_with_mpi_ = src.distribute_ensemble_generation_with_mpi_;
+	ensemble_generation_timings_ = src.ensemble_generation_timings_;
+	performance_counters_ = ( src.performance_counters_ == nullptr ? nullptr : src.performance_counters_->clone() );
+	observers_ = observers_for_copy( src.observers_ );
+	if ( shared_memory_aggregator_ != nullptr && shared_memory_contribution_pending_ ) {
+		shared_memory_aggregator_->unregister_local_copy();
+	}
+	shared_memory_aggregator_ = src.shared_memory_aggregator_;
+	shared_memory_contribution_pending_ = ( shared_memory_aggregator_ != nullptr );
+	if ( shared_memory_contribution_pending_ ) {
+		shared_memory_aggregator_->register_local_copy();
+	}
+	state_dump_filename_ = src.state_dump_filename_;
+	current_attempt_index_ = src.current_attempt_index_;
 	return *this;
 }
 
 /// @brief Destructor.
 /// @note On destruction, an ensemble metric that has not yet reported does its final report.  This
 /// behaviour must be implemented by derived classes due to order of calls to destructors.
-EnsembleMetric::~EnsembleMetric() = default;
+EnsembleMetric::~EnsembleMetric() {
+	if ( shared_memory_aggregator_ != nullptr && shared_memory_contribution_pending_ ) {
+		shared_memory_aggregator_->unregister_local_copy();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRIVATE VIRTUAL FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Finish computing the real-valued metrics from the accumulated data, so that
+/// derived_get_real_metric_value_by_name() can be called, without producing a text report.
+/// @details Called instead of produce_final_report_string() when a machine-readable report format is used.  The
+/// default implementation does nothing; derived classes that only compute their real-valued metrics in
+/// produce_final_report_string() must override this.
+/*virtual*/
+void
+EnsembleMetric::finalize_real_valued_metrics() {}
 
 ////////////////////////////////////////////////////////////////////////////////
 // STATIC ENUM FUNCTIONS
@@ -166,6 +418,41 @@ EnsembleMetric::output_mode_name_from_enum(
 	return "FAIL"; //Should never reach here; keeps compiler happy.
 }
 
+/// @brief Given a report format name, get the enum.
+/// @details Returns UNKNOWN_FORMAT if string can't be interpreted.
+EnsembleMetricReportFormat
+EnsembleMetric::report_format_enum_from_name(
+	std::string const & format_name
+) {
+	for ( core::Size i(1); i <= static_cast<core::Size>(EnsembleMetricReportFormat::N_REPORT_FORMATS); ++i ) {
+		if ( format_name == report_format_name_from_enum( static_cast< EnsembleMetricReportFormat >(i) ) ) {
+			return static_cast< EnsembleMetricReportFormat >(i);
+		}
+	}
+	return EnsembleMetricReportFormat::UNKNOWN_FORMAT;
+}
+
+/// @brief Given a report format enum, get the name.
+/// @details Throws if bad format.
+std::string
+EnsembleMetric::report_format_name_from_enum(
+	EnsembleMetricReportFormat const format_enum
+) {
+	switch( format_enum ) {
+	case EnsembleMetricReportFormat::TEXT :
+		return "text";
+	case EnsembleMetricReportFormat::JSON_LINES :
+		return "json_lines";
+	case EnsembleMetricReportFormat::CSV :
+		return "csv";
+	case EnsembleMetricReportFormat::BINARY :
+		return "binary";
+	default :
+		utility_exit_with_message( "Error in EnsembleMetric::report_format_name_from_enum(): Unknown enum found!  This should not happen.  Please consult a developer." );
+	};
+	return "FAIL"; //Should never reach here; keeps compiler happy.
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // PUBLIC APPLY FUNCTION (NOT VIRUTAL)
 ////////////////////////////////////////////////////////////////////////////////
@@ -202,11 +489,24 @@ EnsembleMetric::apply(
 			"protocol, or set the use_addtional_output_from_last_mover option to true."
 		);
 	}
+	if ( distribute_ensemble_generation_with_mpi_ && ensemble_generating_protocol_ != nullptr ) {
+		runtime_assert_string_msg(
+			supports_summary_merging(),
+			errmsg + "The " + name() + " ensemble metric does not support summary merging, so ensemble generation "
+			"cannot be distributed with MPI."
+		);
+		runtime_assert_string_msg(
+			!use_additional_output_from_last_mover_,
+			errmsg + "Ensemble generation cannot be distributed with MPI when the additional output from the last "
+			"mover is used, since each process has its own copy of the last mover's output."
+		);
+	}
 #endif
 
 	if ( ensemble_generating_protocol_ == nullptr ) {
 		++poses_in_ensemble_;
-		add_pose_to_ensemble( pose );
+		current_attempt_index_ = poses_in_ensemble_;
+		profiled_add_pose_to_ensemble( pose );
 		if ( use_additional_output_from_last_mover_ && last_mover_ != nullptr ) {
 			protocols::moves::MoverOP mover_copy( last_mover_->clone() );
 			core::pose::PoseOP curpose;
@@ -214,12 +514,29 @@ EnsembleMetric::apply(
 				curpose = mover_copy->get_additional_output();
 				if ( curpose == nullptr ) break;
 				++poses_in_ensemble_;
-				add_pose_to_ensemble( *curpose );
+				current_attempt_index_ = poses_in_ensemble_;
+				profiled_add_pose_to_ensemble( *curpose );
 			} while(true);
 			produce_final_report();
 		}
 	} else {
 		generate_ensemble_and_apply_to_poses( pose );
+#ifdef USEMPI
+		if ( distribute_ensemble_generation_with_mpi_ ) {
+			int mpirank(0);
+			MPI_Comm_rank( MPI_COMM_WORLD, &mpirank );
+			if ( mpirank != 0 ) {
+				// Every process holds the merged data, but only process 0 reports.  The other processes still
+				// finalize, so that filters can query the metric's values.
+				for ( EnsembleMetricObserverOP const & observer : observers_ ) {
+					observer->flush();
+				}
+				profiled_final_report_string();
+				finalized_ = true;
+				return;
+			}
+		}
+#endif
 		produce_final_report();
 	}
 }
@@ -233,16 +550,47 @@ EnsembleMetric::apply(
 /// Writes to disk if output_mode_ == EnsembleMetricOutputMode::FILE!
 void
 EnsembleMetric::produce_final_report() {
+	for ( EnsembleMetricObserverOP const & observer : observers_ ) {
+		observer->flush();
+	}
+
+	bool consolidated( false );
+	if ( shared_memory_aggregator_ != nullptr && shared_memory_contribution_pending_ ) {
+		runtime_assert_string_msg( reports_at_end(), "Error in EnsembleMetric::produce_final_report(): Shared-memory aggregation "
+			"is only available for ensemble metrics that report at the end of a run, but the " + name() + " ensemble metric "
+			"reports immediately after generating an ensemble."
+		);
+		shared_memory_contribution_pending_ = false;
+		if ( !shared_memory_aggregator_->contribute_and_detach( *this ) ) {
+			TR << "Handed the data collected by the " << name() << " ensemble metric to shared-memory segment "
+				<< shared_memory_aggregator_->segment_name() << ".  Another copy of the ensemble metric or another process "
+				"will report them." << std::endl;
+			finalized_ = true;
+			return;
+		}
+		consolidated = ( shared_memory_aggregator_->n_summaries_merged() > 0 );
+	}
+
+	runtime_assert_string_msg( report_format_ != EnsembleMetricReportFormat::BINARY || output_mode_ == EnsembleMetricOutputMode::FILE,
+		"Error in EnsembleMetric::produce_final_report(): The binary report format can only be written to files, but the "
+		"output mode of the " + name() + " ensemble metric is \"" + output_mode_name_from_enum( output_mode_ ) + "\"."
+	);
+
+	// Save the state before producing the report, since some derived classes reorder their data when finalizing.
+	if ( !state_dump_filename_.empty() ) {
+		save_state_to_file( decorated_output_filename( state_dump_filename_, !consolidated ) );
+	}
+
 	switch( output_mode_ ) {
 	case EnsembleMetricOutputMode::TRACER :
-		produce_final_report_to_tracer( get_derived_tracer() );
+		produce_final_report_to_tracer( get_derived_tracer(), consolidated );
 		break;
 	case EnsembleMetricOutputMode::TRACER_AND_FILE :
-		produce_final_report_to_tracer( get_derived_tracer() );
-		produce_final_report_to_file( output_filename_);
+		produce_final_report_to_tracer( get_derived_tracer(), consolidated );
+		produce_final_report_to_file( output_filename_, consolidated );
 		break;
 	case EnsembleMetricOutputMode::FILE :
-		produce_final_report_to_file( output_filename_ );
+		produce_final_report_to_file( output_filename_, consolidated );
 		break;
 	default :
 		utility_exit_with_message( "Invalid output mode for EnsembleMetric " + name() + "!" );
@@ -281,6 +629,32 @@ EnsembleMetric::complex_type_generator_for_ensemble_metric(
 		"The file to which the ensemble metric report will be written if output mode is 'tracer_and_file' or 'file'.  Note that "
 		"this filename will have the job name and number prepended so that each report is unique."
 		)
+		+ XMLSchemaAttribute::attribute_w_default( "report_format", xs_string,
+		"The format of reports from this ensemble metric.  Allowed formats are: 'text' (the default human-readable "
+		"report), 'json_lines' (one JSON object per report), 'csv' (a header line and one row per report), or 'binary' "
+		"(a compact binary record, only available with output mode 'file').  The machine-readable formats hold the "
+		"ensemble metric name and label, the job, the number of poses in the ensemble, the value of each real-valued "
+		"metric that can be filtered on (with NaN and infinite values written as JSON nulls or empty CSV fields), and, "
+		"if profiling is on, the performance counters.  In tracer output, the CSV header is written once per process.",
+		"text"
+		)
+		+ XMLSchemaAttribute::attribute_w_default( "single_report_file", xsct_rosetta_bool,
+		"If true, all reports written to file by this ensemble metric in this process (e.g. one per job) are appended "
+		"to one file, rather than each being written to its own file named with the job name.  The label prefix and "
+		"suffix and, in MPI builds, the process index are still added to the filename.  Writes go through one open "
+		"handle per file.  Reports are buffered (see the -jd2:ensemble_metric_report_buffer_size option), and each "
+		"buffer is appended as complete records under a file lock and flushed to disk, so that several processes can share a file (text reports separated by blank lines; JSON lines and CSV rows one "
+		"per line, with the CSV header written only to an empty file; binary records self-delimiting).  Only used if output mode is 'file' or 'tracer_and_file'.  False by default.",
+		"false"
+		)
+		+ XMLSchemaAttribute::attribute_w_default( "write_reports_in_background", xsct_rosetta_bool,
+		"If true, report files are written by a background writer thread (in multi-threaded builds), so that the next job "
+		"can proceed while the filesystem is slow.  Reports wait in a bounded queue, and a job only waits if the queue is "
+		"full.  All queued reports are written before the process exits, and the time spent writing files is summarized "
+		"in the tracer output at that point.  Only used if output mode is 'file' or 'tracer_and_file'.  In builds without "
+		"multi-threading, reports are written immediately, but the time spent is still summarized.  False by default.",
+		"false"
+		)
 		+ XMLSchemaAttribute( "ensemble_generating_protocol", xs_string,
 		"An optional ParsedProtocol or other mover for generating an ensemble from the current pose.  "
 		"This protocol will be applied repeatedly (ensemble_generating_protocol_repeats times) to generate "
@@ -305,6 +679,57 @@ EnsembleMetric::complex_type_generator_for_ensemble_metric(
 		"FOR MANY ENSEMBLE-GENERATING PROTOCOLS.  When in doubt, leave this set to 1.",
 		"1"
 		)
+		+ XMLSchemaAttribute::attribute_w_default( "profile_with_performance_counters", xsct_rosetta_bool,
+		"If true, the hot paths of this ensemble metric (measuring each pose, finalizing, and MPI summary communication) "
+		"are profiled with hardware performance counters (instructions, cycles, cache misses, and branch misses), and "
+		"the aggregated counts are appended to the report.  Hardware counters are only available on Linux, and only if the "
+		"kernel's perf_event_paranoid setting permits access; otherwise, only call counts and wall times are reported.  "
+		"False by default.",
+		"false"
+		)
+		+ XMLSchemaAttribute::attribute_w_default( "distribute_ensemble_generation_with_mpi", xsct_rosetta_bool,
+		"If true, the repeats of the ensemble-generating protocol are divided among all MPI processes, and the data "
+		"are merged before the report is produced.  Every process must apply this ensemble metric at the same time, so "
+		"this is only suitable for protocols in which all processes run the same job together (not for the JD2 MPI work "
+		"pool).  Only process 0 writes the report.  Has no effect in non-MPI builds.  False by default.",
+		"false"
+		)
+		+ XMLSchemaAttribute( "shared_memory_aggregation_segment", xs_string,
+		"If provided, all processes on this machine that run this ensemble metric merge their data through a POSIX "
+		"shared-memory segment whose name is this prefix followed by an underscore and the ensemble metric label, and "
+		"only the last process to finish writes one consolidated report (without a job name prefix).  This is intended "
+		"for many independent (non-MPI) processes sharing a node.  Only available on Linux and macOS, for ensemble metrics "
+		"that report at the end of a run and that support summary merging.  If a process crashes, no consolidated report "
+		"is written, and the segment must be removed manually (e.g. from /dev/shm on Linux)."
+		)
+		+ XMLSchemaAttribute::attribute_w_default( "shared_memory_aggregation_capacity", xsct_non_negative_integer,
+		"The size, in megabytes, of the shared-memory segment used for shared-memory aggregation, if this process creates "
+		"it.  Processes whose data do not fit write their own reports.  Only used if shared_memory_aggregation_segment is "
+		"provided.  Defaults to 64.",
+		"64"
+		)
+		+ XMLSchemaAttribute( "state_dump_filename", xs_string,
+		"If provided, the accumulated state of this ensemble metric is saved to this binary file when the final report is "
+		"produced (with the filename decorated in the same way as the report filename).  States saved by independent runs "
+		"can be merged with the merge_ensemble_metric_states application to produce the report that the combined ensemble "
+		"would have produced.  Only available for ensemble metrics that support summary merging."
+		)
+		+ XMLSchemaAttribute( "columnar_dump_filename", xs_string,
+		"If provided, the values measured for each pose are streamed, with the attempt index and job of each pose, to "
+		"this compact binary file (with the filename decorated with the label prefix and suffix, and the process index in "
+		"MPI builds).  Values are stored column by column, in blocks, so that they can be reloaded for plotting or re-"
+		"analysis without parsing.  The file spans all jobs run by the process."
+		)
+		+ XMLSchemaAttribute::attribute_w_default( "columnar_dump_block_size", xsct_non_negative_integer,
+		"The number of per-pose records buffered in memory and written as one block of the columnar dump file.  Only "
+		"used if columnar_dump_filename is provided.  Defaults to 65536.",
+		"65536"
+		)
+		+ XMLSchemaAttribute::attribute_w_default( "columnar_dump_compression", xsct_rosetta_bool,
+		"If true, each block of the columnar dump file is compressed with zlib.  If false, the file is larger, but it can "
+		"be memory-mapped and used in place.  Only used if columnar_dump_filename is provided.  True by default.",
+		"true"
+		)
 		+ XMLSchemaAttribute::attribute_w_default( "use_additional_output_from_last_mover", xsct_rosetta_bool,
 		"If true, this ensemble metric will use the additional output from the previous pose (assuming the previous pose "
 		"generates multiple outputs) as the ensemble, analysing it and producing a report immediately.  If false, "
@@ -349,6 +774,12 @@ EnsembleMetric::parse_common_ensemble_metric_options(
 	if ( tag->hasOption( "n_threads" ) ) {
 		set_n_threads( tag->getOption<core::Size>( "n_threads" ) );
 	}
+	if ( tag->hasOption( "profile_with_performance_counters" ) ) {
+		set_profile_with_performance_counters( tag->getOption< bool >( "profile_with_performance_counters" ) );
+	}
+	if ( tag->hasOption( "distribute_ensemble_generation_with_mpi" ) ) {
+		set_distribute_ensemble_generation_with_mpi( tag->getOption< bool >( "distribute_ensemble_generation_with_mpi" ) );
+	}
 	if ( tag->hasOption("use_additional_output_from_last_mover") ) {
 		set_use_additional_output_from_last_mover( tag->getOption<bool>("use_additional_output_from_last_mover") );
 	}
@@ -363,6 +794,48 @@ EnsembleMetric::parse_common_ensemble_metric_options(
 		);
 		set_output_filename( tag->getOption< std::string >( "output_filename" ) );
 	}
+	if ( tag->hasOption( "single_report_file" ) ) {
+		set_single_report_file( tag->getOption< bool >( "single_report_file" ) );
+	}
+	if ( tag->hasOption( "write_reports_in_background" ) ) {
+		set_write_reports_in_background( tag->getOption< bool >( "write_reports_in_background" ) );
+	}
+	if ( tag->hasOption( "report_format" ) ) {
+		set_report_format( tag->getOption< std::string >( "report_format" ) );
+		runtime_assert_string_msg(
+			report_format_ != EnsembleMetricReportFormat::BINARY || output_mode_ == EnsembleMetricOutputMode::FILE,
+			"Error in EnsembleMetric::parse_common_ensemble_metric_options(): The binary report format can only be "
+			"written to files, so the output mode must be \"file\"."
+		);
+	}
+	if ( tag->hasOption( "state_dump_filename" ) ) {
+		set_state_dump_filename( tag->getOption< std::string >( "state_dump_filename" ) );
+	}
+	if ( tag->hasOption( "columnar_dump_filename" ) ) {
+		core::Size const block_size( tag->getOption< core::Size >( "columnar_dump_block_size", 65536 ) );
+		runtime_assert_string_msg( block_size > 0, "Error in EnsembleMetric::parse_common_ensemble_metric_options(): The columnar_dump_block_size option must be nonzero." );
+		set_columnar_dump(
+			tag->getOption< std::string >( "columnar_dump_filename" ),
+			block_size,
+			tag->getOption< bool >( "columnar_dump_compression", true )
+		);
+	} else if ( tag->hasOption( "columnar_dump_block_size" ) || tag->hasOption( "columnar_dump_compression" ) ) {
+		TR.Warning << "WARNING! The columnar_dump_block_size and columnar_dump_compression options have no effect if no file is provided with the columnar_dump_filename option." << std::endl;
+	}
+	if ( tag->hasOption( "shared_memory_aggregation_segment" ) ) {
+		runtime_assert_string_msg(
+			reports_at_end(),
+			"Error in EnsembleMetric::parse_common_ensemble_metric_options(): Shared-memory aggregation is only available "
+			"for ensemble metrics that report at the end of a run, not those with an ensemble-generating protocol or that "
+			"use the additional output from the last mover."
+		);
+		set_shared_memory_aggregation(
+			tag->getOption< std::string >( "shared_memory_aggregation_segment" ),
+			tag->getOption< core::Size >( "shared_memory_aggregation_capacity", 64 ) * 1024 * 1024
+		);
+	} else if ( tag->hasOption( "shared_memory_aggregation_capacity" ) ) {
+		TR.Warning << "WARNING! The shared_memory_aggregation_capacity option has no effect if no segment is provided with the shared_memory_aggregation_segment option." << std::endl;
+	}
 
 #ifdef USEMPI
 	if( ensemble_generating_protocol_ == nullptr && !use_additional_output_from_last_mover_ ) {
@@ -383,10 +856,16 @@ EnsembleMetric::parse_common_ensemble_metric_options(
 
 /// @brief Reset this ensemble metric.  Calls derived_reset() to reset
 /// the data collected by the derived class.
+/// @details Also advances the generation counter.
 void
 EnsembleMetric::reset() {
 	poses_in_ensemble_ = 0;
+	poses_packed_in_summary_deltas_ = 0;
 	finalized_ = false;
+	++generation_;
+	if ( performance_counters_ != nullptr ) {
+		performance_counters_->reset();
+	}
 	derived_reset();
 }
 
@@ -406,6 +885,26 @@ EnsembleMetric::set_label_suffix(
 	label_suffix_ = setting;
 }
 
+/// @brief Set the label prefix and suffix from a label produced by get_ensemble_metric_label() for an ensemble
+/// metric of this type (e.g. one read from a state file).
+/// @details The name of this ensemble metric must appear in the label, preceded by the start of the label or by
+/// an underscore, and followed by the end of the label or by an underscore.  The first such occurrence is used.
+void
+EnsembleMetric::set_label_prefix_and_suffix_from_label(
+	std::string const & label
+) {
+	std::string const metric_name( name() );
+	for ( std::string::size_type position( label.find( metric_name ) ); position != std::string::npos; position = label.find( metric_name, position + 1 ) ) {
+		std::string::size_type const end( position + metric_name.size() );
+		if ( position == 1 || ( position > 1 && label[ position - 1 ] != '_' ) ) continue;
+		if ( end != label.size() && ( label[ end ] != '_' || end + 1 == label.size() ) ) continue;
+		set_label_prefix( position == 0 ? "" : label.substr( 0, position - 1 ) );
+		set_label_suffix( end == label.size() ? "" : label.substr( end + 1 ) );
+		return;
+	}
+	utility_exit_with_message( "Error in EnsembleMetric::set_label_prefix_and_suffix_from_label(): The label \"" + label + "\" was not produced by the " + metric_name + " ensemble metric." );
+}
+
 /// @brief Set the protocol that will generate an ensemble of states.
 /// @details If not set, the ensemble metric just collects data from the current pose.  If set,
 /// the ensemble metric runs this N times to generate N poses, collects data from each, and then
@@ -456,6 +955,50 @@ EnsembleMetric::set_output_filename(
 	output_filename_ = setting;
 }
 
+/// @brief Set report format by string.
+void
+EnsembleMetric::set_report_format(
+	std::string const & format_string
+) {
+	EnsembleMetricReportFormat const format_enum( report_format_enum_from_name( format_string ) );
+	runtime_assert_string_msg( format_enum != EnsembleMetricReportFormat::UNKNOWN_FORMAT, "Error in EnsembleMetric::set_report_format(): \"" + format_string + "\" is not a valid report format." );
+	set_report_format( format_enum );
+}
+
+/// @brief Set report format.
+/// @details Indicate whether the report is human-readable text or a machine-readable record.  The binary format
+/// can only be written to files.
+void
+EnsembleMetric::set_report_format(
+	EnsembleMetricReportFormat const setting
+) {
+	runtime_assert( setting > EnsembleMetricReportFormat::UNKNOWN_FORMAT && setting <= EnsembleMetricReportFormat::N_REPORT_FORMATS );
+	report_format_ = setting;
+}
+
+/// @brief Set whether all reports written to file by this process are appended to one file, rather than written to
+/// one file per job.
+/// @details If true, the job name is not added to the output filename (though the label prefix and suffix and, in MPI
+/// builds, the process index still are), and each report is appended to the file as a record.  Writes go through
+/// one open handle per file, shared by all ensemble metrics in this process.
+void
+EnsembleMetric::set_single_report_file(
+	bool const setting
+) {
+	single_report_file_ = setting;
+}
+
+/// @brief Set whether report files are written by a background writer.
+/// @details If true, the report is rendered when it is produced, and handed to the EnsembleMetricReportWriter, which
+/// writes it in a background thread in multi-threaded builds (so that the next job need not wait for the filesystem),
+/// or immediately in other builds.  Queued reports are written before the process exits.
+void
+EnsembleMetric::set_write_reports_in_background(
+	bool const setting
+) {
+	write_reports_in_background_ = setting;
+}
+
 /// @brief Set the last mover that ran before this ensemble metric.
 /// @details Only used to get additional output, if any, and only if use_additional_output_ is true.
 void
@@ -484,6 +1027,203 @@ EnsembleMetric::set_n_threads(
 #endif
 }
 
+/// @brief Set whether we collect timing statistics (wall time, per-thread time, and time spent waiting
+/// on mutexes) when generating an ensemble with the ensemble-generating protocol.
+/// @details False by default.  Intended for benchmarking the scaling of ensemble generation with thread count.
+void
+EnsembleMetric::set_collect_ensemble_generation_timings(
+	bool const setting
+) {
+	collect_ensemble_generation_timings_ = setting;
+}
+
+/// @brief Set whether we profile the hot paths of this ensemble metric (adding poses, finalizing, and MPI
+/// summary communication) with hardware performance counters.
+/// @details False by default.  When true, the aggregated counters are appended to the report.  Hardware counters
+/// are only available on Linux, and only if the kernel permits access; otherwise, only call counts and wall
+/// times are reported.  Setting this to true discards any counts collected so far.
+void
+EnsembleMetric::set_profile_with_performance_counters(
+	bool const setting
+) {
+	if ( setting ) {
+		performance_counters_ = utility::pointer::make_shared< EnsembleMetricPerformanceCounters >();
+		if ( !EnsembleMetricPerformanceCounters::hardware_counters_available() ) {
+			TR.Warning << "Hardware performance counters are unavailable (either this is not a Linux system, or the kernel's "
+				"perf_event_paranoid setting forbids access).  The " << name() << " ensemble metric will only profile call "
+				"counts and wall times." << std::endl;
+		}
+	} else {
+		performance_counters_ = nullptr;
+	}
+}
+
+/// @brief Set whether the repeats of the ensemble-generating protocol are divided among all of the processes in
+/// MPI_COMM_WORLD.
+/// @details False by default.  When true, every process must apply this metric at the same time, and the metric
+/// must support summary merging.  Has no effect in non-MPI builds.  Throws in MPI builds without serialization
+/// support, and when the JD2 MPI work pool job distributor is in use.
+void
+EnsembleMetric::set_distribute_ensemble_generation_with_mpi(
+	bool const setting
+) {
+#ifdef USEMPI
+	if ( setting ) {
+		std::string const errmsg( "Error in EnsembleMetric::set_distribute_ensemble_generation_with_mpi(): " );
+#ifndef SERIALIZATION
+		utility_exit_with_message( errmsg + "Distributing ensemble generation with MPI requires a build with serialization "
+			"support (extras=mpi,serialization), since the input pose must be broadcast from process 0.  Without it, each "
+			"process would generate its part of the ensemble from its own input pose."
+		);
+#endif
+		// The master process of the work pool never applies movers, so it would never join the collective operations.
+		runtime_assert_string_msg(
+			!protocols::jd2::jd2_used() || dynamic_cast< protocols::jd2::MPIWorkPoolJobDistributor const * >( protocols::jd2::JobDistributor::get_instance() ) == nullptr,
+			errmsg + "Ensemble generation cannot be distributed with MPI when the JD2 MPI work pool job distributor is in "
+			"use, since its master process never applies the " + name() + " ensemble metric.  Use a job distributor in which "
+			"every process applies it the same number of times (e.g. -jd2:mpi_work_partition_job_distributor with a number "
+			"of jobs divisible by the number of processes)."
+		);
+	}
+#else
+	if ( setting ) {
+		TR.Warning << "Distributing ensemble generation with MPI has no effect in non-MPI builds of Rosetta.  The " << name()
+			<< " ensemble metric will generate its ensemble in this process." << std::endl;
+	}
+#endif
+	distribute_ensemble_generation_with_mpi_ = setting;
+}
+
+/// @brief Set up merging of the data collected by this ensemble metric in all processes on this machine through a
+/// named POSIX shared-memory segment, so that only the last process to finish writes one consolidated report.
+/// @details Attaches to the segment immediately (creating it if necessary), unless another copy of this ensemble metric
+/// in this process has already done so, in which case the copies share the attachment.  An empty prefix turns
+/// shared-memory aggregation off.
+void
+EnsembleMetric::set_shared_memory_aggregation(
+	std::string const & segment_prefix,
+	core::Size const capacity_bytes
+) {
+	if ( shared_memory_aggregator_ != nullptr && shared_memory_contribution_pending_ ) {
+		shared_memory_aggregator_->unregister_local_copy();
+	}
+	shared_memory_aggregator_ = nullptr;
+	shared_memory_contribution_pending_ = false;
+	if ( segment_prefix.empty() ) return;
+	runtime_assert_string_msg( supports_summary_merging(), "Error in EnsembleMetric::set_shared_memory_aggregation(): The " + name() + " ensemble metric does not support summary merging, so its data cannot be merged through shared memory." );
+	shared_memory_aggregator_ = EnsembleMetricSharedMemoryAggregator::get_aggregator( segment_prefix + "_" + get_ensemble_metric_label(), capacity_bytes );
+	shared_memory_aggregator_->register_local_copy();
+	shared_memory_contribution_pending_ = true;
+}
+
+/// @brief Set the file to which the accumulated state of this ensemble metric is saved when it produces its final
+/// report.  An empty string (the default) means that no state is saved.
+void
+EnsembleMetric::set_state_dump_filename(
+	std::string const & setting
+) {
+	runtime_assert_string_msg( setting.empty() || supports_summary_merging(), "Error in EnsembleMetric::set_state_dump_filename(): The " + name() + " ensemble metric does not support summary merging, so its state cannot be saved for later merging." );
+	state_dump_filename_ = setting;
+}
+
+/// @brief Register an observer, which will be passed the values measured for each pose as they are measured.
+/// @details The observer is stored by owning pointer, not cloned.  Copies of this ensemble metric share it unless
+/// its observer_for_metric_copy() function provides another observer for them.  Not threadsafe: do not call this while poses are being measured.
+void
+EnsembleMetric::add_observer(
+	EnsembleMetricObserverOP const & observer
+) {
+	runtime_assert_string_msg( observer != nullptr, "Error in EnsembleMetric::add_observer(): A null pointer was passed to this function." );
+	observers_.push_back( observer );
+}
+
+/// @brief Remove all registered observers.
+/// @details Not threadsafe: do not call this while poses are being measured.
+void
+EnsembleMetric::clear_observers() {
+	observers_.clear();
+}
+
+/// @brief Stream the values measured for each pose to a block-compressed, columnar binary file, by registering a
+/// ColumnarDumpEnsembleMetricObserver.
+/// @details The filename is decorated with the label prefix and suffix (and the MPI rank, in MPI builds), but not
+/// the job name, since the file spans jobs: each record carries the index of its job.  Ensemble metrics that write the
+/// same file in this process share one observer, so a metric parsed again for each job continues the file rather than
+/// truncating it.  At most block_records records are buffered before being written.  If compress is true, blocks are
+/// compressed with zlib; otherwise, the file can be used in place when memory-mapped.  Not threadsafe: do not call
+/// this while poses are being measured.
+void
+EnsembleMetric::set_columnar_dump(
+	std::string const & filename,
+	core::Size const block_records,
+	bool const compress
+) {
+	runtime_assert_string_msg( !filename.empty(), "Error in EnsembleMetric::set_columnar_dump(): A filename must be provided." );
+	add_observer(
+		observers::ColumnarDumpEnsembleMetricObserver::observer_for_file(
+			decorated_output_filename( filename, false ), block_records, compress
+		)
+	);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC RAW VALUE INGESTION FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Given the (one-based) index of a metric in real_valued_metric_names(), get its value.
+/// @details The default implementation looks up the name and calls derived_get_real_metric_value_by_name().
+/// Derived classes should override this to return the value without any string work.
+core::Real
+EnsembleMetric::derived_get_real_metric_value_by_index(
+	core::Size const metric_index
+) const {
+	return derived_get_real_metric_value_by_name( real_valued_metric_names()[ metric_index ] );
+}
+
+/// @brief Can this EnsembleMetric accumulate raw per-pose values directly (with add_raw_values()), without
+/// computing them from poses?  The default implementation returns false.
+bool
+EnsembleMetric::supports_raw_value_ingestion() const {
+	return false;
+}
+
+/// @brief Accumulate a contiguous block of raw per-pose values, one per pose, as though measured from poses.
+/// @details The default implementation throws.
+void
+EnsembleMetric::add_raw_values(
+	core::Real const *,
+	core::Size const
+) {
+	utility_exit_with_message( "Error in EnsembleMetric::add_raw_values(): The " + name() + " ensemble metric does not support the ingestion of raw per-pose values." );
+}
+
+/// @brief Prepare to accumulate n_values more raw values, e.g. by pre-allocating storage.
+/// @details The default implementation does nothing.
+void
+EnsembleMetric::reserve_raw_values(
+	core::Size const
+) {}
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC RAW SAMPLE ACCESS FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Can this EnsembleMetric expose the raw per-pose samples that it has accumulated (with raw_samples())?
+/// The default implementation returns false.
+bool
+EnsembleMetric::supports_raw_sample_access() const {
+	return false;
+}
+
+/// @brief Get a read-only view of the raw per-pose samples accumulated so far, pointing directly into this
+/// EnsembleMetric's storage.
+/// @details The default implementation throws.
+EnsembleMetricSampleSpan
+EnsembleMetric::raw_samples() const {
+	utility_exit_with_message( "Error in EnsembleMetric::raw_samples(): The " + name() + " ensemble metric does not provide access to its raw per-pose samples." );
+	return EnsembleMetricSampleSpan();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // PUBLIC GETTERS
 ////////////////////////////////////////////////////////////////////////////////
@@ -496,6 +1236,14 @@ EnsembleMetric::reports_at_end() const {
 	return ( ensemble_generating_protocol_ == nullptr && !use_additional_output_from_last_mover_ );
 }
 
+/// @brief Get the names of the values measured for each pose and passed to observers.
+/// @details Used to label the columns of per-pose dumps.  The default implementation returns an empty list,
+/// in which case generic names are used.
+utility::vector1< std::string >
+EnsembleMetric::per_pose_value_names() const {
+	return utility::vector1< std::string >();
+}
+
 /// @brief Get the label.
 /// @details By default, this is just the name().  If a prefix is provided, it is prepended
 /// followed by an underscore; if a suffix is provided, it is appended preceded by an underscore.
@@ -531,6 +1279,59 @@ EnsembleMetric::get_real_metric_value_by_name(
 	return derived_get_real_metric_value_by_name( metric_name );
 }
 
+/// @brief Given a metric name, get its (one-based) index in real_valued_metric_names(), for use with
+/// get_real_metric_value_by_index().  Throws if this ensemble metric produces no such real-valued metric.
+/// @details Every ensemble metric of a given type returns the same list of names, so the index is stable: it can
+/// be resolved once (e.g. when a script is parsed) and used for the lifetime of the ensemble metric, and of any
+/// copies of it.
+core::Size
+EnsembleMetric::real_valued_metric_index(
+	std::string const & metric_name
+) const {
+	utility::vector1< std::string > const & names( real_valued_metric_names() );
+	for ( core::Size i( 1 ); i <= names.size(); ++i ) {
+		if ( names[i] == metric_name ) return i;
+	}
+	utility_exit_with_message( "Error in EnsembleMetric::real_valued_metric_index(): Metric name \"" + metric_name + "\" was requested, but the " + name() + " ensemble metric produces no such real-valued metric." );
+	return 0; //Keep older compilers happy.  Never reached.
+}
+
+/// @brief Given the (one-based) index of a metric in real_valued_metric_names(), get its value, without any
+/// string lookup.
+/// @details Calls derived_get_real_metric_value_by_index().  The final report must have been generated.
+core::Real
+EnsembleMetric::get_real_metric_value_by_index(
+	core::Size const metric_index
+) const {
+	runtime_assert_string_msg( finalized_, "Error in EnsembleMetric::get_real_metric_value_by_index(): The final report has not yet been generated for the " + name() + " ensemble metric." );
+	debug_assert( metric_index > 0 && metric_index <= real_valued_metric_names().size() );
+	return derived_get_real_metric_value_by_index( metric_index );
+}
+
+/// @brief Given a list of (one-based) indices of metrics in real_valued_metric_names(), get all of their values
+/// in one call.
+/// @details The values vector is resized to match the list of indices, and is filled in the same order.  The
+/// final report must have been generated; this is checked once for the whole batch.
+void
+EnsembleMetric::get_real_metric_values_by_indices(
+	utility::vector1< core::Size > const & metric_indices,
+	utility::vector1< core::Real > & values
+) const {
+	runtime_assert_string_msg( finalized_, "Error in EnsembleMetric::get_real_metric_values_by_indices(): The final report has not yet been generated for the " + name() + " ensemble metric." );
+	values.resize( metric_indices.size() );
+	for ( core::Size i( 1 ), imax( metric_indices.size() ); i <= imax; ++i ) {
+		debug_assert( metric_indices[i] > 0 && metric_indices[i] <= real_valued_metric_names().size() );
+		values[i] = derived_get_real_metric_value_by_index( metric_indices[i] );
+	}
+}
+
+/// @brief Get the performance counters aggregated so far.
+/// @details Null if profiling is off.
+EnsembleMetricPerformanceCountersCOP
+EnsembleMetric::performance_counters() const {
+	return performance_counters_;
+}
+
 /// @brief Get the ensemble generating protocol.
 /// @details Could be nullptr if none is set.
 protocols::moves::MoverCOP
@@ -566,6 +1367,247 @@ EnsembleMetric::increment_poses_in_ensemble(
 	poses_in_ensemble_ += n_additional_poses;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC SUMMARY FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Can the data accumulated by this EnsembleMetric be packed into a flat summary (with pack_summary()) and
+/// merged into another instance (with merge_summary())?  The default implementation returns false; derived classes
+/// that support this must override this to return true.  IF THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT
+/// OVERRIDES FOR derived_pack_summary() AND derived_merge_summary()!
+/// @details Mergeable summaries allow data collected by many instances (e.g. in many MPI processes) to be combined
+/// pairwise, as in a reduction tree, so that no single instance has to receive data from every other instance.
+/// In builds with serialization support, the default implementation returns supports_ensemble_metric_data_merging(),
+/// and the default summary is the serialized state of the EnsembleMetric (without its movers).  A derived class that
+/// relies on this default must still implement derived_merge_ensemble_metric_data(), which does the merging.
+bool
+EnsembleMetric::supports_summary_merging() const {
+#ifdef SERIALIZATION
+	return supports_ensemble_metric_data_merging();
+#else
+	return false;
+#endif
+}
+
+/// @brief Pack all of the data accumulated by this EnsembleMetric so far into a flat binary summary.
+/// @details The base class writes a header (including the name of the EnsembleMetric and the number of poses
+/// in the ensemble), then calls derived_pack_summary() to append the data accumulated by the derived class.
+std::string
+EnsembleMetric::pack_summary() const {
+	runtime_assert_string_msg( supports_summary_merging(), "Error in EnsembleMetric::pack_summary(): The " + name() + " ensemble metric does not support packing its data into a mergeable summary." );
+	std::string summary;
+	EnsembleMetricSummaryWriter writer( summary );
+	write_summary_header( writer, poses_in_ensemble_ );
+	derived_pack_summary( writer );
+	return summary;
+}
+
+/// @brief Merge a summary produced by pack_summary() on another instance of the same EnsembleMetric into
+/// the data accumulated by this instance.
+/// @details The base class reads and checks the header and updates the number of poses in the ensemble, then
+/// calls derived_merge_summary() to merge the data accumulated by the derived class.  Must not be called after
+/// this EnsembleMetric has been finalized.  Not threadsafe.
+void
+EnsembleMetric::merge_summary(
+	std::string const & summary
+) {
+	merge_summary( summary.data(), summary.size() );
+}
+
+/// @brief Merge a summary produced by pack_summary() on another instance of the same EnsembleMetric into
+/// the data accumulated by this instance.  This version takes a pointer to a block of memory and its size.
+/// @details The base class reads and checks the header and updates the number of poses in the ensemble, then
+/// calls derived_merge_summary() to merge the data accumulated by the derived class.  Must not be called after
+/// this EnsembleMetric has been finalized.  Not threadsafe.
+void
+EnsembleMetric::merge_summary(
+	char const * data,
+	core::Size const n_bytes
+) {
+	std::string const errmsg( "Error in EnsembleMetric::merge_summary(): " );
+	runtime_assert_string_msg( supports_summary_merging(), errmsg + "The " + name() + " ensemble metric does not support merging of summaries." );
+	runtime_assert_string_msg( !finalized_, errmsg + "The " + name() + " ensemble metric has already been finalized.  The reset() function must be called before accumulating more data." );
+
+	EnsembleMetricSummaryReader reader( data, n_bytes );
+	runtime_assert_string_msg( reader.read< std::uint32_t >() == ensemble_metric_summary_magic, errmsg + "The data are not an ensemble metric summary." );
+	std::uint32_t const version( reader.read< std::uint32_t >() );
+	runtime_assert_string_msg( version == ensemble_metric_summary_version, errmsg + "Unsupported ensemble metric summary version " + std::to_string( version ) + "." );
+	std::string const summary_name( reader.read_string() );
+	runtime_assert_string_msg( summary_name == name(), errmsg + "A summary produced by the " + summary_name + " ensemble metric cannot be merged into the " + name() + " ensemble metric." );
+	core::Size const n_additional_poses( static_cast< core::Size >( reader.read< std::uint64_t >() ) );
+
+	derived_merge_summary( reader, n_additional_poses );
+	runtime_assert_string_msg( reader.remaining() == 0, errmsg + "The " + name() + " ensemble metric did not read the whole summary.  The summary may be corrupt." );
+	poses_in_ensemble_ += n_additional_poses;
+}
+
+/// @brief Can this EnsembleMetric pack only the data accumulated since the last call to pack_summary_delta()?  The
+/// default implementation returns false; derived classes that support this must override this to return true.  IF
+/// THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT AN OVERRIDE FOR derived_pack_summary_delta()!
+/// @details Deltas allow partial data to be streamed to another instance while the ensemble is still being generated.
+bool
+EnsembleMetric::supports_summary_deltas() const {
+	return false;
+}
+
+/// @brief Pack the data accumulated by this EnsembleMetric since the last call to this function (or since the last
+/// reset()) into a flat binary summary, and advance the watermark.
+/// @details The result has the same format as the output of pack_summary(), and is merged with merge_summary().  Must
+/// not be called while poses are being added to this EnsembleMetric.
+std::string
+EnsembleMetric::pack_summary_delta() {
+	runtime_assert_string_msg( supports_summary_merging() && supports_summary_deltas(), "Error in EnsembleMetric::pack_summary_delta(): The " + name() + " ensemble metric does not support packing partial summaries." );
+	debug_assert( poses_packed_in_summary_deltas_ <= poses_in_ensemble_ );
+	std::string summary;
+	EnsembleMetricSummaryWriter writer( summary );
+	write_summary_header( writer, poses_in_ensemble_ - poses_packed_in_summary_deltas_ );
+	derived_pack_summary_delta( writer, poses_packed_in_summary_deltas_ );
+	poses_packed_in_summary_deltas_ = poses_in_ensemble_;
+	return summary;
+}
+
+/// @brief Can the data accumulated by another instance of this EnsembleMetric be merged into this one with
+/// merge_ensemble_metric_data()?  The default implementation returns false; derived classes that support this
+/// must override this to return true.  IF THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT AN OVERRIDE FOR
+/// derived_merge_ensemble_metric_data()!
+/// @details In builds with serialization support, this is all that a derived class needs in order to support
+/// summary merging and MPI-based collection: the default summary is the serialized state of the EnsembleMetric
+/// (without its movers), which is deserialized and merged with derived_merge_ensemble_metric_data() on receipt.
+bool
+EnsembleMetric::supports_ensemble_metric_data_merging() const {
+	return false;
+}
+
+/// @brief Merge the data accumulated by another instance of the same EnsembleMetric into this instance.
+/// @details Calls derived_merge_ensemble_metric_data(), then updates the number of poses in the ensemble.  Must
+/// not be called after this EnsembleMetric has been finalized.  Not threadsafe.
+void
+EnsembleMetric::merge_ensemble_metric_data(
+	EnsembleMetric const & other
+) {
+	std::string const errmsg( "Error in EnsembleMetric::merge_ensemble_metric_data(): " );
+	runtime_assert_string_msg( supports_ensemble_metric_data_merging(), errmsg + "The " + name() + " ensemble metric does not support merging of data from other instances." );
+	runtime_assert_string_msg( &other != this, errmsg + "An ensemble metric cannot merge its own data." );
+	runtime_assert_string_msg( other.name() == name(), errmsg + "Data from the " + other.name() + " ensemble metric cannot be merged into the " + name() + " ensemble metric." );
+	runtime_assert_string_msg( !finalized_, errmsg + "The " + name() + " ensemble metric has already been finalized.  The reset() function must be called before accumulating more data." );
+	derived_merge_ensemble_metric_data( other );
+	poses_in_ensemble_ += other.poses_in_ensemble_;
+}
+
+/// @brief Flush a file (or a directory, to make a rename in it durable) from the operating system's cache to disk.
+/// @details Does nothing on platforms without fsync().
+/// @returns False if the file could not be flushed.
+static
+bool
+sync_path_to_disk(
+	std::string const & path,
+	bool const is_directory
+) {
+#ifdef ENSEMBLE_METRIC_POSIX_STATE_FILES
+	int const file_descriptor( ::open( path.c_str(), is_directory ? O_RDONLY : O_WRONLY ) );
+	if ( file_descriptor < 0 ) return false;
+	bool const success( ::fsync( file_descriptor ) == 0 );
+	::close( file_descriptor );
+	return success;
+#else
+	(void) path;
+	(void) is_directory;
+	return true;
+#endif
+}
+
+/// @brief Save the data accumulated by this EnsembleMetric so far to a binary state file, which can be read with
+/// read_state_file() and merged into another instance with merge_summary().
+/// @details The file holds the label of this EnsembleMetric followed by the output of pack_summary().  It uses
+/// native byte order, so it can only be read on the same architecture.  The state is written to a temporary file
+/// that is flushed to disk and then renamed, so a reader never sees a partially written file, and an earlier state
+/// file with the same name survives intact if writing fails or the machine crashes.
+void
+EnsembleMetric::save_state_to_file(
+	std::string const & filename
+) const {
+	std::string const summary( pack_summary() );
+	std::string header;
+	EnsembleMetricSummaryWriter writer( header );
+	writer.write< std::uint32_t >( ensemble_metric_state_file_magic );
+	writer.write< std::uint32_t >( ensemble_metric_state_file_version );
+	writer.write_string( get_ensemble_metric_label() );
+	writer.write< std::uint64_t >( static_cast< std::uint64_t >( summary.size() ) );
+
+	std::string const temporary_filename( filename + ".tmp" );
+	std::ofstream outfile( temporary_filename, std::ios::out | std::ios::binary | std::ios::trunc );
+	runtime_assert_string_msg( outfile.good(), "Error in EnsembleMetric::save_state_to_file(): Could not open \"" + temporary_filename + "\" for writing." );
+	outfile.write( header.data(), static_cast< std::streamsize >( header.size() ) );
+	outfile.write( summary.data(), static_cast< std::streamsize >( summary.size() ) );
+	outfile.close();
+	runtime_assert_string_msg( !outfile.fail(), "Error in EnsembleMetric::save_state_to_file(): Could not write the state of the " + name() + " ensemble metric to \"" + temporary_filename + "\"." );
+	// Without this, the rename could reach the disk before the contents, leaving an empty file after a crash.
+	runtime_assert_string_msg( sync_path_to_disk( temporary_filename, false ), "Error in EnsembleMetric::save_state_to_file(): Could not flush \"" + temporary_filename + "\" to disk." );
+	// Renaming within a filesystem is atomic, so the file at filename is always either the old state or the new one.
+	runtime_assert_string_msg( std::rename( temporary_filename.c_str(), filename.c_str() ) == 0, "Error in EnsembleMetric::save_state_to_file(): Could not rename \"" + temporary_filename + "\" to \"" + filename + "\"." );
+	std::string::size_type const last_slash( filename.find_last_of( '/' ) );
+	if ( !sync_path_to_disk( last_slash == std::string::npos ? std::string( "." ) : ( last_slash == 0 ? std::string( "/" ) : filename.substr( 0, last_slash ) ), true ) ) {
+		TR.Warning << "Could not flush the directory containing \"" << filename << "\" to disk.  The renamed state file may not survive a crash." << std::endl;
+	}
+	TR.Debug << "Saved the state of the " << name() << " ensemble metric (" << poses_in_ensemble_ << " poses) to file \"" << filename << "\"." << std::endl;
+}
+
+/// @brief Read a binary state file written by save_state_to_file().
+/// @param[in] filename The file to read.
+/// @param[out] label The label of the EnsembleMetric that wrote the file.
+/// @returns The summary of the data in the file, which may be passed to merge_summary().
+std::string
+EnsembleMetric::read_state_file(
+	std::string const & filename,
+	std::string & label
+) {
+	std::string const errmsg( "Error in EnsembleMetric::read_state_file(): " );
+	std::ifstream infile( filename, std::ios::in | std::ios::binary );
+	runtime_assert_string_msg( infile.good(), errmsg + "Could not open \"" + filename + "\" for reading." );
+	infile.seekg( 0, std::ios::end );
+	std::streamoff const file_size( infile.tellg() );
+	infile.seekg( 0, std::ios::beg );
+	runtime_assert_string_msg( infile.good() && file_size >= 0, errmsg + "Could not determine the size of \"" + filename + "\"." );
+
+	// The fixed-size fields are read first, so that the label length is known.
+	std::uint32_t magic(0), version(0);
+	std::uint64_t label_length(0);
+	infile.read( reinterpret_cast< char * >( &magic ), sizeof( std::uint32_t ) );
+	infile.read( reinterpret_cast< char * >( &version ), sizeof( std::uint32_t ) );
+	infile.read( reinterpret_cast< char * >( &label_length ), sizeof( std::uint64_t ) );
+	runtime_assert_string_msg( infile.good() && magic == ensemble_metric_state_file_magic, errmsg + "\"" + filename + "\" is not an ensemble metric state file." );
+	runtime_assert_string_msg( version == ensemble_metric_state_file_version, errmsg + "\"" + filename + "\" has unsupported state file version " + std::to_string( version ) + "." );
+
+	// The lengths are checked against the file size before anything is allocated, so a corrupt length field produces
+	// an error rather than an enormous allocation.
+	runtime_assert_string_msg( label_length <= static_cast< std::uint64_t >( file_size - infile.tellg() ), errmsg + "\"" + filename + "\" is truncated or corrupt." );
+	label.assign( static_cast< core::Size >( label_length ), '\0' );
+	if ( label_length > 0 ) infile.read( &label[0], static_cast< std::streamsize >( label_length ) );
+	std::uint64_t summary_length(0);
+	infile.read( reinterpret_cast< char * >( &summary_length ), sizeof( std::uint64_t ) );
+	runtime_assert_string_msg( infile.good(), errmsg + "\"" + filename + "\" is truncated." );
+	runtime_assert_string_msg( summary_length <= static_cast< std::uint64_t >( file_size - infile.tellg() ), errmsg + "\"" + filename + "\" is truncated or corrupt." );
+
+	std::string summary( static_cast< core::Size >( summary_length ), '\0' );
+	if ( summary_length > 0 ) infile.read( &summary[0], static_cast< std::streamsize >( summary_length ) );
+	runtime_assert_string_msg( static_cast< std::uint64_t >( infile.gcount() ) == summary_length || summary_length == 0, errmsg + "\"" + filename + "\" is truncated." );
+	return summary;
+}
+
+/// @brief Get the name of the EnsembleMetric (i.e. the type that must be instantiated to merge it) that produced a
+/// summary, from the summary header.
+std::string
+EnsembleMetric::ensemble_metric_name_from_summary(
+	std::string const & summary
+) {
+	std::string const errmsg( "Error in EnsembleMetric::ensemble_metric_name_from_summary(): " );
+	EnsembleMetricSummaryReader reader( summary.data(), summary.size() );
+	runtime_assert_string_msg( reader.read< std::uint32_t >() == ensemble_metric_summary_magic, errmsg + "The data are not an ensemble metric summary." );
+	std::uint32_t const version( reader.read< std::uint32_t >() );
+	runtime_assert_string_msg( version == ensemble_metric_summary_version, errmsg + "Unsupported ensemble metric summary version " + std::to_string( version ) + "." );
+	return reader.read_string();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // PUBLIC MPI PARALLEL COMMUNICATION FUNCTIONS
 ////////////////////////////////////////////////////////////////////////////////
@@ -573,8 +1615,9 @@ EnsembleMetric::increment_poses_in_ensemble(
 #ifdef USEMPI
 
 /// @brief Does this EnsembleMetric support MPI-based collection of ensemble properties from an ensemble
-/// sampled in a distributed manner?  The default implementation returns false; derived classes that support
-/// MPI must override this to return true.  IF THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT OVERRIDES
+/// sampled in a distributed manner?  The default implementation returns supports_summary_merging(), since
+/// the default send_mpi_summary() and recv_mpi_summary() can transport any mergeable summary; other derived
+/// classes that support MPI must override this to return true.  IF THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT OVERRIDES
 /// FOR send_mpi_summary() AND recv_mpi_summary()!
 /// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
 /// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
@@ -588,11 +1631,12 @@ EnsembleMetric::increment_poses_in_ensemble(
 /// has been set for MPI-based collection at the end.
 bool
 EnsembleMetric::supports_mpi() const {
-	return false;
+	return supports_summary_merging();
 }
 
-/// @brief Send all of the data collected by this EnsembleMetric to another node.  The base class implementation
-/// throws, so this must be overridden by any derived EnsembleMetric class that supports MPI.  IF THIS FUNCTION
+/// @brief Send all of the data collected by this EnsembleMetric to another node.  If this EnsembleMetric supports
+/// summary merging, the base class implementation sends the packed summary in a single message; otherwise it
+/// throws, and this must be overridden by any derived EnsembleMetric class that supports MPI.  IF THIS FUNCTION
 /// IS OVERRIDDEN, BE SURE TO IMPLEMENT OVERRIDES FOR recv_mpi_summary() AND supports_mpi()!
 /// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
 /// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
@@ -608,16 +1652,25 @@ EnsembleMetric::supports_mpi() const {
 /// guarantee synchronicity and which can avoid deadlock (e.g. the JD2 MPI job distributor)!
 void
 EnsembleMetric::send_mpi_summary(
-	core::Size const /*receiving_node_index*/
+	core::Size const receiving_node_index
 ) const {
+	if ( supports_summary_merging() ) {
+		EnsembleMetricPerformanceCounterScope profile( performance_counters_for_profiling(), EnsembleMetricProfiledRegion::SEND_MPI_SUMMARY );
+		// Generic transport: send the packed summary in one message.
+		std::string const summary( pack_summary() );
+		runtime_assert_string_msg( summary.size() <= static_cast< core::Size >( std::numeric_limits< int >::max() ), "Error in EnsembleMetric::send_mpi_summary(): The summary for the " + name() + " ensemble metric is too large to send in a single MPI message." );
+		MPI_Send( static_cast< const void * >( summary.data() ), static_cast< int >( summary.size() ), MPI_BYTE, static_cast< int >( receiving_node_index ), 0, MPI_COMM_WORLD );
+		return;
+	}
 	utility_exit_with_message( "Error in EnsembleMetric::send_mpi_summary(): The " + name() + " ensemble metric "
 		"does not support distributed ensemble generation and analysis with MPI.  This function must be overridden "
 		"to enable support."
 	);
 }
 
-/// @brief Receive all of the data collected by this EnsembleMetric on another node.  The base class implementation
-/// throws, so this must be overridden by any derived EnsembleMetric class that supports MPI.  IF THIS FUNCTION
+/// @brief Receive all of the data collected by this EnsembleMetric on another node.  If this EnsembleMetric supports
+/// summary merging, the base class implementation receives a packed summary in a single message and merges it;
+/// otherwise it throws, and this must be overridden by any derived EnsembleMetric class that supports MPI.  IF THIS FUNCTION
 /// IS OVERRIDDEN, BE SURE TO IMPLEMENT OVERRIDES FOR send_mpi_summary() AND supports_mpi()!  Note that this should
 /// receive from any MPI process, and report the process index that it received from.
 /// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
@@ -635,6 +1688,19 @@ EnsembleMetric::send_mpi_summary(
 /// guarantee synchronicity and which can avoid deadlock (e.g. the JD2 MPI job distributor)!
 core::Size
 EnsembleMetric::recv_mpi_summary() {
+	if ( supports_summary_merging() ) {
+		EnsembleMetricPerformanceCounterScope profile( performance_counters_for_profiling(), EnsembleMetricProfiledRegion::RECV_MPI_SUMMARY );
+		// Generic transport: receive a packed summary from any process in one message, and merge it.
+		MPI_Status mystatus;
+		MPI_Probe( MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &mystatus );
+		int const originating_proc( mystatus.MPI_SOURCE );
+		int n_bytes(0);
+		MPI_Get_count( &mystatus, MPI_BYTE, &n_bytes );
+		std::string summary( static_cast< core::Size >( n_bytes ), '\0' );
+		MPI_Recv( static_cast< void * >( n_bytes > 0 ? &summary[0] : nullptr ), n_bytes, MPI_BYTE, originating_proc, 0, MPI_COMM_WORLD, &mystatus );
+		merge_summary( summary );
+		return static_cast< core::Size >( originating_proc );
+	}
 	utility_exit_with_message( "Error in EnsembleMetric::recv_mpi_summary(): The " + name() + " ensemble metric "
 		"does not support distributed ensemble generation and analysis with MPI.  This function must be overridden "
 		"to enable support."
@@ -651,14 +1717,28 @@ EnsembleMetric::recv_mpi_summary() {
 /// @brief Write the final report to the tracer.
 void
 EnsembleMetric::produce_final_report_to_tracer(
-	basic::Tracer & tracer
+	basic::Tracer & tracer,
+	bool const consolidated
 ) {
 	runtime_assert(
 		output_mode_ == EnsembleMetricOutputMode::TRACER ||
 		output_mode_ == EnsembleMetricOutputMode::TRACER_AND_FILE
 	);
+	if ( report_format_ != EnsembleMetricReportFormat::TEXT ) {
+		bool write_csv_header( false );
+		if ( report_format_ == EnsembleMetricReportFormat::CSV ) {
+			std::ostringstream header;
+			write_csv_report_header( header );
+			write_csv_header = first_csv_header_for_tracer( name(), header.str() );
+		}
+		write_machine_readable_report( tracer, consolidated, write_csv_header );
+		tracer.flush();
+		return;
+	}
 	tracer << "Report from " << name() << ":\n";
-	if ( protocols::jd2::jd2_used() ) {
+	if ( consolidated ) {
+		tracer << "\tconsolidated_processes:\t" << shared_memory_aggregator_->n_summaries_merged() + 1 << "\n";
+	} else if ( protocols::jd2::jd2_used() ) {
 		tracer << "\tjob_name:\t" << protocols::jd2::current_output_name() << "\n";
 		tracer << "\tjob_nstruct_index:\t" << protocols::jd2::current_nstruct_index() << "\n";
 	}
@@ -668,13 +1748,14 @@ EnsembleMetric::produce_final_report_to_tracer(
 	tracer << "\tMPI_process:\t" << mpirank << "\n";
 #endif
 	tracer << "\tposes_in_ensemble:\t" << poses_in_ensemble() << "\n";
-	tracer << produce_final_report_string() << std::endl;
+	tracer << profiled_final_report_string() << std::endl;
 }
 
 /// @brief Write the final report to an output file.
 void
 EnsembleMetric::produce_final_report_to_file(
-	std::string const & output_file
+	std::string const & output_file,
+	bool const consolidated
 ) {
 	runtime_assert(
 		output_mode_ == EnsembleMetricOutputMode::FILE ||
@@ -682,12 +1763,92 @@ EnsembleMetric::produce_final_report_to_file(
 	);
 	runtime_assert_string_msg( !output_file.empty(), "Error in EnsembleMetric::produce_final_report_to_file(): An output file must be set in order to use file output." );
 
+	std::string const output_file_fullname( decorated_output_filename( output_file, !consolidated && !single_report_file_ ) );
+
+	if ( write_reports_in_background_ ) {
+		// The report is rendered now, since the data may be reset as soon as this returns, and written later.
+		EnsembleMetricReportPayload payload;
+		payload.filename = output_file_fullname;
+		payload.append = single_report_file_;
+		std::ostringstream contents;
+		write_report_to_stream( contents, consolidated, !single_report_file_ );
+		if ( single_report_file_ ) {
+			if ( report_format_ == EnsembleMetricReportFormat::TEXT ) {
+				contents << "\n";
+			} else if ( report_format_ == EnsembleMetricReportFormat::CSV ) {
+				std::ostringstream header;
+				write_csv_report_header( header );
+				payload.header_if_new_file = header.str();
+			}
+		}
+		payload.contents = contents.str();
+		EnsembleMetricReportWriter::get_instance()->submit( std::move( payload ) );
+		TR << "Queued " << name() << " ensemble metric output for writing to file \"" << output_file_fullname << "\"." << std::endl;
+		return;
+	}
+
+	if ( single_report_file_ ) {
+		// Text reports are separated by blank lines.  The other formats are already one record per line or self-delimiting.
+		// The CSV header is written by the file manager, only if the file is empty.
+		bool const text_format( report_format_ == EnsembleMetricReportFormat::TEXT );
+		std::ostringstream header;
+		if ( report_format_ == EnsembleMetricReportFormat::CSV ) write_csv_report_header( header );
+		EnsembleMetricReportFileManager::get_instance()->append_record( output_file_fullname,
+			[this, consolidated, text_format]( std::ostream & out ) {
+				write_report_to_stream( out, consolidated, false );
+				if ( text_format ) out << "\n";
+			},
+			header.str()
+		);
+		TR << "Appended " << name() << " ensemble metric output to file \"" << output_file_fullname << "\"." << std::endl;
+		return;
+	}
+
+	utility::io::ozstream outfile( output_file_fullname, std::ios_base::out | std::ios_base::binary );
+	write_report_to_stream( outfile, consolidated, true );
+	outfile.close();
+	TR << "Wrote " << name() << " ensemble metric output to file \"" << output_file_fullname << "\"." << std::endl;
+}
+
+/// @brief Write the final report to a stream, in the current report format.
+/// @details If write_csv_header is true and the format is CSV, the header line is written before the row.
+void
+EnsembleMetric::write_report_to_stream(
+	std::ostream & out,
+	bool const consolidated,
+	bool const write_csv_header
+) {
+	if ( report_format_ != EnsembleMetricReportFormat::TEXT ) {
+		write_machine_readable_report( out, consolidated, write_csv_header );
+		return;
+	}
+	out << "Report from " << name() << ":\n";
+	if ( consolidated ) {
+		out << "\tconsolidated_processes:\t" << shared_memory_aggregator_->n_summaries_merged() + 1 << "\n";
+	} else if ( protocols::jd2::jd2_used() ) {
+		out << "\tjob_name:\t" << protocols::jd2::current_output_name() << "\n";
+		out << "\tjob_nstruct_index:\t" << protocols::jd2::current_nstruct_index() << "\n";
+	}
+#ifdef USEMPI
+	int mpirank;
+	MPI_Comm_rank( MPI_COMM_WORLD, &mpirank );
+	out << "\tMPI_process:\t" << mpirank << "\n";
+#endif
+	out << "\tposes_in_ensemble:\t" << poses_in_ensemble() << "\n" << profiled_final_report_string() << "\n";
+}
+
+/// @brief Decorate an output filename with the label prefix and suffix, the MPI process index, and (if
+/// include_job_name is true) the job name, so that each output file is unique.
+std::string
+EnsembleMetric::decorated_output_filename(
+	std::string const & output_file,
+	bool const include_job_name
+) const {
 	std::string const output_file_basename( utility::file::file_basename( output_file ) );
 	std::string const output_file_extn( utility::file::file_extension( output_file ) );
 
-	bool const jd2_used( protocols::jd2::jd2_used() );
 	std::string const jobstring(
-		jd2_used ? protocols::jd2::current_output_name() : ""
+		( include_job_name && protocols::jd2::jd2_used() ) ? protocols::jd2::current_output_name() : ""
 	);
 
 #ifdef USEMPI
@@ -695,8 +1856,7 @@ EnsembleMetric::produce_final_report_to_file(
 	MPI_Comm_rank( MPI_COMM_WORLD, &mpirank );
 #endif
 
-	std::string const output_file_fullname(
-		label_prefix_ +
+	return label_prefix_ +
 		(label_prefix_.empty() ? "" : "_") +
 		jobstring +
 		(jobstring.empty() ? "" : "_" ) +
@@ -707,28 +1867,317 @@ EnsembleMetric::produce_final_report_to_file(
 		( label_suffix_.empty() ? "" : "_" ) +
 		label_suffix_ +
 		( output_file_extn.empty() ? "" : "." ) +
-		output_file_extn
-	);
+		output_file_extn;
+}
+
+/// @brief Call produce_final_report_string(), profiling it if profiling is on, and append the aggregated
+/// performance counters (if any) to the result.
+std::string
+EnsembleMetric::profiled_final_report_string() {
+	std::string report;
+	{
+		EnsembleMetricPerformanceCounterScope profile( performance_counters_.get(), EnsembleMetricProfiledRegion::FINALIZE );
+		report = produce_final_report_string();
+	}
+	if ( performance_counters_ != nullptr ) {
+		report += "\n" + performance_counters_->report_string();
+	}
+	return report;
+}
 
-	std::string output( "Report from " + name() + ":\n" );
-	if ( protocols::jd2::jd2_used() ) {
-		output += "\tjob_name:\t" + protocols::jd2::current_output_name() + "\n"
-			+ "\tjob_nstruct_index:\t" + std::to_string( protocols::jd2::current_nstruct_index() ) + "\n";
+/// @brief Write the header line for CSV reports.
+/// @details If profiling is on, the real-valued metrics are followed by the call count, wall time, and hardware
+/// counts of each profiled region.
+void
+EnsembleMetric::write_csv_report_header(
+	std::ostream & out
+) const {
+	out << "ensemble_metric,label,job_name,job_nstruct_index,consolidated_processes,MPI_process,poses_in_ensemble";
+	for ( std::string const & value_name : real_valued_metric_names() ) {
+		out << ',';
+		write_csv_string( out, value_name );
+	}
+	if ( performance_counters_ != nullptr ) {
+		for ( core::Size iregion(1); iregion <= static_cast< core::Size >( EnsembleMetricProfiledRegion::N_REGIONS ); ++iregion ) {
+			std::string const region_name( EnsembleMetricPerformanceCounters::region_name_from_enum( static_cast< EnsembleMetricProfiledRegion >( iregion ) ) );
+			out << ',' << region_name << "_calls," << region_name << "_wall_time";
+			for ( core::Size icounter(1); icounter <= static_cast< core::Size >( EnsembleMetricHardwareCounter::N_COUNTERS ); ++icounter ) {
+				out << ',' << region_name << '_' << EnsembleMetricPerformanceCounters::counter_name_from_enum( static_cast< EnsembleMetricHardwareCounter >( icounter ) );
+			}
+		}
 	}
+	out << '\n';
+}
+
+/// @brief Write the final report as a machine-readable record in the current report format, directly from the
+/// real-valued metrics.
+/// @details Calls finalize_real_valued_metrics() (profiled, if profiling is on).  If write_csv_header is true and the
+/// format is CSV, the header line is written before the row.  If profiling is on, the performance counters follow the
+/// values.  NaN and infinite values are written as JSON nulls, empty CSV fields, or (in binary records) as they are.
+/// Hardware counts that were never available are likewise null or empty.  The binary format must only be written to
+/// streams opened in binary mode.
+void
+EnsembleMetric::write_machine_readable_report(
+	std::ostream & out,
+	bool const consolidated,
+	bool const write_csv_header
+) {
+	runtime_assert( report_format_ != EnsembleMetricReportFormat::TEXT && report_format_ != EnsembleMetricReportFormat::UNKNOWN_FORMAT );
+	{
+		EnsembleMetricPerformanceCounterScope profile( performance_counters_.get(), EnsembleMetricProfiledRegion::FINALIZE );
+		finalize_real_valued_metrics();
+	}
+
+	// Fields that don't apply are omitted from JSON records, and are empty (or, in binary records, zero or -1) otherwise.
+	bool const jd2_used( !consolidated && protocols::jd2::jd2_used() );
+	std::string const job_name( jd2_used ? protocols::jd2::current_output_name() : "" );
+	core::Size const job_nstruct_index( jd2_used ? protocols::jd2::current_nstruct_index() : 0 );
+	core::Size const consolidated_processes( consolidated ? shared_memory_aggregator_->n_summaries_merged() + 1 : 0 );
+	int mpi_process( -1 );
 #ifdef USEMPI
-		output += "\tMPI_process:\t" + std::to_string( mpirank ) + "\n";
+	MPI_Comm_rank( MPI_COMM_WORLD, &mpi_process );
 #endif
-	output += "\tposes_in_ensemble:\t" + std::to_string( poses_in_ensemble() ) + "\n" + produce_final_report_string() + "\n";
-	utility::io::ozstream outfile( output_file_fullname );
-	outfile << output;
-	outfile.close();
-	TR << "Wrote " << name() << " ensemble metric output to file \"" << output_file_fullname << "\"." << std::endl;
+	utility::vector1< std::string > const & value_names( real_valued_metric_names() );
+	core::Size const n_regions( performance_counters_ == nullptr ? 0 : static_cast< core::Size >( EnsembleMetricProfiledRegion::N_REGIONS ) );
+	core::Size const n_counters( static_cast< core::Size >( EnsembleMetricHardwareCounter::N_COUNTERS ) );
+
+	std::streamsize const old_precision( out.precision( std::numeric_limits< core::Real >::max_digits10 ) );
+	switch( report_format_ ) {
+	case EnsembleMetricReportFormat::JSON_LINES :
+		out << "{\"ensemble_metric\":";
+		write_json_string( out, name() );
+		out << ",\"label\":";
+		write_json_string( out, get_ensemble_metric_label() );
+		if ( jd2_used ) {
+			out << ",\"job_name\":";
+			write_json_string( out, job_name );
+			out << ",\"job_nstruct_index\":" << job_nstruct_index;
+		}
+		if ( consolidated ) out << ",\"consolidated_processes\":" << consolidated_processes;
+		if ( mpi_process >= 0 ) out << ",\"MPI_process\":" << mpi_process;
+		out << ",\"poses_in_ensemble\":" << poses_in_ensemble() << ",\"values\":{";
+		for ( core::Size i(1), imax(value_names.size()); i<=imax; ++i ) {
+			if ( i > 1 ) out << ',';
+			write_json_string( out, value_names[i] );
+			out << ':';
+			write_json_number( out, derived_get_real_metric_value_by_index( i ) );
+		}
+		out << '}';
+		if ( performance_counters_ != nullptr ) {
+			out << ",\"performance_counters\":{\"hardware_counts_complete\":" << ( performance_counters_->hardware_counts_complete() ? "true" : "false" );
+			for ( core::Size iregion(1); iregion <= n_regions; ++iregion ) {
+				EnsembleMetricProfiledRegion const region( static_cast< EnsembleMetricProfiledRegion >( iregion ) );
+				EnsembleMetricRegionCounts const & counts( performance_counters_->counts_for_region( region ) );
+				out << ',';
+				write_json_string( out, EnsembleMetricPerformanceCounters::region_name_from_enum( region ) );
+				out << ":{\"calls\":" << counts.calls << ",\"wall_time\":";
+				write_json_number( out, counts.wall_time );
+				for ( core::Size icounter(1); icounter <= n_counters; ++icounter ) {
+					out << ',';
+					write_json_string( out, EnsembleMetricPerformanceCounters::counter_name_from_enum( static_cast< EnsembleMetricHardwareCounter >( icounter ) ) );
+					out << ':';
+					if ( counts.hardware_calls > 0 ) {
+						out << counts.counts[ icounter - 1 ];
+					} else {
+						out << "null";
+					}
+				}
+				out << '}';
+			}
+			out << '}';
+		}
+		out << "}\n";
+		break;
+	case EnsembleMetricReportFormat::CSV :
+		if ( write_csv_header ) write_csv_report_header( out );
+		write_csv_string( out, name() );
+		out << ',';
+		write_csv_string( out, get_ensemble_metric_label() );
+		out << ',';
+		write_csv_string( out, job_name );
+		out << ',';
+		if ( jd2_used ) out << job_nstruct_index;
+		out << ',';
+		if ( consolidated ) out << consolidated_processes;
+		out << ',';
+		if ( mpi_process >= 0 ) out << mpi_process;
+		out << ',' << poses_in_ensemble();
+		for ( core::Size i(1), imax(value_names.size()); i<=imax; ++i ) {
+			out << ',';
+			write_csv_number( out, derived_get_real_metric_value_by_index( i ) );
+		}
+		for ( core::Size iregion(1); iregion <= n_regions; ++iregion ) {
+			EnsembleMetricRegionCounts const & counts( performance_counters_->counts_for_region( static_cast< EnsembleMetricProfiledRegion >( iregion ) ) );
+			out << ',' << counts.calls << ',';
+			write_csv_number( out, counts.wall_time );
+			for ( core::Size icounter(1); icounter <= n_counters; ++icounter ) {
+				out << ',';
+				if ( counts.hardware_calls > 0 ) out << counts.counts[ icounter - 1 ];
+			}
+		}
+		out << '\n';
+		break;
+	case EnsembleMetricReportFormat::BINARY :
+		write_binary_value< std::uint32_t >( out, ensemble_metric_binary_report_magic );
+		write_binary_value< std::uint32_t >( out, ensemble_metric_binary_report_version );
+		write_binary_string( out, name() );
+		write_binary_string( out, get_ensemble_metric_label() );
+		write_binary_string( out, job_name );
+		write_binary_value< std::uint64_t >( out, static_cast< std::uint64_t >( job_nstruct_index ) );
+		write_binary_value< std::uint64_t >( out, static_cast< std::uint64_t >( consolidated_processes ) );
+		write_binary_value< std::int64_t >( out, static_cast< std::int64_t >( mpi_process ) );
+		write_binary_value< std::uint64_t >( out, static_cast< std::uint64_t >( poses_in_ensemble() ) );
+		write_binary_value< std::uint64_t >( out, static_cast< std::uint64_t >( value_names.size() ) );
+		for ( core::Size i(1), imax(value_names.size()); i<=imax; ++i ) {
+			write_binary_string( out, value_names[i] );
+			write_binary_value< double >( out, static_cast< double >( derived_get_real_metric_value_by_index( i ) ) );
+		}
+		// Version 2 adds the performance counters: the number of profiled regions (zero if profiling is off), then for
+		// each region its name, call count, count of calls with hardware counters, wall time, and hardware counts.
+		write_binary_value< std::uint64_t >( out, static_cast< std::uint64_t >( n_regions ) );
+		for ( core::Size iregion(1); iregion <= n_regions; ++iregion ) {
+			EnsembleMetricProfiledRegion const region( static_cast< EnsembleMetricProfiledRegion >( iregion ) );
+			EnsembleMetricRegionCounts const & counts( performance_counters_->counts_for_region( region ) );
+			write_binary_string( out, EnsembleMetricPerformanceCounters::region_name_from_enum( region ) );
+			write_binary_value< std::uint64_t >( out, static_cast< std::uint64_t >( counts.calls ) );
+			write_binary_value< std::uint64_t >( out, static_cast< std::uint64_t >( counts.hardware_calls ) );
+			write_binary_value< double >( out, static_cast< double >( counts.wall_time ) );
+			write_binary_value< std::uint64_t >( out, static_cast< std::uint64_t >( n_counters ) );
+			for ( core::Size icounter(1); icounter <= n_counters; ++icounter ) {
+				write_binary_string( out, EnsembleMetricPerformanceCounters::counter_name_from_enum( static_cast< EnsembleMetricHardwareCounter >( icounter ) ) );
+				write_binary_value< std::uint64_t >( out, counts.counts[ icounter - 1 ] );
+			}
+		}
+		break;
+	default :
+		utility_exit_with_message( "Invalid report format for EnsembleMetric " + name() + "!" );
+	}
+	out.precision( old_precision );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRIVATE SUMMARY FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Write the header common to all summaries.
+void
+EnsembleMetric::write_summary_header(
+	EnsembleMetricSummaryWriter & writer,
+	core::Size const n_poses
+) const {
+	writer.write< std::uint32_t >( ensemble_metric_summary_magic );
+	writer.write< std::uint32_t >( ensemble_metric_summary_version );
+	writer.write_string( name() );
+	writer.write< std::uint64_t >( static_cast< std::uint64_t >( n_poses ) );
+}
+
+/// @brief Append the data accumulated by the derived class to a summary.  The base class implementation
+/// throws, so this must be overridden by any derived class for which supports_summary_merging() returns true.
+void
+EnsembleMetric::derived_pack_summary(
+#ifdef SERIALIZATION
+	EnsembleMetricSummaryWriter & writer
+#else
+	EnsembleMetricSummaryWriter &
+#endif
+) const {
+#ifdef SERIALIZATION
+	if ( supports_ensemble_metric_data_merging() ) {
+		// The default summary is the serialized state of the derived class.  A non-owning pointer to this object lets
+		// cereal serialize it polymorphically without cloning the accumulated data.
+		EnsembleMetricCOP const this_metric( this, []( EnsembleMetric const * ){} );
+		std::ostringstream outstream;
+		{
+			EnsembleMetricSummarySerializationScope const summary_scope;
+			cereal::BinaryOutputArchive arc( outstream );
+			arc( this_metric );
+		}
+		writer.write_string( outstream.str() );
+		return;
+	}
+#endif
+	utility_exit_with_message( "Error in EnsembleMetric::derived_pack_summary(): The " + name() + " ensemble metric does not support packing its data into a mergeable summary." );
+}
+
+/// @brief Merge the data accumulated by another instance of the derived class, read from a summary, into the
+/// data accumulated by this instance.  The base class implementation throws, so this must be overridden by any
+/// derived class for which supports_summary_merging() returns true.
+/// @details The number of poses in the ensemble is updated by the base class, and must not be updated here.
+/// The number of additional poses that the summary represents is provided for consistency checks.
+void
+EnsembleMetric::derived_merge_summary(
+#ifdef SERIALIZATION
+	EnsembleMetricSummaryReader & reader,
+	core::Size const n_additional_poses
+#else
+	EnsembleMetricSummaryReader &,
+	core::Size const
+#endif
+) {
+#ifdef SERIALIZATION
+	if ( supports_ensemble_metric_data_merging() ) {
+		// The default summary is the serialized state of the derived class.
+		core::Size length(0);
+		char const * const serialized( reader.read_string_in_place( length ) );
+		std::istringstream instream( std::string( serialized, length ) );
+		EnsembleMetricOP other;
+		{
+			cereal::BinaryInputArchive arc( instream );
+			arc( other );
+		}
+		runtime_assert_string_msg( other != nullptr, "Error in EnsembleMetric::derived_merge_summary(): The summary holds no serialized " + name() + " ensemble metric." );
+		// The deserialized copy must be reset before it is destroyed, or it would produce a report of its own.
+		try {
+			runtime_assert_string_msg( other->poses_in_ensemble() == n_additional_poses, "Error in EnsembleMetric::derived_merge_summary(): The serialized " + name() + " ensemble metric in the summary is inconsistent with the summary header." );
+			derived_merge_ensemble_metric_data( *other );
+		} catch ( ... ) {
+			other->reset();
+			throw;
+		}
+		other->reset();
+		return;
+	}
+#endif
+	utility_exit_with_message( "Error in EnsembleMetric::derived_merge_summary(): The " + name() + " ensemble metric does not support merging of summaries." );
+}
+
+/// @brief Append the data accumulated by the derived class for all but the first n_poses_already_packed poses
+/// to a summary.  The base class implementation throws, so this must be overridden by any derived class for which
+/// supports_summary_deltas() returns true.
+/// @details The output must be readable by derived_merge_summary().
+void
+EnsembleMetric::derived_pack_summary_delta(
+	EnsembleMetricSummaryWriter &,
+	core::Size const
+) const {
+	utility_exit_with_message( "Error in EnsembleMetric::derived_pack_summary_delta(): The " + name() + " ensemble metric does not support packing partial summaries." );
+}
+
+/// @brief Merge the data accumulated by another instance of the derived class into the data accumulated by this
+/// instance.  The base class implementation throws, so this must be overridden by any derived class for which
+/// supports_ensemble_metric_data_merging() returns true.
+/// @details The other instance is guaranteed to be of the same type (same name()).  The number of poses in the
+/// ensemble is updated by the base class, and must not be updated here.
+void
+EnsembleMetric::derived_merge_ensemble_metric_data(
+	EnsembleMetric const &
+) {
+	utility_exit_with_message( "Error in EnsembleMetric::derived_merge_ensemble_metric_data(): The " + name() + " ensemble metric does not support merging of data from other instances." );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // PRIVATE CALCULATION FUNCTIONS
 ////////////////////////////////////////////////////////////////////////////////
 
+/// @brief Call add_pose_to_ensemble(), profiling it if profiling is on.
+void
+EnsembleMetric::profiled_add_pose_to_ensemble(
+	core::pose::Pose const & pose
+) {
+	EnsembleMetricPerformanceCounterScope profile( performance_counters_.get(), EnsembleMetricProfiledRegion::ADD_POSE_TO_ENSEMBLE );
+	add_pose_to_ensemble( pose );
+}
+
 /// @brief Called by apply() function if and only if an ensemble-generating protocol is provided.
 /// @details Generates an ensemble of poses (in parallel, if multi-threading is enabled) and measures
 /// properties of each.
@@ -736,18 +2185,44 @@ void
 EnsembleMetric::generate_ensemble_and_apply_to_poses(
 	core::pose::Pose const & pose
 ) {
+	std::chrono::steady_clock::time_point const start_time( std::chrono::steady_clock::now() );
+	if ( collect_ensemble_generation_timings_ ) {
+		ensemble_generation_timings_ = EnsembleGenerationTimings();
+	}
+
 	utility::vector1< basic::thread_manager::RosettaThreadFunction > workvec;
 	workvec.reserve( ensemble_generating_protocol_repeats_ );
 
 	bool const doing_multiple_outputs( last_mover_ != nullptr && use_additional_output_from_last_mover_ );
 
+	// By default, this process runs every attempt.  If generation is distributed with MPI, each process runs
+	// every nprocs-th attempt, starting from the one matching its rank, so that attempt indices stay global.
+	core::pose::Pose const * master_pose( &pose );
+	core::Size first_attempt(1), attempt_stride(1);
+#ifdef USEMPI
+#ifdef SERIALIZATION
+	core::pose::PoseOP broadcast_pose;
+#endif
+	if ( distribute_ensemble_generation_with_mpi_ ) {
+		int mpirank(0), mpisize(1);
+		MPI_Comm_rank( MPI_COMM_WORLD, &mpirank );
+		MPI_Comm_size( MPI_COMM_WORLD, &mpisize );
+#ifdef SERIALIZATION
+		broadcast_pose = broadcast_master_pose( pose );
+		if ( broadcast_pose != nullptr ) master_pose = broadcast_pose.get();
+#endif
+		first_attempt = static_cast< core::Size >( mpirank ) + 1;
+		attempt_stride = static_cast< core::Size >( mpisize );
+	}
+#endif
+
 	// Set up the work vector:
-	for ( core::Size i(1); i<=ensemble_generating_protocol_repeats_; ++i ) {
+	for ( core::Size i(first_attempt); i<=ensemble_generating_protocol_repeats_; i += attempt_stride ) {
 		workvec.push_back(
 			std::bind(
 			&EnsembleMetric::generate_one_ensemble_entry, this,
 			i,
-			std::cref( pose ),
+			std::cref( *master_pose ),
 			std::cref( *ensemble_generating_protocol_ ),
 			(doing_multiple_outputs ? last_mover_->clone() : nullptr)
 			)
@@ -767,6 +2242,25 @@ EnsembleMetric::generate_ensemble_and_apply_to_poses(
 	TR << ".  ";
 #endif
 	TR << poses_in_ensemble_ << " poses are in the ensemble." << std::endl;
+
+#ifdef USEMPI
+	if ( distribute_ensemble_generation_with_mpi_ ) {
+		share_distributed_ensemble_data();
+		TR << "Merged the ensembles generated by all MPI processes.  " << poses_in_ensemble_ << " poses are in the ensemble." << std::endl;
+	}
+#endif
+
+	if ( collect_ensemble_generation_timings_ ) {
+		ensemble_generation_timings_.wall_time = std::chrono::duration< core::Real >( std::chrono::steady_clock::now() - start_time ).count();
+#ifdef MULTI_THREADED
+		ensemble_generation_timings_.assigned_threads = thread_assignments.get_assigned_total_thread_count();
+#else
+		ensemble_generation_timings_.assigned_threads = 1;
+#endif
+		TR << "Ensemble generation took " << ensemble_generation_timings_.wall_time << " seconds of wall time and "
+			<< ensemble_generation_timings_.thread_time << " seconds of thread time, of which "
+			<< ensemble_generation_timings_.total_lock_wait_time() << " seconds were spent waiting for locks." << std::endl;
+	}
 }
 
 /// @brief Given a protocol and a pose, clone the pose, clone the protocol, apply the protocol to the pose,
@@ -781,13 +2275,16 @@ EnsembleMetric::generate_one_ensemble_entry(
 	protocols::moves::MoverOP last_mover_copy
 ) {
 	basic::Tracer & TR_derived( get_derived_tracer() );
+	std::chrono::steady_clock::time_point const start_time( std::chrono::steady_clock::now() );
 
 	// Make thread-local copies of pose and protocol.
 	core::pose::PoseOP my_pose( utility::pointer::make_shared< core::pose::Pose >() );
 	protocols::moves::MoverOP my_protocol;
 	{
 #ifdef MULTI_THREADED
+		std::chrono::steady_clock::time_point const wait_start( std::chrono::steady_clock::now() );
 		std::lock_guard< std::mutex > lock( pose_mutex_ );
+		record_lock_wait_time( wait_start, ensemble_generation_timings_.pose_lock_wait_time );
 #endif
 		my_pose->detached_copy( master_pose ); // Detached copy the pose.
 	}
@@ -795,7 +2292,9 @@ EnsembleMetric::generate_one_ensemble_entry(
 	// Clone the protocol.
 	{
 #ifdef MULTI_THREADED
+		std::chrono::steady_clock::time_point const wait_start( std::chrono::steady_clock::now() );
 		std::lock_guard< std::mutex > lock( ensemble_generating_protocol_mutex_ );
+		record_lock_wait_time( wait_start, ensemble_generation_timings_.protocol_lock_wait_time );
 #endif
 		my_protocol = master_protocol.clone();
 	}
@@ -815,16 +2314,19 @@ EnsembleMetric::generate_one_ensemble_entry(
 		if ( my_protocol->get_last_move_status() != protocols::moves::MoverStatus::MS_SUCCESS ) {
 			if ( last_mover_copy == nullptr ) {
 				TR_derived << "Attempt " << attempt_index << " failed.  Continuing on..." << std::endl;
-				return;
+				break;
 			} else {
 				TR_derived << "Attempt " << attempt_index << "-" << counter << " failed.  Continuing on..." << std::endl;
 			}
 		} else {
 #ifdef MULTI_THREADED
+			std::chrono::steady_clock::time_point const wait_start( std::chrono::steady_clock::now() );
 			std::lock_guard< std::mutex > lock( ensemble_metric_mutex_ );
+			record_lock_wait_time( wait_start, ensemble_generation_timings_.ensemble_metric_lock_wait_time );
 #endif
 			++poses_in_ensemble_;
-			add_pose_to_ensemble( *my_pose );
+			current_attempt_index_ = attempt_index;
+			profiled_add_pose_to_ensemble( *my_pose );
 			if ( last_mover_copy == nullptr ) {
 				TR_derived << name() << " ensemble metric generated ensemble entry " << attempt_index << " and added its measurements to the ensemble." << std::endl;
 			} else {
@@ -836,7 +2338,9 @@ EnsembleMetric::generate_one_ensemble_entry(
 		if ( last_mover_copy != nullptr ) {
 			my_pose->clear();
 #ifdef MULTI_THREADED
+			std::chrono::steady_clock::time_point const wait_start( std::chrono::steady_clock::now() );
 			std::lock_guard< std::mutex > lock( pose_mutex_ );
+			record_lock_wait_time( wait_start, ensemble_generation_timings_.pose_lock_wait_time );
 #endif
 			my_pose->detached_copy( *last_mover_copy->get_additional_output() );
 			if ( my_pose != nullptr ) {
@@ -846,6 +2350,104 @@ EnsembleMetric::generate_one_ensemble_entry(
 			break;
 		}
 	} while( my_pose != nullptr );
+
+	if ( collect_ensemble_generation_timings_ ) {
+		core::Real const elapsed( std::chrono::duration< core::Real >( std::chrono::steady_clock::now() - start_time ).count() );
+#ifdef MULTI_THREADED
+		std::lock_guard< std::mutex > lock( timings_mutex_ );
+#endif
+		ensemble_generation_timings_.thread_time += elapsed;
+	}
+}
+
+/// @brief Pass the values measured for one pose to all registered observers.
+/// @details Called by notify_observers() if there are any observers.
+void
+EnsembleMetric::notify_registered_observers(
+	core::Size const attempt_index,
+	core::Real const * values,
+	core::Size const n_values
+) const {
+	for ( EnsembleMetricObserverOP const & observer : observers_ ) {
+		observer->observe_measurement( *this, attempt_index, values, n_values );
+	}
+}
+
+#ifdef USEMPI
+#ifdef SERIALIZATION
+/// @brief Broadcast the input pose from process 0 to all processes in MPI_COMM_WORLD.
+/// @details Used when ensemble generation is distributed with MPI.  Returns the received copy in processes other
+/// than process 0, and nullptr in process 0 (which should continue to use its own pose).  Collective.
+core::pose::PoseOP
+EnsembleMetric::broadcast_master_pose(
+	core::pose::Pose const & pose
+) const {
+	int mpirank(0);
+	MPI_Comm_rank( MPI_COMM_WORLD, &mpirank );
+
+	std::string serialized_pose;
+	if ( mpirank == 0 ) {
+		std::ostringstream outstream;
+		{
+			cereal::BinaryOutputArchive arc( outstream );
+			arc( pose );
+		}
+		serialized_pose = outstream.str();
+	}
+
+	unsigned long long n_bytes( serialized_pose.size() );
+	MPI_Bcast( &n_bytes, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD );
+	runtime_assert_string_msg( n_bytes <= static_cast< unsigned long long >( std::numeric_limits< int >::max() ), "Error in EnsembleMetric::broadcast_master_pose(): The serialized pose is too large to broadcast in a single MPI message." );
+	serialized_pose.resize( static_cast< core::Size >( n_bytes ) );
+	if ( n_bytes > 0 ) {
+		MPI_Bcast( static_cast< void * >( &serialized_pose[0] ), static_cast< int >( n_bytes ), MPI_BYTE, 0, MPI_COMM_WORLD );
+	}
+
+	if ( mpirank == 0 ) return nullptr;
+	core::pose::PoseOP received_pose( utility::pointer::make_shared< core::pose::Pose >() );
+	std::istringstream instream( serialized_pose );
+	{
+		cereal::BinaryInputArchive arc( instream );
+		arc( *received_pose );
+	}
+	return received_pose;
+}
+#endif //SERIALIZATION
+
+/// @brief After distributed ensemble generation, merge the data accumulated by all processes in MPI_COMM_WORLD
+/// in process 0, then replace the data in every other process with the merged data.  Collective.
+void
+EnsembleMetric::share_distributed_ensemble_data() {
+	reduce_ensemble_metric_summaries_to_root( *this, MPI_COMM_WORLD );
+
+	int mpirank(0);
+	MPI_Comm_rank( MPI_COMM_WORLD, &mpirank );
+	std::string summary( mpirank == 0 ? pack_summary() : std::string() );
+	unsigned long long n_bytes( summary.size() );
+	MPI_Bcast( &n_bytes, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD );
+	runtime_assert_string_msg( n_bytes <= static_cast< unsigned long long >( std::numeric_limits< int >::max() ), "Error in EnsembleMetric::share_distributed_ensemble_data(): The merged summary for the " + name() + " ensemble metric is too large to broadcast in a single MPI message." );
+	summary.resize( static_cast< core::Size >( n_bytes ) );
+	if ( n_bytes > 0 ) {
+		MPI_Bcast( static_cast< void * >( &summary[0] ), static_cast< int >( n_bytes ), MPI_BYTE, 0, MPI_COMM_WORLD );
+	}
+
+	if ( mpirank != 0 ) {
+		// The reduction has already reset this copy.
+		merge_summary( summary );
+	}
+}
+#endif //USEMPI
+
+/// @brief If we are collecting ensemble generation timings, add the time elapsed since wait_start to the
+/// given lock wait time accumulator.
+/// @details Must be called while holding the lock that was being waited for, since this lock protects the accumulator.
+void
+EnsembleMetric::record_lock_wait_time(
+	std::chrono::steady_clock::time_point const & wait_start,
+	core::Real & accumulator
+) const {
+	if ( !collect_ensemble_generation_timings_ ) return;
+	accumulator += std::chrono::duration< core::Real >( std::chrono::steady_clock::now() - wait_start ).count();
 }
 
 } //ensemble_metrics
@@ -860,13 +2462,30 @@ protocols::ensemble_metrics::EnsembleMetric::save( Archive & arc ) const {
 	arc( CEREAL_NVP( use_additional_output_from_last_mover_ ) );
 	arc( CEREAL_NVP( output_mode_ ) );
 	arc( CEREAL_NVP( output_filename_ ) );
+	arc( CEREAL_NVP( report_format_ ) );
+	arc( CEREAL_NVP( single_report_file_ ) );
+	arc( CEREAL_NVP( write_reports_in_background_ ) );
 	arc( CEREAL_NVP( label_prefix_ ) );
 	arc( CEREAL_NVP( label_suffix_ ) );
-	arc( CEREAL_NVP( last_mover_ ) );
-	arc( CEREAL_NVP( ensemble_generating_protocol_ ) );
+	if ( serializing_ensemble_metric_summary ) {
+		// Summaries carry only the accumulated data.  The receiving instance has its own movers.
+		protocols::moves::MoverCOP const no_mover;
+		arc( cereal::make_nvp( "last_mover_", no_mover ) );
+		arc( cereal::make_nvp( "ensemble_generating_protocol_", no_mover ) );
+	} else {
+		arc( CEREAL_NVP( last_mover_ ) );
+		arc( CEREAL_NVP( ensemble_generating_protocol_ ) );
+	}
 	arc( CEREAL_NVP( ensemble_generating_protocol_repeats_ ) );
 	arc( CEREAL_NVP( poses_in_ensemble_ ) );
+	arc( CEREAL_NVP( poses_packed_in_summary_deltas_ ) );
 	arc( CEREAL_NVP( n_threads_ ) );
+	arc( CEREAL_NVP( collect_ensemble_generation_timings_ ) );
+	arc( CEREAL_NVP( distribute_ensemble_generation_with_mpi_ ) );
+	arc( CEREAL_NVP( state_dump_filename_ ) );
+	// EXEMPT ensemble_generation_timings_ observers_ current_attempt_index_ shared_memory_aggregator_ shared_memory_contribution_pending_ generation_
+	bool const profile_with_performance_counters( performance_counters_ != nullptr );
+	arc( CEREAL_NVP( profile_with_performance_counters ) ); // EXEMPT performance_counters_
 }
 
 template< class Archive >
@@ -876,13 +2495,24 @@ protocols::ensemble_metrics::EnsembleMetric::load( Archive & arc ) {
 	arc( use_additional_output_from_last_mover_ );
 	arc( output_mode_ );
 	arc( output_filename_ );
+	arc( report_format_ );
+	arc( single_report_file_ );
+	arc( write_reports_in_background_ );
 	arc( label_prefix_ );
 	arc( label_suffix_ );
 	arc( last_mover_ );
 	arc( ensemble_generating_protocol_ );
 	arc( ensemble_generating_protocol_repeats_ );
 	arc( poses_in_ensemble_ );
+	arc( poses_packed_in_summary_deltas_ );
 	arc( n_threads_ );
+	arc( collect_ensemble_generation_timings_ );
+	arc( distribute_ensemble_generation_with_mpi_ );
+	arc( state_dump_filename_ );
+	bool profile_with_performance_counters( false );
+	arc( profile_with_performance_counters );
+	performance_counters_ = ( profile_with_performance_counters ? utility::pointer::make_shared< EnsembleMetricPerformanceCounters >() : nullptr );
+	++generation_;
 }
 
 SAVE_AND_LOAD_SERIALIZABLE( protocols::ensemble_metrics::EnsembleMetric );
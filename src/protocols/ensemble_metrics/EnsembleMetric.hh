@@ -39,6 +39,11 @@
 #define INCLUDED_protocols_ensemble_metrics_EnsembleMetric_hh
 
 #include <protocols/ensemble_metrics/EnsembleMetric.fwd.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricObserver.fwd.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricSampleSpan.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricPerformanceCounters.fwd.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryIO.fwd.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricSharedMemoryAggregator.fwd.hh>
 
 // Core headers
 #include <core/pose/Pose.fwd.hh>
@@ -55,11 +60,14 @@
 // Utility headers
 #include <utility/pointer/owning_ptr.hh>
 #include <utility/VirtualBase.hh>
+#include <utility/vector1.hh>
 #include <utility/tag/XMLSchemaGeneration.fwd.hh>
 #include <utility/tag/Tag.fwd.hh>
 
 //STL headers
 #include <string>
+#include <iosfwd>
+#include <chrono>
 
 #ifdef MULTI_THREADED
 #include <mutex>
@@ -83,6 +91,53 @@ enum class EnsembleMetricOutputMode {
 	N_OUTPUT_MODES = FILE //Keep last.
 };
 
+/// @brief List of report formats.  If you add to this list, update
+/// EnsembleMetric::report_format_name_from_enum().
+/// @details TEXT is the human-readable report.  The others are machine-readable records written directly from the
+/// real-valued metrics of the EnsembleMetric: JSON_LINES writes one JSON object per line, CSV writes a header line and
+/// one row, and BINARY writes a compact binary record (only to files).
+enum class EnsembleMetricReportFormat {
+	UNKNOWN_FORMAT = 0, //Keep first.
+	TEXT,
+	JSON_LINES,
+	CSV,
+	BINARY, //Keep second-to-last.
+	N_REPORT_FORMATS = BINARY //Keep last.
+};
+
+/// @brief Timing statistics collected during the last call to EnsembleMetric::generate_ensemble_and_apply_to_poses(),
+/// if collection of ensemble generation timings is enabled.
+/// @details All times are in seconds.  Thread times and lock wait times are summed over all threads.
+struct EnsembleGenerationTimings {
+
+	/// @brief Wall-clock time for the whole ensemble generation.
+	core::Real wall_time = 0.0;
+
+	/// @brief Time spent in the generation of individual ensemble entries, summed over all threads.
+	core::Real thread_time = 0.0;
+
+	/// @brief Time spent waiting to acquire the mutex that protects the master pose, summed over all threads.
+	core::Real pose_lock_wait_time = 0.0;
+
+	/// @brief Time spent waiting to acquire the mutex that protects the ensemble-generating protocol, summed
+	/// over all threads.
+	core::Real protocol_lock_wait_time = 0.0;
+
+	/// @brief Time spent waiting to acquire the mutex that protects the accumulated data, summed over all threads.
+	core::Real ensemble_metric_lock_wait_time = 0.0;
+
+	/// @brief The number of threads actually assigned by the RosettaThreadManager.
+	core::Size assigned_threads = 1;
+
+	/// @brief Total time spent waiting for all mutexes, summed over all threads.
+	inline
+	core::Real
+	total_lock_wait_time() const {
+		return pose_lock_wait_time + protocol_lock_wait_time + ensemble_metric_lock_wait_time;
+	}
+
+};
+
 /// @brief Pure virtual base class for ensemble metrics, which measure properties of an ensemble of poses.
 /// @details Ensemble metrics expect to receive poses one by one, accumulating data internally as they
 /// do.  At the end of a protocol, an ensemble metric can generate a report (written to tracer or to disk)
@@ -127,6 +182,13 @@ public: // Public pure virtual functions
 	utility::vector1< std::string > const &
 	real_valued_metric_names() const = 0;
 
+	/// @brief Get the names of the values measured for each pose and passed to observers.
+	/// @details Used to label the columns of per-pose dumps.  The default implementation returns an empty list,
+	/// in which case generic names are used.
+	virtual
+	utility::vector1< std::string >
+	per_pose_value_names() const;
+
 private: // Private pure virtual functions
 
 	/// @brief Write the final report produced by this metric to a string.
@@ -168,6 +230,26 @@ private: // Private pure virtual functions
 	void
 	derived_reset() = 0;
 
+private: // Private virtual functions
+
+	/// @brief Given the (one-based) index of a metric in real_valued_metric_names(), get its value.
+	/// @details The default implementation looks up the name and calls derived_get_real_metric_value_by_name().
+	/// Derived classes should override this to return the value without any string work.
+	virtual
+	core::Real
+	derived_get_real_metric_value_by_index(
+		core::Size const metric_index
+	) const;
+
+	/// @brief Finish computing the real-valued metrics from the accumulated data, so that
+	/// derived_get_real_metric_value_by_name() can be called, without producing a text report.
+	/// @details Called instead of produce_final_report_string() when a machine-readable report format is used.  The
+	/// default implementation does nothing; derived classes that only compute their real-valued metrics in
+	/// produce_final_report_string() must override this.
+	virtual
+	void
+	finalize_real_valued_metrics();
+
 public: // Static enum functions
 
 	/// @brief Given an output mode name, get the enum.
@@ -186,6 +268,22 @@ public: // Static enum functions
 		EnsembleMetricOutputMode const mode_enum
 	);
 
+	/// @brief Given a report format name, get the enum.
+	/// @details Returns UNKNOWN_FORMAT if string can't be interpreted.
+	static
+	EnsembleMetricReportFormat
+	report_format_enum_from_name(
+		std::string const & format_name
+	);
+
+	/// @brief Given a report format enum, get the name.
+	/// @details Throws if bad format.
+	static
+	std::string
+	report_format_name_from_enum(
+		EnsembleMetricReportFormat const format_enum
+	);
+
 public: // Apply function (NOT virtual).
 
 	/// @brief Measure data from the current pose.
@@ -209,7 +307,9 @@ public: // Reporting functions
 
 	/// @brief Write the final report produced by this metric to a file or to tracer.
 	/// @details If output_mode_ == EnsembleMetricOutputMode::TRACER, writes to tracer.
-	/// Writes to disk if output_mode_ == EnsembleMetricOutputMode::FILE!
+	/// Writes to disk if output_mode_ == EnsembleMetricOutputMode::FILE!  If shared-memory aggregation is set up,
+	/// this process's data are instead handed to the shared-memory segment, and only the last process to do so
+	/// writes a consolidated report.
 	void produce_final_report();
 
 public: // RosettaScripts functions
@@ -240,6 +340,7 @@ public: // Setters
 
 	/// @brief Reset this ensemble metric.  Calls derived_reset() to reset
 	/// the data collected by the derived class.
+	/// @details Also advances the generation counter.
 	void reset();
 
 	/// @brief Set the optional prefix added to the start of the label for this metric.
@@ -254,6 +355,15 @@ public: // Setters
 		std::string const & setting
 	);
 
+	/// @brief Set the label prefix and suffix from a label produced by get_ensemble_metric_label() for an ensemble
+	/// metric of this type (e.g. one read from a state file).
+	/// @details The name of this ensemble metric must appear in the label, preceded by the start of the label or by
+	/// an underscore, and followed by the end of the label or by an underscore.  The first such occurrence is used.
+	void
+	set_label_prefix_and_suffix_from_label(
+		std::string const & label
+	);
+
 	/// @brief Set the protocol that will generate an ensemble of states.
 	/// @details If not set, the ensemble metric just collects data from the current pose.  If set,
 	/// the ensemble metric runs this N times to generate N poses, collects data from each, and then
@@ -290,6 +400,39 @@ public: // Setters
 		std::string const & setting
 	);
 
+	/// @brief Set report format by string.
+	void
+	set_report_format(
+		std::string const & format_string
+	);
+
+	/// @brief Set report format.
+	/// @details Indicate whether the report is human-readable text or a machine-readable record.  The binary format
+	/// can only be written to files.
+	void
+	set_report_format(
+		EnsembleMetricReportFormat const setting
+	);
+
+	/// @brief Set whether all reports written to file by this process are appended to one file, rather than written to
+	/// one file per job.
+	/// @details If true, the job name is not added to the output filename (though the label prefix and suffix and, in MPI
+	/// builds, the process index still are), and each report is appended to the file as a record.  Writes go through
+	/// one open handle per file, shared by all ensemble metrics in this process.
+	void
+	set_single_report_file(
+		bool const setting
+	);
+
+	/// @brief Set whether report files are written by a background writer.
+	/// @details If true, the report is rendered when it is produced, and handed to the EnsembleMetricReportWriter, which
+	/// writes it in a background thread in multi-threaded builds (so that the next job need not wait for the filesystem),
+	/// or immediately in other builds.  Queued reports are written before the process exits.
+	void
+	set_write_reports_in_background(
+		bool const setting
+	);
+
 	/// @brief Set the last mover that ran before this ensemble metric.
 	/// @details Only used to get additional output, if any, and only if use_additional_output_ is true.
 	void
@@ -309,6 +452,90 @@ public: // Setters
 		core::Size const setting
 	);
 
+	/// @brief Set whether we collect timing statistics (wall time, per-thread time, and time spent waiting
+	/// on mutexes) when generating an ensemble with the ensemble-generating protocol.
+	/// @details False by default.  Intended for benchmarking the scaling of ensemble generation with thread count.
+	void
+	set_collect_ensemble_generation_timings(
+		bool const setting
+	);
+
+	/// @brief Set whether we profile the hot paths of this ensemble metric (adding poses, finalizing, and MPI
+	/// summary communication) with hardware performance counters.
+	/// @details False by default.  When true, the aggregated counters are appended to the report.  Hardware counters
+	/// are only available on Linux, and only if the kernel permits access; otherwise, only call counts and wall
+	/// times are reported.  Setting this to true discards any counts collected so far.
+	void
+	set_profile_with_performance_counters(
+		bool const setting
+	);
+
+	/// @brief Set whether the repeats of the ensemble-generating protocol are divided among all of the processes in
+	/// MPI_COMM_WORLD.
+	/// @details False by default.  When true, the input pose is broadcast from process 0 (in builds with serialization
+	/// support), each process runs the attempts whose indices are congruent to its rank modulo the number of processes,
+	/// and the data are merged in process 0 and then shared with all processes before the report is produced, so that
+	/// any filter that depends on this metric gives the same result everywhere.  Only process 0 writes the report.
+	/// This is collective: every process must apply this metric at the same time.  The metric must support summary
+	/// merging.  Has no effect in non-MPI builds.
+	/// @note Throws in MPI builds without serialization support (which cannot broadcast the input pose), and when the
+	/// JD2 MPI work pool job distributor is in use (since its master process never applies movers, so the collective
+	/// operations would never complete).
+	void
+	set_distribute_ensemble_generation_with_mpi(
+		bool const setting
+	);
+
+	/// @brief Set up merging of the data collected by this ensemble metric in all processes on this machine through a
+	/// named POSIX shared-memory segment, so that only the last process to finish writes one consolidated report.
+	/// @details Attaches to the segment immediately (creating it if necessary).  The segment name is the given prefix
+	/// followed by an underscore and the ensemble metric label.  The capacity is only used if this process creates the
+	/// segment.  An empty prefix turns shared-memory aggregation off.  Only available for ensemble metrics that support
+	/// summary merging and that report at the end of a run, and only on Linux and macOS.  All copies of this ensemble
+	/// metric in this process share one attachment, and their data are merged in this process before it contributes.
+	void
+	set_shared_memory_aggregation(
+		std::string const & segment_prefix,
+		core::Size const capacity_bytes
+	);
+
+	/// @brief Set the file to which the accumulated state of this ensemble metric is saved when it produces its final
+	/// report, so that states from independent runs can later be merged (e.g. with the merge_ensemble_metric_states
+	/// application).  An empty string (the default) means that no state is saved.
+	/// @details The filename is decorated in the same way as the report filename.  Only available for ensemble metrics
+	/// that support summary merging.
+	void
+	set_state_dump_filename(
+		std::string const & setting
+	);
+
+	/// @brief Register an observer, which will be passed the values measured for each pose as they are measured.
+	/// @details The observer is stored by owning pointer, not cloned.  Copies of this ensemble metric share it unless
+	/// its observer_for_metric_copy() function provides another observer for them.  Not threadsafe: do not call this while poses are being measured.
+	void
+	add_observer(
+		EnsembleMetricObserverOP const & observer
+	);
+
+	/// @brief Remove all registered observers.
+	/// @details Not threadsafe: do not call this while poses are being measured.
+	void clear_observers();
+
+	/// @brief Stream the values measured for each pose to a block-compressed, columnar binary file, by registering a
+	/// ColumnarDumpEnsembleMetricObserver.
+	/// @details The filename is decorated with the label prefix and suffix (and the MPI rank, in MPI builds), but not
+	/// the job name, since the file spans jobs: each record carries the index of its job.  Ensemble metrics that write
+	/// the same file in this process share one observer, so a metric parsed again for each job continues the file rather
+	/// than truncating it.  At most block_records records are buffered before being written.  If compress is true, blocks
+	/// are compressed with zlib; otherwise, the file can be used in place when memory-mapped.  Not threadsafe: do not
+	/// call this while poses are being measured.
+	void
+	set_columnar_dump(
+		std::string const & filename,
+		core::Size const block_records,
+		bool const compress
+	);
+
 public: // Getters
 
 	/// @brief Has this ensemble metric finished accumulating data and produced its report?
@@ -318,6 +545,17 @@ public: // Getters
 		return finalized_;
 	}
 
+	/// @brief Get the generation counter for this ensemble metric.
+	/// @details This starts at 1, and is advanced whenever the accumulated data are discarded or replaced (by reset(),
+	/// assignment, or deserialization).  It is never zero.  Objects that cache something that depends on the state of
+	/// the ensemble metric (e.g. the EnsembleFilter, which caches the fact that the metric has been finalized) can
+	/// store the generation and compare it to this cheaply to detect a reset.
+	inline
+	core::Size
+	generation() const {
+		return generation_;
+	}
+
 	/// @brief Is the configuration set so that this metric expects to give its report at the end of
 	/// a protocol (true) or immediately after internally generating an ensemble or inheriting an ensemble
 	/// from a multiple pose mover (false)?
@@ -346,6 +584,27 @@ public: // Getters
 		return output_filename_;
 	}
 
+	/// @brief Get report format.
+	inline
+	EnsembleMetricReportFormat
+	report_format() const {
+		return report_format_;
+	}
+
+	/// @brief Get whether all reports written to file by this process are appended to one file.
+	inline
+	bool
+	single_report_file() const {
+		return single_report_file_;
+	}
+
+	/// @brief Get whether report files are written by a background writer.
+	inline
+	bool
+	write_reports_in_background() const {
+		return write_reports_in_background_;
+	}
+
 	/// @brief Get the label.
 	/// @details By default, this is just the name().  If a prefix is provided, it is prepended
 	/// followed by an underscore; if a suffix is provided, it is appended preceded by an underscore.
@@ -364,11 +623,100 @@ public: // Getters
 		std::string const & metric_name
 	) const;
 
+	/// @brief Given a metric name, get its (one-based) index in real_valued_metric_names(), for use with
+	/// get_real_metric_value_by_index().  Throws if this ensemble metric produces no such real-valued metric.
+	/// @details Every ensemble metric of a given type returns the same list of names, so the index is stable: it can
+	/// be resolved once (e.g. when a script is parsed) and used for the lifetime of the ensemble metric, and of any
+	/// copies of it.
+	core::Size
+	real_valued_metric_index(
+		std::string const & metric_name
+	) const;
+
+	/// @brief Given the (one-based) index of a metric in real_valued_metric_names(), get its value, without any
+	/// string lookup.
+	/// @details Calls derived_get_real_metric_value_by_index().  The final report must have been generated.
+	core::Real
+	get_real_metric_value_by_index(
+		core::Size const metric_index
+	) const;
+
+	/// @brief Given a list of (one-based) indices of metrics in real_valued_metric_names(), get all of their values
+	/// in one call.
+	/// @details The values vector is resized to match the list of indices, and is filled in the same order.  The
+	/// final report must have been generated; this is checked once for the whole batch.
+	void
+	get_real_metric_values_by_indices(
+		utility::vector1< core::Size > const & metric_indices,
+		utility::vector1< core::Real > & values
+	) const;
+
 	/// @brief Get the ensemble generating protocol.
 	/// @details Could be nullptr if none is set.
 	protocols::moves::MoverCOP
 	ensemble_generating_protocol() const;
 
+	/// @brief Get the number of threads to request.  Zero means to request all available.
+	inline
+	core::Size
+	n_threads() const {
+		return n_threads_;
+	}
+
+	/// @brief Are we collecting timing statistics when generating an ensemble with the ensemble-generating protocol?
+	inline
+	bool
+	collect_ensemble_generation_timings() const {
+		return collect_ensemble_generation_timings_;
+	}
+
+	/// @brief Get the timing statistics collected during the last ensemble generation.
+	/// @details Only populated if set_collect_ensemble_generation_timings() has been set to true.
+	inline
+	EnsembleGenerationTimings const &
+	ensemble_generation_timings() const {
+		return ensemble_generation_timings_;
+	}
+
+	/// @brief Are we profiling the hot paths of this ensemble metric with hardware performance counters?
+	inline
+	bool
+	profile_with_performance_counters() const {
+		return performance_counters_ != nullptr;
+	}
+
+	/// @brief Are the repeats of the ensemble-generating protocol divided among all of the processes in MPI_COMM_WORLD?
+	inline
+	bool
+	distribute_ensemble_generation_with_mpi() const {
+		return distribute_ensemble_generation_with_mpi_;
+	}
+
+	/// @brief Is the data collected by this ensemble metric merged with that of other processes through shared memory?
+	inline
+	bool
+	uses_shared_memory_aggregation() const {
+		return shared_memory_aggregator_ != nullptr;
+	}
+
+	/// @brief Get the file to which the accumulated state is saved at finalization.  Empty if none.
+	inline
+	std::string const &
+	state_dump_filename() const {
+		return state_dump_filename_;
+	}
+
+	/// @brief Get the performance counters aggregated so far.
+	/// @details Null if profiling is off.
+	EnsembleMetricPerformanceCountersCOP performance_counters() const;
+
+	/// @brief Get the number of registered observers.
+	inline
+	core::Size
+	n_observers() const {
+		return observers_.size();
+	}
+
 public: // Citation manager functions
 
 	/// @brief Provide citations to the passed CitationCollectionList
@@ -387,13 +735,225 @@ protected:
 	/// added to the ensemble.
 	void increment_poses_in_ensemble( core::Size const n_additional_poses );
 
+	/// @brief Allow derived classes to get the index of the attempt that produced the pose currently being
+	/// passed to add_pose_to_ensemble().
+	/// @details If an ensemble-generating protocol is used, this is the index of the repeat of that protocol.
+	/// Otherwise, it is the ordinal of the pose in the ensemble.
+	inline
+	core::Size
+	current_attempt_index() const {
+		return current_attempt_index_;
+	}
+
+	/// @brief Allow derived classes to get the performance counter aggregator, for profiling regions (such as MPI
+	/// communication) that the base class does not call.
+	/// @details Null if profiling is off.  Intended to be passed to an EnsembleMetricPerformanceCounterScope, which
+	/// does nothing if passed a null pointer.
+	inline
+	EnsembleMetricPerformanceCounters *
+	performance_counters_for_profiling() const {
+		return performance_counters_.get();
+	}
+
+	/// @brief Allow derived classes to pass the values measured for one pose to all registered observers.
+	/// @details Intended to be called from add_pose_to_ensemble() after each measurement.  If no observers are
+	/// registered, this costs one check.
+	inline
+	void
+	notify_observers(
+		core::Size const attempt_index,
+		core::Real const * values,
+		core::Size const n_values
+	) const {
+		if ( observers_.empty() ) return;
+		notify_registered_observers( attempt_index, values, n_values );
+	}
+
+public: // Raw value ingestion functions
+
+	/// @brief Can this EnsembleMetric accumulate raw per-pose values directly (with add_raw_values()), without
+	/// computing them from poses?  The default implementation returns false; derived classes that support this must
+	/// override this to return true, AND MUST ALSO OVERRIDE add_raw_values().
+	/// @details This allows per-pose values saved earlier (e.g. in a columnar dump) to be re-analysed without poses.
+	virtual bool supports_raw_value_ingestion() const;
+
+	/// @brief Accumulate a contiguous block of raw per-pose values, one per pose, as though measured from poses.
+	/// @details The default implementation throws.  Derived classes that override supports_raw_value_ingestion()
+	/// must override this.
+	/// @note Not threadsafe.  Do not call this concurrently with apply().
+	virtual
+	void
+	add_raw_values(
+		core::Real const * values,
+		core::Size const n_values
+	);
+
+	/// @brief Prepare to accumulate n_values more raw values, e.g. by pre-allocating storage.
+	/// @details The default implementation does nothing.
+	virtual void reserve_raw_values( core::Size const n_values );
+
+public: // Raw sample access functions
+
+	/// @brief Can this EnsembleMetric expose the raw per-pose samples that it has accumulated (with raw_samples())?
+	/// The default implementation returns false; derived classes that support this must override this to return true,
+	/// AND MUST ALSO OVERRIDE raw_samples().
+	virtual bool supports_raw_sample_access() const;
+
+	/// @brief Get a read-only view of the raw per-pose samples accumulated so far, pointing directly into this
+	/// EnsembleMetric's storage, so that embedding code can hand them to numeric libraries without copying.
+	/// @details Available before or after finalization.  The columns are named by per_pose_value_names().  The view is
+	/// invalidated by anything that adds data to, merges data into, or resets this EnsembleMetric.  The default
+	/// implementation throws.
+	/// @note Not threadsafe.  Do not call this concurrently with apply().
+	virtual EnsembleMetricSampleSpan raw_samples() const;
+
+public: // Summary functions
+
+	/// @brief Can the data accumulated by this EnsembleMetric be packed into a flat summary (with pack_summary()) and
+	/// merged into another instance (with merge_summary())?  The default implementation returns false; derived classes
+	/// that support this must override this to return true.  IF THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT
+	/// OVERRIDES FOR derived_pack_summary() AND derived_merge_summary()!
+	/// @details Mergeable summaries allow data collected by many instances (e.g. in many MPI processes) to be combined
+	/// pairwise, as in a reduction tree, so that no single instance has to receive data from every other instance.
+	/// In builds with serialization support, the default implementation returns supports_ensemble_metric_data_merging(),
+	/// and the default summary is the serialized state of the EnsembleMetric (without its movers).  A derived class that
+	/// relies on this default must still implement derived_merge_ensemble_metric_data(), which does the merging.
+	virtual bool supports_summary_merging() const;
+
+	/// @brief Pack all of the data accumulated by this EnsembleMetric so far into a flat binary summary.
+	/// @details The base class writes a header (including the name of the EnsembleMetric and the number of poses
+	/// in the ensemble), then calls derived_pack_summary() to append the data accumulated by the derived class.
+	std::string pack_summary() const;
+
+	/// @brief Merge a summary produced by pack_summary() on another instance of the same EnsembleMetric into
+	/// the data accumulated by this instance.
+	/// @details The base class reads and checks the header and updates the number of poses in the ensemble, then
+	/// calls derived_merge_summary() to merge the data accumulated by the derived class.  Must not be called after
+	/// this EnsembleMetric has been finalized.  Not threadsafe.
+	void merge_summary( std::string const & summary );
+
+	/// @brief Merge a summary produced by pack_summary() on another instance of the same EnsembleMetric into
+	/// the data accumulated by this instance.  This version takes a pointer to a block of memory and its size.
+	/// @details The base class reads and checks the header and updates the number of poses in the ensemble, then
+	/// calls derived_merge_summary() to merge the data accumulated by the derived class.  Must not be called after
+	/// this EnsembleMetric has been finalized.  Not threadsafe.
+	void merge_summary( char const * data, core::Size const n_bytes );
+
+	/// @brief Can this EnsembleMetric pack only the data accumulated since the last call to pack_summary_delta()?  The
+	/// default implementation returns false; derived classes that support this must override this to return true.  IF
+	/// THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT AN OVERRIDE FOR derived_pack_summary_delta()!
+	/// @details Deltas allow partial data to be streamed to another instance while the ensemble is still being generated.
+	virtual bool supports_summary_deltas() const;
+
+	/// @brief Pack the data accumulated by this EnsembleMetric since the last call to this function (or since the last
+	/// reset()) into a flat binary summary, and advance the watermark.
+	/// @details The result has the same format as the output of pack_summary(), and is merged with merge_summary().  Must
+	/// not be called while poses are being added to this EnsembleMetric.
+	std::string pack_summary_delta();
+
+	/// @brief The number of poses whose data have already been packed by pack_summary_delta().
+	inline core::Size poses_packed_in_summary_deltas() const { return poses_packed_in_summary_deltas_; }
+
+	/// @brief Can the data accumulated by another instance of this EnsembleMetric be merged into this one with
+	/// merge_ensemble_metric_data()?  The default implementation returns false; derived classes that support this
+	/// must override this to return true.  IF THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT AN OVERRIDE FOR
+	/// derived_merge_ensemble_metric_data()!
+	/// @details In builds with serialization support, this is all that a derived class needs in order to support
+	/// summary merging and MPI-based collection: the default summary is the serialized state of the EnsembleMetric
+	/// (without its movers), which is deserialized and merged with derived_merge_ensemble_metric_data() on receipt.
+	virtual bool supports_ensemble_metric_data_merging() const;
+
+	/// @brief Merge the data accumulated by another instance of the same EnsembleMetric into this instance.
+	/// @details Calls derived_merge_ensemble_metric_data(), then updates the number of poses in the ensemble.  Must
+	/// not be called after this EnsembleMetric has been finalized.  Not threadsafe.
+	void merge_ensemble_metric_data( EnsembleMetric const & other );
+
+	/// @brief Save the data accumulated by this EnsembleMetric so far to a binary state file, which can be read with
+	/// read_state_file() and merged into another instance with merge_summary().
+	/// @details The file holds the label of this EnsembleMetric followed by the output of pack_summary().  It uses
+	/// native byte order, so it can only be read on the same architecture.  The state is written to a temporary file
+	/// that is then renamed, so a reader never sees a partially written file, and an earlier state file with the same
+	/// name survives intact if writing fails.
+	void save_state_to_file( std::string const & filename ) const;
+
+	/// @brief Read a binary state file written by save_state_to_file().
+	/// @param[in] filename The file to read.
+	/// @param[out] label The label of the EnsembleMetric that wrote the file.
+	/// @returns The summary of the data in the file, which may be passed to merge_summary().
+	static
+	std::string
+	read_state_file(
+		std::string const & filename,
+		std::string & label
+	);
+
+	/// @brief Get the name of the EnsembleMetric (i.e. the type that must be instantiated to merge it) that produced a
+	/// summary, from the summary header.
+	static
+	std::string
+	ensemble_metric_name_from_summary(
+		std::string const & summary
+	);
+
+private: // Private summary functions
+
+	/// @brief Write the header common to all summaries.
+	void
+	write_summary_header(
+		EnsembleMetricSummaryWriter & writer,
+		core::Size const n_poses
+	) const;
+
+	/// @brief Append the data accumulated by the derived class to a summary.  The base class implementation
+	/// throws, so this must be overridden by any derived class for which supports_summary_merging() returns true.
+	virtual
+	void
+	derived_pack_summary(
+		EnsembleMetricSummaryWriter & writer
+	) const;
+
+	/// @brief Merge the data accumulated by another instance of the derived class, read from a summary, into the
+	/// data accumulated by this instance.  The base class implementation throws, so this must be overridden by any
+	/// derived class for which supports_summary_merging() returns true.
+	/// @details The number of poses in the ensemble is updated by the base class, and must not be updated here.
+	/// The number of additional poses that the summary represents is provided for consistency checks.
+	virtual
+	void
+	derived_merge_summary(
+		EnsembleMetricSummaryReader & reader,
+		core::Size const n_additional_poses
+	);
+
+	/// @brief Append the data accumulated by the derived class for all but the first n_poses_already_packed poses
+	/// to a summary.  The base class implementation throws, so this must be overridden by any derived class for which
+	/// supports_summary_deltas() returns true.
+	/// @details The output must be readable by derived_merge_summary().
+	virtual
+	void
+	derived_pack_summary_delta(
+		EnsembleMetricSummaryWriter & writer,
+		core::Size const n_poses_already_packed
+	) const;
+
+	/// @brief Merge the data accumulated by another instance of the derived class into the data accumulated by this
+	/// instance.  The base class implementation throws, so this must be overridden by any derived class for which
+	/// supports_ensemble_metric_data_merging() returns true.
+	/// @details The other instance is guaranteed to be of the same type (same name()).  The number of poses in the
+	/// ensemble is updated by the base class, and must not be updated here.
+	virtual
+	void
+	derived_merge_ensemble_metric_data(
+		EnsembleMetric const & other
+	);
+
 public: // MPI functions
 
 #ifdef USEMPI
 
 	/// @brief Does this EnsembleMetric support MPI-based collection of ensemble properties from an ensemble
-	/// sampled in a distributed manner?  The default implementation returns false; derived classes that support
-	/// MPI must override this to return true.  IF THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT OVERRIDES
+	/// sampled in a distributed manner?  The default implementation returns supports_summary_merging(), since
+	/// the default send_mpi_summary() and recv_mpi_summary() can transport any mergeable summary; other derived
+	/// classes that support MPI must override this to return true.  IF THIS FUNCTION IS OVERRIDDEN, BE SURE TO IMPLEMENT OVERRIDES
 	/// FOR send_mpi_summary() AND recv_mpi_summary()!
 	/// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
 	/// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
@@ -407,8 +967,9 @@ public: // MPI functions
 	/// has been set for MPI-based collection at the end.
 	virtual bool supports_mpi() const;
 
-	/// @brief Send all of the data collected by this EnsembleMetric to another node.  The base class implementation
-	/// throws, so this must be overridden by any derived EnsembleMetric class that supports MPI.  IF THIS FUNCTION
+	/// @brief Send all of the data collected by this EnsembleMetric to another node.  If this EnsembleMetric supports
+	/// summary merging, the base class implementation sends the packed summary in a single message; otherwise it
+	/// throws, and this must be overridden by any derived EnsembleMetric class that supports MPI.  IF THIS FUNCTION
 	/// IS OVERRIDDEN, BE SURE TO IMPLEMENT OVERRIDES FOR recv_mpi_summary() AND supports_mpi()!
 	/// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
 	/// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
@@ -424,8 +985,9 @@ public: // MPI functions
 	/// guarantee synchronicity and which can avoid deadlock (e.g. the JD2 MPI job distributor)!
 	virtual void send_mpi_summary( core::Size const receiving_node_index ) const;
 
-	/// @brief Receive all of the data collected by this EnsembleMetric on another node.  The base class implementation
-	/// throws, so this must be overridden by any derived EnsembleMetric class that supports MPI.  IF THIS FUNCTION
+	/// @brief Receive all of the data collected by this EnsembleMetric on another node.  If this EnsembleMetric supports
+	/// summary merging, the base class implementation receives a packed summary in a single message and merges it;
+	/// otherwise it throws, and this must be overridden by any derived EnsembleMetric class that supports MPI.  IF THIS FUNCTION
 	/// IS OVERRIDDEN, BE SURE TO IMPLEMENT OVERRIDES FOR send_mpi_summary() AND supports_mpi()!  Note that this should
 	/// receive from any MPI process, and report the process index that it received from.
 	/// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
@@ -448,13 +1010,71 @@ public: // MPI functions
 private: // Private reporting functions
 
 	/// @brief Write the final report to the tracer.
-	void produce_final_report_to_tracer( basic::Tracer & tracer );
+	/// @details If consolidated is true, the report covers data merged from several processes, so no job is named.
+	void produce_final_report_to_tracer( basic::Tracer & tracer, bool const consolidated );
 
 	/// @brief Write the final report to an output file.
-	void produce_final_report_to_file( std::string const & output_file );
+	/// @details If consolidated is true, the report covers data merged from several processes, so the filename is not
+	/// prefixed with the job name.  Nor is it if single_report_file_ is true, in which case the report is appended to a
+	/// file shared by all jobs in this process.
+	void produce_final_report_to_file( std::string const & output_file, bool const consolidated );
+
+	/// @brief Call produce_final_report_string(), profiling it if profiling is on, and append the aggregated
+	/// performance counters (if any) to the result.
+	std::string profiled_final_report_string();
+
+	/// @brief Write the header line for CSV reports.
+	/// @details If profiling is on, the real-valued metrics are followed by the call count, wall time, and hardware
+	/// counts of each profiled region.
+	void write_csv_report_header( std::ostream & out ) const;
+
+	/// @brief Write the final report as a machine-readable record in the current report format, directly from the
+	/// real-valued metrics.
+	/// @details Calls finalize_real_valued_metrics() (profiled, if profiling is on).  If write_csv_header is true and the
+	/// format is CSV, the header line is written before the row.  If profiling is on, the performance counters follow the
+	/// values.  NaN and infinite values are written as JSON nulls, empty CSV fields, or (in binary records) as they are.
+	/// The binary format must only be written to streams opened in binary mode.
+	void
+	write_machine_readable_report(
+		std::ostream & out,
+		bool const consolidated,
+		bool const write_csv_header
+	);
+
+	/// @brief Decorate an output filename with the label prefix and suffix, the MPI process index, and (if
+	/// include_job_name is true) the job name, so that each output file is unique.
+	std::string
+	decorated_output_filename(
+		std::string const & output_file,
+		bool const include_job_name
+	) const;
+
+	/// @brief Write the final report to a stream, in the current report format.
+	/// @details If write_csv_header is true and the format is CSV, the header line is written before the row.
+	void
+	write_report_to_stream(
+		std::ostream & out,
+		bool const consolidated,
+		bool const write_csv_header
+	);
 
 private: // Private calculating functions
 
+	/// @brief Call add_pose_to_ensemble(), profiling it if profiling is on.
+	void
+	profiled_add_pose_to_ensemble(
+		core::pose::Pose const & pose
+	);
+
+	/// @brief Pass the values measured for one pose to all registered observers.
+	/// @details Called by notify_observers() if there are any observers.
+	void
+	notify_registered_observers(
+		core::Size const attempt_index,
+		core::Real const * values,
+		core::Size const n_values
+	) const;
+
 	/// @brief Called by apply() function if and only if an ensemble-generating protocol is provided.
 	/// @details Generates an ensemble of poses (in parallel, if multi-threading is enabled) and measures
 	/// properties of each.
@@ -475,11 +1095,41 @@ private: // Private calculating functions
 		protocols::moves::MoverOP last_mover_copy
 	);
 
+#ifdef USEMPI
+#ifdef SERIALIZATION
+	/// @brief Broadcast the input pose from process 0 to all processes in MPI_COMM_WORLD.
+	/// @details Used when ensemble generation is distributed with MPI.  Returns the received copy in processes other
+	/// than process 0, and nullptr in process 0 (which should continue to use its own pose).  Collective.
+	core::pose::PoseOP
+	broadcast_master_pose(
+		core::pose::Pose const & pose
+	) const;
+#endif //SERIALIZATION
+
+	/// @brief After distributed ensemble generation, merge the data accumulated by all processes in MPI_COMM_WORLD
+	/// in process 0, then replace the data in every other process with the merged data.  Collective.
+	void share_distributed_ensemble_data();
+#endif //USEMPI
+
+	/// @brief If we are collecting ensemble generation timings, add the time elapsed since wait_start to the
+	/// given lock wait time accumulator.
+	/// @details Must be called while holding the lock that was being waited for, since this lock protects the accumulator.
+	void
+	record_lock_wait_time(
+		std::chrono::steady_clock::time_point const & wait_start,
+		core::Real & accumulator
+	) const;
+
 private:
 
 	/// @brief Has this metric finished its computations and given its report?
 	bool finalized_ = false;
 
+	/// @brief Generation counter, advanced whenever the accumulated data are discarded or replaced.
+	/// @details Copied by the copy constructor, so that a copy holding the same data is in the same generation.
+	/// Advanced (never copied) by the assignment operator, since assignment replaces the data.
+	core::Size generation_ = 1;
+
 	/// @brief Should we use the additional output from the last mover as the source
 	/// of the ensemble?
 	bool use_additional_output_from_last_mover_ = false;
@@ -490,6 +1140,15 @@ private:
 	/// @brief File to which output will be written, if output_mode_ == EnsembleMetricOutputMode::FILE.
 	std::string output_filename_;
 
+	/// @brief The format of the report.
+	EnsembleMetricReportFormat report_format_ = EnsembleMetricReportFormat::TEXT;
+
+	/// @brief Are all reports written to file by this process appended to one file?
+	bool single_report_file_ = false;
+
+	/// @brief Are report files written by a background writer?
+	bool write_reports_in_background_ = false;
+
 	/// @brief An optional prefix added to the start of the label for this metric.
 	std::string label_prefix_;
 
@@ -511,6 +1170,9 @@ private:
 	/// @brief Number of poses seen by this ensemble metric so far.
 	core::Size poses_in_ensemble_ = 0;
 
+	/// @brief Number of poses whose data have already been packed by pack_summary_delta().
+	core::Size poses_packed_in_summary_deltas_ = 0;
+
 #ifdef MULTI_THREADED
 	/// @brief A mutex used when cloning the input pose for use by the ensemble generating protocol.
 	/// @details Only used if the ensemble generating protocol is used.
@@ -522,11 +1184,49 @@ private:
 
 	/// @brief A mutex used when collecting data on the cloned pose, in a multi-threaded context.
 	std::mutex ensemble_metric_mutex_;
+
+	/// @brief A mutex used when accumulating per-thread time in the ensemble generation timings.
+	/// @details Only used if collect_ensemble_generation_timings_ is true.
+	std::mutex timings_mutex_;
 #endif
 
 	/// @brief Number of threads to request.  1 means request all available.
 	core::Size n_threads_ = 1;
 
+	/// @brief Should we collect timing statistics when generating an ensemble?  False by default.
+	bool collect_ensemble_generation_timings_ = false;
+
+	/// @brief Should the repeats of the ensemble-generating protocol be divided among all MPI processes?  False by default.
+	bool distribute_ensemble_generation_with_mpi_ = false;
+
+	/// @brief Timing statistics from the last ensemble generation.
+	/// @details Only populated if collect_ensemble_generation_timings_ is true.
+	EnsembleGenerationTimings ensemble_generation_timings_;
+
+	/// @brief Hardware performance counters aggregated over the hot paths of this ensemble metric.
+	/// @details Null unless profiling is on, so that the cost of profiling when off is a null pointer check.
+	EnsembleMetricPerformanceCountersOP performance_counters_;
+
+	/// @brief Observers that are passed the values measured for each pose.
+	/// @details On copy, each observer's observer_for_metric_copy() function decides whether the copy shares it or
+	/// uses another observer.
+	utility::vector1< EnsembleMetricObserverOP > observers_;
+
+	/// @brief Attachment to a shared-memory segment through which the data of several processes are merged.
+	/// @details Null unless shared-memory aggregation is set up.  Shared (not cloned) on copy: there is one per process,
+	/// and each copy registers with it, so that the copies' data are merged before the process contributes.
+	EnsembleMetricSharedMemoryAggregatorOP shared_memory_aggregator_;
+
+	/// @brief Is this copy registered with the shared-memory aggregator, and yet to contribute its data?
+	bool shared_memory_contribution_pending_ = false;
+
+	/// @brief File to which the accumulated state is saved at finalization.  Empty if none.
+	std::string state_dump_filename_;
+
+	/// @brief The index of the attempt that produced the pose currently being measured.
+	/// @details In a multi-threaded context, only written while ensemble_metric_mutex_ is held.
+	core::Size current_attempt_index_ = 0;
+
 #ifdef    SERIALIZATION
 public: //Serialization functions.
 	template< class Archive > void save( Archive & arc ) const;
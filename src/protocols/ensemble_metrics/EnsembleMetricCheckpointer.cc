@@ -0,0 +1,164 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricCheckpointer.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file protocols/ensemble_metrics/EnsembleMetricCheckpointer.cc
+/// @brief Periodically saves the data accumulated by EnsembleMetrics in one process to state files, so that they can
+/// be recovered if the process dies before the end of a run.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Project headers:
+#include <protocols/ensemble_metrics/EnsembleMetricCheckpointer.hh>
+#include <protocols/ensemble_metrics/EnsembleMetric.hh>
+
+// Basic headers:
+#include <basic/Tracer.hh>
+
+// Utility headers:
+#include <utility/exit.hh>
+#include <utility/file/file_sys_util.hh>
+
+static basic::Tracer TR( "protocols.ensemble_metrics.EnsembleMetricCheckpointer" );
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief Constructor.
+/// @param[in] directory The directory in which checkpoint files are written.  For recovery during a run, this must
+/// be visible to the process that produces the reports.
+/// @param[in] run_id An identifier for the run, shared by all processes.
+/// @param[in] process_index The index of this process (e.g. its MPI rank).
+/// @param[in] min_seconds_between_checkpoints Checkpoints are written no more often than this.
+EnsembleMetricCheckpointer::EnsembleMetricCheckpointer(
+	std::string const & directory,
+	std::string const & run_id,
+	core::Size const process_index,
+	core::Real const min_seconds_between_checkpoints
+) :
+	utility::VirtualBase(),
+	directory_( directory.empty() ? "." : directory ),
+	run_id_( run_id ),
+	process_index_( process_index ),
+	min_interval_between_checkpoints_( min_seconds_between_checkpoints ),
+	last_checkpoint_time_( std::chrono::steady_clock::now() )
+{
+	runtime_assert_string_msg( min_seconds_between_checkpoints >= 0.0, "Error in EnsembleMetricCheckpointer constructor: The minimum interval between checkpoints cannot be negative." );
+}
+
+/// @brief Destructor.
+EnsembleMetricCheckpointer::~EnsembleMetricCheckpointer() = default;
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC ACCESSORS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief The name of the checkpoint file for an EnsembleMetric in a given process.
+std::string
+EnsembleMetricCheckpointer::checkpoint_filename(
+	EnsembleMetric const & metric,
+	core::Size const process_index
+) const {
+	return directory_ + "/" + metric.get_ensemble_metric_label() + "." + run_id_ + ".proc" + std::to_string( process_index ) + ".emstate";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC CHECKPOINTING FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Save the state of all of the EnsembleMetrics, if at least the minimum interval has passed since the last
+/// checkpoint (or if force is true) and any poses have been added since then.
+/// @details Must not be called while poses are being added to the EnsembleMetrics.
+/// @returns True if a checkpoint was written; false otherwise.
+bool
+EnsembleMetricCheckpointer::checkpoint_if_due(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	bool const force /*= false*/
+) {
+	std::chrono::steady_clock::time_point const now( std::chrono::steady_clock::now() );
+	if ( !force && now - last_checkpoint_time_ < min_interval_between_checkpoints_ ) return false;
+
+	core::Size total_poses(0);
+	for ( EnsembleMetricOP const & metric : metrics ) {
+		runtime_assert_string_msg( metric->supports_summary_merging(), "Error in EnsembleMetricCheckpointer::checkpoint_if_due(): The " + metric->name() + " ensemble metric does not support summary merging, so its state cannot be checkpointed." );
+		total_poses += metric->poses_in_ensemble();
+	}
+	if ( total_poses == poses_at_last_checkpoint_ ) return false;
+
+	for ( EnsembleMetricOP const & metric : metrics ) {
+		metric->save_state_to_file( checkpoint_filename( *metric, process_index_ ) );
+	}
+	last_checkpoint_time_ = now;
+	poses_at_last_checkpoint_ = total_poses;
+	++n_checkpoints_written_;
+	TR.Debug << "Process " << process_index_ << " checkpointed " << metrics.size() << " ensemble metrics (" << total_poses << " poses in total)." << std::endl;
+	return true;
+}
+
+/// @brief Merge the last checkpoint written by another process into the EnsembleMetrics.
+/// @details EnsembleMetrics for which the other process wrote no checkpoint are left unchanged.
+/// @returns The number of EnsembleMetrics into which checkpointed data were merged.
+core::Size
+EnsembleMetricCheckpointer::recover_from_checkpoints(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	core::Size const process_index
+) const {
+	core::Size n_recovered(0);
+	for ( EnsembleMetricOP const & metric : metrics ) {
+		std::string const filename( checkpoint_filename( *metric, process_index ) );
+		if ( !utility::file::file_exists( filename ) ) {
+			TR.Warning << "No checkpoint of the " << metric->get_ensemble_metric_label() << " ensemble metric was found for process " << process_index << ".  Its data for this ensemble metric are lost." << std::endl;
+			continue;
+		}
+		std::string label;
+		std::string const summary( EnsembleMetric::read_state_file( filename, label ) );
+		runtime_assert_string_msg( label == metric->get_ensemble_metric_label(), "Error in EnsembleMetricCheckpointer::recover_from_checkpoints(): The checkpoint file \"" + filename + "\" holds data for ensemble metric \"" + label + "\", not \"" + metric->get_ensemble_metric_label() + "\"." );
+		metric->merge_summary( summary.data(), summary.size() );
+		++n_recovered;
+	}
+	TR << "Recovered checkpointed data for " << n_recovered << " of " << metrics.size() << " ensemble metrics from process " << process_index << "." << std::endl;
+	return n_recovered;
+}
+
+/// @brief Delete the checkpoint files written by a process for the EnsembleMetrics, if they exist.
+/// @details Intended for cleanup once the data that they hold have safely reached the reports.
+void
+EnsembleMetricCheckpointer::remove_checkpoints(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	core::Size const process_index
+) const {
+	for ( EnsembleMetricOP const & metric : metrics ) {
+		std::string const filename( checkpoint_filename( *metric, process_index ) );
+		if ( utility::file::file_exists( filename ) ) {
+			utility::file::file_delete( filename );
+		}
+	}
+}
+
+} //ensemble_metrics
+} //protocols
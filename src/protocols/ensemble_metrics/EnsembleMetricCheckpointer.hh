@@ -0,0 +1,165 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricCheckpointer.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file protocols/ensemble_metrics/EnsembleMetricCheckpointer.hh
+/// @brief Periodically saves the data accumulated by EnsembleMetrics in one process to state files, so that they can
+/// be recovered if the process dies before the end of a run.
+/// @details Intended for long MPI runs, in which losing one process near the end would otherwise lose the data that
+/// every process had accumulated.  Each process writes one state file per EnsembleMetric (with
+/// EnsembleMetric::save_state_to_file(), which replaces the previous file atomically), no more often than a given
+/// interval.  The process that produces the reports can then merge the last checkpoint of any process that failed to
+/// deliver its data with recover_from_checkpoints().  The files can also be merged after the fact with the
+/// merge_ensemble_metric_states application.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricCheckpointer_hh
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricCheckpointer_hh
+
+#include <protocols/ensemble_metrics/EnsembleMetricCheckpointer.fwd.hh>
+
+// Protocols headers
+#include <protocols/ensemble_metrics/EnsembleMetric.fwd.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/VirtualBase.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <string>
+#include <chrono>
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief Periodically saves the data accumulated by EnsembleMetrics in one process to state files, so that they can
+/// be recovered if the process dies before the end of a run.
+/// @details Checkpoint files are named <directory>/<label>.<run_id>.proc<process_index>.emstate.  The run ID keeps
+/// files from an earlier run in the same directory from being mistaken for those of the current run, so it should be
+/// the same in all processes of a run and different between runs.  Every EnsembleMetric must support summary merging.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricCheckpointer : public utility::VirtualBase {
+
+public:
+
+	/// @brief Constructor.
+	/// @param[in] directory The directory in which checkpoint files are written.  For recovery during a run, this must
+	/// be visible to the process that produces the reports.
+	/// @param[in] run_id An identifier for the run, shared by all processes.
+	/// @param[in] process_index The index of this process (e.g. its MPI rank).
+	/// @param[in] min_seconds_between_checkpoints Checkpoints are written no more often than this.
+	EnsembleMetricCheckpointer(
+		std::string const & directory,
+		std::string const & run_id,
+		core::Size const process_index,
+		core::Real const min_seconds_between_checkpoints
+	);
+
+	/// @brief No default constructor.
+	EnsembleMetricCheckpointer() = delete;
+
+	/// @brief Destructor.
+	~EnsembleMetricCheckpointer() override;
+
+public: // Accessors
+
+	/// @brief The index of this process.
+	inline core::Size process_index() const { return process_index_; }
+
+	/// @brief The number of checkpoints written by this process.
+	inline core::Size n_checkpoints_written() const { return n_checkpoints_written_; }
+
+	/// @brief The name of the checkpoint file for an EnsembleMetric in a given process.
+	std::string
+	checkpoint_filename(
+		EnsembleMetric const & metric,
+		core::Size const process_index
+	) const;
+
+public: // Checkpointing functions
+
+	/// @brief Save the state of all of the EnsembleMetrics, if at least the minimum interval has passed since the last
+	/// checkpoint (or if force is true) and any poses have been added since then.
+	/// @details Must not be called while poses are being added to the EnsembleMetrics.
+	/// @returns True if a checkpoint was written; false otherwise.
+	bool
+	checkpoint_if_due(
+		utility::vector1< EnsembleMetricOP > const & metrics,
+		bool const force = false
+	);
+
+	/// @brief Merge the last checkpoint written by another process into the EnsembleMetrics.
+	/// @details EnsembleMetrics for which the other process wrote no checkpoint are left unchanged.
+	/// @returns The number of EnsembleMetrics into which checkpointed data were merged.
+	core::Size
+	recover_from_checkpoints(
+		utility::vector1< EnsembleMetricOP > const & metrics,
+		core::Size const process_index
+	) const;
+
+	/// @brief Delete the checkpoint files written by a process for the EnsembleMetrics, if they exist.
+	/// @details Intended for cleanup once the data that they hold have safely reached the reports.
+	void
+	remove_checkpoints(
+		utility::vector1< EnsembleMetricOP > const & metrics,
+		core::Size const process_index
+	) const;
+
+private: // Data
+
+	/// @brief The directory in which checkpoint files are written.
+	std::string directory_;
+
+	/// @brief An identifier for the run, shared by all processes.
+	std::string run_id_;
+
+	/// @brief The index of this process.
+	core::Size process_index_ = 0;
+
+	/// @brief Checkpoints are written no more often than this.
+	std::chrono::duration< double > min_interval_between_checkpoints_;
+
+	/// @brief When this process last wrote a checkpoint.
+	std::chrono::steady_clock::time_point last_checkpoint_time_;
+
+	/// @brief The total number of poses in the EnsembleMetrics at the last checkpoint.
+	core::Size poses_at_last_checkpoint_ = 0;
+
+	/// @brief The number of checkpoints written by this process.
+	core::Size n_checkpoints_written_ = 0;
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricCheckpointer_hh
@@ -0,0 +1,316 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricColumnarDumpReader.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricColumnarDumpReader.cc
+/// @brief Memory-maps a columnar dump of per-pose values (written by a ColumnarDumpEnsembleMetricObserver) for
+/// re-analysis, without parsing and, where blocks are stored uncompressed, without copying.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Unit headers
+#include <protocols/ensemble_metrics/EnsembleMetricColumnarDumpReader.hh>
+
+// Package headers
+#include <protocols/ensemble_metrics/EnsembleMetric.hh>
+
+// Basic headers
+#include <basic/Tracer.hh>
+
+// Utility headers
+#include <utility/exit.hh>
+
+// External headers
+#include <zlib/zlib.h>
+
+// STL headers
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define ENSEMBLE_METRIC_POSIX_MEMORY_MAPPING
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+static basic::Tracer TR( "protocols.ensemble_metrics.EnsembleMetricColumnarDumpReader" );
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief The number of bytes needed to pad a payload of a given size to a multiple of eight bytes.
+static
+core::Size
+padded_bytes(
+	core::Size const payload_bytes
+) {
+	return payload_bytes + ( 8 - payload_bytes % 8 ) % 8;
+}
+
+/// @brief Feed a block of values into an EnsembleMetric.  If core::Real is double (as it normally is), the values are
+/// passed in place; otherwise, they are converted through the scratch vector.
+static
+void
+add_doubles_to_metric(
+	EnsembleMetric & metric,
+	double const * values,
+	core::Size const n_values,
+	utility::vector1< core::Real > & conversion_scratch
+) {
+	if ( std::is_same< core::Real, double >::value ) {
+		metric.add_raw_values( reinterpret_cast< core::Real const * >( values ), n_values );
+	} else {
+		conversion_scratch.assign( values, values + n_values );
+		metric.add_raw_values( conversion_scratch.data(), n_values );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Constructor.  Maps and indexes the file.
+EnsembleMetricColumnarDumpReader::EnsembleMetricColumnarDumpReader(
+	std::string const & filename
+) :
+	utility::VirtualBase(),
+	filename_( filename )
+{
+	map_file();
+	index_chunks();
+	TR.Debug << "Indexed " << n_records_ << " records in " << blocks_.size() << " blocks from columnar dump file \"" << filename_ << "\"." << std::endl;
+}
+
+/// @brief Destructor.  Unmaps the file.
+EnsembleMetricColumnarDumpReader::~EnsembleMetricColumnarDumpReader() {
+#ifdef ENSEMBLE_METRIC_POSIX_MEMORY_MAPPING
+	if ( memory_mapped_ ) {
+		munmap( const_cast< char * >( data_ ), size_ );
+	}
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GETTERS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Get the (one-based) index of a value column from its name.  Throws if there is no such column.
+core::Size
+EnsembleMetricColumnarDumpReader::column_index(
+	std::string const & column_name
+) const {
+	for ( core::Size i( 1 ); i <= column_names_.size(); ++i ) {
+		if ( column_names_[i] == column_name ) return i;
+	}
+	utility_exit_with_message( "Error in EnsembleMetricColumnarDumpReader::column_index(): The columnar dump file \"" + filename_ + "\" has no value column named \"" + column_name + "\"." );
+	return 0;
+}
+
+/// @brief The number of blocks that were stored compressed (and so must be decompressed to be read).
+core::Size
+EnsembleMetricColumnarDumpReader::n_compressed_blocks() const {
+	core::Size count( 0 );
+	for ( BlockEntry const & entry : blocks_ ) {
+		if ( entry.compressed ) ++count;
+	}
+	return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// READING FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Get a view of a (one-based) block of records.
+/// @details If the block was stored uncompressed, the view points into the mapping, and scratch is untouched.
+/// Otherwise, the block is decompressed into scratch, which is resized as needed.  Threadsafe if each thread
+/// passes its own scratch buffer.
+EnsembleMetricColumnarDumpBlockView
+EnsembleMetricColumnarDumpReader::block(
+	core::Size const block_index,
+	std::vector< std::uint64_t > & scratch
+) const {
+	runtime_assert_string_msg( block_index > 0 && block_index <= blocks_.size(), "Error in EnsembleMetricColumnarDumpReader::block(): Block " + std::to_string( block_index ) + " was requested, but the columnar dump file \"" + filename_ + "\" has " + std::to_string( blocks_.size() ) + " blocks." );
+	BlockEntry const & entry( blocks_[ block_index ] );
+	if ( !entry.compressed ) {
+		return EnsembleMetricColumnarDumpBlockView( data_ + entry.payload_offset, entry.n_records, true );
+	}
+
+	scratch.resize( entry.uncompressed_bytes / sizeof( std::uint64_t ) );
+	uLongf uncompressed_bytes( entry.uncompressed_bytes );
+	int const status(
+		uncompress(
+			reinterpret_cast< Bytef * >( scratch.data() ), &uncompressed_bytes,
+			reinterpret_cast< Bytef const * >( data_ + entry.payload_offset ), entry.stored_bytes
+		)
+	);
+	runtime_assert_string_msg( status == Z_OK && uncompressed_bytes == entry.uncompressed_bytes, "Error in EnsembleMetricColumnarDumpReader::block(): Could not decompress block " + std::to_string( block_index ) + " of columnar dump file \"" + filename_ + "\".  The file may be corrupt." );
+	return EnsembleMetricColumnarDumpBlockView( reinterpret_cast< char const * >( scratch.data() ), entry.n_records, false );
+}
+
+/// @brief Feed every value in a (one-based) value column into an EnsembleMetric that supports raw value
+/// ingestion, block by block, straight from the mapping (or from the decompression buffer).
+/// @returns The number of values fed in.
+core::Size
+EnsembleMetricColumnarDumpReader::add_column_to_metric(
+	EnsembleMetric & metric,
+	core::Size const column /*= 1*/
+) const {
+	std::string const errmsg( "Error in EnsembleMetricColumnarDumpReader::add_column_to_metric(): " );
+	runtime_assert_string_msg( metric.supports_raw_value_ingestion(), errmsg + "The " + metric.name() + " ensemble metric does not support the ingestion of raw per-pose values." );
+	runtime_assert_string_msg( column > 0 && column <= column_names_.size(), errmsg + "Column " + std::to_string( column ) + " was requested, but the columnar dump file \"" + filename_ + "\" has " + std::to_string( column_names_.size() ) + " value columns." );
+
+	metric.reserve_raw_values( n_records_ );
+	utility::vector1< core::Real > conversion_scratch;
+	for_each_block(
+		[&metric, &conversion_scratch, column]( EnsembleMetricColumnarDumpBlockView const & view ) {
+			add_doubles_to_metric( metric, view.values( column ), view.n_records(), conversion_scratch );
+		}
+	);
+	return n_records_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Map (or read) the file.
+void
+EnsembleMetricColumnarDumpReader::map_file() {
+	std::string const errmsg( "Error in EnsembleMetricColumnarDumpReader::map_file(): " );
+#ifdef ENSEMBLE_METRIC_POSIX_MEMORY_MAPPING
+	int const fd( open( filename_.c_str(), O_RDONLY ) );
+	runtime_assert_string_msg( fd >= 0, errmsg + "Could not open columnar dump file \"" + filename_ + "\": " + std::strerror( errno ) );
+	struct stat file_stat;
+	if ( fstat( fd, &file_stat ) != 0 ) {
+		int const error( errno );
+		close( fd );
+		utility_exit_with_message( errmsg + "Could not get the size of columnar dump file \"" + filename_ + "\": " + std::strerror( error ) );
+	}
+	size_ = static_cast< core::Size >( file_stat.st_size );
+	if ( size_ == 0 ) {
+		close( fd );
+		utility_exit_with_message( errmsg + "The columnar dump file \"" + filename_ + "\" is empty." );
+	}
+	void * const mapping( mmap( nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0 ) );
+	close( fd );
+	runtime_assert_string_msg( mapping != MAP_FAILED, errmsg + "Could not map columnar dump file \"" + filename_ + "\": " + std::strerror( errno ) );
+	madvise( mapping, size_, MADV_SEQUENTIAL );
+	data_ = static_cast< char const * >( mapping );
+	memory_mapped_ = true;
+#else
+	std::ifstream infile( filename_, std::ios_base::in | std::ios_base::binary | std::ios_base::ate );
+	runtime_assert_string_msg( infile.good(), errmsg + "Could not open columnar dump file \"" + filename_ + "\"." );
+	size_ = static_cast< core::Size >( infile.tellg() );
+	infile.seekg( 0 );
+	fallback_storage_.resize( ( size_ + sizeof( std::uint64_t ) - 1 ) / sizeof( std::uint64_t ) );
+	infile.read( reinterpret_cast< char * >( fallback_storage_.data() ), size_ );
+	runtime_assert_string_msg( infile.good(), errmsg + "Could not read columnar dump file \"" + filename_ + "\"." );
+	data_ = reinterpret_cast< char const * >( fallback_storage_.data() );
+	memory_mapped_ = false;
+#endif
+}
+
+/// @brief Scan the chunk headers, indexing the column names, job names, and blocks.
+void
+EnsembleMetricColumnarDumpReader::index_chunks() {
+	using namespace protocols::ensemble_metrics::observers;
+	std::string const errmsg( "Error in EnsembleMetricColumnarDumpReader::index_chunks(): " );
+
+	runtime_assert_string_msg( size_ >= sizeof( ColumnarDumpFileHeader ), errmsg + "The file \"" + filename_ + "\" is too short to be a columnar dump file." );
+	ColumnarDumpFileHeader file_header;
+	std::memcpy( &file_header, data_, sizeof( ColumnarDumpFileHeader ) );
+	runtime_assert_string_msg( file_header.magic == columnar_dump_magic, errmsg + "The file \"" + filename_ + "\" is not a columnar dump file, or was written on a machine with a different byte order." );
+	runtime_assert_string_msg( file_header.version == columnar_dump_version, errmsg + "The columnar dump file \"" + filename_ + "\" was written in an unsupported version (" + std::to_string( file_header.version ) + ") of the format." );
+	core::Size const n_columns( file_header.n_value_columns );
+	runtime_assert_string_msg( n_columns > 0, errmsg + "The columnar dump file \"" + filename_ + "\" has no value columns." );
+	core::Size const record_bytes( 2 * sizeof( std::uint64_t ) + n_columns * sizeof( double ) );
+
+	core::Size offset( sizeof( ColumnarDumpFileHeader ) );
+	while ( offset < size_ ) {
+		if ( size_ - offset < sizeof( ColumnarDumpChunkHeader ) ) {
+			TR.Warning << "The columnar dump file \"" << filename_ << "\" ends with a truncated chunk, which will be ignored." << std::endl;
+			break;
+		}
+		ColumnarDumpChunkHeader header;
+		std::memcpy( &header, data_ + offset, sizeof( ColumnarDumpChunkHeader ) );
+		core::Size const payload_offset( offset + sizeof( ColumnarDumpChunkHeader ) );
+		if ( header.stored_bytes > size_ - payload_offset || padded_bytes( header.stored_bytes ) > size_ - payload_offset ) {
+			TR.Warning << "The columnar dump file \"" << filename_ << "\" ends with a truncated chunk, which will be ignored." << std::endl;
+			break;
+		}
+		char const * const payload( data_ + payload_offset );
+
+		switch ( static_cast< ColumnarDumpChunkType >( header.chunk_type ) ) {
+		case ColumnarDumpChunkType::COLUMN_NAMES : {
+			column_names_.clear();
+			char const * name( payload );
+			char const * const end( payload + header.stored_bytes );
+			while ( name < end ) {
+				core::Size const length( strnlen( name, end - name ) );
+				column_names_.push_back( std::string( name, length ) );
+				name += length + 1;
+			}
+			runtime_assert_string_msg( column_names_.size() == n_columns, errmsg + "The columnar dump file \"" + filename_ + "\" names " + std::to_string( column_names_.size() ) + " value columns, but has " + std::to_string( n_columns ) + "." );
+			break;
+		}
+		case ColumnarDumpChunkType::JOB_NAME :
+			runtime_assert_string_msg( header.n_records == job_names_.size(), errmsg + "The jobs in columnar dump file \"" + filename_ + "\" are out of order.  The file may be corrupt." );
+			job_names_.push_back( std::string( payload, header.stored_bytes ) );
+			break;
+		case ColumnarDumpChunkType::RECORDS : {
+			BlockEntry entry;
+			entry.payload_offset = payload_offset;
+			entry.n_records = header.n_records;
+			entry.stored_bytes = header.stored_bytes;
+			entry.uncompressed_bytes = header.uncompressed_bytes;
+			entry.compressed = ( static_cast< ColumnarDumpCompression >( header.compression ) == ColumnarDumpCompression::ZLIB );
+			runtime_assert_string_msg( entry.compressed || static_cast< ColumnarDumpCompression >( header.compression ) == ColumnarDumpCompression::NONE, errmsg + "The columnar dump file \"" + filename_ + "\" uses an unknown compression scheme." );
+			runtime_assert_string_msg( entry.uncompressed_bytes == entry.n_records * record_bytes && ( entry.compressed || entry.stored_bytes == entry.uncompressed_bytes ), errmsg + "A block in columnar dump file \"" + filename_ + "\" has an inconsistent size.  The file may be corrupt." );
+			blocks_.push_back( entry );
+			n_records_ += entry.n_records;
+			break;
+		}
+		default :
+			TR.Warning << "Skipping a chunk of unknown type " << header.chunk_type << " in columnar dump file \"" << filename_ << "\"." << std::endl;
+		}
+
+		offset = payload_offset + padded_bytes( header.stored_bytes );
+	}
+
+	if ( column_names_.empty() ) {
+		for ( core::Size i( 1 ); i <= n_columns; ++i ) {
+			column_names_.push_back( "value_" + std::to_string( i ) );
+		}
+	}
+}
+
+} //ensemble_metrics
+} //protocols
@@ -0,0 +1,264 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricColumnarDumpReader.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricColumnarDumpReader.hh
+/// @brief Memory-maps a columnar dump of per-pose values (written by a ColumnarDumpEnsembleMetricObserver) for
+/// re-analysis, without parsing and, where blocks are stored uncompressed, without copying.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricColumnarDumpReader_HH
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricColumnarDumpReader_HH
+
+// Unit headers
+#include <protocols/ensemble_metrics/EnsembleMetricColumnarDumpReader.fwd.hh>
+
+// Package headers
+#include <protocols/ensemble_metrics/EnsembleMetric.fwd.hh>
+#include <protocols/ensemble_metrics/observers/ColumnarDumpEnsembleMetricObserver.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/VirtualBase.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief A read-only view of one block of records from a columnar dump.
+/// @details Points either into the memory-mapped file (if the block was stored uncompressed) or into a caller-supplied
+/// scratch buffer (if it was decompressed).  Only valid while the reader, and the scratch buffer, are unchanged.
+class EnsembleMetricColumnarDumpBlockView {
+
+public:
+
+	/// @brief Constructor.
+	/// @param[in] data The start of the uncompressed block payload.  Must be aligned to eight bytes.
+	EnsembleMetricColumnarDumpBlockView(
+		char const * data,
+		core::Size const n_records,
+		bool const in_place
+	) :
+		data_( data ),
+		n_records_( n_records ),
+		in_place_( in_place )
+	{}
+
+	/// @brief The number of records in this block.
+	inline core::Size n_records() const { return n_records_; }
+
+	/// @brief The attempt index of each record.
+	inline
+	std::uint64_t const *
+	attempt_indices() const {
+		return reinterpret_cast< std::uint64_t const * >( data_ );
+	}
+
+	/// @brief The (zero-based) index of the job that produced each record.
+	inline
+	std::uint64_t const *
+	job_indices() const {
+		return reinterpret_cast< std::uint64_t const * >( data_ ) + n_records_;
+	}
+
+	/// @brief The values in a (one-based) value column, one per record.
+	inline
+	double const *
+	values(
+		core::Size const column
+	) const {
+		return reinterpret_cast< double const * >( data_ + 2 * n_records_ * sizeof( std::uint64_t ) ) + ( column - 1 ) * n_records_;
+	}
+
+	/// @brief Does this view point into the mapped file itself (true), or into a decompression buffer (false)?
+	inline bool in_place() const { return in_place_; }
+
+private:
+
+	/// @brief The start of the uncompressed block payload.
+	char const * data_;
+
+	/// @brief The number of records in this block.
+	core::Size n_records_;
+
+	/// @brief Does this view point into the mapped file itself?
+	bool in_place_;
+
+};
+
+/// @brief Memory-maps a columnar dump of per-pose values (written by a ColumnarDumpEnsembleMetricObserver) for
+/// re-analysis, without parsing and, where blocks are stored uncompressed, without copying.
+/// @details On construction, the file is mapped read-only and its chunk headers are scanned (skipping over the
+/// payloads) to index the column names, job names and blocks of records.  A truncated final chunk (e.g. from a
+/// process that died) is ignored with a warning.  Blocks stored uncompressed are then used in place; compressed
+/// blocks are decompressed, one at a time, into a scratch buffer.  Values can be fed straight into any EnsembleMetric
+/// that supports raw value ingestion (such as the CentralTendencyEnsembleMetric) with add_column_to_metric().
+/// @note On platforms without POSIX memory mapping, the file is read into memory instead.  Dumps use native byte
+/// order, so they must be read on the same architecture that wrote them.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricColumnarDumpReader : public utility::VirtualBase {
+
+public:
+
+	/// @brief Constructor.  Maps and indexes the file.
+	EnsembleMetricColumnarDumpReader( std::string const & filename );
+
+	/// @brief No default constructor.
+	EnsembleMetricColumnarDumpReader() = delete;
+
+	/// @brief No copy constructor (since this owns a mapping).
+	EnsembleMetricColumnarDumpReader( EnsembleMetricColumnarDumpReader const & ) = delete;
+
+	/// @brief No assignment operator.
+	EnsembleMetricColumnarDumpReader & operator=( EnsembleMetricColumnarDumpReader const & ) = delete;
+
+	/// @brief Destructor.  Unmaps the file.
+	~EnsembleMetricColumnarDumpReader() override;
+
+public: // Getters
+
+	/// @brief The file that was read.
+	inline std::string const & filename() const { return filename_; }
+
+	/// @brief The number of value columns.
+	inline core::Size n_value_columns() const { return column_names_.size(); }
+
+	/// @brief The names of the value columns.
+	inline utility::vector1< std::string > const & column_names() const { return column_names_; }
+
+	/// @brief Get the (one-based) index of a value column from its name.  Throws if there is no such column.
+	core::Size column_index( std::string const & column_name ) const;
+
+	/// @brief The names of the jobs that produced the records, indexed by the (zero-based) job indices plus one.
+	inline utility::vector1< std::string > const & job_names() const { return job_names_; }
+
+	/// @brief The number of blocks of records.
+	inline core::Size n_blocks() const { return blocks_.size(); }
+
+	/// @brief The total number of records.
+	inline core::Size n_records() const { return n_records_; }
+
+	/// @brief The number of blocks that were stored compressed (and so must be decompressed to be read).
+	core::Size n_compressed_blocks() const;
+
+	/// @brief Was the file memory-mapped (true), or read into memory (false)?
+	inline bool memory_mapped() const { return memory_mapped_; }
+
+public: // Reading functions
+
+	/// @brief Get a view of a (one-based) block of records.
+	/// @details If the block was stored uncompressed, the view points into the mapping, and scratch is untouched.
+	/// Otherwise, the block is decompressed into scratch, which is resized as needed.  Threadsafe if each thread
+	/// passes its own scratch buffer.
+	EnsembleMetricColumnarDumpBlockView
+	block(
+		core::Size const block_index,
+		std::vector< std::uint64_t > & scratch
+	) const;
+
+	/// @brief Call fxn( view ) with a view of each block of records in turn, reusing one scratch buffer for any
+	/// decompression.
+	template< class BlockFunction >
+	void
+	for_each_block(
+		BlockFunction && fxn
+	) const {
+		std::vector< std::uint64_t > scratch;
+		for ( core::Size i( 1 ); i <= blocks_.size(); ++i ) {
+			fxn( block( i, scratch ) );
+		}
+	}
+
+	/// @brief Feed every value in a (one-based) value column into an EnsembleMetric that supports raw value
+	/// ingestion, block by block, straight from the mapping (or from the decompression buffer).
+	/// @returns The number of values fed in.
+	core::Size
+	add_column_to_metric(
+		EnsembleMetric & metric,
+		core::Size const column = 1
+	) const;
+
+private: // Private functions
+
+	/// @brief Map (or read) the file.
+	void map_file();
+
+	/// @brief Scan the chunk headers, indexing the column names, job names, and blocks.
+	void index_chunks();
+
+private: // Private data
+
+	/// @brief The location of one block of records in the file.
+	struct BlockEntry {
+		core::Size payload_offset;
+		core::Size n_records;
+		core::Size stored_bytes;
+		core::Size uncompressed_bytes;
+		bool compressed;
+	};
+
+	/// @brief The file that was read.
+	std::string const filename_;
+
+	/// @brief The start of the file's contents in memory.
+	char const * data_ = nullptr;
+
+	/// @brief The size of the file.
+	core::Size size_ = 0;
+
+	/// @brief Was the file memory-mapped?
+	bool memory_mapped_ = false;
+
+	/// @brief The file's contents, if it could not be memory-mapped.  Held as 64-bit words for alignment.
+	std::vector< std::uint64_t > fallback_storage_;
+
+	/// @brief The names of the value columns.
+	utility::vector1< std::string > column_names_;
+
+	/// @brief The names of the jobs that produced the records.
+	utility::vector1< std::string > job_names_;
+
+	/// @brief The blocks of records.
+	utility::vector1< BlockEntry > blocks_;
+
+	/// @brief The total number of records.
+	core::Size n_records_ = 0;
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricColumnarDumpReader_HH
@@ -97,6 +97,20 @@ EnsembleMetricFactory::new_ensemble_metric(
 	return new_ensemble_metric;
 }
 
+/// @brief Create an ensemble metric with default settings, without parsing any XML.
+/// @details Intended for merging saved data (e.g. with merge_summary()) when the original script is unavailable.
+EnsembleMetricOP
+EnsembleMetricFactory::new_ensemble_metric(
+	std::string const & ensemble_metric_name
+) const {
+	auto iter = creator_map_.find( ensemble_metric_name );
+	runtime_assert_string_msg(
+		iter != creator_map_.end(),
+		"No EnsembleMetricCreator with the name '" + ensemble_metric_name + "' has been registered with the EnsembleMetricFactory!"
+	);
+	return iter->second->create_ensemble_metric();
+}
+
 
 /// @brief Get the XML schema for a given ensemble metric.
 /// @details Throws an error if the residue selector is unknown to Rosetta.
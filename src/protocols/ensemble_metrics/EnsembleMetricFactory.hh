@@ -75,6 +75,12 @@ public:
 		basic::datacache::DataMap & datamap
 	) const;
 
+	/// @brief Create an ensemble metric with default settings, without parsing any XML.
+	/// @details Intended for merging saved data (e.g. with merge_summary()) when the original script is unavailable.
+	EnsembleMetricOP new_ensemble_metric(
+		std::string const & ensemble_metric_name
+	) const;
+
 	/// @brief Get the XML schema for a given residue selector.
 	/// @details Throws an error if the residue selector is unknown to Rosetta.
 	void
@@ -0,0 +1,103 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricObserver.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file   protocols/ensemble_metrics/EnsembleMetricObserver.hh
+/// @brief  Pure virtual base class for observers that receive each per-pose measurement made by an
+/// EnsembleMetric, as it is made.
+/// @details Observers are registered with EnsembleMetric::add_observer().  This lets downstream tools
+/// (plotting, online dashboards, database writers, etc.) receive every per-pose value without having to
+/// scrape tracer output.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricObserver_HH
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricObserver_HH
+
+// Package headers
+#include <protocols/ensemble_metrics/EnsembleMetricObserver.fwd.hh>
+#include <protocols/ensemble_metrics/EnsembleMetric.fwd.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/VirtualBase.hh>
+#include <utility/pointer/owning_ptr.hh>
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief  Pure virtual base class for observers that receive each per-pose measurement made by an
+/// EnsembleMetric, as it is made.
+/// @details The EnsembleMetric calls observe_measurement() once per pose measured.  In the multi-threaded
+/// ensemble generation path, calls are made while the EnsembleMetric holds the lock that protects its
+/// accumulated data, so calls for a given EnsembleMetric never overlap.  Implementations should return
+/// quickly, since every thread generating ensemble members waits on that lock.  An observer registered
+/// with several EnsembleMetrics may be called concurrently by different metrics, however.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricObserver : public utility::VirtualBase {
+public:
+
+	/// @brief Receive the values measured for one pose.
+	/// @param[in] metric The EnsembleMetric that made the measurement.
+	/// @param[in] attempt_index The index of the attempt that produced the pose.  If the ensemble was generated
+	/// by an ensemble-generating protocol, this is the index of the repeat of that protocol; otherwise, it is
+	/// the ordinal of the pose in the ensemble.
+	/// @param[in] values Pointer to the first of the values measured.  Only valid for the duration of the call.
+	/// @param[in] n_values The number of values measured.
+	virtual
+	void
+	observe_measurement(
+		EnsembleMetric const & metric,
+		core::Size const attempt_index,
+		core::Real const * values,
+		core::Size const n_values
+	) = 0;
+
+	/// @brief Get the observer that a copy of an EnsembleMetric registered with this observer should use.
+	/// @details Called by the EnsembleMetric copy constructor and assignment operator.  Copies of EnsembleMetrics are
+	/// typically made so that they can run concurrently (e.g. one per thread), so observers that are not safe for
+	/// concurrent calls from several EnsembleMetrics must override this to return a new observer.  The default
+	/// implementation returns nullptr, which means that the copy shares this observer.
+	virtual
+	EnsembleMetricObserverOP
+	observer_for_metric_copy() const {
+		return nullptr;
+	}
+
+	/// @brief Write out anything that this observer has buffered.
+	/// @details Called by the EnsembleMetric when it produces its final report.  The default implementation does
+	/// nothing.
+	virtual void flush() {}
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricObserver_HH
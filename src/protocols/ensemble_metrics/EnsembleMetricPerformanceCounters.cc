@@ -0,0 +1,372 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricPerformanceCounters.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricPerformanceCounters.cc
+/// @brief Optional hardware performance-counter profiling of the hot paths of an EnsembleMetric
+/// (adding poses, finalizing, and MPI summary communication), using the Linux perf_event interface.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Project headers:
+#include <protocols/ensemble_metrics/EnsembleMetricPerformanceCounters.hh>
+
+// Utility headers:
+#include <utility/exit.hh>
+#include <utility/pointer/memory.hh>
+
+//STL headers:
+#include <sstream>
+
+#if defined(__linux__)
+// Linux headers:
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief The number of hardware counters read.
+static constexpr core::Size n_hardware_counters( static_cast< core::Size >( EnsembleMetricHardwareCounter::N_COUNTERS ) );
+
+#if defined(__linux__)
+
+/// @brief The perf_event hardware event for each EnsembleMetricHardwareCounter, in order.
+static std::array< std::uint64_t, n_hardware_counters > const perf_event_configs{
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_BRANCH_MISSES
+};
+
+/// @brief A group of perf_event file descriptors counting events for one thread.
+/// @details Opened on first use in each thread, and closed when the thread exits.  The group is
+/// read with a single read() call on the group leader.
+struct PerThreadCounterGroup {
+
+	/// @brief Constructor.  Opens the counters for the calling thread.
+	PerThreadCounterGroup() {
+		fds.fill( -1 );
+		for ( core::Size i(0); i<n_hardware_counters; ++i ) {
+			perf_event_attr attr;
+			std::memset( &attr, 0, sizeof( perf_event_attr ) );
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.size = sizeof( perf_event_attr );
+			attr.config = perf_event_configs[i];
+			attr.disabled = ( i == 0 ? 1 : 0 ); //Only the leader starts disabled; the group is enabled through it.
+			attr.exclude_kernel = 1; //Allows use with perf_event_paranoid settings up to 2.
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+			// Count this thread (pid 0), on any CPU (-1):
+			fds[i] = static_cast< int >( syscall( __NR_perf_event_open, &attr, 0, -1, ( i == 0 ? -1 : fds[0] ), 0 ) );
+			if ( fds[i] < 0 ) {
+				close_all();
+				return;
+			}
+		}
+		ioctl( fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP );
+		ioctl( fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP );
+		available = true;
+	}
+
+	/// @brief Destructor.  Closes the counters.
+	~PerThreadCounterGroup() {
+		close_all();
+	}
+
+	/// @brief Close any open file descriptors.
+	void
+	close_all() {
+		for ( int & fd : fds ) {
+			if ( fd >= 0 ) close( fd );
+			fd = -1;
+		}
+		available = false;
+	}
+
+	/// @brief Read all counters with one system call.
+	bool
+	read_counts(
+		std::array< std::uint64_t, n_hardware_counters > & counts
+	) const {
+		if ( !available ) return false;
+		struct {
+			std::uint64_t nr;
+			std::uint64_t values[ n_hardware_counters ];
+		} buffer;
+		if ( read( fds[0], &buffer, sizeof( buffer ) ) != static_cast< ssize_t >( sizeof( buffer ) ) || buffer.nr != n_hardware_counters ) {
+			return false;
+		}
+		for ( core::Size i(0); i<n_hardware_counters; ++i ) {
+			counts[i] = buffer.values[i];
+		}
+		return true;
+	}
+
+	/// @brief The file descriptors.  The first is the group leader.
+	std::array< int, n_hardware_counters > fds;
+
+	/// @brief Were all counters opened successfully?
+	bool available = false;
+
+};
+
+/// @brief Get the counter group for the calling thread, opening it on first use.
+static
+PerThreadCounterGroup const &
+counter_group_for_this_thread() {
+	static thread_local PerThreadCounterGroup const group;
+	return group;
+}
+
+#endif //defined(__linux__)
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTOR AND DESTRUCTOR
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Default constructor.
+EnsembleMetricPerformanceCounters::EnsembleMetricPerformanceCounters() = default;
+
+/// @brief Copy constructor.
+/// @details Explicit because std::mutex has a deleted copy constructor.
+EnsembleMetricPerformanceCounters::EnsembleMetricPerformanceCounters(
+	EnsembleMetricPerformanceCounters const & src
+) :
+	VirtualBase( src )
+{
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( src.counts_mutex_ );
+#endif
+	region_counts_ = src.region_counts_;
+	hardware_counts_complete_ = src.hardware_counts_complete_;
+}
+
+/// @brief Destructor.
+EnsembleMetricPerformanceCounters::~EnsembleMetricPerformanceCounters() = default;
+
+/// @brief Clone operation: make a copy of this object, and return an owning pointer to the copy.
+EnsembleMetricPerformanceCountersOP
+EnsembleMetricPerformanceCounters::clone() const {
+	return utility::pointer::make_shared< EnsembleMetricPerformanceCounters >( *this );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// STATIC FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Given a region enum, get its name.
+std::string
+EnsembleMetricPerformanceCounters::region_name_from_enum(
+	EnsembleMetricProfiledRegion const region
+) {
+	switch( region ) {
+	case EnsembleMetricProfiledRegion::ADD_POSE_TO_ENSEMBLE :
+		return "add_pose_to_ensemble";
+	case EnsembleMetricProfiledRegion::FINALIZE :
+		return "finalize";
+	case EnsembleMetricProfiledRegion::SEND_MPI_SUMMARY :
+		return "send_mpi_summary";
+	case EnsembleMetricProfiledRegion::RECV_MPI_SUMMARY :
+		return "recv_mpi_summary";
+	default :
+		utility_exit_with_message( "Error in EnsembleMetricPerformanceCounters::region_name_from_enum(): Invalid region!" );
+	}
+	return ""; //Keep older compilers happy.
+}
+
+/// @brief Given a hardware counter enum, get its name.
+std::string
+EnsembleMetricPerformanceCounters::counter_name_from_enum(
+	EnsembleMetricHardwareCounter const counter
+) {
+	switch( counter ) {
+	case EnsembleMetricHardwareCounter::INSTRUCTIONS :
+		return "instructions";
+	case EnsembleMetricHardwareCounter::CYCLES :
+		return "cycles";
+	case EnsembleMetricHardwareCounter::CACHE_MISSES :
+		return "cache_misses";
+	case EnsembleMetricHardwareCounter::BRANCH_MISSES :
+		return "branch_misses";
+	default :
+		utility_exit_with_message( "Error in EnsembleMetricPerformanceCounters::counter_name_from_enum(): Invalid counter!" );
+	}
+	return ""; //Keep older compilers happy.
+}
+
+/// @brief Are hardware counters available to the calling thread?
+/// @details Opens the counters for the calling thread if they have not yet been opened.  False on platforms
+/// other than Linux, and if the kernel refuses access to the counters.
+bool
+EnsembleMetricPerformanceCounters::hardware_counters_available() {
+#if defined(__linux__)
+	return counter_group_for_this_thread().available;
+#else
+	return false;
+#endif
+}
+
+/// @brief Read the current values of the hardware counters for the calling thread.
+/// @returns False (leaving counts unaltered) if hardware counters are unavailable.
+bool
+EnsembleMetricPerformanceCounters::read_hardware_counters(
+	std::array< std::uint64_t, n_hardware_counters > & counts
+) {
+#if defined(__linux__)
+	return counter_group_for_this_thread().read_counts( counts );
+#else
+	(void) counts;
+	return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ACCUMULATION FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Add one pass through a region to the aggregated counts.
+/// @details Threadsafe.  The counter deltas are ignored if hardware_counts_valid is false.
+void
+EnsembleMetricPerformanceCounters::accumulate(
+	EnsembleMetricProfiledRegion const region,
+	core::Real const wall_time,
+	std::array< std::uint64_t, n_hardware_counters > const & count_deltas,
+	bool const hardware_counts_valid
+) {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( counts_mutex_ );
+#endif
+	EnsembleMetricRegionCounts & counts( region_counts_[ static_cast< core::Size >( region ) - 1 ] );
+	++counts.calls;
+	counts.wall_time += wall_time;
+	if ( hardware_counts_valid ) {
+		++counts.hardware_calls;
+		for ( core::Size i(0); i<n_hardware_counters; ++i ) {
+			counts.counts[i] += count_deltas[i];
+		}
+	} else {
+		hardware_counts_complete_ = false;
+	}
+}
+
+/// @brief Discard all aggregated counts.
+void
+EnsembleMetricPerformanceCounters::reset() {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( counts_mutex_ );
+#endif
+	region_counts_.fill( EnsembleMetricRegionCounts() );
+	hardware_counts_complete_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GETTERS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Get the aggregated counts for a region.
+EnsembleMetricRegionCounts const &
+EnsembleMetricPerformanceCounters::counts_for_region(
+	EnsembleMetricProfiledRegion const region
+) const {
+	runtime_assert_string_msg(
+		region >= EnsembleMetricProfiledRegion::ADD_POSE_TO_ENSEMBLE && region <= EnsembleMetricProfiledRegion::N_REGIONS,
+		"Error in EnsembleMetricPerformanceCounters::counts_for_region(): Invalid region!"
+	);
+	return region_counts_[ static_cast< core::Size >( region ) - 1 ];
+}
+
+/// @brief Write the aggregated counts to a string, for appending to an EnsembleMetric's report.
+/// @note Output is not terminated in a newline.
+std::string
+EnsembleMetricPerformanceCounters::report_string() const {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( counts_mutex_ );
+#endif
+	std::ostringstream ss;
+	ss << "Performance counters";
+	if ( !hardware_counts_complete_ ) {
+		ss << " (hardware counters were unavailable for some or all calls; only call counts and wall times are complete)";
+	}
+	ss << ":";
+	for ( core::Size iregion(1); iregion <= static_cast< core::Size >( EnsembleMetricProfiledRegion::N_REGIONS ); ++iregion ) {
+		EnsembleMetricRegionCounts const & counts( region_counts_[ iregion - 1 ] );
+		if ( counts.calls == 0 ) continue;
+		ss << "\n\t" << region_name_from_enum( static_cast< EnsembleMetricProfiledRegion >( iregion ) ) << ":"
+			<< "\tcalls=" << counts.calls
+			<< "\twall_time=" << counts.wall_time << "s";
+		if ( counts.hardware_calls == 0 ) continue;
+		for ( core::Size icounter(1); icounter <= n_hardware_counters; ++icounter ) {
+			ss << "\t" << counter_name_from_enum( static_cast< EnsembleMetricHardwareCounter >( icounter ) ) << "=" << counts.counts[ icounter - 1 ];
+		}
+		std::uint64_t const instructions( counts.counts[ static_cast< core::Size >( EnsembleMetricHardwareCounter::INSTRUCTIONS ) - 1 ] );
+		std::uint64_t const cycles( counts.counts[ static_cast< core::Size >( EnsembleMetricHardwareCounter::CYCLES ) - 1 ] );
+		if ( cycles > 0 ) {
+			ss << "\tinstructions_per_cycle=" << static_cast< core::Real >( instructions ) / static_cast< core::Real >( cycles );
+		}
+		ss << "\tinstructions_per_call=" << static_cast< core::Real >( instructions ) / static_cast< core::Real >( counts.hardware_calls );
+	}
+	return ss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EnsembleMetricPerformanceCounterScope
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Constructor.  Reads the counters at the start of the region.
+EnsembleMetricPerformanceCounterScope::EnsembleMetricPerformanceCounterScope(
+	EnsembleMetricPerformanceCounters * counters,
+	EnsembleMetricProfiledRegion const region
+) :
+	counters_( counters ),
+	region_( region )
+{
+	if ( counters_ == nullptr ) return;
+	start_counts_valid_ = EnsembleMetricPerformanceCounters::read_hardware_counters( start_counts_ );
+	start_time_ = std::chrono::steady_clock::now(); //Last, so that reading the counters is not timed.
+}
+
+/// @brief Destructor.  Reads the counters at the end of the region and adds the differences to the aggregate.
+EnsembleMetricPerformanceCounterScope::~EnsembleMetricPerformanceCounterScope() {
+	if ( counters_ == nullptr ) return;
+	core::Real const wall_time( std::chrono::duration< core::Real >( std::chrono::steady_clock::now() - start_time_ ).count() );
+	std::array< std::uint64_t, n_hardware_counters > end_counts{};
+	bool const valid( start_counts_valid_ && EnsembleMetricPerformanceCounters::read_hardware_counters( end_counts ) );
+	if ( valid ) {
+		for ( core::Size i(0); i<n_hardware_counters; ++i ) {
+			end_counts[i] -= start_counts_[i];
+		}
+	}
+	counters_->accumulate( region_, wall_time, end_counts, valid );
+}
+
+} //ensemble_metrics
+} //protocols
@@ -0,0 +1,230 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricPerformanceCounters.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricPerformanceCounters.hh
+/// @brief Optional hardware performance-counter profiling of the hot paths of an EnsembleMetric
+/// (adding poses, finalizing, and MPI summary communication), using the Linux perf_event interface.
+/// @details Counters (instructions, cycles, cache misses, branch misses) are opened once per thread and
+/// read at the start and end of each profiled region.  The differences are aggregated per region.  On
+/// platforms other than Linux, or if the kernel refuses access to the counters (e.g. because of the
+/// perf_event_paranoid setting), only call counts and wall time are collected.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricPerformanceCounters_hh
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricPerformanceCounters_hh
+
+#include <protocols/ensemble_metrics/EnsembleMetricPerformanceCounters.fwd.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/VirtualBase.hh>
+
+//STL headers
+#include <string>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief The regions of an EnsembleMetric that can be profiled.  If you add to this list, update
+/// EnsembleMetricPerformanceCounters::region_name_from_enum().
+enum class EnsembleMetricProfiledRegion {
+	ADD_POSE_TO_ENSEMBLE = 1, //Keep first.
+	FINALIZE,
+	SEND_MPI_SUMMARY,
+	RECV_MPI_SUMMARY, //Keep second-to-last.
+	N_REGIONS = RECV_MPI_SUMMARY //Keep last.
+};
+
+/// @brief The hardware counters read in each profiled region.  If you add to this list, update
+/// EnsembleMetricPerformanceCounters::counter_name_from_enum() and the list of events opened in the .cc file.
+enum class EnsembleMetricHardwareCounter {
+	INSTRUCTIONS = 1, //Keep first.
+	CYCLES,
+	CACHE_MISSES,
+	BRANCH_MISSES, //Keep second-to-last.
+	N_COUNTERS = BRANCH_MISSES //Keep last.
+};
+
+/// @brief Aggregated counter values for one profiled region.
+struct EnsembleMetricRegionCounts {
+
+	/// @brief The number of times the region was entered.
+	core::Size calls = 0;
+
+	/// @brief The number of times the region was entered with hardware counters available.
+	core::Size hardware_calls = 0;
+
+	/// @brief Total wall time spent in the region, in seconds.
+	core::Real wall_time = 0.0;
+
+	/// @brief Total counts for each hardware counter, indexed by EnsembleMetricHardwareCounter minus one.
+	/// @details Only accumulated over the hardware_calls passes for which counters were available.
+	std::array< std::uint64_t, static_cast< core::Size >( EnsembleMetricHardwareCounter::N_COUNTERS ) > counts{};
+
+};
+
+/// @brief Optional hardware performance-counter profiling of the hot paths of an EnsembleMetric
+/// (adding poses, finalizing, and MPI summary communication), using the Linux perf_event interface.
+/// @details An EnsembleMetric only owns one of these if profiling has been enabled, so when profiling is off,
+/// the only cost is a null pointer check per region.  Use an EnsembleMetricPerformanceCounterScope to profile a region.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricPerformanceCounters : public utility::VirtualBase {
+
+public:
+
+	/// @brief Default constructor.
+	EnsembleMetricPerformanceCounters();
+
+	/// @brief Copy constructor.
+	/// @details Explicit because std::mutex has a deleted copy constructor.
+	EnsembleMetricPerformanceCounters( EnsembleMetricPerformanceCounters const & src );
+
+	/// @brief Destructor.
+	~EnsembleMetricPerformanceCounters() override;
+
+	/// @brief Clone operation: make a copy of this object, and return an owning pointer to the copy.
+	EnsembleMetricPerformanceCountersOP clone() const;
+
+public: // Static functions
+
+	/// @brief Given a region enum, get its name.
+	static std::string region_name_from_enum( EnsembleMetricProfiledRegion const region );
+
+	/// @brief Given a hardware counter enum, get its name.
+	static std::string counter_name_from_enum( EnsembleMetricHardwareCounter const counter );
+
+	/// @brief Are hardware counters available to the calling thread?
+	/// @details Opens the counters for the calling thread if they have not yet been opened.  False on platforms
+	/// other than Linux, and if the kernel refuses access to the counters.
+	static bool hardware_counters_available();
+
+	/// @brief Read the current values of the hardware counters for the calling thread.
+	/// @returns False (leaving counts unaltered) if hardware counters are unavailable.
+	static
+	bool
+	read_hardware_counters(
+		std::array< std::uint64_t, static_cast< core::Size >( EnsembleMetricHardwareCounter::N_COUNTERS ) > & counts
+	);
+
+public: // Accumulation functions
+
+	/// @brief Add one pass through a region to the aggregated counts.
+	/// @details Threadsafe.  The counter deltas are ignored if hardware_counts_valid is false.
+	void
+	accumulate(
+		EnsembleMetricProfiledRegion const region,
+		core::Real const wall_time,
+		std::array< std::uint64_t, static_cast< core::Size >( EnsembleMetricHardwareCounter::N_COUNTERS ) > const & count_deltas,
+		bool const hardware_counts_valid
+	);
+
+	/// @brief Discard all aggregated counts.
+	void reset();
+
+public: // Getters
+
+	/// @brief Get the aggregated counts for a region.
+	EnsembleMetricRegionCounts const & counts_for_region( EnsembleMetricProfiledRegion const region ) const;
+
+	/// @brief Were hardware counters available for every pass through every region?
+	inline bool hardware_counts_complete() const { return hardware_counts_complete_; }
+
+	/// @brief Write the aggregated counts to a string, for appending to an EnsembleMetric's report.
+	/// @note Output is not terminated in a newline.
+	std::string report_string() const;
+
+private: // Private data
+
+	/// @brief The aggregated counts, indexed by EnsembleMetricProfiledRegion minus one.
+	std::array< EnsembleMetricRegionCounts, static_cast< core::Size >( EnsembleMetricProfiledRegion::N_REGIONS ) > region_counts_;
+
+	/// @brief Were hardware counters available for every pass through every region?
+	bool hardware_counts_complete_ = true;
+
+#ifdef MULTI_THREADED
+	/// @brief A mutex protecting the aggregated counts.
+	mutable std::mutex counts_mutex_;
+#endif
+
+};
+
+/// @brief An RAII object that profiles a region of an EnsembleMetric from its construction to its destruction.
+/// @details If constructed with a null pointer, does nothing.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricPerformanceCounterScope {
+
+public:
+
+	/// @brief Constructor.  Reads the counters at the start of the region.
+	EnsembleMetricPerformanceCounterScope(
+		EnsembleMetricPerformanceCounters * counters,
+		EnsembleMetricProfiledRegion const region
+	);
+
+	/// @brief No copying.
+	EnsembleMetricPerformanceCounterScope( EnsembleMetricPerformanceCounterScope const & ) = delete;
+
+	/// @brief No assignment.
+	EnsembleMetricPerformanceCounterScope & operator=( EnsembleMetricPerformanceCounterScope const & ) = delete;
+
+	/// @brief Destructor.  Reads the counters at the end of the region and adds the differences to the aggregate.
+	~EnsembleMetricPerformanceCounterScope();
+
+private:
+
+	/// @brief The aggregator.  Null if profiling is off.
+	EnsembleMetricPerformanceCounters * counters_;
+
+	/// @brief The region being profiled.
+	EnsembleMetricProfiledRegion region_;
+
+	/// @brief Wall time at the start of the region.
+	std::chrono::steady_clock::time_point start_time_;
+
+	/// @brief Counter values at the start of the region.
+	std::array< std::uint64_t, static_cast< core::Size >( EnsembleMetricHardwareCounter::N_COUNTERS ) > start_counts_{};
+
+	/// @brief Could the counters be read at the start of the region?
+	bool start_counts_valid_ = false;
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricPerformanceCounters_hh
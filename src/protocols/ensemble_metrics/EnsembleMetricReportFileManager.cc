@@ -0,0 +1,250 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricReportFileManager.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file protocols/ensemble_metrics/EnsembleMetricReportFileManager.cc
+/// @brief Keeps one open, buffered handle per report file to which EnsembleMetrics in this process append their
+/// reports.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Project headers:
+#include <protocols/ensemble_metrics/EnsembleMetricReportFileManager.hh>
+
+// Basic headers:
+#include <basic/Tracer.hh>
+#include <basic/options/option.hh>
+#include <basic/options/keys/jd2.OptionKeys.gen.hh>
+
+// Utility headers:
+#include <utility/exit.hh>
+#include <utility/pointer/memory.hh>
+
+// STL headers:
+#include <cstdlib>
+#include <tuple>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define ENSEMBLE_METRIC_POSIX_REPORT_FILES
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+static basic::Tracer TR( "protocols.ensemble_metrics.EnsembleMetricReportFileManager" );
+
+/// @brief Write all buffered report records when the process exits.  (The singleton instance is never destroyed, so
+/// its destructor cannot be relied upon for this.)
+static
+void
+flush_ensemble_metric_report_files_at_exit() {
+	protocols::ensemble_metrics::EnsembleMetricReportFileManager::get_instance()->flush_all();
+}
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief Constructor.  Reads the buffer size from the -jd2:ensemble_metric_report_buffer_size option, and
+/// arranges for buffered records to be written when the process exits.
+EnsembleMetricReportFileManager::EnsembleMetricReportFileManager() :
+	utility::SingletonBase< EnsembleMetricReportFileManager >()
+{
+	int const buffer_size( basic::options::option[ basic::options::OptionKeys::jd2::ensemble_metric_report_buffer_size ]() );
+	runtime_assert_string_msg( buffer_size >= 0, "Error in EnsembleMetricReportFileManager constructor: The -jd2:ensemble_metric_report_buffer_size option cannot be negative." );
+	max_buffered_bytes_ = static_cast< core::Size >( buffer_size );
+	std::atexit( &flush_ensemble_metric_report_files_at_exit );
+}
+
+/// @brief Destructor.  Writes all buffered records and closes all files.
+EnsembleMetricReportFileManager::~EnsembleMetricReportFileManager() {
+	for ( std::map< std::string, ReportFile >::iterator it( report_files_.begin() ); it != report_files_.end(); ++it ) {
+		flush_report_file( it->first, it->second );
+		close_report_file( it->second );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Append a record to a file, opening the file if this is the first record written to it by this process.
+/// @details The record is buffered, and the buffer is written to the file if it has reached max_buffered_bytes().
+/// If header_if_new_file is not empty, it is written before the records if the file is empty at that point.
+void
+EnsembleMetricReportFileManager::append_record(
+	std::string const & filename,
+	RecordWriter const & record_writer,
+	std::string const & header_if_new_file
+) {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif
+	std::map< std::string, ReportFile >::iterator it( report_files_.find( filename ) );
+	if ( it == report_files_.end() ) {
+		it = report_files_.emplace( std::piecewise_construct, std::forward_as_tuple( filename ), std::forward_as_tuple() ).first;
+		open_report_file( filename, it->second );
+	}
+	ReportFile & file( it->second );
+	if ( file.header_if_new_file.empty() ) file.header_if_new_file = header_if_new_file;
+	record_writer( file.buffer );
+	if ( static_cast< core::Size >( file.buffer.tellp() ) >= max_buffered_bytes_ ) {
+		flush_report_file( filename, file );
+	}
+}
+
+/// @brief Write all buffered records to their files.
+void
+EnsembleMetricReportFileManager::flush_all() {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif
+	for ( std::map< std::string, ReportFile >::iterator it( report_files_.begin() ); it != report_files_.end(); ++it ) {
+		flush_report_file( it->first, it->second );
+	}
+}
+
+/// @brief Set the number of bytes buffered for a file before they are written to it.
+/// @details Zero means that every record is written immediately.  Larger values mean fewer locks and flushes to
+/// disk, at the cost of losing the buffered records if the process is killed.
+void
+EnsembleMetricReportFileManager::set_max_buffered_bytes(
+	core::Size const setting
+) {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif
+	max_buffered_bytes_ = setting;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Open a file for appending.
+void
+EnsembleMetricReportFileManager::open_report_file(
+	std::string const & filename,
+	ReportFile & file
+) const {
+#ifdef ENSEMBLE_METRIC_POSIX_REPORT_FILES
+	file.file_descriptor = ::open( filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644 );
+	if ( file.file_descriptor < 0 ) {
+		utility_exit_with_message( "Error in EnsembleMetricReportFileManager::open_report_file(): Could not open \"" + filename + "\" for appending: " + std::string( std::strerror( errno ) ) );
+	}
+#else
+	file.stream = utility::pointer::make_shared< std::ofstream >( filename, std::ios::out | std::ios::binary | std::ios::app );
+	runtime_assert_string_msg( file.stream->good(), "Error in EnsembleMetricReportFileManager::open_report_file(): Could not open \"" + filename + "\" for appending." );
+#endif
+	TR.Debug << "Opened \"" << filename << "\" for appending ensemble metric reports." << std::endl;
+}
+
+/// @brief Write the records buffered for a file to it.  Does not lock the mutex.
+/// @details On Linux and macOS, the file is locked while the header (if the file is empty) and the records are written
+/// and flushed to disk.  O_APPEND alone is not enough: on network filesystems such as NFS and Lustre, appends from
+/// different machines are not atomic, and a partial write would leave the rest of the buffer to be written after
+/// another process's records.
+void
+EnsembleMetricReportFileManager::flush_report_file(
+	std::string const & filename,
+	ReportFile & file
+) const {
+	std::string contents( file.buffer.str() );
+	if ( contents.empty() ) return;
+	file.buffer.str( std::string() );
+	file.buffer.clear();
+#ifdef ENSEMBLE_METRIC_POSIX_REPORT_FILES
+	std::string const errmsg( "Error in EnsembleMetricReportFileManager::flush_report_file(): " );
+	struct flock file_lock;
+	std::memset( &file_lock, 0, sizeof( file_lock ) );
+	file_lock.l_type = F_WRLCK;
+	file_lock.l_whence = SEEK_SET; // Zero start and length lock the whole file.
+	bool locked( true );
+	while ( ::fcntl( file.file_descriptor, F_SETLKW, &file_lock ) != 0 ) {
+		if ( errno == EINTR ) continue;
+		// Some filesystems do not support locks.  Records are still appended with O_APPEND.
+		TR.Warning << "Could not lock \"" << filename << "\" (" << std::strerror( errno ) << ").  Records from other processes appending to it may be interleaved." << std::endl;
+		locked = false;
+		break;
+	}
+
+	// Once the file is locked, its size is current, even on a network filesystem.
+	struct stat file_status;
+	if ( !file.header_if_new_file.empty() && ::fstat( file.file_descriptor, &file_status ) == 0 && file_status.st_size == 0 ) {
+		contents = file.header_if_new_file + contents;
+	}
+
+	core::Size n_written(0);
+	while ( n_written < contents.size() ) {
+		ssize_t const result( ::write( file.file_descriptor, contents.data() + n_written, contents.size() - n_written ) );
+		if ( result < 0 ) {
+			if ( errno == EINTR ) continue;
+			utility_exit_with_message( errmsg + "Could not write to \"" + filename + "\": " + std::string( std::strerror( errno ) ) );
+		}
+		n_written += static_cast< core::Size >( result );
+	}
+	if ( ::fsync( file.file_descriptor ) != 0 ) {
+		utility_exit_with_message( errmsg + "Could not flush \"" + filename + "\" to disk: " + std::string( std::strerror( errno ) ) );
+	}
+
+	if ( locked ) {
+		file_lock.l_type = F_UNLCK;
+		::fcntl( file.file_descriptor, F_SETLK, &file_lock );
+	}
+#else
+	if ( !file.header_if_new_file.empty() ) {
+		std::ifstream existing( filename, std::ios::in | std::ios::binary | std::ios::ate );
+		if ( !existing.good() || existing.tellg() == 0 ) contents = file.header_if_new_file + contents;
+	}
+	file.stream->write( contents.data(), static_cast< std::streamsize >( contents.size() ) );
+	file.stream->flush();
+	runtime_assert_string_msg( !file.stream->fail(), "Error in EnsembleMetricReportFileManager::flush_report_file(): Could not write to \"" + filename + "\"." );
+#endif
+}
+
+/// @brief Close a file.
+void
+EnsembleMetricReportFileManager::close_report_file(
+	ReportFile & file
+) const {
+#ifdef ENSEMBLE_METRIC_POSIX_REPORT_FILES
+	if ( file.file_descriptor >= 0 ) {
+		::close( file.file_descriptor );
+		file.file_descriptor = -1;
+	}
+#else
+	if ( file.stream != nullptr ) {
+		file.stream->close();
+		file.stream = nullptr;
+	}
+#endif
+}
+
+} //ensemble_metrics
+} //protocols
@@ -0,0 +1,161 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricReportFileManager.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file protocols/ensemble_metrics/EnsembleMetricReportFileManager.hh
+/// @brief Keeps one open, buffered handle per report file to which EnsembleMetrics in this process append their
+/// reports.
+/// @details Used by EnsembleMetrics with the single_report_file option, so that a run that produces many reports (e.g.
+/// one per job) writes them all to one file per process instead of creating one file per report.  Each report is
+/// written as a complete record.  Records are buffered, and on Linux and macOS each buffer is written under an
+/// exclusive fcntl() lock on the file and flushed to disk before the lock is released, so that records from several processes (or several machines, on
+/// a network filesystem) appending to the same file are never interleaved or lost.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricReportFileManager_hh
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricReportFileManager_hh
+
+#include <protocols/ensemble_metrics/EnsembleMetricReportFileManager.fwd.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/SingletonBase.hh>
+#include <utility/pointer/owning_ptr.hh>
+
+// STL headers
+#include <string>
+#include <map>
+#include <functional>
+#include <fstream>
+#include <sstream>
+
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief Keeps one open, buffered handle per report file to which EnsembleMetrics in this process append their
+/// reports.
+/// @details Records are buffered, and only written when a file's buffer reaches max_buffered_bytes() (set with the
+/// -jd2:ensemble_metric_report_buffer_size option, 1 MiB by default), when flush_all() is called, and when the
+/// process exits normally, so the file is locked and flushed to disk once per buffer rather than once per record.
+/// Records still buffered when a process is killed are lost; setting the buffer size to zero avoids this.  A
+/// header is written before the first record only if the file is empty when the records are written, which is decided
+/// under the file lock, so only one process writes it.  Threadsafe.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricReportFileManager : public utility::SingletonBase< EnsembleMetricReportFileManager > {
+
+public:
+
+	/// @brief Signature of a function that writes one record to a stream.
+	using RecordWriter = std::function< void( std::ostream & ) >;
+
+	/// @brief Constructor.  Reads the buffer size from the -jd2:ensemble_metric_report_buffer_size option, and
+	/// arranges for buffered records to be written when the process exits.
+	EnsembleMetricReportFileManager();
+
+	/// @brief Destructor.  Writes all buffered records and closes all files.
+	~EnsembleMetricReportFileManager() override;
+
+public: // Public functions
+
+	/// @brief Append a record to a file, opening the file if this is the first record written to it by this process.
+	/// @details The record is buffered, and the buffer is written to the file if it has reached max_buffered_bytes().
+	/// If header_if_new_file is not empty, it is written before the records if the file is empty at that point.
+	void
+	append_record(
+		std::string const & filename,
+		RecordWriter const & record_writer,
+		std::string const & header_if_new_file = ""
+	);
+
+	/// @brief Write all buffered records to their files.
+	void flush_all();
+
+	/// @brief The number of bytes buffered for a file before they are written to it.
+	inline core::Size max_buffered_bytes() const { return max_buffered_bytes_; }
+
+	/// @brief Set the number of bytes buffered for a file before they are written to it.
+	/// @details Zero means that every record is written immediately.  Larger values mean fewer locks and flushes to
+	/// disk, at the cost of losing the buffered records if the process is killed.
+	void set_max_buffered_bytes( core::Size const setting );
+
+private: // Private types
+
+	/// @brief An open report file and the records buffered for it.
+	struct ReportFile {
+
+		/// @brief The POSIX file descriptor, on Linux and macOS.  Otherwise unused.
+		int file_descriptor = -1;
+
+		/// @brief The stream, on other platforms.  Otherwise null.
+		utility::pointer::shared_ptr< std::ofstream > stream;
+
+		/// @brief Records not yet written to the file.
+		std::ostringstream buffer;
+
+		/// @brief The header to write before the records if the file is empty when they are written.
+		std::string header_if_new_file;
+
+	};
+
+private: // Private functions
+
+	/// @brief Open a file for appending.
+	void open_report_file( std::string const & filename, ReportFile & file ) const;
+
+	/// @brief Write the records buffered for a file to it.  Does not lock the mutex.
+	void flush_report_file( std::string const & filename, ReportFile & file ) const;
+
+	/// @brief Close a file.
+	void close_report_file( ReportFile & file ) const;
+
+private: // Data
+
+	/// @brief The open report files, by name.
+	std::map< std::string, ReportFile > report_files_;
+
+	/// @brief The number of bytes buffered for a file before they are written to it.
+	core::Size max_buffered_bytes_ = 1048576;
+
+#ifdef MULTI_THREADED
+	/// @brief Protects report_files_ and the files themselves.
+	mutable std::mutex mutex_;
+#endif
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricReportFileManager_hh
@@ -0,0 +1,254 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricReportWriter.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file protocols/ensemble_metrics/EnsembleMetricReportWriter.cc
+/// @brief Writes finished EnsembleMetric report files, optionally in a background thread so that jobs do not wait
+/// for the filesystem.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Project headers:
+#include <protocols/ensemble_metrics/EnsembleMetricReportWriter.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricReportFileManager.hh>
+
+// Basic headers:
+#include <basic/Tracer.hh>
+
+// Utility headers:
+#include <utility/exit.hh>
+#include <utility/io/ozstream.hh>
+
+// STL headers:
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <ostream>
+#include <sstream>
+#include <algorithm>
+
+static basic::Tracer TR( "protocols.ensemble_metrics.EnsembleMetricReportWriter" );
+
+/// @brief Write all queued reports when the process exits.  (The singleton instance is never destroyed, so its
+/// destructor cannot be relied upon for this.)
+static
+void
+drain_ensemble_metric_report_writer_at_exit() {
+	protocols::ensemble_metrics::EnsembleMetricReportWriter::get_instance()->shutdown();
+}
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief Constructor.  Arranges for the queue to be drained when the process exits.
+/// @details Handlers registered with std::atexit() run in the reverse of the order of registration.  The
+/// EnsembleMetricReportFileManager is set up first so that its buffers are flushed after this drains into them.
+EnsembleMetricReportWriter::EnsembleMetricReportWriter() :
+	utility::SingletonBase< EnsembleMetricReportWriter >()
+{
+	EnsembleMetricReportFileManager::get_instance();
+	std::atexit( &drain_ensemble_metric_report_writer_at_exit );
+}
+
+/// @brief Destructor.  Drains the queue and stops the writer thread.
+EnsembleMetricReportWriter::~EnsembleMetricReportWriter() {
+	shutdown();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Hand a finished report to the writer, which takes ownership of it.
+/// @details In multi-threaded builds, this returns as soon as the payload is in the queue (starting the writer thread
+/// if it is not yet running), waiting only if the queue is full.  In other builds, the payload is written before this
+/// returns.
+void
+EnsembleMetricReportWriter::submit(
+	EnsembleMetricReportPayload && payload
+) {
+#ifdef MULTI_THREADED
+	std::unique_lock< std::mutex > lock( mutex_ );
+	if ( !writer_thread_.joinable() ) {
+		writer_thread_ = std::thread( &EnsembleMetricReportWriter::writer_loop, this );
+	}
+	if ( queue_.size() >= max_queued_reports_ ) {
+		std::chrono::steady_clock::time_point const wait_start( std::chrono::steady_clock::now() );
+		queue_not_full_or_idle_.wait( lock, [this]{ return queue_.size() < max_queued_reports_; } );
+		statistics_.total_submit_wait_time += std::chrono::duration< double >( std::chrono::steady_clock::now() - wait_start ).count();
+	}
+	queue_.push_back( std::move( payload ) );
+	statistics_.max_queue_depth = std::max( statistics_.max_queue_depth, static_cast< core::Size >( queue_.size() ) );
+	lock.unlock();
+	queue_not_empty_.notify_one();
+#else
+	write_payload( payload );
+#endif
+}
+
+/// @brief Wait until every submitted report has been written.
+void
+EnsembleMetricReportWriter::drain() {
+#ifdef MULTI_THREADED
+	std::unique_lock< std::mutex > lock( mutex_ );
+	queue_not_full_or_idle_.wait( lock, [this]{ return queue_.empty() && !writing_; } );
+#endif
+}
+
+/// @brief Drain the queue, stop the writer thread, and write a summary of the statistics to the tracer.
+/// @details Reports submitted later restart the writer thread.
+void
+EnsembleMetricReportWriter::shutdown() {
+#ifdef MULTI_THREADED
+	{
+		std::lock_guard< std::mutex > lock( mutex_ );
+		if ( !writer_thread_.joinable() ) return;
+		stop_requested_ = true;
+	}
+	queue_not_empty_.notify_all();
+	writer_thread_.join(); //The writer thread empties the queue before it stops.
+	{
+		std::lock_guard< std::mutex > lock( mutex_ );
+		stop_requested_ = false;
+	}
+#endif
+	EnsembleMetricReportWriterStatistics const stats( statistics() );
+	if ( stats.reports_written + stats.reports_failed > 0 ) {
+		TR << statistics_string() << std::endl;
+	}
+}
+
+/// @brief Get the statistics on the report files written so far.
+EnsembleMetricReportWriterStatistics
+EnsembleMetricReportWriter::statistics() const {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif
+	return statistics_;
+}
+
+/// @brief Get the statistics on the report files written so far, as a human-readable string.
+/// @note Output is not terminated in a newline.
+std::string
+EnsembleMetricReportWriter::statistics_string() const {
+	EnsembleMetricReportWriterStatistics const stats( statistics() );
+	std::ostringstream ss;
+	ss << "Ensemble metric report file writing:"
+		<< "\n\treports_written:\t" << stats.reports_written
+		<< "\n\treports_failed:\t" << stats.reports_failed
+		<< "\n\ttotal_write_time:\t" << stats.total_write_time << "s"
+		<< "\n\tmean_write_time:\t" << ( stats.reports_written > 0 ? stats.total_write_time / static_cast< core::Real >( stats.reports_written ) : 0.0 ) << "s"
+		<< "\n\tmax_write_time:\t" << stats.max_write_time << "s"
+		<< "\n\ttotal_submit_wait_time:\t" << stats.total_submit_wait_time << "s"
+		<< "\n\tmax_queue_depth:\t" << stats.max_queue_depth;
+	return ss.str();
+}
+
+/// @brief Set the largest number of reports that may wait in the queue.  Must be at least 1.
+void
+EnsembleMetricReportWriter::set_max_queued_reports(
+	core::Size const setting
+) {
+	runtime_assert_string_msg( setting > 0, "Error in EnsembleMetricReportWriter::set_max_queued_reports(): At least one report must be allowed to wait in the queue." );
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif
+	max_queued_reports_ = setting;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Write one payload, recording the time taken.
+/// @details Failures are counted and logged rather than thrown, since the writer thread has no caller to throw to.
+void
+EnsembleMetricReportWriter::write_payload(
+	EnsembleMetricReportPayload const & payload
+) {
+	std::chrono::steady_clock::time_point const start_time( std::chrono::steady_clock::now() );
+	bool success( true );
+	try {
+		if ( payload.append ) {
+			EnsembleMetricReportFileManager::get_instance()->append_record( payload.filename,
+				[&payload]( std::ostream & out ) {
+					out << payload.contents;
+				},
+				payload.header_if_new_file
+			);
+		} else {
+			utility::io::ozstream outfile( payload.filename, std::ios_base::out | std::ios_base::binary );
+			outfile << payload.contents;
+			outfile.close();
+		}
+	} catch ( std::exception const & err ) {
+		success = false;
+		TR.Error << "Could not write ensemble metric report to \"" << payload.filename << "\": " << err.what() << std::endl;
+	}
+	core::Real const write_time( std::chrono::duration< double >( std::chrono::steady_clock::now() - start_time ).count() );
+
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif
+	if ( success ) {
+		++statistics_.reports_written;
+	} else {
+		++statistics_.reports_failed;
+	}
+	statistics_.total_write_time += write_time;
+	statistics_.max_write_time = std::max( statistics_.max_write_time, write_time );
+}
+
+#ifdef MULTI_THREADED
+/// @brief The function run by the writer thread.
+/// @details Takes payloads from the queue in order until asked to stop, and stops only once the queue is empty.
+void
+EnsembleMetricReportWriter::writer_loop() {
+	while ( true ) {
+		EnsembleMetricReportPayload payload;
+		{
+			std::unique_lock< std::mutex > lock( mutex_ );
+			queue_not_empty_.wait( lock, [this]{ return !queue_.empty() || stop_requested_; } );
+			if ( queue_.empty() ) break; //Only reached if asked to stop.
+			payload = std::move( queue_.front() );
+			queue_.pop_front();
+			writing_ = true;
+		}
+		queue_not_full_or_idle_.notify_all();
+		write_payload( payload );
+		{
+			std::lock_guard< std::mutex > lock( mutex_ );
+			writing_ = false;
+		}
+		queue_not_full_or_idle_.notify_all();
+	}
+}
+#endif
+
+} //ensemble_metrics
+} //protocols
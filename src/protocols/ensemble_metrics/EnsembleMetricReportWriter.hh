@@ -0,0 +1,196 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricReportWriter.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file protocols/ensemble_metrics/EnsembleMetricReportWriter.hh
+/// @brief Writes finished EnsembleMetric report files, optionally in a background thread so that jobs do not wait
+/// for the filesystem.
+/// @details An EnsembleMetric with the write_reports_in_background option renders its report into a payload and
+/// submits it here, instead of writing the file itself.  In multi-threaded builds, a writer thread takes payloads from
+/// a bounded queue and writes them while the next job proceeds; a job only waits if the queue is full.  In other builds,
+/// payloads are written immediately by the submitting thread.  Either way, the time spent writing and waiting is
+/// recorded, so that filesystem latency can be reported.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricReportWriter_hh
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricReportWriter_hh
+
+#include <protocols/ensemble_metrics/EnsembleMetricReportWriter.fwd.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/SingletonBase.hh>
+
+// STL headers
+#include <string>
+#include <deque>
+
+#ifdef MULTI_THREADED
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#endif
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief A finished report, ready to be written.
+struct EnsembleMetricReportPayload {
+
+	/// @brief The file to write.
+	std::string filename;
+
+	/// @brief The report.
+	std::string contents;
+
+	/// @brief If true, the report is appended to the file through the EnsembleMetricReportFileManager.  If false, the
+	/// file is overwritten.
+	bool append = false;
+
+	/// @brief If appending, text written before the report if the file is new (e.g. a CSV header line).
+	std::string header_if_new_file;
+
+};
+
+/// @brief Statistics on the report files written, for measuring filesystem latency.
+/// @details All times are in seconds.
+struct EnsembleMetricReportWriterStatistics {
+
+	/// @brief The number of reports written.
+	core::Size reports_written = 0;
+
+	/// @brief The number of reports that could not be written.
+	core::Size reports_failed = 0;
+
+	/// @brief Total time spent writing reports (opening, writing, and closing files).
+	core::Real total_write_time = 0.0;
+
+	/// @brief The longest time spent writing one report.
+	core::Real max_write_time = 0.0;
+
+	/// @brief Total time that submitting threads spent waiting for space in a full queue.
+	core::Real total_submit_wait_time = 0.0;
+
+	/// @brief The largest number of reports waiting in the queue at once.
+	core::Size max_queue_depth = 0;
+
+};
+
+/// @brief Writes finished EnsembleMetric report files, optionally in a background thread so that jobs do not wait
+/// for the filesystem.
+/// @details Payloads are written in the order submitted.  The queue is drained when the process exits normally, or when
+/// drain() is called.  Threadsafe.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricReportWriter : public utility::SingletonBase< EnsembleMetricReportWriter > {
+
+public:
+
+	/// @brief Constructor.  Arranges for the queue to be drained when the process exits.
+	EnsembleMetricReportWriter();
+
+	/// @brief Destructor.  Drains the queue and stops the writer thread.
+	~EnsembleMetricReportWriter() override;
+
+public: // Public functions
+
+	/// @brief Hand a finished report to the writer, which takes ownership of it.
+	/// @details In multi-threaded builds, this returns as soon as the payload is in the queue (starting the writer thread
+	/// if it is not yet running), waiting only if the queue is full.  In other builds, the payload is written before this
+	/// returns.
+	void submit( EnsembleMetricReportPayload && payload );
+
+	/// @brief Wait until every submitted report has been written.
+	void drain();
+
+	/// @brief Drain the queue, stop the writer thread, and write a summary of the statistics to the tracer.
+	/// @details Reports submitted later restart the writer thread.
+	void shutdown();
+
+	/// @brief Get the statistics on the report files written so far.
+	EnsembleMetricReportWriterStatistics statistics() const;
+
+	/// @brief Get the statistics on the report files written so far, as a human-readable string.
+	/// @note Output is not terminated in a newline.
+	std::string statistics_string() const;
+
+	/// @brief The largest number of reports that may wait in the queue.
+	inline core::Size max_queued_reports() const { return max_queued_reports_; }
+
+	/// @brief Set the largest number of reports that may wait in the queue.  Must be at least 1.
+	void set_max_queued_reports( core::Size const setting );
+
+private: // Private functions
+
+	/// @brief Write one payload, recording the time taken.
+	void write_payload( EnsembleMetricReportPayload const & payload );
+
+#ifdef MULTI_THREADED
+	/// @brief The function run by the writer thread.
+	void writer_loop();
+#endif
+
+private: // Data
+
+	/// @brief The largest number of reports that may wait in the queue.
+	core::Size max_queued_reports_ = 64;
+
+	/// @brief Statistics on the report files written so far.
+	EnsembleMetricReportWriterStatistics statistics_;
+
+#ifdef MULTI_THREADED
+	/// @brief Reports waiting to be written.
+	std::deque< EnsembleMetricReportPayload > queue_;
+
+	/// @brief Is the writer thread writing a report that it has taken from the queue?
+	bool writing_ = false;
+
+	/// @brief Has the writer thread been asked to stop?
+	bool stop_requested_ = false;
+
+	/// @brief The writer thread.  Not joinable if not running.
+	std::thread writer_thread_;
+
+	/// @brief Protects the queue, the flags, and the statistics.
+	mutable std::mutex mutex_;
+
+	/// @brief Signalled when a report is added to the queue, or when the writer thread is asked to stop.
+	std::condition_variable queue_not_empty_;
+
+	/// @brief Signalled when a report is taken from the queue, or when the writer becomes idle.
+	std::condition_variable queue_not_full_or_idle_;
+#endif
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricReportWriter_hh
@@ -0,0 +1,135 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricSampleSpan.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricSampleSpan.hh
+/// @brief A read-only, non-owning view of the raw per-pose samples accumulated by an EnsembleMetric, with the shape
+/// metadata needed to hand them to numeric code without copying.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricSampleSpan_HH
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricSampleSpan_HH
+
+// Unit headers
+#include <protocols/ensemble_metrics/EnsembleMetricSampleSpan.fwd.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/exit.hh>
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief A read-only, non-owning view of the raw per-pose samples accumulated by an EnsembleMetric, with the shape
+/// metadata needed to hand them to numeric code without copying.
+/// @details The samples form a contiguous, row-major (C-order) two-dimensional array of core::Real, with one row per
+/// pose and n_values_per_sample() columns.  For NumPy, for instance, the shape is ( n_samples(), n_values_per_sample() )
+/// and the strides are ( row_stride_bytes(), sizeof( core::Real ) ).  The span points into the EnsembleMetric's own
+/// storage: it is invalidated by anything that adds data to, merges data into, or resets the EnsembleMetric.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricSampleSpan {
+
+public:
+
+	/// @brief Default constructor: an empty span.
+	EnsembleMetricSampleSpan() = default;
+
+	/// @brief Constructor.
+	/// @param[in] data The first value of the first sample.  May be null only if n_samples is zero.
+	/// @param[in] n_samples The number of samples (poses).
+	/// @param[in] n_values_per_sample The number of values per sample.  Must be nonzero.
+	EnsembleMetricSampleSpan(
+		core::Real const * data,
+		core::Size const n_samples,
+		core::Size const n_values_per_sample
+	) :
+		data_( data ),
+		n_samples_( n_samples ),
+		n_values_per_sample_( n_values_per_sample )
+	{
+		runtime_assert_string_msg( n_values_per_sample_ > 0, "Error in EnsembleMetricSampleSpan constructor: The number of values per sample must be nonzero." );
+		runtime_assert_string_msg( data_ != nullptr || n_samples_ == 0, "Error in EnsembleMetricSampleSpan constructor: A null pointer was passed for a nonempty span." );
+	}
+
+	/// @brief The first value of the first sample.
+	inline core::Real const * data() const { return data_; }
+
+	/// @brief The number of samples (poses).
+	inline core::Size n_samples() const { return n_samples_; }
+
+	/// @brief The number of values per sample.
+	inline core::Size n_values_per_sample() const { return n_values_per_sample_; }
+
+	/// @brief The total number of values.
+	inline core::Size size() const { return n_samples_ * n_values_per_sample_; }
+
+	/// @brief The total size of the values, in bytes.
+	inline core::Size size_bytes() const { return size() * sizeof( core::Real ); }
+
+	/// @brief The distance, in bytes, from one sample to the next.
+	inline core::Size row_stride_bytes() const { return n_values_per_sample_ * sizeof( core::Real ); }
+
+	/// @brief Is the span empty?
+	inline bool empty() const { return n_samples_ == 0; }
+
+	/// @brief Access a value by (one-based) sample index and (one-based) value index.
+	/// @details Bounds are not checked.
+	inline
+	core::Real
+	operator()(
+		core::Size const sample,
+		core::Size const value
+	) const {
+		return data_[ ( sample - 1 ) * n_values_per_sample_ + ( value - 1 ) ];
+	}
+
+	/// @brief The start of the values, for iteration over all values.
+	inline core::Real const * begin() const { return data_; }
+
+	/// @brief The end of the values, for iteration over all values.
+	inline core::Real const * end() const { return data_ + size(); }
+
+private:
+
+	/// @brief The first value of the first sample.
+	core::Real const * data_ = nullptr;
+
+	/// @brief The number of samples.
+	core::Size n_samples_ = 0;
+
+	/// @brief The number of values per sample.
+	core::Size n_values_per_sample_ = 1;
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricSampleSpan_HH
@@ -0,0 +1,464 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricSharedMemoryAggregator.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricSharedMemoryAggregator.cc
+/// @brief Merges the data accumulated by EnsembleMetrics in several processes on one machine through a named POSIX
+/// shared-memory segment, without MPI.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Project headers:
+#include <protocols/ensemble_metrics/EnsembleMetricSharedMemoryAggregator.hh>
+#include <protocols/ensemble_metrics/EnsembleMetric.hh>
+
+// Basic headers:
+#include <basic/Tracer.hh>
+
+// Utility headers:
+#include <utility/exit.hh>
+
+// STL headers:
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <new>
+#include <thread>
+
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#define ENSEMBLE_METRIC_POSIX_SHARED_MEMORY
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+static basic::Tracer TR( "protocols.ensemble_metrics.EnsembleMetricSharedMemoryAggregator" );
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief The header at the start of the shared-memory segment.
+/// @details The data region follows at segment_data_offset.  It holds records, each consisting of a std::uint64_t
+/// summary length followed by the summary, padded to a multiple of eight bytes.  A length of zero marks the end.
+struct EnsembleMetricSharedMemorySegmentHeader {
+	/// @brief Set to segment_magic (with release ordering) once the creator has initialized the segment.
+	std::atomic< std::uint64_t > magic;
+	/// @brief The number of processes attached, or closed_segment once the last one has detached.
+	std::atomic< std::uint64_t > n_attached;
+	/// @brief The number of bytes of the data region reserved so far.  May exceed data_bytes if summaries did not fit.
+	std::atomic< std::uint64_t > bytes_reserved;
+	/// @brief The size of the data region, in bytes.
+	std::uint64_t data_bytes;
+};
+
+static_assert( std::atomic< std::uint64_t >::is_always_lock_free, "Shared-memory aggregation of EnsembleMetrics requires lock-free 64-bit atomics." );
+
+/// @brief Identifies an initialized segment ("EMSHMEM1").
+static std::uint64_t const segment_magic( 0x454D53484D454D31ULL );
+
+/// @brief The value of n_attached once the last process has detached.  Later processes may not attach.
+static std::uint64_t const closed_segment( ~static_cast< std::uint64_t >( 0 ) );
+
+/// @brief The offset of the data region from the start of the segment.
+static core::Size const segment_data_offset( 64 );
+static_assert( sizeof( EnsembleMetricSharedMemorySegmentHeader ) <= 64, "The shared-memory segment header must fit before the data region." );
+
+/// @brief How many times to wait for another process before giving up.
+static core::Size const max_waits( 10000 );
+
+/// @brief Round a size up to a multiple of eight bytes.
+static
+core::Size
+padded_size(
+	core::Size const n_bytes
+) {
+	return ( n_bytes + 7 ) & ~static_cast< core::Size >( 7 );
+}
+
+/// @brief Wait for another process (for about a millisecond).
+static
+void
+wait_briefly() {
+	std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+}
+
+/// @brief The aggregators in this process, by segment name.  Expired entries are replaced as needed.
+static std::map< std::string, utility::pointer::weak_ptr< EnsembleMetricSharedMemoryAggregator > > process_aggregators;
+
+#ifdef MULTI_THREADED
+/// @brief Protects process_aggregators.
+static std::mutex process_aggregators_mutex;
+#endif
+
+/// @brief Access the header of a mapped segment.
+static
+EnsembleMetricSharedMemorySegmentHeader &
+segment_header(
+	void * mapping
+) {
+	return *static_cast< EnsembleMetricSharedMemorySegmentHeader * >( mapping );
+}
+
+/// @brief Constructor.  Attaches to the named segment, creating it if it does not exist.
+/// @param[in] segment_name The name of the shared-memory segment.  A leading slash is added if absent.
+/// @param[in] capacity_bytes The number of bytes available for summaries, if this process creates the segment.
+/// Ignored if the segment already exists.
+EnsembleMetricSharedMemoryAggregator::EnsembleMetricSharedMemoryAggregator(
+	std::string const & segment_name,
+	core::Size const capacity_bytes
+) :
+	utility::VirtualBase(),
+	segment_name_( ( !segment_name.empty() && segment_name[0] == '/' ) ? segment_name : "/" + segment_name )
+{
+	runtime_assert_string_msg( segment_name_.size() > 1 && segment_name_.find( '/', 1 ) == std::string::npos, "Error in EnsembleMetricSharedMemoryAggregator constructor: The segment name \"" + segment_name + "\" is invalid.  It must be nonempty, and may not contain slashes (other than a leading slash)." );
+	runtime_assert_string_msg( capacity_bytes >= 1024, "Error in EnsembleMetricSharedMemoryAggregator constructor: The capacity of the shared-memory segment must be at least 1024 bytes." );
+	attach( capacity_bytes );
+}
+
+/// @brief Destructor.  Detaches without contributing data, if contribute_and_detach() was never called, and unmaps
+/// the segment.
+EnsembleMetricSharedMemoryAggregator::~EnsembleMetricSharedMemoryAggregator() {
+	if ( attached_ ) {
+		if ( release_attachment() ) {
+			TR.Warning << "The last process attached to shared-memory segment " << segment_name_ << " detached without "
+				"contributing data.  Any summaries appended by other processes have been discarded." << std::endl;
+		}
+	}
+#ifdef ENSEMBLE_METRIC_POSIX_SHARED_MEMORY
+	if ( mapping_ != nullptr ) {
+		munmap( mapping_, mapping_bytes_ );
+	}
+#endif
+}
+
+/// @brief Get the aggregator for the named segment in this process, creating (and attaching) it if this process
+/// has none that is still attached.
+/// @details Threadsafe.  Copies of an EnsembleMetric share the aggregator, so that the process attaches once.
+EnsembleMetricSharedMemoryAggregatorOP
+EnsembleMetricSharedMemoryAggregator::get_aggregator(
+	std::string const & segment_name,
+	core::Size const capacity_bytes
+) {
+	std::string const key( ( !segment_name.empty() && segment_name[0] == '/' ) ? segment_name : "/" + segment_name );
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( process_aggregators_mutex );
+#endif
+	EnsembleMetricSharedMemoryAggregatorOP aggregator( process_aggregators[ key ].lock() );
+	if ( aggregator != nullptr ) {
+#ifdef MULTI_THREADED
+		std::lock_guard< std::mutex > aggregator_lock( aggregator->local_mutex_ );
+#endif
+		if ( aggregator->attached_ ) return aggregator;
+	}
+	aggregator = utility::pointer::make_shared< EnsembleMetricSharedMemoryAggregator >( segment_name, capacity_bytes );
+	process_aggregators[ key ] = aggregator;
+	return aggregator;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC LOCAL COPY TRACKING FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Note that a copy of the EnsembleMetric in this process will contribute its data through this aggregator.
+/// @details Threadsafe.  Each registered copy must later call either contribute_and_detach() or
+/// unregister_local_copy().
+void
+EnsembleMetricSharedMemoryAggregator::register_local_copy() {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( local_mutex_ );
+#endif
+	++n_local_copies_;
+}
+
+/// @brief Note that a registered copy of the EnsembleMetric will not contribute its data (e.g. because it was
+/// destroyed without producing a report).
+/// @details Threadsafe.  If this was the last registered copy, the data of the copies that contributed are appended
+/// to the segment and this process detaches.
+void
+EnsembleMetricSharedMemoryAggregator::unregister_local_copy() {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( local_mutex_ );
+#endif
+	runtime_assert( n_local_copies_ > 0 ); //Should be true.
+	--n_local_copies_;
+	if ( n_local_copies_ == 0 && attached_ && !local_summaries_.empty() ) {
+		append_local_summaries_and_detach();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC AGGREGATION FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Append the packed summary of an EnsembleMetric's data to the segment, and detach.  If this process was
+/// the last one attached, instead merge the summaries appended by all other processes into the EnsembleMetric, and
+/// remove the segment.
+/// @details The EnsembleMetric must support summary merging.  If the summary does not fit in the remaining space in
+/// the segment, it is not appended, and a warning is printed.
+/// @returns True if this process should produce a report: either it was the last to detach (in which case the
+/// EnsembleMetric now holds the consolidated data), or its summary did not fit.  False if another process will
+/// report this process's data.
+bool
+EnsembleMetricSharedMemoryAggregator::contribute_and_detach(
+	EnsembleMetric & metric
+) {
+	std::string const errmsg( "Error in EnsembleMetricSharedMemoryAggregator::contribute_and_detach(): " );
+	runtime_assert_string_msg( metric.supports_summary_merging(), errmsg + "The " + metric.name() + " ensemble metric does not support summary merging." );
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( local_mutex_ );
+#endif
+	runtime_assert_string_msg( n_local_copies_ > 0, errmsg + "The " + metric.name() + " ensemble metric is not registered with shared-memory segment " + segment_name_ + "." );
+	--n_local_copies_;
+	if ( !attached_ ) return true;
+
+	// Copies in this process are merged here, so that the process contributes once.
+	if ( n_local_copies_ > 0 ) {
+		if ( metric.poses_in_ensemble() > 0 ) local_summaries_.push_back( metric.pack_summary() );
+		return false;
+	}
+	for ( std::string const & local_summary : local_summaries_ ) {
+		metric.merge_summary( local_summary );
+		++n_local_copies_merged_;
+	}
+	local_summaries_.clear();
+
+	// Our summary must be in the segment before we detach, since we can't know until then whether we are last.  If
+	// we turn out to be last, it is simply skipped.
+	core::Size const data_bytes( segment_header( mapping_ ).data_bytes );
+	core::Size const own_offset( append_summary( metric.pack_summary() ) );
+	bool const fit( own_offset < data_bytes );
+	if ( !fit ) {
+		TR.Warning << "The summary of the " << metric.name() << " ensemble metric did not fit in shared-memory segment "
+			<< segment_name_ << ".  This process will report its own data separately." << std::endl;
+	}
+
+	if ( release_attachment() ) {
+		merge_appended_summaries( metric, own_offset );
+		TR << "Merged the " << metric.name() << " ensemble metric summaries of " << n_summaries_merged_ << " other processes "
+			"from shared-memory segment " << segment_name_ << "." << std::endl;
+		return true;
+	}
+	return !fit;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Open or create the segment, map it, and register this process as attached.
+void
+EnsembleMetricSharedMemoryAggregator::attach(
+#ifdef ENSEMBLE_METRIC_POSIX_SHARED_MEMORY
+	core::Size const capacity_bytes
+#else
+	core::Size const
+#endif
+) {
+#ifdef ENSEMBLE_METRIC_POSIX_SHARED_MEMORY
+	std::string const errmsg( "Error in EnsembleMetricSharedMemoryAggregator::attach(): " );
+	for ( core::Size attempt(1); ; ++attempt ) {
+		runtime_assert_string_msg( attempt <= max_waits, errmsg + "Timed out attaching to shared-memory segment " + segment_name_ + "." );
+
+		// Try to create the segment.  If another process got there first, open theirs.
+		int fd( shm_open( segment_name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600 ) );
+		bool const created( fd >= 0 );
+		if ( !created ) {
+			if ( errno != EEXIST ) utility_exit_with_message( errmsg + "Could not create shared-memory segment " + segment_name_ + ": " + std::strerror( errno ) );
+			fd = shm_open( segment_name_.c_str(), O_RDWR, 0600 );
+			if ( fd < 0 ) {
+				// The segment may have been removed by its last process since we tried to create it.
+				if ( errno != ENOENT ) utility_exit_with_message( errmsg + "Could not open shared-memory segment " + segment_name_ + ": " + std::strerror( errno ) );
+				wait_briefly();
+				continue;
+			}
+		}
+
+		// Size the segment (if we created it), or wait for its creator to do so.
+		core::Size total_bytes( segment_data_offset + padded_size( capacity_bytes ) );
+		if ( created ) {
+			if ( ftruncate( fd, static_cast< off_t >( total_bytes ) ) != 0 ) {
+				int const error( errno );
+				close( fd );
+				shm_unlink( segment_name_.c_str() );
+				utility_exit_with_message( errmsg + "Could not size shared-memory segment " + segment_name_ + ": " + std::strerror( error ) );
+			}
+		} else {
+			struct stat segment_stat;
+			core::Size n_waits(0);
+			while ( fstat( fd, &segment_stat ) == 0 && static_cast< core::Size >( segment_stat.st_size ) <= segment_data_offset ) {
+				runtime_assert_string_msg( ++n_waits <= max_waits, errmsg + "Timed out waiting for shared-memory segment " + segment_name_ + " to be initialized." );
+				wait_briefly();
+			}
+			total_bytes = static_cast< core::Size >( segment_stat.st_size );
+		}
+
+		void * const mapping( mmap( nullptr, total_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) );
+		close( fd );
+		if ( mapping == MAP_FAILED ) {
+			if ( created ) shm_unlink( segment_name_.c_str() );
+			utility_exit_with_message( errmsg + "Could not map shared-memory segment " + segment_name_ + ": " + std::strerror( errno ) );
+		}
+
+		if ( created ) {
+			// The new segment is zero-filled.  Initialize the header, registering ourselves, and publish it.
+			EnsembleMetricSharedMemorySegmentHeader * const header( new( mapping ) EnsembleMetricSharedMemorySegmentHeader );
+			header->data_bytes = total_bytes - segment_data_offset;
+			header->bytes_reserved.store( 0, std::memory_order_relaxed );
+			header->n_attached.store( 1, std::memory_order_relaxed );
+			header->magic.store( segment_magic, std::memory_order_release );
+			mapping_ = mapping;
+			mapping_bytes_ = total_bytes;
+			attached_ = true;
+			TR.Debug << "Created shared-memory segment " << segment_name_ << "." << std::endl;
+			return;
+		}
+
+		// Wait for the creator to publish the header, then register ourselves unless the segment is closing.
+		EnsembleMetricSharedMemorySegmentHeader & header( segment_header( mapping ) );
+		core::Size n_waits(0);
+		while ( header.magic.load( std::memory_order_acquire ) != segment_magic ) {
+			runtime_assert_string_msg( ++n_waits <= max_waits, errmsg + "Timed out waiting for shared-memory segment " + segment_name_ + " to be initialized." );
+			wait_briefly();
+		}
+		runtime_assert_string_msg( header.data_bytes + segment_data_offset <= total_bytes, errmsg + "Shared-memory segment " + segment_name_ + " is smaller than its header says." );
+		std::uint64_t n_attached( header.n_attached.load( std::memory_order_acquire ) );
+		while ( n_attached != closed_segment ) {
+			if ( header.n_attached.compare_exchange_weak( n_attached, n_attached + 1, std::memory_order_acq_rel, std::memory_order_acquire ) ) {
+				mapping_ = mapping;
+				mapping_bytes_ = total_bytes;
+				attached_ = true;
+				TR.Debug << "Attached to shared-memory segment " << segment_name_ << "." << std::endl;
+				return;
+			}
+		}
+
+		// The last process is closing this segment, and will remove its name.  Try again with a fresh segment.
+		munmap( mapping, total_bytes );
+		wait_briefly();
+	}
+#else
+	utility_exit_with_message( "Error in EnsembleMetricSharedMemoryAggregator::attach(): Shared-memory aggregation of ensemble metrics is only available on Linux and macOS." );
+#endif
+}
+
+/// @brief Unregister this process.
+/// @returns True if this process was the last one attached (in which case the segment has been closed to new
+/// processes and its name has been removed).
+bool
+EnsembleMetricSharedMemoryAggregator::release_attachment() {
+	runtime_assert( attached_ ); //Should be true.
+	EnsembleMetricSharedMemorySegmentHeader & header( segment_header( mapping_ ) );
+	// Release ordering publishes anything we appended; the last process's acquire then sees everyone's appends.
+	std::uint64_t n_attached( header.n_attached.load( std::memory_order_acquire ) );
+	do {
+		runtime_assert_string_msg( n_attached != closed_segment && n_attached > 0, "Error in EnsembleMetricSharedMemoryAggregator::release_attachment(): Shared-memory segment " + segment_name_ + " has been corrupted." );
+	} while ( !header.n_attached.compare_exchange_weak( n_attached, ( n_attached == 1 ? closed_segment : n_attached - 1 ), std::memory_order_acq_rel, std::memory_order_acquire ) );
+	attached_ = false;
+	if ( n_attached != 1 ) return false;
+
+	// We were last.  Remove the name now so that new processes can start a fresh segment; our mapping stays valid.
+#ifdef ENSEMBLE_METRIC_POSIX_SHARED_MEMORY
+	shm_unlink( segment_name_.c_str() );
+#endif
+	return true;
+}
+
+/// @brief Reserve space in the segment and copy a summary into it.
+/// @returns The offset of the record in the data region, or the data region size if it did not fit.
+core::Size
+EnsembleMetricSharedMemoryAggregator::append_summary(
+	std::string const & summary
+) {
+	runtime_assert( !summary.empty() ); //Should be true: summaries always have a header.
+	EnsembleMetricSharedMemorySegmentHeader & header( segment_header( mapping_ ) );
+	core::Size const data_bytes( header.data_bytes );
+	core::Size const record_bytes( sizeof( std::uint64_t ) + padded_size( summary.size() ) );
+	core::Size const offset( header.bytes_reserved.fetch_add( record_bytes, std::memory_order_relaxed ) );
+	if ( offset + record_bytes > data_bytes ) return data_bytes;
+
+	char * const record( static_cast< char * >( mapping_ ) + segment_data_offset + offset );
+	std::uint64_t const summary_length( summary.size() );
+	std::memcpy( record, &summary_length, sizeof( std::uint64_t ) );
+	std::memcpy( record + sizeof( std::uint64_t ), summary.data(), summary.size() );
+	return offset;
+}
+
+/// @brief Append the summaries held for copies in this process to the segment without merging them, and detach.
+/// @details Used if the last registered copy leaves without contributing.  Must be called with local_mutex_ held.
+void
+EnsembleMetricSharedMemoryAggregator::append_local_summaries_and_detach() {
+	core::Size const data_bytes( segment_header( mapping_ ).data_bytes );
+	core::Size n_lost(0);
+	for ( std::string const & local_summary : local_summaries_ ) {
+		if ( append_summary( local_summary ) >= data_bytes ) ++n_lost;
+	}
+	core::Size const n_held( local_summaries_.size() );
+	local_summaries_.clear();
+	if ( release_attachment() ) n_lost = n_held;
+	if ( n_lost > 0 ) {
+		TR.Warning << "The data of " << n_lost << " copies of an ensemble metric in this process could not be handed to "
+			"shared-memory segment " << segment_name_ << ", and have been discarded." << std::endl;
+	}
+}
+
+/// @brief Merge every summary in the segment except the one at skip_offset into an EnsembleMetric.
+void
+EnsembleMetricSharedMemoryAggregator::merge_appended_summaries(
+	EnsembleMetric & metric,
+	core::Size const skip_offset
+) {
+	EnsembleMetricSharedMemorySegmentHeader & header( segment_header( mapping_ ) );
+	core::Size const end( std::min< core::Size >( header.bytes_reserved.load( std::memory_order_acquire ), header.data_bytes ) );
+	char const * const data( static_cast< char const * >( mapping_ ) + segment_data_offset );
+
+	// Records were reserved in order, so the first one that did not fit (whose space is still zero-filled) ends the data.
+	core::Size offset(0);
+	while ( offset + sizeof( std::uint64_t ) <= end ) {
+		std::uint64_t summary_length(0);
+		std::memcpy( &summary_length, data + offset, sizeof( std::uint64_t ) );
+		if ( summary_length == 0 ) break;
+		core::Size const record_bytes( sizeof( std::uint64_t ) + padded_size( static_cast< core::Size >( summary_length ) ) );
+		if ( offset + record_bytes > end ) break;
+		if ( offset != skip_offset ) {
+			metric.merge_summary( data + offset + sizeof( std::uint64_t ), static_cast< core::Size >( summary_length ) );
+			++n_summaries_merged_;
+		}
+		offset += record_bytes;
+	}
+}
+
+} //ensemble_metrics
+} //protocols
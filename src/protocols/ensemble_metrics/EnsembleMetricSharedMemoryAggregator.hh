@@ -0,0 +1,218 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricSharedMemoryAggregator.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricSharedMemoryAggregator.hh
+/// @brief Merges the data accumulated by EnsembleMetrics in several processes on one machine through a named POSIX
+/// shared-memory segment, without MPI.
+/// @details Intended for runs in which many independent processes (e.g. rosetta_scripts processes launched by a batch
+/// scheduler) share a node.  Each process attaches to the segment when the EnsembleMetric is configured, and appends the
+/// packed summary of its data when it would otherwise produce its report.  The last process to detach merges everything
+/// that the others appended and produces one consolidated report.  No locks are used: space in the segment is reserved
+/// with an atomic counter, and attachment is tracked with another.  Each process attaches only once per segment, however
+/// many copies of the EnsembleMetric it holds: the copies share one aggregator (from get_aggregator()), merge their data
+/// in the process, and the last copy to report contributes once.  Only available on Linux and macOS.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricSharedMemoryAggregator_hh
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricSharedMemoryAggregator_hh
+
+#include <protocols/ensemble_metrics/EnsembleMetricSharedMemoryAggregator.fwd.hh>
+
+// Protocols headers
+#include <protocols/ensemble_metrics/EnsembleMetric.fwd.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/VirtualBase.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <string>
+
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief Merges the data accumulated by EnsembleMetrics in several processes on one machine through a named POSIX
+/// shared-memory segment, without MPI.
+/// @details All processes attaching to a segment must use it for the same EnsembleMetric (by type and name), and
+/// must run on the same architecture.  A process that exits without detaching (e.g. one that crashes) leaves the
+/// segment waiting for it, so no process produces the consolidated report; the segment must then be removed manually
+/// (e.g. from /dev/shm on Linux).
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricSharedMemoryAggregator : public utility::VirtualBase {
+
+public:
+
+	/// @brief Constructor.  Attaches to the named segment, creating it if it does not exist.
+	/// @param[in] segment_name The name of the shared-memory segment.  A leading slash is added if absent.
+	/// @param[in] capacity_bytes The number of bytes available for summaries, if this process creates the segment.
+	/// Ignored if the segment already exists.
+	EnsembleMetricSharedMemoryAggregator(
+		std::string const & segment_name,
+		core::Size const capacity_bytes
+	);
+
+	/// @brief No default constructor.
+	EnsembleMetricSharedMemoryAggregator() = delete;
+
+	/// @brief No copy constructor (since this owns a mapping and an attachment).
+	EnsembleMetricSharedMemoryAggregator( EnsembleMetricSharedMemoryAggregator const & ) = delete;
+
+	/// @brief No assignment operator.
+	EnsembleMetricSharedMemoryAggregator & operator=( EnsembleMetricSharedMemoryAggregator const & ) = delete;
+
+	/// @brief Destructor.  Detaches without contributing data, if contribute_and_detach() was never called, and unmaps
+	/// the segment.
+	~EnsembleMetricSharedMemoryAggregator() override;
+
+	/// @brief Get the aggregator for the named segment in this process, creating (and attaching) it if this process
+	/// has none that is still attached.
+	/// @details Threadsafe.  Copies of an EnsembleMetric share the aggregator, so that the process attaches once.
+	static
+	EnsembleMetricSharedMemoryAggregatorOP
+	get_aggregator(
+		std::string const & segment_name,
+		core::Size const capacity_bytes
+	);
+
+public: // Accessors
+
+	/// @brief The name of the shared-memory segment (with leading slash).
+	inline std::string const & segment_name() const { return segment_name_; }
+
+	/// @brief Is this process still attached to the segment?
+	inline bool attached() const { return attached_; }
+
+	/// @brief The number of other processes whose summaries were merged by contribute_and_detach().
+	/// @details Only nonzero in the last process to detach.
+	inline core::Size n_summaries_merged() const { return n_summaries_merged_; }
+
+	/// @brief The number of other copies of the EnsembleMetric in this process whose data were merged by
+	/// contribute_and_detach().
+	inline core::Size n_local_copies_merged() const { return n_local_copies_merged_; }
+
+public: // Local copy tracking
+
+	/// @brief Note that a copy of the EnsembleMetric in this process will contribute its data through this aggregator.
+	/// @details Threadsafe.  Each registered copy must later call either contribute_and_detach() or
+	/// unregister_local_copy().
+	void register_local_copy();
+
+	/// @brief Note that a registered copy of the EnsembleMetric will not contribute its data (e.g. because it was
+	/// destroyed without producing a report).
+	/// @details Threadsafe.  If this was the last registered copy, the data of the copies that contributed are appended
+	/// to the segment and this process detaches.
+	void unregister_local_copy();
+
+public: // Aggregation functions
+
+	/// @brief Contribute the data of a registered copy of an EnsembleMetric.  If other registered copies in this process
+	/// have yet to contribute, the data are held in this process.  Otherwise, the data held for the other copies are
+	/// merged into the EnsembleMetric, its packed summary is appended to the segment, and this process detaches.  If
+	/// this process was the last one attached, the summaries appended by all other processes are instead merged into
+	/// the EnsembleMetric, and the segment is removed.
+	/// @details Threadsafe.  The EnsembleMetric must support summary merging.  If the summary does not fit in the
+	/// remaining space in the segment, it is not appended, and a warning is printed.
+	/// @returns True if this copy should produce a report: either this process was the last to detach (in which case
+	/// the EnsembleMetric now holds the consolidated data), its summary did not fit, or this process had already
+	/// detached.  False if another copy or another process will report this copy's data.
+	bool
+	contribute_and_detach(
+		EnsembleMetric & metric
+	);
+
+private: // Private functions
+
+	/// @brief Open or create the segment, map it, and register this process as attached.
+	void attach( core::Size const capacity_bytes );
+
+	/// @brief Unregister this process.
+	/// @returns True if this process was the last one attached (in which case the segment has been closed to new
+	/// processes and its name has been removed).
+	bool release_attachment();
+
+	/// @brief Reserve space in the segment and copy a summary into it.
+	/// @returns The offset of the record in the data region, or the data region size if it did not fit.
+	core::Size append_summary( std::string const & summary );
+
+	/// @brief Merge every summary in the segment except the one at skip_offset into an EnsembleMetric.
+	void
+	merge_appended_summaries(
+		EnsembleMetric & metric,
+		core::Size const skip_offset
+	);
+
+	/// @brief Append the summaries held for copies in this process to the segment without merging them, and detach.
+	/// @details Used if the last registered copy leaves without contributing.  Must be called with local_mutex_ held.
+	void append_local_summaries_and_detach();
+
+private: // Data
+
+	/// @brief The name of the shared-memory segment (with leading slash).
+	std::string segment_name_;
+
+	/// @brief The start of the mapped segment, or nullptr if not mapped.
+	void * mapping_ = nullptr;
+
+	/// @brief The size of the mapped segment, in bytes.
+	core::Size mapping_bytes_ = 0;
+
+	/// @brief Is this process still attached to the segment?
+	bool attached_ = false;
+
+	/// @brief The number of other processes whose summaries were merged by contribute_and_detach().
+	core::Size n_summaries_merged_ = 0;
+
+	/// @brief The number of copies of the EnsembleMetric in this process that have yet to contribute or unregister.
+	core::Size n_local_copies_ = 0;
+
+	/// @brief Summaries of the copies in this process that have contributed, held until the last copy contributes.
+	utility::vector1< std::string > local_summaries_;
+
+	/// @brief The number of other copies of the EnsembleMetric in this process whose data were merged by
+	/// contribute_and_detach().
+	core::Size n_local_copies_merged_ = 0;
+
+#ifdef MULTI_THREADED
+	/// @brief Protects the local copy tracking, and the attachment.
+	std::mutex local_mutex_;
+#endif
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricSharedMemoryAggregator_hh
@@ -0,0 +1,153 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricSummaryIO.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricSummaryIO.cc
+/// @brief Helpers for packing the data accumulated by an EnsembleMetric into a flat, mergeable binary
+/// summary, and for reading such a summary back.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Project headers:
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryIO.hh>
+
+// Utility headers:
+#include <utility/exit.hh>
+
+namespace protocols {
+namespace ensemble_metrics {
+
+////////////////////////////////////////////////////////////////////////////////
+// EnsembleMetricSummaryWriter
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Constructor.  Values will be appended to the given buffer, which must outlive this object.
+EnsembleMetricSummaryWriter::EnsembleMetricSummaryWriter(
+	std::string & buffer
+) :
+	buffer_( buffer )
+{}
+
+/// @brief Append a count followed by an array of real values.
+void
+EnsembleMetricSummaryWriter::write_real_array(
+	core::Real const * values,
+	core::Size const n_values
+) {
+	write< std::uint64_t >( static_cast< std::uint64_t >( n_values ) );
+	if ( n_values == 0 ) return;
+	buffer_.append( reinterpret_cast< char const * >( values ), n_values * sizeof( core::Real ) );
+}
+
+/// @brief Append a length followed by the characters of a string.
+void
+EnsembleMetricSummaryWriter::write_string(
+	std::string const & value
+) {
+	write< std::uint64_t >( static_cast< std::uint64_t >( value.size() ) );
+	buffer_.append( value );
+}
+
+/// @brief Reserve space for this many additional bytes.
+void
+EnsembleMetricSummaryWriter::reserve_additional(
+	core::Size const n_bytes
+) {
+	buffer_.reserve( buffer_.size() + n_bytes );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// EnsembleMetricSummaryReader
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Constructor.  Reads from the given block of memory, which must outlive this object.
+EnsembleMetricSummaryReader::EnsembleMetricSummaryReader(
+	char const * data,
+	core::Size const n_bytes
+) :
+	data_( data ),
+	n_bytes_( n_bytes )
+{
+	runtime_assert_string_msg( data_ != nullptr || n_bytes_ == 0, "Error in EnsembleMetricSummaryReader constructor: A null pointer was passed with a nonzero size." );
+}
+
+/// @brief Read the count that precedes an array of real values written by write_real_array().
+/// @details Follow this with a call to read_real_array_values() with the same count.
+core::Size
+EnsembleMetricSummaryReader::read_real_array_count() {
+	core::Size const n_values( static_cast< core::Size >( read< std::uint64_t >() ) );
+	check_available( n_values * sizeof( core::Real ) ); //Catch corrupt counts before the caller allocates storage.
+	return n_values;
+}
+
+/// @brief Read the values of an array of real values written by write_real_array() into the given
+/// destination, which must have room for n_values values.
+void
+EnsembleMetricSummaryReader::read_real_array_values(
+	core::Real * destination,
+	core::Size const n_values
+) {
+	if ( n_values == 0 ) return;
+	check_available( n_values * sizeof( core::Real ) );
+	std::memcpy( destination, data_ + position_, n_values * sizeof( core::Real ) );
+	position_ += n_values * sizeof( core::Real );
+}
+
+/// @brief Read a string written by write_string().
+std::string
+EnsembleMetricSummaryReader::read_string() {
+	core::Size const length( static_cast< core::Size >( read< std::uint64_t >() ) );
+	check_available( length );
+	std::string const value( data_ + position_, length );
+	position_ += length;
+	return value;
+}
+
+/// @brief Read a string written by write_string() without copying it.
+/// @details Returns a pointer into the underlying buffer (which must outlive its use), and sets length to the
+/// number of bytes in the string.
+char const *
+EnsembleMetricSummaryReader::read_string_in_place(
+	core::Size & length
+) {
+	length = static_cast< core::Size >( read< std::uint64_t >() );
+	check_available( length );
+	char const * const value( data_ + position_ );
+	position_ += length;
+	return value;
+}
+
+/// @brief Throw if fewer than n_bytes remain.
+void
+EnsembleMetricSummaryReader::check_available(
+	core::Size const n_bytes
+) const {
+	runtime_assert_string_msg( n_bytes <= remaining(), "Error in EnsembleMetricSummaryReader: Attempted to read " + std::to_string( n_bytes ) + " bytes past position " + std::to_string( position_ ) + " of a summary of only " + std::to_string( n_bytes_ ) + " bytes.  The summary is truncated or corrupt." );
+}
+
+} //ensemble_metrics
+} //protocols
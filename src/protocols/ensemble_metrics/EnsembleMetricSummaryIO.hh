@@ -0,0 +1,159 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricSummaryIO.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricSummaryIO.hh
+/// @brief Helpers for packing the data accumulated by an EnsembleMetric into a flat, mergeable binary
+/// summary, and for reading such a summary back.
+/// @details A summary is a plain byte string, so it can be sent over MPI, written to disk, or held in
+/// memory without any knowledge of the EnsembleMetric that produced it.  Values are stored in native byte
+/// order, so summaries may only be exchanged between machines with the same endianness and the same
+/// floating-point format (which is the case for all supported MPI configurations).
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricSummaryIO_hh
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricSummaryIO_hh
+
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryIO.fwd.hh>
+
+// Core headers
+#include <core/types.hh>
+
+//STL headers
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief Appends values to a summary buffer.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricSummaryWriter {
+
+public:
+
+	/// @brief Constructor.  Values will be appended to the given buffer, which must outlive this object.
+	explicit EnsembleMetricSummaryWriter( std::string & buffer );
+
+	/// @brief No default constructor.
+	EnsembleMetricSummaryWriter() = delete;
+
+	/// @brief Append a single trivially-copyable value.
+	template< class T >
+	void
+	write(
+		T const & value
+	) {
+		static_assert( std::is_trivially_copyable< T >::value, "Only trivially-copyable types can be written to an ensemble metric summary." );
+		buffer_.append( reinterpret_cast< char const * >( &value ), sizeof( T ) );
+	}
+
+	/// @brief Append a count followed by an array of real values.
+	void write_real_array( core::Real const * values, core::Size const n_values );
+
+	/// @brief Append a length followed by the characters of a string.
+	void write_string( std::string const & value );
+
+	/// @brief Reserve space for this many additional bytes.
+	void reserve_additional( core::Size const n_bytes );
+
+private:
+
+	/// @brief The buffer to which we are appending.
+	std::string & buffer_;
+
+};
+
+/// @brief Reads values from a summary buffer, in the order in which they were written.
+/// @details Throws if an attempt is made to read past the end of the buffer.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricSummaryReader {
+
+public:
+
+	/// @brief Constructor.  Reads from the given block of memory, which must outlive this object.
+	EnsembleMetricSummaryReader( char const * data, core::Size const n_bytes );
+
+	/// @brief No default constructor.
+	EnsembleMetricSummaryReader() = delete;
+
+	/// @brief Read a single trivially-copyable value.
+	template< class T >
+	T
+	read() {
+		static_assert( std::is_trivially_copyable< T >::value, "Only trivially-copyable types can be read from an ensemble metric summary." );
+		check_available( sizeof( T ) );
+		T value;
+		std::memcpy( &value, data_ + position_, sizeof( T ) );
+		position_ += sizeof( T );
+		return value;
+	}
+
+	/// @brief Read the count that precedes an array of real values written by write_real_array().
+	/// @details Follow this with a call to read_real_array_values() with the same count.
+	core::Size read_real_array_count();
+
+	/// @brief Read the values of an array of real values written by write_real_array() into the given
+	/// destination, which must have room for n_values values.
+	void read_real_array_values( core::Real * destination, core::Size const n_values );
+
+	/// @brief Read a string written by write_string().
+	std::string read_string();
+
+	/// @brief Read a string written by write_string() without copying it.
+	/// @details Returns a pointer into the underlying buffer (which must outlive its use), and sets length to the
+	/// number of bytes in the string.
+	char const * read_string_in_place( core::Size & length );
+
+	/// @brief The number of bytes not yet read.
+	inline core::Size remaining() const { return n_bytes_ - position_; }
+
+private:
+
+	/// @brief Throw if fewer than n_bytes remain.
+	void check_available( core::Size const n_bytes ) const;
+
+private:
+
+	/// @brief The data being read.
+	char const * data_;
+
+	/// @brief The size of the data being read.
+	core::Size n_bytes_;
+
+	/// @brief The position of the next byte to read.
+	core::Size position_ = 0;
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricSummaryIO_hh
@@ -0,0 +1,252 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricSummaryStreamer.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricSummaryStreamer.cc
+/// @brief Streams partial summaries of the data accumulated by EnsembleMetrics from worker MPI processes to a
+/// root process while an ensemble is still being generated.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Project headers:
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryStreamer.hh>
+
+#ifdef USEMPI
+
+#include <protocols/ensemble_metrics/EnsembleMetric.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryIO.hh>
+#include <protocols/ensemble_metrics/util.hh>
+
+// Basic headers:
+#include <basic/Tracer.hh>
+
+// Utility headers:
+#include <utility/exit.hh>
+
+// STL headers:
+#include <cstdint>
+#include <limits>
+
+static basic::Tracer TR( "protocols.ensemble_metrics.EnsembleMetricSummaryStreamer" );
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief The MPI tag used for partial summaries.  (Messages are on a private communicator, so this only
+/// needs to be consistent within this class.)
+static int const partial_summary_mpi_tag( 1 );
+
+/// @brief Constructor.  This is collective over comm, which is duplicated.
+/// @param[in] comm The communicator containing the root and all workers.
+/// @param[in] root_rank The rank of the process that merges everything.
+/// @param[in] min_seconds_between_sends Workers send a partial summary no more often than this.
+EnsembleMetricSummaryStreamer::EnsembleMetricSummaryStreamer(
+	MPI_Comm comm,
+	int const root_rank,
+	core::Real const min_seconds_between_sends
+) :
+	utility::VirtualBase(),
+	root_rank_( root_rank ),
+	min_interval_between_sends_( min_seconds_between_sends ),
+	last_send_time_( std::chrono::steady_clock::now() )
+{
+	MPI_Comm_dup( comm, &comm_ );
+	MPI_Comm_rank( comm_, &rank_ );
+	MPI_Comm_size( comm_, &nprocs_ );
+	runtime_assert_string_msg( root_rank_ >= 0 && root_rank_ < nprocs_, "Error in EnsembleMetricSummaryStreamer constructor: The root rank is not in the communicator." );
+	runtime_assert_string_msg( min_seconds_between_sends >= 0.0, "Error in EnsembleMetricSummaryStreamer constructor: The minimum interval between sends cannot be negative." );
+}
+
+/// @brief Destructor.  Waits for any outstanding sends to complete, and frees the duplicated communicator.
+EnsembleMetricSummaryStreamer::~EnsembleMetricSummaryStreamer() {
+	for ( std::pair< MPI_Request, std::string > & send : pending_sends_ ) {
+		MPI_Wait( &send.first, MPI_STATUS_IGNORE );
+	}
+	pending_sends_.clear();
+	MPI_Comm_free( &comm_ );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC STREAMING FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief In a worker process, pack the data accumulated since the last send and post a non-blocking send to the
+/// root, if at least the minimum interval has passed since the last send (or if force is true) and there are any
+/// new data.  Does nothing in the root process.
+/// @details Also releases the buffers of earlier sends that have completed.  Must not be called while poses are being
+/// added to the EnsembleMetrics.
+/// @returns True if a partial summary was sent; false otherwise.
+bool
+EnsembleMetricSummaryStreamer::send_partial_summaries(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	bool const force /*= false*/
+) {
+	if ( is_root() ) return false;
+	runtime_assert_string_msg( !finished_, "Error in EnsembleMetricSummaryStreamer::send_partial_summaries(): Cannot send after finish() has been called." );
+	release_completed_sends();
+
+	std::chrono::steady_clock::time_point const now( std::chrono::steady_clock::now() );
+	if ( !force && now - last_send_time_ < min_interval_between_sends_ ) return false;
+
+	bool any_new_data( false );
+	for ( EnsembleMetricOP const & metric : metrics ) {
+		if ( metric->poses_in_ensemble() > metric->poses_packed_in_summary_deltas() ) {
+			any_new_data = true;
+			break;
+		}
+	}
+	if ( !any_new_data ) return false;
+
+	post_send( pack_message( metrics, false ) );
+	last_send_time_ = now;
+	return true;
+}
+
+/// @brief In the root process, merge all partial summaries that have arrived, without blocking.  Does nothing in
+/// worker processes.
+/// @returns The number of partial summaries merged.
+core::Size
+EnsembleMetricSummaryStreamer::merge_available_summaries(
+	utility::vector1< EnsembleMetricOP > const & metrics
+) {
+	if ( !is_root() || finished_ ) return 0;
+	core::Size n_merged(0);
+	while ( true ) {
+		int message_waiting(0);
+		MPI_Status status;
+		MPI_Iprobe( MPI_ANY_SOURCE, partial_summary_mpi_tag, comm_, &message_waiting, &status );
+		if ( !message_waiting ) break;
+		if ( receive_and_merge_message( status, metrics ) ) {
+			++n_workers_finished_;
+		}
+		++n_merged;
+	}
+	return n_merged;
+}
+
+/// @brief Flush the last delta from each worker to the root and merge it there.  This is collective over the
+/// communicator.  Afterward, the EnsembleMetrics in worker processes are reset (so that only the root reports).
+void
+EnsembleMetricSummaryStreamer::finish(
+	utility::vector1< EnsembleMetricOP > const & metrics
+) {
+	runtime_assert_string_msg( !finished_, "Error in EnsembleMetricSummaryStreamer::finish(): This function can only be called once." );
+
+	if ( is_root() ) {
+		while ( n_workers_finished_ < static_cast< core::Size >( nprocs_ - 1 ) ) {
+			MPI_Status status;
+			MPI_Probe( MPI_ANY_SOURCE, partial_summary_mpi_tag, comm_, &status );
+			if ( receive_and_merge_message( status, metrics ) ) {
+				++n_workers_finished_;
+			}
+		}
+		TR.Debug << "Process " << rank_ << " merged " << n_messages_merged_ << " partial summaries from " << nprocs_ - 1 << " processes." << std::endl;
+	} else {
+		post_send( pack_message( metrics, true ) );
+		for ( std::pair< MPI_Request, std::string > & send : pending_sends_ ) {
+			MPI_Wait( &send.first, MPI_STATUS_IGNORE );
+		}
+		pending_sends_.clear();
+		TR.Debug << "Process " << rank_ << " sent " << n_messages_sent_ << " partial summaries to process " << root_rank_ << "." << std::endl;
+		for ( EnsembleMetricOP const & metric : metrics ) {
+			metric->reset(); //Suppresses this process from producing reports.
+		}
+	}
+	finished_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Pack deltas for all of the EnsembleMetrics into one message.
+std::string
+EnsembleMetricSummaryStreamer::pack_message(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	bool const final_message
+) const {
+	std::string message;
+	EnsembleMetricSummaryWriter writer( message );
+	writer.write< std::uint8_t >( final_message ? 1 : 0 );
+	writer.write< std::uint64_t >( static_cast< std::uint64_t >( metrics.size() ) );
+	for ( EnsembleMetricOP const & metric : metrics ) {
+		writer.write_string( metric->pack_summary_delta() );
+	}
+	return message;
+}
+
+/// @brief Post a non-blocking send of a message to the root process.
+void
+EnsembleMetricSummaryStreamer::post_send(
+	std::string && message
+) {
+	runtime_assert_string_msg( message.size() <= static_cast< core::Size >( std::numeric_limits< int >::max() ), "Error in EnsembleMetricSummaryStreamer::post_send(): The partial summary is too large to send in a single MPI message." );
+	pending_sends_.emplace_back( MPI_REQUEST_NULL, std::move( message ) );
+	std::pair< MPI_Request, std::string > & send( pending_sends_.back() );
+	MPI_Isend( static_cast< const void * >( send.second.data() ), static_cast< int >( send.second.size() ), MPI_BYTE, root_rank_, partial_summary_mpi_tag, comm_, &send.first );
+	++n_messages_sent_;
+}
+
+/// @brief Release the buffers of sends that have completed.
+void
+EnsembleMetricSummaryStreamer::release_completed_sends() {
+	for ( std::list< std::pair< MPI_Request, std::string > >::iterator it( pending_sends_.begin() ); it != pending_sends_.end(); ) {
+		int complete(0);
+		MPI_Test( &it->first, &complete, MPI_STATUS_IGNORE );
+		if ( complete ) {
+			it = pending_sends_.erase( it );
+		} else {
+			++it;
+		}
+	}
+}
+
+/// @brief Receive the message that has been probed, and merge it.
+/// @returns True if this was the final message from its sender.
+bool
+EnsembleMetricSummaryStreamer::receive_and_merge_message(
+	MPI_Status & status,
+	utility::vector1< EnsembleMetricOP > const & metrics
+) {
+	int const source( status.MPI_SOURCE );
+	int n_bytes(0);
+	MPI_Get_count( &status, MPI_BYTE, &n_bytes );
+	receive_buffer_.resize( static_cast< core::Size >( n_bytes ) );
+	MPI_Recv( static_cast< void * >( n_bytes > 0 ? &receive_buffer_[0] : nullptr ), n_bytes, MPI_BYTE, source, partial_summary_mpi_tag, comm_, &status );
+
+	EnsembleMetricSummaryReader reader( receive_buffer_.data(), receive_buffer_.size() );
+	bool const final_message( reader.read< std::uint8_t >() != 0 );
+	// A worker that never ran a job never set up its EnsembleMetrics, and sends none.
+	merge_ensemble_metric_summaries( metrics, reader, "process " + std::to_string( source ) );
+	++n_messages_merged_;
+	return final_message;
+}
+
+} //ensemble_metrics
+} //protocols
+
+#endif //USEMPI
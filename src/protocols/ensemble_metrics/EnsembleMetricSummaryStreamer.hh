@@ -0,0 +1,211 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricSummaryStreamer.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/EnsembleMetricSummaryStreamer.hh
+/// @brief Streams partial summaries of the data accumulated by EnsembleMetrics from worker MPI processes to a
+/// root process while an ensemble is still being generated.
+/// @details Worker processes periodically pack the data accumulated since their last message (a delta) for all
+/// of the streamed EnsembleMetrics into one buffer, and post it with a non-blocking send.  The root process merges
+/// whatever has arrived whenever it polls.  At the end of a run, finish() only has to flush the last delta from
+/// each worker, rather than collecting everything at once.  Messages travel on a private duplicate of the
+/// communicator, so they never interfere with other traffic.  Only available in the MPI build.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_EnsembleMetricSummaryStreamer_hh
+#define INCLUDED_protocols_ensemble_metrics_EnsembleMetricSummaryStreamer_hh
+
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryStreamer.fwd.hh>
+
+#ifdef USEMPI
+
+// Protocols headers
+#include <protocols/ensemble_metrics/EnsembleMetric.fwd.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/VirtualBase.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <string>
+#include <list>
+#include <chrono>
+
+#include <mpi.h>
+
+namespace protocols {
+namespace ensemble_metrics {
+
+/// @brief Streams partial summaries of the data accumulated by EnsembleMetrics from worker MPI processes to a
+/// root process while an ensemble is still being generated.
+/// @details All processes must pass the same EnsembleMetrics (by type and name) in the same order to every call.
+/// Every EnsembleMetric must support summary merging and summary deltas.  Partial summaries from different workers
+/// may be merged in any order, but those from any one worker are always merged in the order sent.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class EnsembleMetricSummaryStreamer : public utility::VirtualBase {
+
+public:
+
+	/// @brief Constructor.  This is collective over comm, which is duplicated.
+	/// @param[in] comm The communicator containing the root and all workers.
+	/// @param[in] root_rank The rank of the process that merges everything.
+	/// @param[in] min_seconds_between_sends Workers send a partial summary no more often than this.
+	EnsembleMetricSummaryStreamer(
+		MPI_Comm comm,
+		int const root_rank,
+		core::Real const min_seconds_between_sends
+	);
+
+	/// @brief No default constructor.
+	EnsembleMetricSummaryStreamer() = delete;
+
+	/// @brief No copy constructor (since this owns a communicator and outstanding requests).
+	EnsembleMetricSummaryStreamer( EnsembleMetricSummaryStreamer const & ) = delete;
+
+	/// @brief No assignment operator.
+	EnsembleMetricSummaryStreamer & operator=( EnsembleMetricSummaryStreamer const & ) = delete;
+
+	/// @brief Destructor.  Waits for any outstanding sends to complete, and frees the duplicated communicator.
+	~EnsembleMetricSummaryStreamer() override;
+
+public: // Accessors
+
+	/// @brief Is this process the root process?
+	inline bool is_root() const { return rank_ == root_rank_; }
+
+	/// @brief Has finish() been called?
+	inline bool finished() const { return finished_; }
+
+	/// @brief The number of partial summaries sent by this process.
+	inline core::Size n_messages_sent() const { return n_messages_sent_; }
+
+	/// @brief The number of partial summaries merged by this process.
+	inline core::Size n_messages_merged() const { return n_messages_merged_; }
+
+public: // Streaming functions
+
+	/// @brief In a worker process, pack the data accumulated since the last send and post a non-blocking send to the
+	/// root, if at least the minimum interval has passed since the last send (or if force is true) and there are any
+	/// new data.  Does nothing in the root process.
+	/// @details Also releases the buffers of earlier sends that have completed.  Must not be called while poses are being
+	/// added to the EnsembleMetrics.
+	/// @returns True if a partial summary was sent; false otherwise.
+	bool
+	send_partial_summaries(
+		utility::vector1< EnsembleMetricOP > const & metrics,
+		bool const force = false
+	);
+
+	/// @brief In the root process, merge all partial summaries that have arrived, without blocking.  Does nothing in
+	/// worker processes.
+	/// @returns The number of partial summaries merged.
+	core::Size
+	merge_available_summaries(
+		utility::vector1< EnsembleMetricOP > const & metrics
+	);
+
+	/// @brief Flush the last delta from each worker to the root and merge it there.  This is collective over the
+	/// communicator.  Afterward, the EnsembleMetrics in worker processes are reset (so that only the root reports).
+	void
+	finish(
+		utility::vector1< EnsembleMetricOP > const & metrics
+	);
+
+private: // Private functions
+
+	/// @brief Pack deltas for all of the EnsembleMetrics into one message.
+	std::string
+	pack_message(
+		utility::vector1< EnsembleMetricOP > const & metrics,
+		bool const final_message
+	) const;
+
+	/// @brief Post a non-blocking send of a message to the root process.
+	void post_send( std::string && message );
+
+	/// @brief Release the buffers of sends that have completed.
+	void release_completed_sends();
+
+	/// @brief Receive the message that has been probed, and merge it.
+	/// @returns True if this was the final message from its sender.
+	bool
+	receive_and_merge_message(
+		MPI_Status & status,
+		utility::vector1< EnsembleMetricOP > const & metrics
+	);
+
+private: // Data
+
+	/// @brief Private duplicate of the communicator passed to the constructor.
+	MPI_Comm comm_;
+
+	/// @brief The rank of this process in comm_.
+	int rank_ = 0;
+
+	/// @brief The number of processes in comm_.
+	int nprocs_ = 1;
+
+	/// @brief The rank of the root process in comm_.
+	int root_rank_ = 0;
+
+	/// @brief Workers send a partial summary no more often than this.
+	std::chrono::duration< double > min_interval_between_sends_;
+
+	/// @brief When a worker last sent a partial summary.
+	std::chrono::steady_clock::time_point last_send_time_;
+
+	/// @brief Sends that have been posted but which may not yet have completed, with the buffers that they are sending.
+	/// @details A list, so that posted buffers are never moved.
+	std::list< std::pair< MPI_Request, std::string > > pending_sends_;
+
+	/// @brief Buffer reused for incoming messages in the root process.
+	std::string receive_buffer_;
+
+	/// @brief The number of workers that have sent their final message to the root.
+	core::Size n_workers_finished_ = 0;
+
+	/// @brief The number of partial summaries sent by this process.
+	core::Size n_messages_sent_ = 0;
+
+	/// @brief The number of partial summaries merged by this process.
+	core::Size n_messages_merged_ = 0;
+
+	/// @brief Has finish() been called?
+	bool finished_ = false;
+
+};
+
+} //ensemble_metrics
+} //protocols
+
+#endif //USEMPI
+
+#endif //INCLUDED_protocols_ensemble_metrics_EnsembleMetricSummaryStreamer_hh
@@ -102,10 +102,59 @@ acceptance_mode_enum_from_string(
 	return EnsembleFilterAcceptanceMode::GREATER_THAN; //Keep compiler happy.  Never reached.
 }
 
+/// @brief Given the filter's combination mode enum, get the corresponding string.
+std::string
+combination_mode_string_from_enum(
+	EnsembleFilterCombinationMode const mode
+) {
+	switch( mode ) {
+	case EnsembleFilterCombinationMode::AND :
+		return "and";
+	case EnsembleFilterCombinationMode::OR :
+		return "or";
+	default :
+		utility_exit_with_message( "Program error.  This should not happen." );
+	}
+	return ""; //Keep older compilers happy.  Never reached.
+}
+
+/// @brief Given the filter's combination mode string, get the corresponding enum.
+EnsembleFilterCombinationMode
+combination_mode_enum_from_string(
+	std::string const & mode_name
+) {
+	for ( core::Size i(1); i <= static_cast<core::Size>( EnsembleFilterCombinationMode::N_MODES ); ++i ) {
+		if ( mode_name == combination_mode_string_from_enum( static_cast<EnsembleFilterCombinationMode>(i) ) ) {
+			return static_cast<EnsembleFilterCombinationMode>(i);
+		}
+	}
+
+	utility_exit_with_message( "Error in protocols::ensemble_metrics::filters::combination_mode_enum_from_string(): "
+		"The string \"" + mode_name + "\" could not be parsed as a criterion combination mode.  Allowed modes are: "
+		"\"and\" and \"or\"."
+	);
+
+	return EnsembleFilterCombinationMode::AND; //Keep compiler happy.  Never reached.
+}
+
 EnsembleFilter::EnsembleFilter():
 	protocols::filters::Filter( "EnsembleFilter" )
 {}
 
+/// @brief Copy constructor.
+/// @details Has to be explicit because std::atomic has a deleted copy constructor.  The ensemble metric is
+/// shared, not cloned, so the copy can keep the source's cached validation.
+EnsembleFilter::EnsembleFilter(
+	EnsembleFilter const & src
+) :
+	protocols::filters::Filter( src ),
+	ensemble_metric_( src.ensemble_metric_ ),
+	criteria_( src.criteria_ ),
+	named_value_indices_( src.named_value_indices_ ),
+	combination_mode_( src.combination_mode_ ),
+	validated_generation_( src.validated_generation_.load() )
+{}
+
 EnsembleFilter::~EnsembleFilter()
 {}
 
@@ -122,20 +171,37 @@ EnsembleFilter::parse_my_tag(
 			+ excn.msg()
 		);
 	}
-	try {
+	if ( tag->hasOption("named_value") ) {
 		set_named_value( tag->getOption< std::string >("named_value") );
-	} catch( utility::excn::Exception & excn ) {
-		utility_exit_with_message(
-			"The EnsembleFilter requires that a floating-point value produced by the EnsembleMetric be specified with "
-			"the \"named_value\" option.  Error message follows:\n"
-			+ excn.msg()
+		if ( tag->hasOption("filter_acceptance_mode") ) {
+			set_acceptance_mode( tag->getOption<std::string>( "filter_acceptance_mode" ) );
+		}
+		if ( tag->hasOption("threshold") ) {
+			set_threshold( tag->getOption<core::Real>("threshold") );
+		}
+	} else {
+		runtime_assert_string_msg( !tag->hasOption("threshold") && !tag->hasOption("filter_acceptance_mode"),
+			"Error in EnsembleFilter::parse_my_tag(): The \"threshold\" and \"filter_acceptance_mode\" options apply "
+			"to the criterion defined by the \"named_value\" option, and cannot be used without it.  Set these on the "
+			"\"Criterion\" subtags instead."
 		);
 	}
-	if ( tag->hasOption("filter_acceptance_mode") ) {
-		set_acceptance_mode( tag->getOption<std::string>( "filter_acceptance_mode" ) );
+	for ( utility::tag::TagCOP const & subtag : tag->getTags() ) {
+		runtime_assert_string_msg( subtag->getName() == "Criterion", "Error in EnsembleFilter::parse_my_tag(): "
+			"Unrecognized subtag \"" + subtag->getName() + "\".  Only \"Criterion\" subtags are allowed."
+		);
+		add_criterion(
+			subtag->getOption< std::string >( "named_value" ),
+			acceptance_mode_enum_from_string( subtag->getOption< std::string >( "filter_acceptance_mode", "less_than_or_equal" ) ),
+			subtag->getOption< core::Real >( "threshold", 0.0 )
+		);
 	}
-	if ( tag->hasOption("threshold") ) {
-		set_threshold( tag->getOption<core::Real>("threshold") );
+	runtime_assert_string_msg( !criteria_[1].named_value.empty(), "The EnsembleFilter requires that a floating-point "
+		"value produced by the EnsembleMetric be specified with the \"named_value\" option, or with one or more "
+		"\"Criterion\" subtags."
+	);
+	if ( tag->hasOption("combine_criteria") ) {
+		set_combination_mode( tag->getOption< std::string >( "combine_criteria" ) );
 	}
 }
 
@@ -159,21 +225,21 @@ EnsembleFilter::provide_citation_info( basic::citation_manager::CitationCollecti
 	);
 }
 
-/// @brief Confirm that this filter has been properly configured prior to filtering with it.
-/// @details Throws if it has not.
+/// @brief Confirm that this filter has been properly configured prior to filtering with it, and
+/// finalize the ensemble metric if it has not yet been finalized.
+/// @details Throws if it has not.  The result is cached: see ensure_validated().
 void
 EnsembleFilter::validate_my_configuration() const {
 	std::string const errmsg( "Error in EnsembleFilter::validate_my_configuration(): ");
 	runtime_assert_string_msg( ensemble_metric_ != nullptr, errmsg + "An ensemble metric must be provided to the EnsembleFilter before using it!" );
-	runtime_assert_string_msg( !named_value_.empty(), errmsg + "The name of a floating-point value returned by the " + ensemble_metric_->name() + " must be provided before using the EnsembleMetric." );
-	runtime_assert_string_msg( ensemble_metric_->real_valued_metric_names().has_value( named_value_ ), errmsg +
-		"The EnsembleMetric was configured to filter based on a floating-point value named \"" + named_value_ +
-		"\" returned by the " + ensemble_metric_->name() + " EnsembleMetric, but this EnsembleMetric " +
-		"returns no such value!"
-	);
+	for ( core::Size i( 1 ), imax( criteria_.size() ); i <= imax; ++i ) {
+		runtime_assert_string_msg( !criteria_[i].named_value.empty(), errmsg + "The name of a floating-point value returned by the " + ensemble_metric_->name() + " must be provided before using the EnsembleMetric." );
+		debug_assert( named_value_indices_[i] != 0 ); //Resolved (or rejected) by the setters.
+	}
 	if ( !ensemble_metric_->finalized() ) {
 		ensemble_metric_->produce_final_report();
 	}
+	validated_generation_.store( ensemble_metric_->generation() );
 }
 
 /// @brief Sets the metric directly; does not clone.
@@ -182,6 +248,7 @@ EnsembleFilter::set_ensemble_metric(
 	protocols::ensemble_metrics::EnsembleMetricOP metric_in
 ) {
 	ensemble_metric_ = metric_in;
+	resolve_named_value_indices();
 }
 
 /// @brief Set the name of the value produced by the EnsembleMetric and used for filtering.
@@ -189,7 +256,8 @@ void
 EnsembleFilter::set_named_value(
 	std::string const & setting
 ) {
-	named_value_ = setting;
+	criteria_[1].named_value = setting;
+	resolve_named_value_index( 1 );
 }
 
 /// @brief Set the cutoff threshold for filtering.
@@ -197,7 +265,7 @@ void
 EnsembleFilter::set_threshold(
 	core::Real const setting
 ) {
-	threshold_ = setting;
+	criteria_[1].threshold = setting;
 }
 
 /// @brief Set the acceptance mode.
@@ -205,7 +273,7 @@ void
 EnsembleFilter::set_acceptance_mode(
 	EnsembleFilterAcceptanceMode const setting
 ) {
-	acceptance_mode_ = setting;
+	criteria_[1].acceptance_mode = setting;
 }
 
 /// @brief Set the acceptance mode, by string.
@@ -216,6 +284,43 @@ EnsembleFilter::set_acceptance_mode(
 	set_acceptance_mode( acceptance_mode_enum_from_string( setting ) );
 }
 
+/// @brief Add a criterion for filtering.
+/// @details If the first criterion has not yet been given a named value, it is replaced by this one; otherwise,
+/// this one is appended to the list.  Throws if the ensemble metric has been set and produces no such value.
+void
+EnsembleFilter::add_criterion(
+	std::string const & named_value,
+	EnsembleFilterAcceptanceMode const acceptance_mode,
+	core::Real const threshold
+) {
+	runtime_assert_string_msg( !named_value.empty(), "Error in EnsembleFilter::add_criterion(): The named value cannot be empty." );
+	if ( !criteria_[1].named_value.empty() ) {
+		criteria_.push_back( EnsembleFilterCriterion() );
+		named_value_indices_.push_back( 0 );
+	}
+	EnsembleFilterCriterion & criterion( criteria_[ criteria_.size() ] );
+	criterion.named_value = named_value;
+	criterion.acceptance_mode = acceptance_mode;
+	criterion.threshold = threshold;
+	resolve_named_value_index( criteria_.size() );
+}
+
+/// @brief Set whether all criteria (AND) or any criterion (OR) must pass for a pose to pass.
+void
+EnsembleFilter::set_combination_mode(
+	EnsembleFilterCombinationMode const setting
+) {
+	combination_mode_ = setting;
+}
+
+/// @brief Set whether all criteria (AND) or any criterion (OR) must pass for a pose to pass, by string.
+void
+EnsembleFilter::set_combination_mode(
+	std::string const & setting
+) {
+	set_combination_mode( combination_mode_enum_from_string( setting ) );
+}
+
 /// @brief Get the ensemble metric.
 /// @details Will be nullptr of not set.
 protocols::ensemble_metrics::EnsembleMetricOP
@@ -226,44 +331,143 @@ EnsembleFilter::ensemble_metric() const {
 /// @brief Get the name of the value produced by the EnsembleMetric and used for filtering.
 std::string const &
 EnsembleFilter::named_value() const {
-	return named_value_;
+	return criteria_[1].named_value;
 }
 
 /// @brief Get the cutoff threshold for filtering.
 core::Real
 EnsembleFilter::threshold() const {
-	return threshold_;
+	return criteria_[1].threshold;
 }
 
 /// @brief Get the acceptance mode.
 EnsembleFilterAcceptanceMode
 EnsembleFilter::acceptance_mode() const {
-	return acceptance_mode_;
+	return criteria_[1].acceptance_mode;
 }
 
-/// @brief Given a value, determine if it's greater than, less than, or equal to the threshold.
-/// Return pass (true) or fail (false) based on the acceptance mode.
+/// @brief Get the list of criteria.  This always has at least one entry.
+utility::vector1< EnsembleFilterCriterion > const &
+EnsembleFilter::criteria() const {
+	return criteria_;
+}
+
+/// @brief Get whether all criteria (AND) or any criterion (OR) must pass for a pose to pass.
+EnsembleFilterCombinationMode
+EnsembleFilter::combination_mode() const {
+	return combination_mode_;
+}
+
+/// @brief Given a value, determine if it's greater than, less than, or equal to a criterion's threshold.
+/// Return pass (true) or fail (false) based on the criterion's acceptance mode.
 bool
 EnsembleFilter::value_passes(
+	EnsembleFilterCriterion const & criterion,
 	core::Real const value
-) const {
-	switch( acceptance_mode_ ) {
+) {
+	core::Real const threshold( criterion.threshold );
+	switch( criterion.acceptance_mode ) {
 	case EnsembleFilterAcceptanceMode::GREATER_THAN :
-		return (value > threshold_);
+		return (value > threshold);
 	case EnsembleFilterAcceptanceMode::LESS_THAN :
-		return (value < threshold_);
+		return (value < threshold);
 	case EnsembleFilterAcceptanceMode::GREATER_THAN_EQ :
-		return (value >= threshold_);
+		return (value >= threshold);
 	case EnsembleFilterAcceptanceMode::LESS_THAN_EQ :
-		return (value <= threshold_);
+		return (value <= threshold);
 	case EnsembleFilterAcceptanceMode::EQ :
-		return (value == threshold_);
+		return (value == threshold);
 	case EnsembleFilterAcceptanceMode::NOT_EQ :
-		return (value != threshold_);
+		return (value != threshold);
 	}
 	return false; //Should never reach here.
 }
 
+/// @brief Validate the configuration if necessary, then evaluate the criteria in order, fetching each value
+/// from the ensemble metric only when it is needed.
+/// @details Stops as soon as the outcome is known: at the first failure under AND, or the first pass under OR.
+/// On return, values holds the values of the criteria that were evaluated, which are the first values.size()
+/// criteria.
+bool
+EnsembleFilter::evaluate_criteria(
+	utility::vector1< core::Real > & values
+) const {
+	ensure_validated();
+	values.clear();
+	values.reserve( criteria_.size() );
+	bool const all_must_pass( combination_mode_ == EnsembleFilterCombinationMode::AND );
+	for ( core::Size i( 1 ), imax( criteria_.size() ); i <= imax; ++i ) {
+		values.push_back( ensemble_metric_->get_real_metric_value_by_index( named_value_indices_[i] ) );
+		if ( value_passes( criteria_[i], values[i] ) != all_must_pass ) {
+			return !all_must_pass; //A failure under AND, or a pass under OR, decides the outcome.
+		}
+	}
+	return all_must_pass;
+}
+
+/// @brief Write the values of the evaluated criteria, and whether the filter passes, to an output stream.
+/// @details Criteria that were not evaluated, because an earlier criterion decided the outcome, are listed as such.
+void
+EnsembleFilter::write_summary(
+	std::ostream & out,
+	utility::vector1< core::Real > const & values,
+	bool const passes
+) const {
+	out << "EnsembleMetric " << ensemble_metric_->name() << " reports ";
+	for ( core::Size i( 1 ), imax( criteria_.size() ); i <= imax; ++i ) {
+		if ( i > 1 ) out << ", ";
+		out << criteria_[i].named_value;
+		if ( i <= values.size() ) {
+			out << " = " << values[i];
+		} else {
+			out << " (not evaluated)";
+		}
+	}
+	out << ".  This " << (passes ? "PASSES" : "FAILS") << " this filter";
+	if ( criteria_.size() > 1 ) {
+		out << " (" << (combination_mode_ == EnsembleFilterCombinationMode::AND ? "all" : "any") << " of " << criteria_.size() << " criteria must pass)";
+	}
+	out << "." << std::endl;
+}
+
+/// @brief If both the ensemble metric and the named value of a criterion have been set, look up the index of
+/// the named value in the ensemble metric's list of real-valued metrics, so that filtering needs no string lookup.
+/// @details Throws if the ensemble metric produces no such value.  Called by the setters.
+void
+EnsembleFilter::resolve_named_value_index(
+	core::Size const criterion_index
+) {
+	std::string const & named_value( criteria_[criterion_index].named_value );
+	named_value_indices_[criterion_index] = 0;
+	validated_generation_.store( 0 );
+	if ( ensemble_metric_ == nullptr || named_value.empty() ) return;
+	runtime_assert_string_msg( ensemble_metric_->real_valued_metric_names().has_value( named_value ),
+		"Error in EnsembleFilter::resolve_named_value_index(): The EnsembleFilter was configured to filter based on "
+		"a floating-point value named \"" + named_value + "\" returned by the " + ensemble_metric_->name() +
+		" EnsembleMetric, but this EnsembleMetric returns no such value!"
+	);
+	named_value_indices_[criterion_index] = ensemble_metric_->real_valued_metric_index( named_value );
+}
+
+/// @brief Resolve the indices of the named values of all criteria.
+void
+EnsembleFilter::resolve_named_value_indices() {
+	for ( core::Size i( 1 ), imax( criteria_.size() ); i <= imax; ++i ) {
+		resolve_named_value_index( i );
+	}
+}
+
+/// @brief Call validate_my_configuration() unless it has already been called for the current generation of
+/// the ensemble metric.
+/// @details Once validated, this costs one pointer dereference and one comparison.  Resetting the ensemble
+/// metric advances its generation, so the next call validates (and finalizes) it again.
+void
+EnsembleFilter::ensure_validated() const {
+	core::Size const validated_generation( validated_generation_.load() );
+	if ( validated_generation == 0 || validated_generation != ensemble_metric_->generation() ) {
+		validate_my_configuration();
+	}
+}
 
 protocols::filters::FilterOP
 EnsembleFilter::fresh_instance() const
@@ -275,28 +479,25 @@ bool
 EnsembleFilter::apply(
 	core::pose::Pose const &
 ) const {
-	validate_my_configuration();
-	core::Real const val( ensemble_metric_->get_real_metric_value_by_name( named_value_ ) );
-	bool const passfail( value_passes(val) );
-	TR << "EnsembleMetric " << ensemble_metric_->name() << " reports " << named_value_ << " = " << val;
-	TR << ".  This " << (passfail ? "PASSES" : "FAILS") << " this filter." << std::endl;
+	utility::vector1< core::Real > values;
+	bool const passfail( evaluate_criteria( values ) );
+	write_summary( TR, values, passfail );
 	return passfail;
 }
 
 core::Real
 EnsembleFilter::report_sm( core::pose::Pose const & ) const
 {
-	validate_my_configuration();
-	return ensemble_metric_->get_real_metric_value_by_name( named_value_ );
+	ensure_validated();
+	return ensemble_metric_->get_real_metric_value_by_index( named_value_indices_[1] );
 }
 
 void
 EnsembleFilter::report( std::ostream & os, core::pose::Pose const & ) const
 {
-	validate_my_configuration();
-	core::Real const val( ensemble_metric_->get_real_metric_value_by_name( named_value_ ) );
-	os << "EnsembleMetric " << ensemble_metric_->name() << " reports " << named_value_ << " = " << val;
-	os << ".  This " << (value_passes(val) ? "PASSES" : "FAILS") << " this filter." << std::endl;
+	utility::vector1< core::Real > values;
+	bool const passfail( evaluate_criteria( values ) );
+	write_summary( os, values, passfail );
 }
 
 std::string EnsembleFilter::name() const {
@@ -317,28 +518,57 @@ void EnsembleFilter::provide_xml_schema( utility::tag::XMLSchemaDefinition & xsd
 		"ensemble_metric", xs_string, "A previously-defined EnsembleMetric that produces at least one "
 		"floating-point value.  This filter will filter a pose based on that value."
 		)
-		+ utility::tag::XMLSchemaAttribute::required_attribute(
+		+ utility::tag::XMLSchemaAttribute(
 		"named_value", xs_string, "A named floating-point value produced by the EnsembleMetric, on which "
-		"this filter will filter."
+		"this filter will filter.  Required unless criteria are provided with \"Criterion\" subtags, in which case "
+		"this defines an additional criterion."
 		)
 		+ utility::tag::XMLSchemaAttribute::attribute_w_default(
-		"threshold", xsct_real, "The threshold for rejecting a pose.", "0.0"
+		"threshold", xsct_real, "The threshold for rejecting a pose.  Only allowed if \"named_value\" is provided.", "0.0"
 		)
 		+ utility::tag::XMLSchemaAttribute::attribute_w_default(
 		"filter_acceptance_mode", xs_string, "The criterion for ACCEPTING a pose.  For instance, if the value "
 		"returned by the ensemble metric is greater than the threshold, and the mode is 'less_than_or_equal' (the "
 		"default mode), then the pose is rejected.  Allowed modes are: 'greater_than', "
+		"'less_than', 'greater_than_or_equal', 'less_than_or_equal', 'equal', and 'not_equal'.  Only allowed if "
+		"\"named_value\" is provided.",
+		"less_than_or_equal"
+		)
+		+ utility::tag::XMLSchemaAttribute::attribute_w_default(
+		"combine_criteria", xs_string, "If more than one criterion is provided, should a pose pass only if all "
+		"criteria pass ('and'), or if any criterion passes ('or')?  Criteria are evaluated in the order given, "
+		"and evaluation stops as soon as the outcome is known, so later values are not fetched from the EnsembleMetric "
+		"once an earlier criterion has decided the outcome.", "and"
+	);
+
+	AttributeList criterion_attlist;
+	criterion_attlist
+		+ utility::tag::XMLSchemaAttribute::required_attribute(
+		"named_value", xs_string, "A named floating-point value produced by the EnsembleMetric."
+		)
+		+ utility::tag::XMLSchemaAttribute::attribute_w_default(
+		"threshold", xsct_real, "The threshold for this criterion.", "0.0"
+		)
+		+ utility::tag::XMLSchemaAttribute::attribute_w_default(
+		"filter_acceptance_mode", xs_string, "The criterion for ACCEPTING a pose.  Allowed modes are: 'greater_than', "
 		"'less_than', 'greater_than_or_equal', 'less_than_or_equal', 'equal', and 'not_equal'.",
 		"less_than_or_equal"
 	);
 
-	protocols::filters::xsd_type_definition_w_attributes(
+	XMLSchemaSimpleSubelementList subelements;
+	subelements.add_simple_subelement( "Criterion", criterion_attlist, "An additional criterion for filtering, "
+		"on another value produced by the same EnsembleMetric.  Criteria are combined as specified by the "
+		"'combine_criteria' option."
+	);
+
+	protocols::filters::xsd_type_definition_w_attributes_and_repeatable_subelements(
 		xsd,
 		class_name(),
-		"A filter that filters based on some named float-valued property measured by an EnsembleMetric.  "
-		"Note that the value produced by the EnsembleMetric is based on an ensemble generated earlier in "
-		"the protocol, presumably from the pose on which we are currently filtering.",
-		attlist
+		"A filter that filters based on some named float-valued property (or properties) measured by an "
+		"EnsembleMetric.  Note that the value produced by the EnsembleMetric is based on an ensemble generated "
+		"earlier in the protocol, presumably from the pose on which we are currently filtering.",
+		attlist,
+		subelements
 	);
 }
 
@@ -43,10 +43,15 @@
 
 // Core headers
 #include <core/pose/Pose.fwd.hh>
+#include <core/types.hh>
 
 // Basic/Utility headers
 #include <basic/datacache/DataMap.fwd.hh>
 #include <basic/citation_manager/CitationCollectionBase.fwd.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <atomic>
 
 namespace protocols {
 namespace ensemble_metrics {
@@ -71,12 +76,46 @@ acceptance_mode_string_from_enum( EnsembleFilterAcceptanceMode const mode );
 EnsembleFilterAcceptanceMode
 acceptance_mode_enum_from_string( std::string const & mode_name );
 
+/// @brief How the filter combines the results of several criteria.
+enum class EnsembleFilterCombinationMode {
+	AND = 1, //Keep first
+	OR, //Keep second-to-last
+	N_MODES = OR //Keep last.
+};
+
+/// @brief Given the filter's combination mode enum, get the corresponding string.
+std::string
+combination_mode_string_from_enum( EnsembleFilterCombinationMode const mode );
+
+/// @brief Given the filter's combination mode string, get the corresponding enum.
+EnsembleFilterCombinationMode
+combination_mode_enum_from_string( std::string const & mode_name );
+
+/// @brief A single criterion for the EnsembleFilter: a named value produced by the EnsembleMetric, a threshold,
+/// and the comparison that must hold between them for a pose to pass.
+struct EnsembleFilterCriterion {
+
+	/// @brief The name of the value produced by the EnsembleMetric.
+	std::string named_value;
+
+	/// @brief The criterion for ACCEPTING a pose.
+	EnsembleFilterAcceptanceMode acceptance_mode = EnsembleFilterAcceptanceMode::LESS_THAN_EQ;
+
+	/// @brief The cutoff threshold.
+	core::Real threshold = 0.0;
+
+};
+
 ///@brief A filter that filters based on some named float-valued property measured by an EnsembleMetric.
 class EnsembleFilter : public protocols::filters::Filter {
 
 public:
 	EnsembleFilter();
 
+	/// @brief Copy constructor.
+	/// @details Has to be explicit because std::atomic has a deleted copy constructor.
+	EnsembleFilter( EnsembleFilter const & src );
+
 	// destructor (important for properly forward-declaring smart-pointer members)
 	~EnsembleFilter() override;
 
@@ -85,6 +124,7 @@ public:
 	apply( core::pose::Pose const & pose ) const override;
 
 	/// @brief required for reporting score values
+	/// @details Reports the value for the first criterion.
 	core::Real
 	report_sm( core::pose::Pose const & pose ) const override;
 
@@ -120,8 +160,9 @@ public:
 	/// @brief This filter is unpublished.  It returns Vikram K. Mulligan as its author.
 	void provide_citation_info( basic::citation_manager::CitationCollectionList & ) const override;
 
-	/// @brief Confirm that this filter has been properly configured prior to filtering with it.
-	/// @details Throws if it has not.
+	/// @brief Confirm that this filter has been properly configured prior to filtering with it, and
+	/// finalize the ensemble metric if it has not yet been finalized.
+	/// @details Throws if it has not.  The result is cached: see ensure_validated().
 	void validate_my_configuration() const;
 
 public: //Setters
@@ -133,29 +174,55 @@ public: //Setters
 	);
 
 	/// @brief Set the name of the value produced by the EnsembleMetric and used for filtering.
+	/// @details Applies to the first criterion.
 	void
 	set_named_value(
 		std::string const & setting
 	);
 
 	/// @brief Set the cutoff threshold for filtering.
+	/// @details Applies to the first criterion.
 	void
 	set_threshold(
 		core::Real const setting
 	);
 
 	/// @brief Set the acceptance mode.
+	/// @details Applies to the first criterion.
 	void
 	set_acceptance_mode(
 		EnsembleFilterAcceptanceMode const setting
 	);
 
 	/// @brief Set the acceptance mode, by string.
+	/// @details Applies to the first criterion.
 	void
 	set_acceptance_mode(
 		std::string const & setting
 	);
 
+	/// @brief Add a criterion for filtering.
+	/// @details If the first criterion has not yet been given a named value, it is replaced by this one; otherwise,
+	/// this one is appended to the list.  Throws if the ensemble metric has been set and produces no such value.
+	void
+	add_criterion(
+		std::string const & named_value,
+		EnsembleFilterAcceptanceMode const acceptance_mode,
+		core::Real const threshold
+	);
+
+	/// @brief Set whether all criteria (AND) or any criterion (OR) must pass for a pose to pass.
+	void
+	set_combination_mode(
+		EnsembleFilterCombinationMode const setting
+	);
+
+	/// @brief Set whether all criteria (AND) or any criterion (OR) must pass for a pose to pass, by string.
+	void
+	set_combination_mode(
+		std::string const & setting
+	);
+
 public: //Getters
 
 	/// @brief Get the ensemble metric.
@@ -164,36 +231,90 @@ public: //Getters
 	ensemble_metric() const;
 
 	/// @brief Get the name of the value produced by the EnsembleMetric and used for filtering.
+	/// @details Applies to the first criterion.
 	std::string const &
 	named_value() const;
 
 	/// @brief Get the cutoff threshold for filtering.
+	/// @details Applies to the first criterion.
 	core::Real
 	threshold() const;
 
 	/// @brief Get the acceptance mode.
+	/// @details Applies to the first criterion.
 	EnsembleFilterAcceptanceMode
 	acceptance_mode() const;
 
+	/// @brief Get the list of criteria.  This always has at least one entry.
+	utility::vector1< EnsembleFilterCriterion > const &
+	criteria() const;
+
+	/// @brief Get whether all criteria (AND) or any criterion (OR) must pass for a pose to pass.
+	EnsembleFilterCombinationMode
+	combination_mode() const;
+
 private: //Functions
 
-	/// @brief Given a value, determine if it's greater than, less than, or equal to the threshold.
-	/// Return pass (true) or fail (false) based on the acceptance mode.
-	bool value_passes( core::Real const value ) const;
+	/// @brief Given a value, determine if it's greater than, less than, or equal to a criterion's threshold.
+	/// Return pass (true) or fail (false) based on the criterion's acceptance mode.
+	static
+	bool
+	value_passes(
+		EnsembleFilterCriterion const & criterion,
+		core::Real const value
+	);
+
+	/// @brief Validate the configuration if necessary, then evaluate the criteria in order, fetching each value
+	/// from the ensemble metric only when it is needed.
+	/// @details Stops as soon as the outcome is known.  On return, values holds the values of the criteria that
+	/// were evaluated, which are the first values.size() criteria.
+	bool
+	evaluate_criteria(
+		utility::vector1< core::Real > & values
+	) const;
+
+	/// @brief Write the values of the evaluated criteria, and whether the filter passes, to an output stream.
+	void
+	write_summary(
+		std::ostream & out,
+		utility::vector1< core::Real > const & values,
+		bool const passes
+	) const;
+
+	/// @brief If both the ensemble metric and the named value of a criterion have been set, look up the index of
+	/// the named value in the ensemble metric's list of real-valued metrics, so that filtering needs no string lookup.
+	/// @details Throws if the ensemble metric produces no such value.  Called by the setters.
+	void resolve_named_value_index( core::Size const criterion_index );
+
+	/// @brief Resolve the indices of the named values of all criteria.
+	void resolve_named_value_indices();
+
+	/// @brief Call validate_my_configuration() unless it has already been called for the current generation of
+	/// the ensemble metric.
+	/// @details Once validated, this costs one pointer dereference and one comparison.  Resetting the ensemble
+	/// metric advances its generation, so the next call validates (and finalizes) it again.
+	void ensure_validated() const;
 
 private:
 
 	/// @brief An ensemble metric that will be used for filtering.
 	protocols::ensemble_metrics::EnsembleMetricOP ensemble_metric_;
 
-	/// @brief The name of the value produced by the EnsembleMetric and used for filtering.
-	std::string named_value_;
+	/// @brief The criteria used for filtering.  There is always at least one.
+	utility::vector1< EnsembleFilterCriterion > criteria_ = { EnsembleFilterCriterion() };
+
+	/// @brief The index of each criterion's named value in the ensemble metric's real_valued_metric_names() list.
+	/// @details Resolved by the setters.  Zero if not yet resolved.
+	utility::vector1< core::Size > named_value_indices_ = { 0 };
 
-	/// @brief The cutoff threshold for filtering.
-	core::Real threshold_ = 0.0;
+	/// @brief Must all criteria pass, or any one?
+	EnsembleFilterCombinationMode combination_mode_ = EnsembleFilterCombinationMode::AND;
 
-	/// @brief Should we reject things over or under the threshold?
-	EnsembleFilterAcceptanceMode acceptance_mode_ = EnsembleFilterAcceptanceMode::LESS_THAN_EQ;
+	/// @brief The generation of the ensemble metric for which validate_my_configuration() last succeeded.
+	/// @details Zero if the current configuration has not been validated.  Cleared by the setters for the
+	/// ensemble metric and the named values.  Atomic, since const apply() calls from several threads may
+	/// validate concurrently.
+	mutable std::atomic< core::Size > validated_generation_{ 0 };
 
 };
 
@@ -44,6 +44,7 @@
 
 // Protocols headers
 #include <protocols/ensemble_metrics/util.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryIO.hh>
 
 // Basic headers
 #include <basic/Tracer.hh>
@@ -55,18 +56,14 @@
 #include <utility/pointer/memory.hh>
 
 // STL headers
-#include <numeric>
+#include <sstream>
+#include <algorithm>
 
 // XSD Includes
 #include <utility/tag/XMLSchemaGeneration.hh>
 #include <basic/citation_manager/UnpublishedModuleInfo.hh>
 #include <basic/citation_manager/CitationCollection.hh>
 
-#ifdef USEMPI
-#include <mpi.h>
-#include <type_traits>
-#endif
-
 #ifdef    SERIALIZATION
 // Utility serialization headers
 #include <utility/serialization/serialization.hh>
@@ -91,6 +88,24 @@ static utility::vector1< std::string > const metric_names_for_class{
 "min", "max", "range"
 };
 
+/// @brief Indices of the metrics in metric_names_for_class.  These must be kept in the same order as the list
+/// above.
+enum CentralTendencyMetricIndex : core::Size {
+	MEAN_INDEX = 1,
+	MEDIAN_INDEX,
+	MODE_INDEX,
+	STDDEV_INDEX,
+	STDERR_INDEX,
+	MIN_INDEX,
+	MAX_INDEX,
+	RANGE_INDEX
+};
+
+/// @brief Version of the data appended to a summary by this ensemble metric.  Increment this if the
+/// format changes.
+static std::uint8_t const summary_format_version( 1 );
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // CONSTRUCTION AND DESTRUCTION
 ////////////////////////////////////////////////////////////////////////////////
@@ -140,6 +155,14 @@ CentralTendencyEnsembleMetric::real_valued_metric_names() const {
 	return metric_names_for_class;
 }
 
+/// @brief Get the names of the values measured for each pose and passed to observers.
+/// @details The one value is named for the simple metric, if it is known.
+utility::vector1< std::string >
+CentralTendencyEnsembleMetric::per_pose_value_names() const {
+	std::string const simple_metric_name( measured_simple_metric_name() );
+	return utility::vector1< std::string >( 1, simple_metric_name.empty() ? "value" : simple_metric_name );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Virtual functions overrides of private pure virtual functions from base class.
 ////////////////////////////////////////////////////////////////////////////////
@@ -151,15 +174,19 @@ std::string
 CentralTendencyEnsembleMetric::produce_final_report_string() {
 	std::ostringstream ss;
 	finalize_values();
-	ss << "Computed values for " << simple_metric_->name() << " real-valued simple metric." << std::endl;
-	ss << "\tmean:\t" << mean_ << std::endl;
-	ss << "\tmedian:\t" << median_ << std::endl;
-	ss << "\tmode:\t" << mode_ << std::endl;
-	ss << "\tstddev:\t" << stddev_ << std::endl;
-	ss << "\tstderr:\t" << stderr_ << std::endl;
-	ss << "\tmin:\t" << min_ << std::endl;
-	ss << "\tmax:\t" << max_ << std::endl;
-	ss << "\trange:\t" << range_;
+	if ( !measured_simple_metric_name().empty() ) {
+		ss << "Computed values for " << measured_simple_metric_name() << " real-valued simple metric." << std::endl;
+	} else {
+		ss << "Computed values for directly-supplied values." << std::endl;
+	}
+	ss << "\tmean:\t" << statistics_.mean() << std::endl;
+	ss << "\tmedian:\t" << statistics_.median() << std::endl;
+	ss << "\tmode:\t" << statistics_.mode() << std::endl;
+	ss << "\tstddev:\t" << statistics_.stddev() << std::endl;
+	ss << "\tstderr:\t" << statistics_.stderror() << std::endl;
+	ss << "\tmin:\t" << statistics_.min() << std::endl;
+	ss << "\tmax:\t" << statistics_.max() << std::endl;
+	ss << "\trange:\t" << statistics_.range();
 	return ss.str();
 }
 
@@ -171,8 +198,10 @@ CentralTendencyEnsembleMetric::add_pose_to_ensemble(
 	core::pose::Pose const & pose
 ) {
 	runtime_assert_string_msg( simple_metric_ != nullptr, "Error in CentralTendencyEnsembleMetric::add_pose_to_ensemble(): A simple metric must be passed to this ensemble metric before it can be used on a set of poses." );
-	values_.push_back( simple_metric_->calculate(pose) );
-	TR << simple_metric_->name() << " simple metric reported value " << values_[values_.size()] << " for pose " << poses_in_ensemble() << "." << std::endl;
+	core::Real const value( simple_metric_->calculate(pose) );
+	statistics_.add_value( value );
+	notify_observers( current_attempt_index(), &value, 1 );
+	TR << simple_metric_->name() << " simple metric reported value " << value << " for pose " << poses_in_ensemble() << "." << std::endl;
 }
 
 /// @brief Given a metric name, get its value.
@@ -181,27 +210,42 @@ core::Real
 CentralTendencyEnsembleMetric::derived_get_real_metric_value_by_name(
 	std::string const & metric_name
 ) const {
-	debug_assert( metric_names_for_class.has_value( metric_name ) );
-
-	//Return the appropriate metric here given the name.
-	if ( metric_name == "mean" ) {
-		return mean_;
-	} else if ( metric_name == "median" ) {
-		return median_;
-	} else if ( metric_name == "mode" ) {
-		return mode_;
-	} else if ( metric_name == "stddev" ) {
-		return stddev_;
-	} else if ( metric_name == "stderr" ) {
-		return stderr_;
-	} else if ( metric_name == "min" ) {
-		return min_;
-	} else if ( metric_name == "max" ) {
-		return max_;
-	} else if ( metric_name == "range" ) {
-		return range_;
-	} else {
-		utility_exit_with_message( "Error in CentralTendencyEnsembleMetric::derived_get_real_metric_value_by_name(): \"" + metric_name + "\" is not a metric that the " + name() + " ensemble metric returns." );
+	core::Size index( 0 );
+	for ( core::Size i( 1 ), imax( metric_names_for_class.size() ); i <= imax; ++i ) {
+		if ( metric_names_for_class[i] == metric_name ) {
+			index = i;
+			break;
+		}
+	}
+	runtime_assert_string_msg( index != 0, "Error in CentralTendencyEnsembleMetric::derived_get_real_metric_value_by_name(): \"" + metric_name + "\" is not a metric that the " + name() + " ensemble metric returns." );
+	return derived_get_real_metric_value_by_index( index );
+}
+
+/// @brief Given the (one-based) index of a metric in real_valued_metric_names(), get its value without any
+/// string comparison.
+core::Real
+CentralTendencyEnsembleMetric::derived_get_real_metric_value_by_index(
+	core::Size const metric_index
+) const {
+	switch( metric_index ) {
+	case MEAN_INDEX :
+		return statistics_.mean();
+	case MEDIAN_INDEX :
+		return statistics_.median();
+	case MODE_INDEX :
+		return statistics_.mode();
+	case STDDEV_INDEX :
+		return statistics_.stddev();
+	case STDERR_INDEX :
+		return statistics_.stderror();
+	case MIN_INDEX :
+		return statistics_.min();
+	case MAX_INDEX :
+		return statistics_.max();
+	case RANGE_INDEX :
+		return statistics_.range();
+	default :
+		utility_exit_with_message( "Error in CentralTendencyEnsembleMetric::derived_get_real_metric_value_by_index(): Index " + std::to_string( metric_index ) + " does not correspond to a metric that the " + name() + " ensemble metric returns." );
 	}
 
 	return 0.0; //Keep older compilers happy.
@@ -218,11 +262,14 @@ CentralTendencyEnsembleMetric::get_derived_tracer() const {
 /// implemented by derived classes.
 void
 CentralTendencyEnsembleMetric::derived_reset() {
-	mean_ = median_ = mode_ = 0.0;
-	stddev_ = stderr_ = 0.0;
-	min_ = max_ = range_ = 0.0;
-	values_.clear();
-	derived_finalized_ = false;
+	statistics_.reset();
+}
+
+/// @brief Compute the statistics from the accumulated values without producing a text report, for machine-readable
+/// report formats.
+void
+CentralTendencyEnsembleMetric::finalize_real_valued_metrics() {
+	finalize_values();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -302,170 +349,182 @@ CentralTendencyEnsembleMetric::provide_citation_info(
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// PUBLIC MPI PARALLEL COMMUNICATION FUNCTIONS
+// RAW VALUE INGESTION FUNCTIONS
 ////////////////////////////////////////////////////////////////////////////////
 
-#ifdef USEMPI
-
-/// @brief Does this EnsembleMetric support MPI-based collection of ensemble properties from an ensemble
-/// sampled in a distributed manner?  Overrides base class and returns true.
-/// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
-/// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
-/// distributor will ensure that all of the distributed instances of an EnsembleMetric synchronously
-/// send their data to the master process EnsembleMetric instance, which receives it.  The base class
-/// function exits with an error, so any derived class that fails to override these functions cannot
-/// be used for MPI-distributed ensemble analysis.  To allow early catching of issues with EnsembleMetric
-/// derived classes that do not support MPI, the base class implements bool supports_mpi() as returning
-/// false, and derived classes must override this to return true if the derived class supports MPI.  This
-/// function is called by the parse_common_ensemble_metric_options() function if the configuration
-/// has been set for MPI-based collection at the end.
+/// @brief Returns true: this ensemble metric can accumulate raw per-pose values directly.
 bool
-CentralTendencyEnsembleMetric::supports_mpi() const {
+CentralTendencyEnsembleMetric::supports_raw_value_ingestion() const {
 	return true;
 }
 
-/// @brief Send all of the data collected by this EnsembleMetric to another node.  Overrides base class.
-/// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
-/// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
-/// distributor will ensure that all of the distributed instances of an EnsembleMetric synchronously
-/// send their data to the master process EnsembleMetric instance, which receives it.  The base class
-/// function exits with an error, so any derived class that fails to override these functions cannot
-/// be used for MPI-distributed ensemble analysis.  To allow early catching of issues with EnsembleMetric
-/// derived classes that do not support MPI, the base class implements bool supports_mpi() as returning
-/// false, and derived classes must override this to return true if the derived class supports MPI.  This
-/// function is called by the parse_common_ensemble_metric_options() function if the configuration
-/// has been set for MPI-based collection at the end.
-/// @note This will do one or more MPI_Send operations!  It is intended only to be called by callers that can
-/// guarantee synchronicity and which can avoid deadlock (e.g. the JD2 MPI job distributor)!
+/// @brief Accumulate a contiguous block of raw per-pose values.  Equivalent to add_values().
+/// @note Not threadsafe.  Do not call this concurrently with apply().
 void
-CentralTendencyEnsembleMetric::send_mpi_summary(
-	core::Size const receiving_node_index
-) const {
-	static_assert( std::is_same< double, core::Real >::value, "Compile-time error!  MPI communication requires that core::Real is defined as a double-precision float." ); //We're in trouble if someone has redefined Real.
-	static_assert( std::is_same< unsigned long int, core::Size >::value, "Compile-time error!  MPI communication requires that core::Size is defined as an unsigned long integer." );
-
-	//Note that we have to use int and double for MPI:
-	int const n_poses_seen( static_cast< int >( poses_in_ensemble() ) );
-	debug_assert(n_poses_seen >= 0 ); //Must be true.
-	runtime_assert( static_cast<core::Size>(n_poses_seen) == values_.size() ); //Should be true.
-
-	//Transmit the number of values:
-	MPI_Send( static_cast< const void * >( &n_poses_seen ), 1, MPI_INT, static_cast<int>(receiving_node_index), 0, MPI_COMM_WORLD );
-	//Transmit the array of values:
-	if( n_poses_seen > 0 ) {
-		MPI_Send( static_cast< const void * >( values_.data() ), n_poses_seen, MPI_DOUBLE, static_cast<int>(receiving_node_index), 0, MPI_COMM_WORLD );
-	}
+CentralTendencyEnsembleMetric::add_raw_values(
+	core::Real const * values,
+	core::Size const n_values
+) {
+	add_values( values, n_values );
 }
 
-/// @brief Receive all of the data collected by this EnsembleMetric on another node.  Overrides base class.
-/// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
-/// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
-/// distributor will ensure that all of the distributed instances of an EnsembleMetric synchronously
-/// send their data to the master process EnsembleMetric instance, which receives it.  The base class
-/// function exits with an error, so any derived class that fails to override these functions cannot
-/// be used for MPI-distributed ensemble analysis.  To allow early catching of issues with EnsembleMetric
-/// derived classes that do not support MPI, the base class implements bool supports_mpi() as returning
-/// false, and derived classes must override this to return true if the derived class supports MPI.  This
-/// function is called by the parse_common_ensemble_metric_options() function if the configuration
-/// has been set for MPI-based collection at the end.
-/// @returns Originating process index that generated the data that this process received.
-/// @note This will do one or more MPI_Recv operations!  It is intended only to be called by callers that can
-/// guarantee synchronicity and which can avoid deadlock (e.g. the JD2 MPI job distributor)!
-core::Size
-CentralTendencyEnsembleMetric::recv_mpi_summary() {
-	static_assert( std::is_same< double, core::Real >::value, "Compile-time error!  MPI communication requires that core::Real is defined as a double-precision float." ); //We're in trouble if someone has redefined Real.
-	static_assert( std::is_same< unsigned long int, core::Size >::value, "Compile-time error!  MPI communication requires that core::Real is defined as a double-precision float." );
+/// @brief Pre-allocate storage for n_values more values.
+void
+CentralTendencyEnsembleMetric::reserve_raw_values(
+	core::Size const n_values
+) {
+	statistics_.reserve( statistics_.n_values() + n_values );
+}
 
-	//Note that we have to use int and double for MPI:
-	int n_additional_poses(-1);
+////////////////////////////////////////////////////////////////////////////////
+// RAW SAMPLE ACCESS FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
 
-	//Status object:
-	MPI_Status mystatus;
-	int originating_proc(-1);
+/// @brief Returns true: this ensemble metric can expose the values that it has accumulated.
+bool
+CentralTendencyEnsembleMetric::supports_raw_sample_access() const {
+	return true;
+}
 
-	//Receive the number of values:
-	MPI_Recv( static_cast< void * >( &n_additional_poses ), 1, MPI_INT, MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &mystatus);
+/// @brief Get a read-only view of the values accumulated so far, one per pose, in the order in which they were
+/// added, pointing directly into the statistics engine's storage.
+/// @details Finalization does not reorder the values.  The view is invalidated by adding values, merging, or
+/// resetting.
+/// @note Not threadsafe.  Do not call this concurrently with apply().
+EnsembleMetricSampleSpan
+CentralTendencyEnsembleMetric::raw_samples() const {
+	return EnsembleMetricSampleSpan( statistics_.values().data(), statistics_.n_values(), 1 );
+}
 
-	//Check what we've got:
-	runtime_assert( n_additional_poses >= 0 );
-	originating_proc = mystatus.MPI_SOURCE; //The node that sent the message.
-	runtime_assert( originating_proc >= 0 );
-	if( n_additional_poses == 0 ) return static_cast< core::Size >( originating_proc );
+////////////////////////////////////////////////////////////////////////////////
+// SUMMARY FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
 
-	//Allocate storage for what we're about to receive.
-	core::Size const oldsize( values_.size() );
-	values_.resize( oldsize + n_additional_poses );
+/// @brief Can the data accumulated by this EnsembleMetric be packed into a flat summary and merged into
+/// another instance?  Overrides base class and returns true.
+bool
+CentralTendencyEnsembleMetric::supports_summary_merging() const {
+	return true;
+}
 
-	//From the same process, receive the list of values.
-	MPI_Recv( static_cast< void * >( values_.data() + oldsize ), n_additional_poses, MPI_DOUBLE, originating_proc, 0, MPI_COMM_WORLD, &mystatus);
-	runtime_assert( mystatus.MPI_SOURCE == originating_proc ); //Should be true.
+/// @brief Can this EnsembleMetric pack only the data accumulated since the last delta?  Overrides base class
+/// and returns true.
+bool
+CentralTendencyEnsembleMetric::supports_summary_deltas() const {
+	return true;
+}
 
-	//Update the number of poses we've seen:
-	increment_poses_in_ensemble( static_cast< core::Size >( n_additional_poses ) );
+/// @brief Can the data accumulated by another CentralTendencyEnsembleMetric be merged into this one?  Overrides
+/// base class and returns true.
+bool
+CentralTendencyEnsembleMetric::supports_ensemble_metric_data_merging() const {
+	return true;
+}
 
-	//Return the index of the originating proc:
-	return static_cast< core::Size >( originating_proc );
+/// @brief Append the values accumulated so far to a summary.  Overrides base class.
+/// @details Also records the name of the simple metric, if any, so that summaries from instances measuring
+/// different things cannot be merged by mistake.
+void
+CentralTendencyEnsembleMetric::derived_pack_summary(
+	protocols::ensemble_metrics::EnsembleMetricSummaryWriter & writer
+) const {
+	pack_values_into_summary( writer, 0 );
 }
 
-#endif //USEMPI
+/// @brief Append the values from a summary produced by another instance to the values accumulated so far.
+/// Overrides base class.
+void
+CentralTendencyEnsembleMetric::derived_merge_summary(
+	protocols::ensemble_metrics::EnsembleMetricSummaryReader & reader,
+	core::Size const n_additional_poses
+) {
+	std::string const errmsg( "Error in CentralTendencyEnsembleMetric::derived_merge_summary(): " );
+	std::uint8_t const version( reader.read< std::uint8_t >() );
+	runtime_assert_string_msg( version == summary_format_version, errmsg + "Unsupported summary format version " + std::to_string( static_cast< int >( version ) ) + "." );
+	std::string const simple_metric_name( reader.read_string() );
+	std::string const my_simple_metric_name( measured_simple_metric_name() );
+	runtime_assert_string_msg(
+		my_simple_metric_name.empty() || simple_metric_name.empty() || simple_metric_name == my_simple_metric_name,
+		errmsg + "A summary of values from the " + simple_metric_name + " simple metric cannot be merged into an ensemble metric measuring the " + my_simple_metric_name + " simple metric."
+	);
+	if ( my_simple_metric_name.empty() ) {
+		simple_metric_name_from_summaries_ = simple_metric_name;
+	}
+	core::Size const n_values( reader.read_real_array_count() );
+	runtime_assert_string_msg( n_values == n_additional_poses, errmsg + "The number of values in the summary does not match the number of poses that it represents." );
+	reader.read_real_array_values( statistics_.extend_storage( n_values ), n_values );
+}
+
+/// @brief Append the values for all but the first n_poses_already_packed poses to a summary.  Overrides
+/// base class.
+void
+CentralTendencyEnsembleMetric::derived_pack_summary_delta(
+	protocols::ensemble_metrics::EnsembleMetricSummaryWriter & writer,
+	core::Size const n_poses_already_packed
+) const {
+	pack_values_into_summary( writer, n_poses_already_packed );
+}
+
+/// @brief Append the values accumulated by another CentralTendencyEnsembleMetric to the values accumulated
+/// so far.  Overrides base class.
+void
+CentralTendencyEnsembleMetric::derived_merge_ensemble_metric_data(
+	protocols::ensemble_metrics::EnsembleMetric const & other
+) {
+	std::string const errmsg( "Error in CentralTendencyEnsembleMetric::derived_merge_ensemble_metric_data(): " );
+	CentralTendencyEnsembleMetric const * other_ct( dynamic_cast< CentralTendencyEnsembleMetric const * >( &other ) );
+	runtime_assert_string_msg( other_ct != nullptr, errmsg + "The other ensemble metric is not a CentralTendencyEnsembleMetric." );
+	std::string const my_simple_metric_name( measured_simple_metric_name() );
+	std::string const other_simple_metric_name( other_ct->measured_simple_metric_name() );
+	runtime_assert_string_msg(
+		my_simple_metric_name.empty() || other_simple_metric_name.empty() || other_simple_metric_name == my_simple_metric_name,
+		errmsg + "Values from the " + other_simple_metric_name + " simple metric cannot be merged into an ensemble metric measuring the " + my_simple_metric_name + " simple metric."
+	);
+	if ( my_simple_metric_name.empty() ) {
+		simple_metric_name_from_summaries_ = other_simple_metric_name;
+	}
+	core::Size const n_values( other_ct->statistics_.n_values() );
+	if ( n_values == 0 ) return;
+	core::Real const * const source( other_ct->statistics_.values().data() );
+	std::copy( source, source + n_values, statistics_.extend_storage( n_values ) );
+}
+
+/// @brief The name of the simple metric whose values are accumulated: that of simple_metric_ if set, or else that
+/// recorded in merged summaries (e.g. when merging saved states without the original script).  Empty if unknown.
+std::string
+CentralTendencyEnsembleMetric::measured_simple_metric_name() const {
+	return simple_metric_ == nullptr ? simple_metric_name_from_summaries_ : simple_metric_->name();
+}
+
+/// @brief Append the values from index first_value_index onward to a summary, in the format read by
+/// derived_merge_summary().
+void
+CentralTendencyEnsembleMetric::pack_values_into_summary(
+	protocols::ensemble_metrics::EnsembleMetricSummaryWriter & writer,
+	core::Size const first_value_index
+) const {
+	runtime_assert( first_value_index <= statistics_.n_values() ); //Should be true.
+	core::Size const n_values( statistics_.n_values() - first_value_index );
+	std::string const simple_metric_name( measured_simple_metric_name() );
+	writer.reserve_additional( sizeof( std::uint8_t ) + 2 * sizeof( std::uint64_t ) + simple_metric_name.size() + n_values * sizeof( core::Real ) );
+	writer.write< std::uint8_t >( summary_format_version );
+	writer.write_string( simple_metric_name );
+	writer.write_real_array( statistics_.values().data() + first_value_index, n_values );
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 // Private functions for this subclass
 ////////////////////////////////////////////////////////////////////////////////
 
 /// @brief At the end of accumulation and start of reporting, finalize the values.
+/// @details The statistics themselves are computed by the pose-independent CentralTendencyStatistics
+/// object; this just checks that the ensemble is consistent and non-empty.
 void
 CentralTendencyEnsembleMetric::finalize_values() {
-	if ( derived_finalized_ ) return;
-	derived_finalized_ = true;
-	debug_assert( poses_in_ensemble() == values_.size() ); // Should be true.
+	if ( statistics_.finalized() ) return;
+	debug_assert( poses_in_ensemble() == statistics_.n_values() ); // Should be true.
 	runtime_assert_string_msg( poses_in_ensemble() > 0, "Error in CentralTendencyEnsembleMetric::finalize_values(): At least one pose must be seen before ensemble properties can be calculated." );
-
-	// Mean:
-	mean_ = std::accumulate( values_.begin(), values_.end(), 0.0 ) / static_cast< core::Real >( poses_in_ensemble() );
-
-	// Median, min, max, range:
-	utility::vector1< core::Real > values_sorted = values_;
-	std::sort( values_sorted.begin(), values_sorted.end() );
-	if ( values_sorted.size() % 2 == 0 ) {
-		core::Size const pos( values_sorted.size() / 2 );
-		median_ = (values_sorted[pos] + values_sorted[pos+1]) / 2.0;
-	} else {
-		median_ = values_sorted[ values_sorted.size() / 2 + 1 ];
-	}
-	min_ = values_sorted[1];
-	max_ = values_sorted[values_sorted.size()];
-	range_ = max_ - min_;
-
-	// Mode, StdDev, StdErr:
-	std::map< core::Real, core::Size > counts;
-	core::Real accumulator( 0.0 );
-	for ( core::Size i(1), imax(values_.size()); i<=imax; ++i ) {
-		core::Real const curval( values_[i]);
-		accumulator += std::pow( curval - mean_, 2 );
-		if ( counts.count( curval ) == 0 ) {
-			counts[curval] = 1;
-		} else {
-			counts[curval] += 1;
-		}
-	}
-	accumulator /= static_cast< core::Real >( values_.size() );
-	stddev_ = std::sqrt( accumulator );
-	stderr_ = stddev_ / std::sqrt( static_cast< core::Real >( values_.size() ) );
-	core::Real accumulator2(0.0);
-	core::Size maxsize( 0 );
-	core::Size maxsize_counter( 0 );
-	for ( std::map< core::Real, core::Size >::const_iterator it( counts.begin() ); it != counts.end(); ++it ) {
-		if ( it->second > maxsize ) {
-			accumulator2 = it->first;
-			maxsize_counter = 1;
-			maxsize = it->second;
-		} else if ( it->second == maxsize ) {
-			accumulator2 += it->first;
-			++maxsize_counter;
-		}
-	}
-	mode_ = accumulator2 / static_cast< core::Real >(maxsize_counter);
+	statistics_.finalize();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -481,12 +540,57 @@ CentralTendencyEnsembleMetric::set_real_metric(
 	simple_metric_ = metric_in;
 }
 
+/// @brief Add a single value to the ensemble directly, without computing it from a pose.
+/// @details Counts as one pose in the ensemble.  This allows offline data, tests, or benchmarks
+/// to feed the statistics without constructing poses.  No simple metric need be set.
+/// @note Not threadsafe.  Do not call this concurrently with apply().
+void
+CentralTendencyEnsembleMetric::add_value(
+	core::Real const value
+) {
+	runtime_assert_string_msg( !finalized(), "Error in CentralTendencyEnsembleMetric::add_value(): The " + name() + " ensemble metric has already been finalized.  The reset() function must be called before accumulating more data." );
+	statistics_.add_value( value );
+	increment_poses_in_ensemble( 1 );
+	notify_observers( poses_in_ensemble(), &value, 1 );
+}
+
+/// @brief Add a contiguous block of values to the ensemble directly, without computing them
+/// from poses.
+/// @details Counts as n_values poses in the ensemble.  The block is appended with a single copy.
+/// @note Not threadsafe.  Do not call this concurrently with apply().
+void
+CentralTendencyEnsembleMetric::add_values(
+	core::Real const * values,
+	core::Size const n_values
+) {
+	runtime_assert_string_msg( !finalized(), "Error in CentralTendencyEnsembleMetric::add_values(): The " + name() + " ensemble metric has already been finalized.  The reset() function must be called before accumulating more data." );
+	core::Size const first_index( poses_in_ensemble() + 1 );
+	statistics_.add_values( values, n_values );
+	increment_poses_in_ensemble( n_values );
+	if ( n_observers() > 0 ) {
+		for ( core::Size i(0); i<n_values; ++i ) {
+			notify_observers( first_index + i, values + i, 1 );
+		}
+	}
+}
+
+/// @brief Add all of the values in a vector to the ensemble directly, without computing them
+/// from poses.
+/// @details Counts as values.size() poses in the ensemble.
+/// @note Not threadsafe.  Do not call this concurrently with apply().
+void
+CentralTendencyEnsembleMetric::add_values(
+	utility::vector1< core::Real > const & values
+) {
+	add_values( values.data(), values.size() );
+}
+
 /// @brief The mean.
 /// @details Must be finalized first!
 core::Real
 CentralTendencyEnsembleMetric::mean() const {
 	runtime_assert_string_msg( finalized(), "Error in CentralTendencyEnsembleMetric::mean(): The CentralTendencyEnsembleMetric has not been finalized!" );
-	return mean_;
+	return statistics_.mean();
 }
 
 /// @brief The median.
@@ -494,7 +598,7 @@ CentralTendencyEnsembleMetric::mean() const {
 core::Real
 CentralTendencyEnsembleMetric::median() const {
 	runtime_assert_string_msg( finalized(), "Error in CentralTendencyEnsembleMetric::median(): The CentralTendencyEnsembleMetric has not been finalized!" );
-	return median_;
+	return statistics_.median();
 }
 
 /// @brief The mode.
@@ -502,7 +606,7 @@ CentralTendencyEnsembleMetric::median() const {
 core::Real
 CentralTendencyEnsembleMetric::mode() const {
 	runtime_assert_string_msg( finalized(), "Error in CentralTendencyEnsembleMetric::mode(): The CentralTendencyEnsembleMetric has not been finalized!" );
-	return mode_;
+	return statistics_.mode();
 }
 
 /// @brief The standard deviation of the mean.
@@ -510,7 +614,7 @@ CentralTendencyEnsembleMetric::mode() const {
 core::Real
 CentralTendencyEnsembleMetric::stddev() const {
 	runtime_assert_string_msg( finalized(), "Error in CentralTendencyEnsembleMetric::stddev(): The CentralTendencyEnsembleMetric has not been finalized!" );
-	return stddev_;
+	return statistics_.stddev();
 }
 
 /// @brief The standard error of the mean.
@@ -518,7 +622,7 @@ CentralTendencyEnsembleMetric::stddev() const {
 core::Real
 CentralTendencyEnsembleMetric::stderror() const {
 	runtime_assert_string_msg( finalized(), "Error in CentralTendencyEnsembleMetric::stderror(): The CentralTendencyEnsembleMetric has not been finalized!" );
-	return stderr_;
+	return statistics_.stderror();
 }
 
 /// @brief The minimum value.
@@ -526,7 +630,7 @@ CentralTendencyEnsembleMetric::stderror() const {
 core::Real
 CentralTendencyEnsembleMetric::min() const {
 	runtime_assert_string_msg( finalized(), "Error in CentralTendencyEnsembleMetric::min(): The CentralTendencyEnsembleMetric has not been finalized!" );
-	return min_;
+	return statistics_.min();
 }
 
 /// @brief The maximum value.
@@ -534,7 +638,7 @@ CentralTendencyEnsembleMetric::min() const {
 core::Real
 CentralTendencyEnsembleMetric::max() const {
 	runtime_assert_string_msg( finalized(), "Error in CentralTendencyEnsembleMetric::max(): The CentralTendencyEnsembleMetric has not been finalized!" );
-	return max_;
+	return statistics_.max();
 }
 
 /// @brief The range of values.
@@ -542,7 +646,7 @@ CentralTendencyEnsembleMetric::max() const {
 core::Real
 CentralTendencyEnsembleMetric::range() const {
 	runtime_assert_string_msg( finalized(), "Error in CentralTendencyEnsembleMetric::range(): The CentralTendencyEnsembleMetric has not been finalized!" );
-	return range_;
+	return statistics_.range();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -577,16 +681,8 @@ void
 protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric::save( Archive & arc ) const {
 	arc( cereal::base_class< protocols::ensemble_metrics::EnsembleMetric >( this ) );
 	arc( CEREAL_NVP( simple_metric_ ) );
-	arc( CEREAL_NVP( values_ ) );
-	arc( CEREAL_NVP( mean_ ) );
-	arc( CEREAL_NVP( median_ ) );
-	arc( CEREAL_NVP( mode_ ) );
-	arc( CEREAL_NVP( stderr_ ) );
-	arc( CEREAL_NVP( stddev_ ) );
-	arc( CEREAL_NVP( min_ ) );
-	arc( CEREAL_NVP( max_ ) );
-	arc( CEREAL_NVP( range_ ) );
-	arc( CEREAL_NVP( derived_finalized_ ) );
+	arc( CEREAL_NVP( simple_metric_name_from_summaries_ ) );
+	arc( CEREAL_NVP( statistics_ ) );
 }
 
 template< class Archive >
@@ -594,16 +690,8 @@ void
 protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric::load( Archive & arc ) {
 	arc( cereal::base_class< protocols::ensemble_metrics::EnsembleMetric >( this ) );
 	arc( simple_metric_ );
-	arc( values_ );
-	arc( mean_ );
-	arc( median_ );
-	arc( mode_ );
-	arc( stderr_ );
-	arc( stddev_ );
-	arc( min_ );
-	arc( max_ );
-	arc( range_ );
-	arc( derived_finalized_ );
+	arc( simple_metric_name_from_summaries_ );
+	arc( statistics_ );
 }
 
 SAVE_AND_LOAD_SERIALIZABLE( protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric );
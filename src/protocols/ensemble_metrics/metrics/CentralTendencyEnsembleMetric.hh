@@ -38,6 +38,7 @@
 
 // Unit headers
 #include <protocols/ensemble_metrics/metrics/CentralTendencyEnsembleMetric.fwd.hh>
+#include <protocols/ensemble_metrics/metrics/CentralTendencyStatistics.hh>
 #include <protocols/ensemble_metrics/EnsembleMetric.hh>
 
 // Utility headers
@@ -92,6 +93,11 @@ public: // Virtual functions overrides of public pure virtual functions from bas
 	utility::vector1< std::string > const &
 	real_valued_metric_names() const override;
 
+	/// @brief Get the names of the values measured for each pose and passed to observers.
+	/// @details The one value is named for the simple metric, if it is known.
+	utility::vector1< std::string >
+	per_pose_value_names() const override;
+
 private: // Virtual functions overrides of private pure virtual functions from base class.
 
 	/// @brief Write the final report produced by this metric to a string.
@@ -115,6 +121,13 @@ private: // Virtual functions overrides of private pure virtual functions from b
 		std::string const & metric_name
 	) const override;
 
+	/// @brief Given the (one-based) index of a metric in real_valued_metric_names(), get its value without any
+	/// string comparison.
+	core::Real
+	derived_get_real_metric_value_by_index(
+		core::Size const metric_index
+	) const override;
+
 	/// @brief Get the tracer for a derived class.
 	/// @details Must be implemented for each derived class.
 	basic::Tracer &
@@ -125,6 +138,11 @@ private: // Virtual functions overrides of private pure virtual functions from b
 	void
 	derived_reset() override;
 
+	/// @brief Compute the statistics from the accumulated values without producing a text report, for machine-readable
+	/// report formats.
+	void
+	finalize_real_valued_metrics() override;
+
 public: // RosettaScripts functions
 
 	/// @brief Parse XML setup.
@@ -156,56 +174,92 @@ public: // Citation manager functions
 		basic::citation_manager::CitationCollectionList & citations
 	) const override;
 
-public: // MPI functions
-
-#ifdef USEMPI
-
-	/// @brief Does this EnsembleMetric support MPI-based collection of ensemble properties from an ensemble
-	/// sampled in a distributed manner?  Overrides base class and returns true.
-	/// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
-	/// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
-	/// distributor will ensure that all of the distributed instances of an EnsembleMetric synchronously
-	/// send their data to the master process EnsembleMetric instance, which receives it.  The base class
-	/// function exits with an error, so any derived class that fails to override these functions cannot
-	/// be used for MPI-distributed ensemble analysis.  To allow early catching of issues with EnsembleMetric
-	/// derived classes that do not support MPI, the base class implements bool supports_mpi() as returning
-	/// false, and derived classes must override this to return true if the derived class supports MPI.  This
-	/// function is called by the parse_common_ensemble_metric_options() function if the configuration
-	/// has been set for MPI-based collection at the end.
-	bool supports_mpi() const override;
-
-	/// @brief Send all of the data collected by this EnsembleMetric to another node.  Overrides base class.
-	/// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
-	/// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
-	/// distributor will ensure that all of the distributed instances of an EnsembleMetric synchronously
-	/// send their data to the master process EnsembleMetric instance, which receives it.  The base class
-	/// function exits with an error, so any derived class that fails to override these functions cannot
-	/// be used for MPI-distributed ensemble analysis.  To allow early catching of issues with EnsembleMetric
-	/// derived classes that do not support MPI, the base class implements bool supports_mpi() as returning
-	/// false, and derived classes must override this to return true if the derived class supports MPI.  This
-	/// function is called by the parse_common_ensemble_metric_options() function if the configuration
-	/// has been set for MPI-based collection at the end.
-	/// @note This will do one or more MPI_Send operations!  It is intended only to be called by callers that can
-	/// guarantee synchronicity and which can avoid deadlock (e.g. the JD2 MPI job distributor)!
-	void send_mpi_summary( core::Size const receiving_node_index ) const override;
-
-	/// @brief Receive all of the data collected by this EnsembleMetric on another node.  Overrides base class.
-	/// @details To collect results from many MPI processes at the end of a JD2 RosettaScripts run,
-	/// an EnsembleMetric must implement send_mpi_summary() and recv_mpi_summary().  The MPI JD2 job
-	/// distributor will ensure that all of the distributed instances of an EnsembleMetric synchronously
-	/// send their data to the master process EnsembleMetric instance, which receives it.  The base class
-	/// function exits with an error, so any derived class that fails to override these functions cannot
-	/// be used for MPI-distributed ensemble analysis.  To allow early catching of issues with EnsembleMetric
-	/// derived classes that do not support MPI, the base class implements bool supports_mpi() as returning
-	/// false, and derived classes must override this to return true if the derived class supports MPI.  This
-	/// function is called by the parse_common_ensemble_metric_options() function if the configuration
-	/// has been set for MPI-based collection at the end.
-	/// @returns Originating process index that generated the data that this process received.
-	/// @note This will do one or more MPI_Recv operations!  It is intended only to be called by callers that can
-	/// guarantee synchronicity and which can avoid deadlock (e.g. the JD2 MPI job distributor)!
-	core::Size recv_mpi_summary() override;
-
-#endif //USEMPI
+public: // Raw value ingestion functions
+
+	/// @brief Returns true: this ensemble metric can accumulate raw per-pose values directly.
+	bool supports_raw_value_ingestion() const override;
+
+	/// @brief Accumulate a contiguous block of raw per-pose values.  Equivalent to add_values().
+	/// @note Not threadsafe.  Do not call this concurrently with apply().
+	void
+	add_raw_values(
+		core::Real const * values,
+		core::Size const n_values
+	) override;
+
+	/// @brief Pre-allocate storage for n_values more values.
+	void reserve_raw_values( core::Size const n_values ) override;
+
+public: // Raw sample access functions
+
+	/// @brief Returns true: this ensemble metric can expose the values that it has accumulated.
+	bool supports_raw_sample_access() const override;
+
+	/// @brief Get a read-only view of the values accumulated so far, one per pose, in the order in which they were
+	/// added, pointing directly into the statistics engine's storage.
+	/// @details Finalization does not reorder the values.  The view is invalidated by adding values, merging, or
+	/// resetting.
+	/// @note Not threadsafe.  Do not call this concurrently with apply().
+	EnsembleMetricSampleSpan raw_samples() const override;
+
+public: // Summary functions
+
+	/// @brief Can the data accumulated by this EnsembleMetric be packed into a flat summary and merged into
+	/// another instance?  Overrides base class and returns true.
+	bool supports_summary_merging() const override;
+
+	/// @brief Can this EnsembleMetric pack only the data accumulated since the last delta?  Overrides base class
+	/// and returns true.
+	bool supports_summary_deltas() const override;
+
+	/// @brief Can the data accumulated by another CentralTendencyEnsembleMetric be merged into this one?  Overrides
+	/// base class and returns true.
+	bool supports_ensemble_metric_data_merging() const override;
+
+private: // Private summary functions
+
+	/// @brief Append the values accumulated so far to a summary.  Overrides base class.
+	/// @details Also records the name of the simple metric, if any, so that summaries from instances measuring
+	/// different things cannot be merged by mistake.
+	void
+	derived_pack_summary(
+		protocols::ensemble_metrics::EnsembleMetricSummaryWriter & writer
+	) const override;
+
+	/// @brief Append the values from a summary produced by another instance to the values accumulated so far.
+	/// Overrides base class.
+	void
+	derived_merge_summary(
+		protocols::ensemble_metrics::EnsembleMetricSummaryReader & reader,
+		core::Size const n_additional_poses
+	) override;
+
+	/// @brief Append the values for all but the first n_poses_already_packed poses to a summary.  Overrides
+	/// base class.
+	void
+	derived_pack_summary_delta(
+		protocols::ensemble_metrics::EnsembleMetricSummaryWriter & writer,
+		core::Size const n_poses_already_packed
+	) const override;
+
+	/// @brief Append the values accumulated by another CentralTendencyEnsembleMetric to the values accumulated
+	/// so far.  Overrides base class.
+	void
+	derived_merge_ensemble_metric_data(
+		protocols::ensemble_metrics::EnsembleMetric const & other
+	) override;
+
+	/// @brief The name of the simple metric whose values are accumulated: that of simple_metric_ if set, or else that
+	/// recorded in merged summaries (e.g. when merging saved states without the original script).  Empty if unknown.
+	std::string measured_simple_metric_name() const;
+
+	/// @brief Append the values from index first_value_index onward to a summary, in the format read by
+	/// derived_merge_summary().
+	void
+	pack_values_into_summary(
+		protocols::ensemble_metrics::EnsembleMetricSummaryWriter & writer,
+		core::Size const first_value_index
+	) const;
 
 private: // Private functions for this subclass.
 
@@ -221,6 +275,27 @@ public: // Public functions for this subclass.
 		core::simple_metrics::RealMetricCOP const & metric_in
 	);
 
+	/// @brief Add a single value to the ensemble directly, without computing it from a pose.
+	/// @details Counts as one pose in the ensemble.  This allows offline data, tests, or benchmarks
+	/// to feed the statistics without constructing poses.  No simple metric need be set.
+	/// @note Not threadsafe.  Do not call this concurrently with apply().
+	void add_value( core::Real const value );
+
+	/// @brief Add a contiguous block of values to the ensemble directly, without computing them
+	/// from poses.
+	/// @details Counts as n_values poses in the ensemble.  The block is appended with a single copy.
+	/// @note Not threadsafe.  Do not call this concurrently with apply().
+	void add_values( core::Real const * values, core::Size const n_values );
+
+	/// @brief Add all of the values in a vector to the ensemble directly, without computing them
+	/// from poses.
+	/// @details Counts as values.size() poses in the ensemble.
+	/// @note Not threadsafe.  Do not call this concurrently with apply().
+	void add_values( utility::vector1< core::Real > const & values );
+
+	/// @brief Read-only access to the pose-independent statistics engine.
+	inline CentralTendencyStatistics const & statistics() const { return statistics_; }
+
 	/// @brief The mean.
 	/// @details Must be finalized first!
 	core::Real mean() const;
@@ -258,35 +333,12 @@ private: // Private data
 	/// @brief The simple metric whose value we will be measuring.
 	core::simple_metrics::RealMetricCOP simple_metric_;
 
-	/// @brief The values that we have accumulated so far.
-	utility::vector1< core::Real > values_;
-
-	/// @brief The average (mean).
-	core::Real mean_ = 0.0;
-
-	/// @brief The median.
-	core::Real median_ = 0.0;
-
-	/// @brief The mode.
-	core::Real mode_ = 0.0;
-
-	/// @brief The standard error of the mean.
-	core::Real stderr_ = 0.0;
-
-	/// @brief The standard deviation of the mean.
-	core::Real stddev_ = 0.0;
-
-	/// @brief The min.
-	core::Real min_ = 0.0;
-
-	/// @brief The max.
-	core::Real max_ = 0.0;
-
-	/// @brief The range.
-	core::Real range_ = 0.0;
+	/// @brief The name of the simple metric recorded in merged summaries, if simple_metric_ is not set.
+	std::string simple_metric_name_from_summaries_;
 
-	/// @brief Have we already finalized the values?
-	bool derived_finalized_ = false;
+	/// @brief The values that we have accumulated so far, and the statistics computed
+	/// from them on finalization.
+	CentralTendencyStatistics statistics_;
 
 #ifdef    SERIALIZATION
 public:
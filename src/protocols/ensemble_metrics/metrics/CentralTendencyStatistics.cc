@@ -0,0 +1,362 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (CentralTendencyStatistics.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/metrics/CentralTendencyStatistics.cc
+/// @brief A pose-independent accumulator of real values that computes measures of central tendency
+/// (mean, median, mode) and other properties of the distribution (standard deviation, standard error
+/// of the mean, min, max, range).
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Unit headers
+#include <protocols/ensemble_metrics/metrics/CentralTendencyStatistics.hh>
+
+// Utility headers
+#include <utility/exit.hh>
+#include <utility/pointer/memory.hh>
+
+// STL headers
+#include <algorithm>
+#include <cmath>
+
+#ifdef    SERIALIZATION
+// Utility serialization headers
+#include <utility/serialization/serialization.hh>
+#include <utility/vector1.srlz.hh>
+
+// Cereal headers
+#include <cereal/types/polymorphic.hpp>
+#endif // SERIALIZATION
+
+namespace protocols {
+namespace ensemble_metrics {
+namespace metrics {
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Default constructor.
+CentralTendencyStatistics::CentralTendencyStatistics() = default;
+
+/// @brief Copy constructor.
+CentralTendencyStatistics::CentralTendencyStatistics( CentralTendencyStatistics const & ) = default;
+
+/// @brief Destructor.
+CentralTendencyStatistics::~CentralTendencyStatistics() = default;
+
+/// @brief Clone operation: make a copy of this object, and return an owning pointer to the copy.
+CentralTendencyStatisticsOP
+CentralTendencyStatistics::clone() const {
+	return utility::pointer::make_shared< CentralTendencyStatistics >( *this );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ACCUMULATION FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Add a single value.
+void
+CentralTendencyStatistics::add_value(
+	core::Real const value
+) {
+	check_not_finalized( "add_value" );
+	values_.push_back( value );
+}
+
+/// @brief Add a contiguous block of values.
+/// @details The values are appended with a single copy, with no per-value overhead.
+void
+CentralTendencyStatistics::add_values(
+	core::Real const * values,
+	core::Size const n_values
+) {
+	check_not_finalized( "add_values" );
+	if ( n_values == 0 ) return;
+	runtime_assert_string_msg( values != nullptr, "Error in CentralTendencyStatistics::add_values(): A null pointer was passed with a nonzero number of values." );
+	values_.insert( values_.end(), values, values + n_values );
+}
+
+/// @brief Add all of the values in a vector.
+void
+CentralTendencyStatistics::add_values(
+	utility::vector1< core::Real > const & values
+) {
+	add_values( values.data(), values.size() );
+}
+
+/// @brief Pre-allocate storage for the given total number of values.
+void
+CentralTendencyStatistics::reserve(
+	core::Size const total_n_values
+) {
+	values_.reserve( total_n_values );
+}
+
+/// @brief Grow storage by n_values entries, and return a pointer to the first new entry so that
+/// a caller (e.g. an MPI receive) can write values directly into place.
+/// @details The new entries are zero-initialized.  The pointer is invalidated by any subsequent
+/// call that adds values.
+core::Real *
+CentralTendencyStatistics::extend_storage(
+	core::Size const n_values
+) {
+	check_not_finalized( "extend_storage" );
+	core::Size const oldsize( values_.size() );
+	values_.resize( oldsize + n_values );
+	return values_.data() + oldsize;
+}
+
+/// @brief Discard all accumulated values and computed statistics.
+void
+CentralTendencyStatistics::reset() {
+	mean_ = median_ = mode_ = 0.0;
+	stddev_ = stderr_ = 0.0;
+	min_ = max_ = range_ = 0.0;
+	values_.clear();
+	finalized_ = false;
+}
+
+/// @brief Compute all statistics from the values accumulated so far.
+/// @details Does nothing if already finalized.  At least one value must have been added.
+/// @note This makes one pass over the unsorted data (for the mean), sorts a copy, and then
+/// makes one pass over the sorted copy to get the variance and the mode together.  Runs of
+/// identical values are contiguous after sorting, so no map of counts is needed.
+void
+CentralTendencyStatistics::finalize() {
+	if ( finalized_ ) return;
+	core::Size const nvals( values_.size() );
+	runtime_assert_string_msg( nvals > 0, "Error in CentralTendencyStatistics::finalize(): At least one value must be added before statistics can be calculated." );
+	core::Real const nvals_real( static_cast< core::Real >( nvals ) );
+
+	// Mean:
+	core::Real sum( 0.0 );
+	for ( core::Real const val : values_ ) {
+		sum += val;
+	}
+	mean_ = sum / nvals_real;
+
+	// Median, min, max, range:
+	utility::vector1< core::Real > values_sorted( values_ );
+	std::sort( values_sorted.begin(), values_sorted.end() );
+	if ( nvals % 2 == 0 ) {
+		core::Size const pos( nvals / 2 );
+		median_ = ( values_sorted[pos] + values_sorted[pos+1] ) / 2.0;
+	} else {
+		median_ = values_sorted[ nvals / 2 + 1 ];
+	}
+	min_ = values_sorted[1];
+	max_ = values_sorted[nvals];
+	range_ = max_ - min_;
+
+	// StdDev, StdErr, and mode, in one pass over the sorted values:
+	core::Real sum_sq_dev( 0.0 );
+	core::Real mode_accumulator( 0.0 );
+	core::Size mode_count( 0 ); //Length of the longest run seen so far.
+	core::Size mode_n_tied( 0 ); //Number of distinct values with a run of that length.
+	core::Size run_length( 0 );
+	for ( core::Size i(1); i<=nvals; ++i ) {
+		core::Real const curval( values_sorted[i] );
+		core::Real const dev( curval - mean_ );
+		sum_sq_dev += dev * dev;
+		++run_length;
+		if ( i == nvals || values_sorted[i+1] != curval ) {
+			if ( run_length > mode_count ) {
+				mode_count = run_length;
+				mode_accumulator = curval;
+				mode_n_tied = 1;
+			} else if ( run_length == mode_count ) {
+				mode_accumulator += curval;
+				++mode_n_tied;
+			}
+			run_length = 0;
+		}
+	}
+	stddev_ = std::sqrt( sum_sq_dev / nvals_real );
+	stderr_ = stddev_ / std::sqrt( nvals_real );
+	mode_ = mode_accumulator / static_cast< core::Real >( mode_n_tied );
+
+	finalized_ = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GETTERS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief The mean.
+/// @details Must be finalized first!
+core::Real
+CentralTendencyStatistics::mean() const {
+	check_finalized( "mean" );
+	return mean_;
+}
+
+/// @brief The median.
+/// @details Must be finalized first!
+core::Real
+CentralTendencyStatistics::median() const {
+	check_finalized( "median" );
+	return median_;
+}
+
+/// @brief The mode.
+/// @details Must be finalized first!  If several values are tied for most frequent, this
+/// is their average.
+core::Real
+CentralTendencyStatistics::mode() const {
+	check_finalized( "mode" );
+	return mode_;
+}
+
+/// @brief The standard deviation.
+/// @details Must be finalized first!
+core::Real
+CentralTendencyStatistics::stddev() const {
+	check_finalized( "stddev" );
+	return stddev_;
+}
+
+/// @brief The standard error of the mean.
+/// @details Must be finalized first!
+core::Real
+CentralTendencyStatistics::stderror() const {
+	check_finalized( "stderror" );
+	return stderr_;
+}
+
+/// @brief The minimum value.
+/// @details Must be finalized first!
+core::Real
+CentralTendencyStatistics::min() const {
+	check_finalized( "min" );
+	return min_;
+}
+
+/// @brief The maximum value.
+/// @details Must be finalized first!
+core::Real
+CentralTendencyStatistics::max() const {
+	check_finalized( "max" );
+	return max_;
+}
+
+/// @brief The range of values.
+/// @details Must be finalized first!
+core::Real
+CentralTendencyStatistics::range() const {
+	check_finalized( "range" );
+	return range_;
+}
+
+/// @brief The value below which the given fraction of the values lie (e.g. 0.95 for the 95th percentile),
+/// interpolating linearly between the nearest values.
+/// @details Need not be finalized, but at least one value must have been added.  Each call selects the quantile
+/// from a copy of the values in linear time, which makes it practical to compute quantiles not included in the
+/// report even for very large ensembles.
+core::Real
+CentralTendencyStatistics::quantile(
+	core::Real const fraction
+) const {
+	runtime_assert_string_msg( fraction >= 0.0 && fraction <= 1.0, "Error in CentralTendencyStatistics::quantile(): The fraction must be between 0 and 1." );
+	core::Size const nvals( values_.size() );
+	runtime_assert_string_msg( nvals > 0, "Error in CentralTendencyStatistics::quantile(): At least one value must be added before quantiles can be calculated." );
+
+	core::Real const position( fraction * static_cast< core::Real >( nvals - 1 ) );
+	core::Size const lower( static_cast< core::Size >( std::floor( position ) ) ); //Zero-based.
+	core::Real const weight( position - static_cast< core::Real >( lower ) );
+
+	utility::vector1< core::Real > values_copy( values_ );
+	utility::vector1< core::Real >::iterator const lower_it( values_copy.begin() + lower );
+	std::nth_element( values_copy.begin(), lower_it, values_copy.end() );
+	core::Real const lower_value( *lower_it );
+	if ( lower + 1 == nvals || weight == 0.0 ) return lower_value;
+	core::Real const upper_value( *std::min_element( lower_it + 1, values_copy.end() ) );
+	return lower_value + weight * ( upper_value - lower_value );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Throw an error if finalized.
+void
+CentralTendencyStatistics::check_not_finalized(
+	std::string const & function_name
+) const {
+	runtime_assert_string_msg( !finalized_, "Error in CentralTendencyStatistics::" + function_name + "(): The statistics have already been finalized.  The reset() function must be called before accumulating more values." );
+}
+
+/// @brief Throw an error if not finalized.
+void
+CentralTendencyStatistics::check_finalized(
+	std::string const & function_name
+) const {
+	runtime_assert_string_msg( finalized_, "Error in CentralTendencyStatistics::" + function_name + "(): The statistics have not been finalized!" );
+}
+
+} //metrics
+} //ensemble_metrics
+} //protocols
+
+#ifdef    SERIALIZATION
+
+template< class Archive >
+void
+protocols::ensemble_metrics::metrics::CentralTendencyStatistics::save( Archive & arc ) const {
+	arc( CEREAL_NVP( values_ ) );
+	arc( CEREAL_NVP( mean_ ) );
+	arc( CEREAL_NVP( median_ ) );
+	arc( CEREAL_NVP( mode_ ) );
+	arc( CEREAL_NVP( stderr_ ) );
+	arc( CEREAL_NVP( stddev_ ) );
+	arc( CEREAL_NVP( min_ ) );
+	arc( CEREAL_NVP( max_ ) );
+	arc( CEREAL_NVP( range_ ) );
+	arc( CEREAL_NVP( finalized_ ) );
+}
+
+template< class Archive >
+void
+protocols::ensemble_metrics::metrics::CentralTendencyStatistics::load( Archive & arc ) {
+	arc( values_ );
+	arc( mean_ );
+	arc( median_ );
+	arc( mode_ );
+	arc( stderr_ );
+	arc( stddev_ );
+	arc( min_ );
+	arc( max_ );
+	arc( range_ );
+	arc( finalized_ );
+}
+
+SAVE_AND_LOAD_SERIALIZABLE( protocols::ensemble_metrics::metrics::CentralTendencyStatistics );
+CEREAL_REGISTER_TYPE( protocols::ensemble_metrics::metrics::CentralTendencyStatistics )
+
+CEREAL_REGISTER_DYNAMIC_INIT( protocols_ensemble_metrics_metrics_CentralTendencyStatistics )
+#endif // SERIALIZATION
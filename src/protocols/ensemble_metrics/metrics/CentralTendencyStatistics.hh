@@ -0,0 +1,221 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (CentralTendencyStatistics.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/metrics/CentralTendencyStatistics.hh
+/// @brief A pose-independent accumulator of real values that computes measures of central tendency
+/// (mean, median, mode) and other properties of the distribution (standard deviation, standard error
+/// of the mean, min, max, range).
+/// @details This is the statistics engine used by the CentralTendencyEnsembleMetric.  It depends on
+/// nothing in core::pose, so it can be fed directly from offline data, unit tests, or benchmarks.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_metrics_CentralTendencyStatistics_HH
+#define INCLUDED_protocols_ensemble_metrics_metrics_CentralTendencyStatistics_HH
+
+// Unit headers
+#include <protocols/ensemble_metrics/metrics/CentralTendencyStatistics.fwd.hh>
+
+// Utility headers
+#include <utility/VirtualBase.hh>
+#include <utility/vector1.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// STL headers
+#include <string>
+
+#ifdef    SERIALIZATION
+// Cereal headers
+#include <cereal/types/polymorphic.fwd.hpp>
+#endif // SERIALIZATION
+
+namespace protocols {
+namespace ensemble_metrics {
+namespace metrics {
+
+/// @brief A pose-independent accumulator of real values that computes measures of central tendency
+/// (mean, median, mode) and other properties of the distribution (standard deviation, standard error
+/// of the mean, min, max, range).
+/// @details Values are accumulated with add_value() or add_values(), then finalize() is called once to
+/// compute all statistics.  Getters require that finalize() has been called.  Adding values after
+/// finalization is an error; call reset() first.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class CentralTendencyStatistics : public utility::VirtualBase {
+
+public:
+
+	/// @brief Default constructor.
+	CentralTendencyStatistics();
+
+	/// @brief Copy constructor.
+	CentralTendencyStatistics( CentralTendencyStatistics const & );
+
+	/// @brief Destructor.
+	~CentralTendencyStatistics() override;
+
+	/// @brief Clone operation: make a copy of this object, and return an owning pointer to the copy.
+	CentralTendencyStatisticsOP clone() const;
+
+public: // Accumulation functions
+
+	/// @brief Add a single value.
+	void add_value( core::Real const value );
+
+	/// @brief Add a contiguous block of values.
+	/// @details The values are appended with a single copy, with no per-value overhead.
+	void add_values( core::Real const * values, core::Size const n_values );
+
+	/// @brief Add all of the values in a vector.
+	void add_values( utility::vector1< core::Real > const & values );
+
+	/// @brief Pre-allocate storage for the given total number of values.
+	void reserve( core::Size const total_n_values );
+
+	/// @brief Grow storage by n_values entries, and return a pointer to the first new entry so that
+	/// a caller (e.g. an MPI receive) can write values directly into place.
+	/// @details The new entries are zero-initialized.  The pointer is invalidated by any subsequent
+	/// call that adds values.
+	core::Real * extend_storage( core::Size const n_values );
+
+	/// @brief Discard all accumulated values and computed statistics.
+	void reset();
+
+	/// @brief Compute all statistics from the values accumulated so far.
+	/// @details Does nothing if already finalized.  At least one value must have been added.
+	void finalize();
+
+public: // Getters
+
+	/// @brief Have the statistics been computed?
+	inline bool finalized() const { return finalized_; }
+
+	/// @brief The number of values accumulated so far.
+	inline core::Size n_values() const { return values_.size(); }
+
+	/// @brief Read-only access to the values accumulated so far, in the order in which they were added.
+	inline utility::vector1< core::Real > const & values() const { return values_; }
+
+	/// @brief The mean.
+	/// @details Must be finalized first!
+	core::Real mean() const;
+
+	/// @brief The median.
+	/// @details Must be finalized first!
+	core::Real median() const;
+
+	/// @brief The mode.
+	/// @details Must be finalized first!  If several values are tied for most frequent, this
+	/// is their average.
+	core::Real mode() const;
+
+	/// @brief The standard deviation.
+	/// @details Must be finalized first!
+	core::Real stddev() const;
+
+	/// @brief The standard error of the mean.
+	/// @details Must be finalized first!
+	core::Real stderror() const;
+
+	/// @brief The minimum value.
+	/// @details Must be finalized first!
+	core::Real min() const;
+
+	/// @brief The maximum value.
+	/// @details Must be finalized first!
+	core::Real max() const;
+
+	/// @brief The range of values.
+	/// @details Must be finalized first!
+	core::Real range() const;
+
+	/// @brief The value below which the given fraction of the values lie (e.g. 0.95 for the 95th percentile),
+	/// interpolating linearly between the nearest values.
+	/// @details Need not be finalized, but at least one value must have been added.  Each call selects the quantile
+	/// from a copy of the values in linear time, which makes it practical to compute quantiles not included in the
+	/// report even for very large ensembles.
+	core::Real quantile( core::Real const fraction ) const;
+
+private: // Private functions
+
+	/// @brief Throw an error if finalized.
+	void check_not_finalized( std::string const & function_name ) const;
+
+	/// @brief Throw an error if not finalized.
+	void check_finalized( std::string const & function_name ) const;
+
+private: // Private data
+
+	/// @brief The values that we have accumulated so far.
+	utility::vector1< core::Real > values_;
+
+	/// @brief The average (mean).
+	core::Real mean_ = 0.0;
+
+	/// @brief The median.
+	core::Real median_ = 0.0;
+
+	/// @brief The mode.
+	core::Real mode_ = 0.0;
+
+	/// @brief The standard error of the mean.
+	core::Real stderr_ = 0.0;
+
+	/// @brief The standard deviation.
+	core::Real stddev_ = 0.0;
+
+	/// @brief The min.
+	core::Real min_ = 0.0;
+
+	/// @brief The max.
+	core::Real max_ = 0.0;
+
+	/// @brief The range.
+	core::Real range_ = 0.0;
+
+	/// @brief Have we already finalized the values?
+	bool finalized_ = false;
+
+#ifdef    SERIALIZATION
+public:
+	template< class Archive > void save( Archive & arc ) const;
+	template< class Archive > void load( Archive & arc );
+#endif // SERIALIZATION
+
+};
+
+} //metrics
+} //ensemble_metrics
+} //protocols
+
+#ifdef    SERIALIZATION
+CEREAL_FORCE_DYNAMIC_INIT( protocols_ensemble_metrics_metrics_CentralTendencyStatistics )
+#endif // SERIALIZATION
+
+#endif //INCLUDED_protocols_ensemble_metrics_metrics_CentralTendencyStatistics_HH
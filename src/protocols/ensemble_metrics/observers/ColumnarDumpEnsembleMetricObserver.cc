@@ -0,0 +1,339 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (ColumnarDumpEnsembleMetricObserver.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/observers/ColumnarDumpEnsembleMetricObserver.cc
+/// @brief An EnsembleMetricObserver that streams each per-pose measurement to a compact, block-compressed,
+/// columnar binary file.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Unit headers
+#include <protocols/ensemble_metrics/observers/ColumnarDumpEnsembleMetricObserver.hh>
+
+// Protocols headers
+#include <protocols/ensemble_metrics/EnsembleMetric.hh>
+#include <protocols/jd2/util.hh>
+
+// Basic headers
+#include <basic/Tracer.hh>
+
+// Utility headers
+#include <utility/exit.hh>
+#include <utility/vector1.hh>
+#include <utility/pointer/memory.hh>
+
+// External headers
+#include <zlib/zlib.h>
+
+// STL headers
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <map>
+
+static basic::Tracer TR( "protocols.ensemble_metrics.observers.ColumnarDumpEnsembleMetricObserver" );
+
+namespace protocols {
+namespace ensemble_metrics {
+namespace observers {
+
+/// @brief The number of bytes needed to pad a payload of a given size to a multiple of eight bytes.
+static
+core::Size
+padding_bytes(
+	core::Size const payload_bytes
+) {
+	return ( 8 - payload_bytes % 8 ) % 8;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Constructor.
+/// @param[in] filename The file to write.  Overwritten if it exists.
+/// @param[in] block_records The number of records per block.  Must be nonzero.
+/// @param[in] compress If true, blocks are compressed with zlib (unless that would not make them smaller).
+/// Uncompressed files are larger, but can be used in place when memory-mapped.
+ColumnarDumpEnsembleMetricObserver::ColumnarDumpEnsembleMetricObserver(
+	std::string const & filename,
+	core::Size const block_records,
+	bool const compress
+) :
+	protocols::ensemble_metrics::EnsembleMetricObserver(),
+	filename_( filename ),
+	block_records_( block_records ),
+	compress_( compress )
+{
+	runtime_assert_string_msg( !filename_.empty(), "Error in ColumnarDumpEnsembleMetricObserver constructor: A filename must be provided." );
+	runtime_assert_string_msg( block_records_ > 0, "Error in ColumnarDumpEnsembleMetricObserver constructor: The number of records per block must be nonzero." );
+}
+
+/// @brief Destructor.  Writes any buffered records.
+ColumnarDumpEnsembleMetricObserver::~ColumnarDumpEnsembleMetricObserver() {
+	try {
+		flush();
+	} catch ( std::exception const & err ) {
+		TR.Error << "Could not write the last records to columnar dump file \"" << filename_ << "\": " << err.what() << std::endl;
+	}
+}
+
+/// @brief Get the observer that writes a file in this process, creating it if this is the first request for the file.
+/// @details Ensemble metrics that are parsed again for each job (with -jd2:share_ensemble_metrics_across_jobs false)
+/// thereby continue one file, with the records of each job marked by job index, rather than each truncating it.
+/// The observer is kept until the process exits.  If it already exists, block_records and compress are ignored.
+/// Threadsafe.
+ColumnarDumpEnsembleMetricObserverOP
+ColumnarDumpEnsembleMetricObserver::observer_for_file(
+	std::string const & filename,
+	core::Size const block_records,
+	bool const compress
+) {
+	static std::map< std::string, ColumnarDumpEnsembleMetricObserverOP > observers_by_file;
+#ifdef MULTI_THREADED
+	static std::mutex observers_by_file_mutex;
+	std::lock_guard< std::mutex > lock( observers_by_file_mutex );
+#endif //MULTI_THREADED
+	std::map< std::string, ColumnarDumpEnsembleMetricObserverOP >::const_iterator const it( observers_by_file.find( filename ) );
+	if ( it != observers_by_file.end() ) {
+		if ( it->second->block_records() != block_records || it->second->compress() != compress ) {
+			TR.Warning << "Columnar dump file \"" << filename << "\" is already being written with " << it->second->block_records() << " records per block and compression " << ( it->second->compress() ? "on" : "off" ) << ".  Keeping these settings." << std::endl;
+		}
+		return it->second;
+	}
+	ColumnarDumpEnsembleMetricObserverOP const observer( utility::pointer::make_shared< ColumnarDumpEnsembleMetricObserver >( filename, block_records, compress ) );
+	observers_by_file[ filename ] = observer;
+	return observer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OBSERVER FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Buffer the values measured for one pose, writing a block if the buffer is full.
+void
+ColumnarDumpEnsembleMetricObserver::observe_measurement(
+	protocols::ensemble_metrics::EnsembleMetric const & metric,
+	core::Size const attempt_index,
+	core::Real const * values,
+	core::Size const n_values
+) {
+	std::string const job_name( protocols::jd2::jd2_used() ? protocols::jd2::current_output_name() : "" );
+
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif //MULTI_THREADED
+
+	if ( !out_.is_open() ) {
+		open_file( metric, n_values );
+	}
+	if ( n_values != n_value_columns_ ) {
+		if ( n_dropped_ == 0 ) {
+			TR.Warning << "Records with " << n_values << " values cannot be written to columnar dump file \"" << filename_ << "\", which has " << n_value_columns_ << " value columns.  Dropping them." << std::endl;
+		}
+		++n_dropped_;
+		return;
+	}
+
+	if ( n_jobs_ == 0 || job_name != current_job_name_ ) {
+		write_chunk( ColumnarDumpChunkType::JOB_NAME, ColumnarDumpCompression::NONE, n_jobs_, job_name.data(), job_name.size(), job_name.size() );
+		current_job_name_ = job_name;
+		++n_jobs_;
+	}
+
+	attempt_indices_[ n_buffered_ ] = attempt_index;
+	job_indices_[ n_buffered_ ] = n_jobs_ - 1;
+	for ( core::Size i( 0 ); i < n_values; ++i ) {
+		values_[ i * block_records_ + n_buffered_ ] = values[ i ];
+	}
+	++n_buffered_;
+
+	if ( n_buffered_ == block_records_ ) {
+		write_block();
+	}
+}
+
+/// @brief Write any buffered records as a (partial) block, and flush the file.
+void
+ColumnarDumpEnsembleMetricObserver::flush() {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif //MULTI_THREADED
+	if ( !out_.is_open() ) return;
+	if ( n_buffered_ > 0 ) {
+		write_block();
+	}
+	out_.flush();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GETTERS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief The number of records written to the file so far (not counting buffered records).
+core::Size
+ColumnarDumpEnsembleMetricObserver::n_records_written() const {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif //MULTI_THREADED
+	return n_records_written_;
+}
+
+/// @brief The number of bytes written to the file so far.
+core::Size
+ColumnarDumpEnsembleMetricObserver::bytes_written() const {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif //MULTI_THREADED
+	return bytes_written_;
+}
+
+/// @brief The number of records dropped because they had the wrong number of values.
+core::Size
+ColumnarDumpEnsembleMetricObserver::n_dropped() const {
+#ifdef MULTI_THREADED
+	std::lock_guard< std::mutex > lock( mutex_ );
+#endif //MULTI_THREADED
+	return n_dropped_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Open the file, and write the file header and the column names.
+/// @details The mutex must be held.
+void
+ColumnarDumpEnsembleMetricObserver::open_file(
+	protocols::ensemble_metrics::EnsembleMetric const & metric,
+	core::Size const n_values
+) {
+	runtime_assert_string_msg( n_values > 0, "Error in ColumnarDumpEnsembleMetricObserver::open_file(): Records must have at least one value." );
+	out_.open( filename_, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+	runtime_assert_string_msg( out_.good(), "Error in ColumnarDumpEnsembleMetricObserver::open_file(): Could not open \"" + filename_ + "\" for writing." );
+
+	n_value_columns_ = n_values;
+	attempt_indices_.assign( block_records_, 0 );
+	job_indices_.assign( block_records_, 0 );
+	values_.assign( block_records_ * n_value_columns_, 0.0 );
+
+	ColumnarDumpFileHeader header;
+	header.magic = columnar_dump_magic;
+	header.version = columnar_dump_version;
+	header.n_value_columns = n_value_columns_;
+	header.reserved[0] = 0;
+	header.reserved[1] = 0;
+	out_.write( reinterpret_cast< char const * >( &header ), sizeof( ColumnarDumpFileHeader ) );
+	bytes_written_ += sizeof( ColumnarDumpFileHeader );
+
+	utility::vector1< std::string > const names( metric.per_pose_value_names() );
+	std::string names_payload;
+	for ( core::Size i( 1 ); i <= n_value_columns_; ++i ) {
+		names_payload += ( names.size() == n_value_columns_ ? names[i] : "value_" + std::to_string( i ) );
+		names_payload += '\0';
+	}
+	write_chunk( ColumnarDumpChunkType::COLUMN_NAMES, ColumnarDumpCompression::NONE, n_value_columns_, names_payload.data(), names_payload.size(), names_payload.size() );
+
+	TR << "Writing per-pose values measured by " << metric.get_ensemble_metric_label() << " to columnar dump file \"" << filename_ << "\"." << std::endl;
+}
+
+/// @brief Write one chunk, padding its payload to a multiple of eight bytes.
+/// @details The mutex must be held.
+void
+ColumnarDumpEnsembleMetricObserver::write_chunk(
+	ColumnarDumpChunkType const chunk_type,
+	ColumnarDumpCompression const compression,
+	core::Size const n_records,
+	char const * payload,
+	core::Size const stored_bytes,
+	core::Size const uncompressed_bytes
+) {
+	ColumnarDumpChunkHeader header;
+	header.chunk_type = static_cast< std::uint32_t >( chunk_type );
+	header.compression = static_cast< std::uint32_t >( compression );
+	header.n_records = n_records;
+	header.stored_bytes = stored_bytes;
+	header.uncompressed_bytes = uncompressed_bytes;
+	out_.write( reinterpret_cast< char const * >( &header ), sizeof( ColumnarDumpChunkHeader ) );
+	out_.write( payload, stored_bytes );
+	static char const zeroes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	core::Size const padding( padding_bytes( stored_bytes ) );
+	out_.write( zeroes, padding );
+	runtime_assert_string_msg( out_.good(), "Error in ColumnarDumpEnsembleMetricObserver::write_chunk(): Could not write to \"" + filename_ + "\"." );
+	bytes_written_ += sizeof( ColumnarDumpChunkHeader ) + stored_bytes + padding;
+}
+
+/// @brief Write the buffered records as one RECORDS chunk, and clear the buffer.
+/// @details The mutex must be held.
+void
+ColumnarDumpEnsembleMetricObserver::write_block() {
+	core::Size const n( n_buffered_ );
+	core::Size const index_bytes( n * sizeof( std::uint64_t ) );
+	core::Size const column_bytes( n * sizeof( double ) );
+	core::Size const uncompressed_bytes( 2 * index_bytes + n_value_columns_ * column_bytes );
+
+	// Assemble the columns contiguously.  The buffered columns are block_records_ long, so a partial block must be
+	// packed down in any case.
+	uncompressed_scratch_.resize( uncompressed_bytes );
+	char * dest( uncompressed_scratch_.data() );
+	std::memcpy( dest, attempt_indices_.data(), index_bytes );
+	dest += index_bytes;
+	std::memcpy( dest, job_indices_.data(), index_bytes );
+	dest += index_bytes;
+	for ( core::Size i( 0 ); i < n_value_columns_; ++i ) {
+		std::memcpy( dest, values_.data() + i * block_records_, column_bytes );
+		dest += column_bytes;
+	}
+
+	bool stored_compressed( false );
+	if ( compress_ ) {
+		uLongf compressed_bytes( compressBound( uncompressed_bytes ) );
+		compressed_scratch_.resize( compressed_bytes );
+		int const status(
+			compress2(
+				reinterpret_cast< Bytef * >( compressed_scratch_.data() ), &compressed_bytes,
+				reinterpret_cast< Bytef const * >( uncompressed_scratch_.data() ), uncompressed_bytes,
+				Z_BEST_SPEED
+			)
+		);
+		if ( status == Z_OK && compressed_bytes < uncompressed_bytes ) {
+			write_chunk( ColumnarDumpChunkType::RECORDS, ColumnarDumpCompression::ZLIB, n, compressed_scratch_.data(), compressed_bytes, uncompressed_bytes );
+			stored_compressed = true;
+		}
+	}
+	if ( !stored_compressed ) {
+		write_chunk( ColumnarDumpChunkType::RECORDS, ColumnarDumpCompression::NONE, n, uncompressed_scratch_.data(), uncompressed_bytes, uncompressed_bytes );
+	}
+
+	n_records_written_ += n;
+	n_buffered_ = 0;
+}
+
+} //observers
+} //ensemble_metrics
+} //protocols
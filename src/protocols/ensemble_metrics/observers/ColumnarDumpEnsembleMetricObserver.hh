@@ -0,0 +1,278 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (ColumnarDumpEnsembleMetricObserver.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/observers/ColumnarDumpEnsembleMetricObserver.hh
+/// @brief An EnsembleMetricObserver that streams each per-pose measurement to a compact, block-compressed,
+/// columnar binary file.
+/// @details The file starts with a ColumnarDumpFileHeader, followed by a sequence of chunks, each of which starts
+/// with a ColumnarDumpChunkHeader and whose payload is padded to a multiple of eight bytes.  Chunks are:
+/// - One COLUMN_NAMES chunk, whose payload is the null-terminated names of the value columns.
+/// - A JOB_NAME chunk each time a record arrives from a new job, whose payload is the job name (not null-
+/// terminated) and whose n_records field holds the (zero-based) index by which records refer to the job.
+/// - RECORDS chunks, each holding up to a block of records.  Uncompressed, the payload is n_records 64-bit
+/// attempt indices, then n_records 64-bit job indices, then n_records 64-bit floating-point values for each
+/// value column in turn.  The payload is either stored as-is (so it can be used in place when the file is
+/// memory-mapped) or compressed with zlib.
+/// All values are written in the byte order of the machine that wrote the file.  Since every chunk is self-
+/// describing, a file from a process that died is readable up to its last complete chunk.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_observers_ColumnarDumpEnsembleMetricObserver_HH
+#define INCLUDED_protocols_ensemble_metrics_observers_ColumnarDumpEnsembleMetricObserver_HH
+
+// Unit headers
+#include <protocols/ensemble_metrics/observers/ColumnarDumpEnsembleMetricObserver.fwd.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricObserver.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// STL headers
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef MULTI_THREADED
+#include <mutex>
+#endif //MULTI_THREADED
+
+namespace protocols {
+namespace ensemble_metrics {
+namespace observers {
+
+/// @brief The magic number at the start of a columnar dump file ("EMCD").
+static constexpr std::uint32_t columnar_dump_magic = 0x454D4344;
+
+/// @brief The version of the columnar dump file format.
+static constexpr std::uint32_t columnar_dump_version = 1;
+
+/// @brief The types of chunk in a columnar dump file.
+enum class ColumnarDumpChunkType : std::uint32_t {
+	COLUMN_NAMES = 1,
+	JOB_NAME = 2,
+	RECORDS = 3
+};
+
+/// @brief The ways in which a chunk payload may be stored.
+enum class ColumnarDumpCompression : std::uint32_t {
+	NONE = 0,
+	ZLIB = 1
+};
+
+/// @brief The header at the start of a columnar dump file.
+struct ColumnarDumpFileHeader {
+	std::uint32_t magic;
+	std::uint32_t version;
+	std::uint64_t n_value_columns;
+	std::uint64_t reserved[2];
+};
+
+/// @brief The header at the start of each chunk in a columnar dump file.
+struct ColumnarDumpChunkHeader {
+	std::uint32_t chunk_type;
+	std::uint32_t compression;
+	std::uint64_t n_records;
+	std::uint64_t stored_bytes;
+	std::uint64_t uncompressed_bytes;
+};
+
+static_assert( sizeof( ColumnarDumpFileHeader ) == 32, "ColumnarDumpFileHeader must be 32 bytes." );
+static_assert( sizeof( ColumnarDumpChunkHeader ) == 32, "ColumnarDumpChunkHeader must be 32 bytes." );
+
+/// @brief An EnsembleMetricObserver that streams each per-pose measurement to a compact, block-compressed,
+/// columnar binary file.
+/// @details Records are buffered, column by column, until a block is full, at which point the block is written
+/// as one chunk, so at most one block of records is held in memory.  The file is opened, and its header and column
+/// names written, when the first record arrives.  The number of value columns is set by the first record; records
+/// with a different number of values are dropped and counted (see n_dropped()).  Partial blocks are written by
+/// flush(), which the EnsembleMetric calls when it produces its final report, and on destruction.
+/// @note Threadsafe in multi-threaded builds: a mutex serializes records from copies of an EnsembleMetric that
+/// share this observer.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class ColumnarDumpEnsembleMetricObserver : public protocols::ensemble_metrics::EnsembleMetricObserver {
+
+public:
+
+	/// @brief Constructor.
+	/// @param[in] filename The file to write.  Overwritten if it exists.
+	/// @param[in] block_records The number of records per block.  Must be nonzero.
+	/// @param[in] compress If true, blocks are compressed with zlib (unless that would not make them smaller).
+	/// Uncompressed files are larger, but can be used in place when memory-mapped.
+	ColumnarDumpEnsembleMetricObserver(
+		std::string const & filename,
+		core::Size const block_records,
+		bool const compress
+	);
+
+	/// @brief No default constructor.
+	ColumnarDumpEnsembleMetricObserver() = delete;
+
+	/// @brief No copy constructor (since this owns an open file).
+	ColumnarDumpEnsembleMetricObserver( ColumnarDumpEnsembleMetricObserver const & ) = delete;
+
+	/// @brief No assignment operator.
+	ColumnarDumpEnsembleMetricObserver & operator=( ColumnarDumpEnsembleMetricObserver const & ) = delete;
+
+	/// @brief Destructor.  Writes any buffered records.
+	~ColumnarDumpEnsembleMetricObserver() override;
+
+	/// @brief Get the observer that writes a file in this process, creating it if this is the first request for the file.
+	/// @details Ensemble metrics that are parsed again for each job (with -jd2:share_ensemble_metrics_across_jobs false)
+	/// thereby continue one file, with the records of each job marked by job index, rather than each truncating it.
+	/// The observer is kept until the process exits.  If it already exists, block_records and compress are ignored.
+	/// Threadsafe.
+	static
+	ColumnarDumpEnsembleMetricObserverOP
+	observer_for_file(
+		std::string const & filename,
+		core::Size const block_records,
+		bool const compress
+	);
+
+public: // Observer functions
+
+	/// @brief Buffer the values measured for one pose, writing a block if the buffer is full.
+	void
+	observe_measurement(
+		protocols::ensemble_metrics::EnsembleMetric const & metric,
+		core::Size const attempt_index,
+		core::Real const * values,
+		core::Size const n_values
+	) override;
+
+	/// @brief Write any buffered records as a (partial) block, and flush the file.
+	void flush() override;
+
+public: // Getters
+
+	/// @brief The file being written.
+	inline std::string const & filename() const { return filename_; }
+
+	/// @brief The number of records per block.
+	inline core::Size block_records() const { return block_records_; }
+
+	/// @brief Are blocks compressed?
+	inline bool compress() const { return compress_; }
+
+	/// @brief The number of records written to the file so far (not counting buffered records).
+	core::Size n_records_written() const;
+
+	/// @brief The number of bytes written to the file so far.
+	core::Size bytes_written() const;
+
+	/// @brief The number of records dropped because they had the wrong number of values.
+	core::Size n_dropped() const;
+
+private: // Private functions
+
+	/// @brief Open the file, and write the file header and the column names.
+	/// @details The mutex must be held.
+	void
+	open_file(
+		protocols::ensemble_metrics::EnsembleMetric const & metric,
+		core::Size const n_values
+	);
+
+	/// @brief Write one chunk, padding its payload to a multiple of eight bytes.
+	/// @details The mutex must be held.
+	void
+	write_chunk(
+		ColumnarDumpChunkType const chunk_type,
+		ColumnarDumpCompression const compression,
+		core::Size const n_records,
+		char const * payload,
+		core::Size const stored_bytes,
+		core::Size const uncompressed_bytes
+	);
+
+	/// @brief Write the buffered records as one RECORDS chunk, and clear the buffer.
+	/// @details The mutex must be held.
+	void write_block();
+
+private: // Private data
+
+	/// @brief The file being written.
+	std::string const filename_;
+
+	/// @brief The number of records per block.
+	core::Size const block_records_;
+
+	/// @brief Are blocks compressed?
+	bool const compress_;
+
+	/// @brief The output stream.  Only opened when the first record arrives.
+	std::ofstream out_;
+
+	/// @brief The number of value columns, set by the first record.
+	core::Size n_value_columns_ = 0;
+
+	/// @brief The number of records in the buffer.
+	core::Size n_buffered_ = 0;
+
+	/// @brief Buffered attempt indices, block_records_ entries.
+	std::vector< std::uint64_t > attempt_indices_;
+
+	/// @brief Buffered job indices, block_records_ entries.
+	std::vector< std::uint64_t > job_indices_;
+
+	/// @brief Buffered values, block_records_ entries per column, column after column.
+	std::vector< double > values_;
+
+	/// @brief Scratch space for assembling and compressing blocks, reused from block to block.
+	std::vector< char > uncompressed_scratch_;
+	std::vector< char > compressed_scratch_;
+
+	/// @brief The name of the job that produced the most recent record.
+	std::string current_job_name_;
+
+	/// @brief The number of JOB_NAME chunks written.
+	core::Size n_jobs_ = 0;
+
+	/// @brief The number of records written to the file.
+	core::Size n_records_written_ = 0;
+
+	/// @brief The number of bytes written to the file.
+	core::Size bytes_written_ = 0;
+
+	/// @brief The number of records dropped.
+	core::Size n_dropped_ = 0;
+
+#ifdef MULTI_THREADED
+	/// @brief Serializes access to the buffer and the file.
+	mutable std::mutex mutex_;
+#endif //MULTI_THREADED
+
+};
+
+} //observers
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_observers_ColumnarDumpEnsembleMetricObserver_HH
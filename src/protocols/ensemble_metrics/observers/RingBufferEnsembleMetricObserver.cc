@@ -0,0 +1,242 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (RingBufferEnsembleMetricObserver.cc), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/observers/RingBufferEnsembleMetricObserver.cc
+/// @brief An EnsembleMetricObserver that copies each measurement into a fixed-size, lock-free
+/// single-producer, single-consumer ring buffer, from which a consumer thread can drain it.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+// Unit headers
+#include <protocols/ensemble_metrics/observers/RingBufferEnsembleMetricObserver.hh>
+
+// Utility headers
+#include <utility/exit.hh>
+#include <utility/pointer/memory.hh>
+
+// STL headers
+#include <algorithm>
+
+namespace protocols {
+namespace ensemble_metrics {
+namespace observers {
+
+/// @brief Given a requested capacity, return the smallest power of two that is at least that large,
+/// minus one.
+/// @details Throws if the requested capacity is zero.
+static
+core::Size
+slot_mask_from_capacity(
+	core::Size const capacity
+) {
+	runtime_assert_string_msg( capacity > 0, "Error in RingBufferEnsembleMetricObserver constructor: The capacity must be nonzero." );
+	core::Size rounded( 1 );
+	while ( rounded < capacity ) {
+		rounded <<= 1;
+		runtime_assert_string_msg( rounded != 0, "Error in RingBufferEnsembleMetricObserver constructor: The requested capacity is too large." );
+	}
+	return rounded - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// RING
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Constructor.
+/// @details Does not allocate the storage for the records: see allocate_storage().
+RingBufferEnsembleMetricObserver::Ring::Ring(
+	core::Size const slot_mask
+) :
+	slot_mask_( slot_mask ),
+	head_( 0 ),
+	tail_( 0 ),
+	n_dropped_( 0 ),
+	producer_alive_( true )
+{}
+
+/// @brief Allocate the storage for the records.  Called by the producer before it writes the first record.
+void
+RingBufferEnsembleMetricObserver::Ring::allocate_storage(
+	core::Size const max_values_per_record
+) {
+	values_.resize( ( slot_mask_ + 1 ) * max_values_per_record, 0.0 );
+	value_counts_.resize( slot_mask_ + 1, 0 );
+	attempt_indices_.resize( slot_mask_ + 1, 0 ); //Last, since storage_allocated() checks this.
+}
+
+/// @brief Make a retired ring just large enough for the records still waiting in this one, holding copies
+/// of them.
+/// @details Only called once the producer no longer exists, with the group's mutex held.
+RingBufferEnsembleMetricObserver::RingOP
+RingBufferEnsembleMetricObserver::Ring::compacted_copy(
+	core::Size const max_values_per_record
+) const {
+	core::Size const tail( tail_.load( std::memory_order_relaxed ) );
+	core::Size const head( head_.load( std::memory_order_acquire ) );
+	RingOP compacted( utility::pointer::make_shared< Ring >( slot_mask_from_capacity( head - tail ) ) );
+	compacted->allocate_storage( max_values_per_record );
+	for ( core::Size i( tail ), j( 1 ); i != head; ++i, ++j ) {
+		core::Size const slot( i & slot_mask_ );
+		compacted->attempt_indices_[ j ] = attempt_indices_[ slot + 1 ];
+		compacted->value_counts_[ j ] = value_counts_[ slot + 1 ];
+		core::Real const * const record( values_.data() + slot * max_values_per_record );
+		std::copy( record, record + max_values_per_record, compacted->values_.data() + ( j - 1 ) * max_values_per_record );
+	}
+	compacted->head_.store( head - tail, std::memory_order_relaxed );
+	compacted->n_dropped_.store( n_dropped_.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+	compacted->producer_alive_.store( false, std::memory_order_relaxed );
+	return compacted;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Constructor.
+/// @param[in] capacity The minimum number of records that the buffer can hold.  Rounded up to
+/// the next power of two.  Must be nonzero.
+/// @param[in] max_values_per_record The maximum number of values in a single record.  Must be nonzero.
+RingBufferEnsembleMetricObserver::RingBufferEnsembleMetricObserver(
+	core::Size const capacity,
+	core::Size const max_values_per_record
+) :
+	RingBufferEnsembleMetricObserver( slot_mask_from_capacity( capacity ), max_values_per_record, utility::pointer::make_shared< RingGroup >() )
+{}
+
+/// @brief Constructor used by observer_for_metric_copy(), which adds a new ring to an existing group.
+RingBufferEnsembleMetricObserver::RingBufferEnsembleMetricObserver(
+	core::Size const slot_mask,
+	core::Size const max_values_per_record,
+	RingGroupOP const & group
+) :
+	protocols::ensemble_metrics::EnsembleMetricObserver(),
+	max_values_per_record_( max_values_per_record ),
+	ring_( utility::pointer::make_shared< Ring >( slot_mask ) ),
+	group_( group )
+{
+	runtime_assert_string_msg( max_values_per_record_ > 0, "Error in RingBufferEnsembleMetricObserver constructor: The maximum number of values per record must be nonzero." );
+	std::lock_guard< std::mutex > lock( group_->mutex_ );
+	group_->rings_.push_back( ring_ );
+}
+
+/// @brief Destructor.
+/// @details Frees this observer's ring if it has been drained.  Otherwise, the records still in it are moved to
+/// a ring just large enough to hold them, which remains available to consume() on other observers in the group.
+RingBufferEnsembleMetricObserver::~RingBufferEnsembleMetricObserver() {
+	ring_->producer_alive_.store( false, std::memory_order_release );
+	std::lock_guard< std::mutex > lock( group_->mutex_ );
+	auto const entry( std::find( group_->rings_.begin(), group_->rings_.end(), ring_ ) );
+	if ( entry == group_->rings_.end() ) return;
+	core::Size const n_waiting( ring_->head_.load( std::memory_order_relaxed ) - ring_->tail_.load( std::memory_order_relaxed ) );
+	if ( n_waiting == 0 ) {
+		group_->retired_n_dropped_ += ring_->n_dropped_.load( std::memory_order_relaxed );
+		group_->rings_.erase( entry );
+	} else if ( n_waiting <= ring_->slot_mask_ / 2 ) {
+		*entry = ring_->compacted_copy( max_values_per_record_ );
+	}
+}
+
+/// @brief Create a new observer in the same group as this one, with a ring of its own, for use by a copy of an
+/// EnsembleMetric.
+protocols::ensemble_metrics::EnsembleMetricObserverOP
+RingBufferEnsembleMetricObserver::observer_for_metric_copy() const {
+	return protocols::ensemble_metrics::EnsembleMetricObserverOP(
+		new RingBufferEnsembleMetricObserver( ring_->slot_mask_, max_values_per_record_, group_ )
+	); //Can't use make_shared with a private constructor.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PRODUCER SIDE
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Copy the values measured for one pose into the next free slot in this observer's ring.
+/// @details Lock-free, and allocation-free except for the first record.  Drops (and counts) the record if the buffer is full or
+/// if n_values exceeds max_values_per_record().
+void
+RingBufferEnsembleMetricObserver::observe_measurement(
+	protocols::ensemble_metrics::EnsembleMetric const &,
+	core::Size const attempt_index,
+	core::Real const * values,
+	core::Size const n_values
+) {
+	Ring & ring( *ring_ );
+	if ( !ring.storage_allocated() ) {
+		ring.allocate_storage( max_values_per_record_ ); //Safe: the consumer reads no slots until head_ advances.
+	}
+	core::Size const head( ring.head_.load( std::memory_order_relaxed ) );
+	if ( n_values > max_values_per_record_ || head - ring.tail_.load( std::memory_order_acquire ) > ring.slot_mask_ ) {
+		ring.n_dropped_.store( ring.n_dropped_.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+		return;
+	}
+	core::Size const slot( head & ring.slot_mask_ );
+	ring.attempt_indices_[ slot + 1 ] = attempt_index;
+	ring.value_counts_[ slot + 1 ] = n_values;
+	std::copy( values, values + n_values, ring.values_.data() + slot * max_values_per_record_ );
+	ring.head_.store( head + 1, std::memory_order_release );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GETTERS
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief The number of records waiting to be consumed, in the rings of all observers in this group.
+/// @details Only a snapshot, if producers or the consumer are active.
+core::Size
+RingBufferEnsembleMetricObserver::size() const {
+	std::lock_guard< std::mutex > lock( group_->mutex_ );
+	core::Size total( 0 );
+	for ( RingOP const & ring : group_->rings_ ) {
+		core::Size const tail( ring->tail_.load( std::memory_order_acquire ) );
+		total += ring->head_.load( std::memory_order_acquire ) - tail;
+	}
+	return total;
+}
+
+/// @brief The number of records dropped, by all observers in this group, because a ring was full or the record
+/// was too large.
+core::Size
+RingBufferEnsembleMetricObserver::n_dropped() const {
+	std::lock_guard< std::mutex > lock( group_->mutex_ );
+	core::Size total( group_->retired_n_dropped_ );
+	for ( RingOP const & ring : group_->rings_ ) {
+		total += ring->n_dropped_.load( std::memory_order_relaxed );
+	}
+	return total;
+}
+
+/// @brief The number of rings in this group (including those of observers that no longer exist but whose rings
+/// have not yet been drained).
+core::Size
+RingBufferEnsembleMetricObserver::n_rings() const {
+	std::lock_guard< std::mutex > lock( group_->mutex_ );
+	return group_->rings_.size();
+}
+
+} //observers
+} //ensemble_metrics
+} //protocols
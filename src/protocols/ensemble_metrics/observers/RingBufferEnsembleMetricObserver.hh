@@ -0,0 +1,286 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (RingBufferEnsembleMetricObserver.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file protocols/ensemble_metrics/observers/RingBufferEnsembleMetricObserver.hh
+/// @brief An EnsembleMetricObserver that copies each measurement into a fixed-size, lock-free
+/// single-producer, single-consumer ring buffer, from which a consumer thread can drain it.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+#ifndef INCLUDED_protocols_ensemble_metrics_observers_RingBufferEnsembleMetricObserver_HH
+#define INCLUDED_protocols_ensemble_metrics_observers_RingBufferEnsembleMetricObserver_HH
+
+// Unit headers
+#include <protocols/ensemble_metrics/observers/RingBufferEnsembleMetricObserver.fwd.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricObserver.hh>
+
+// Core headers
+#include <core/types.hh>
+
+// Utility headers
+#include <utility/vector1.hh>
+
+// STL headers
+#include <atomic>
+#include <mutex>
+
+namespace protocols {
+namespace ensemble_metrics {
+namespace observers {
+
+/// @brief An EnsembleMetricObserver that copies each measurement into a fixed-size, lock-free
+/// single-producer, single-consumer ring buffer, from which a consumer thread can drain it.
+/// @details The producer side (observe_measurement()) never blocks, and allocates only once, when the first record
+/// is written to a ring: each record is copied once into that storage.  If the buffer is full, or if a measurement has more values
+/// than a record can hold, the record is dropped and counted (see n_dropped()).  The consumer side
+/// (consume()) passes pointers into the buffer itself to the consumer function, so there is no second copy.
+/// @note Each ring has exactly one producer.  When an EnsembleMetric observed by this observer is copied (for
+/// instance, once per thread by a multi-threaded job distributor), the copy is given a new observer of this type
+/// with a ring of its own (see observer_for_metric_copy()), so copies that run concurrently never write to the same
+/// ring.  All of the observers made in this way form a group, and consume() on any observer in the group drains
+/// the rings of all of them.  A ring's storage is allocated by its first record, so copies that never measure
+/// anything cost almost nothing.  When an observer is destroyed, its ring is freed at once if it has been drained,
+/// or otherwise replaced by a ring just large enough for the records that remain, which consume() then frees.
+/// Within one EnsembleMetric, calls are made while the metric holds the lock that
+/// protects its accumulated data, so a single ring suffices even when the ensemble is generated in many threads.
+/// Do not register one instance with several different EnsembleMetrics that may run concurrently; give each its
+/// own instance instead.  There must be at most one consumer at a time per group.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+class RingBufferEnsembleMetricObserver : public protocols::ensemble_metrics::EnsembleMetricObserver {
+
+private: // Private classes
+
+	/// @brief The storage for one single-producer, single-consumer ring.
+	class Ring {
+	public:
+
+		/// @brief Constructor.
+		/// @details Does not allocate the storage for the records: see allocate_storage().
+		Ring(
+			core::Size const slot_mask
+		);
+
+		/// @brief Allocate the storage for the records.  Called by the producer before it writes the first record.
+		void
+		allocate_storage(
+			core::Size const max_values_per_record
+		);
+
+		/// @brief Have the records been allocated?
+		inline bool storage_allocated() const { return !attempt_indices_.empty(); }
+
+		/// @brief Make a retired ring just large enough for the records still waiting in this one, holding copies
+		/// of them.
+		/// @details Only called once the producer no longer exists, with the group's mutex held.
+		utility::pointer::shared_ptr< Ring >
+		compacted_copy(
+			core::Size const max_values_per_record
+		) const;
+
+		/// @brief Pass every record currently in this ring, oldest first, to a consumer function, then
+		/// release the slots for reuse.
+		template< class ConsumerFunction >
+		core::Size
+		consume(
+			ConsumerFunction && fxn,
+			core::Size const max_values_per_record
+		) {
+			core::Size const tail( tail_.load( std::memory_order_relaxed ) );
+			core::Size const head( head_.load( std::memory_order_acquire ) );
+			for ( core::Size i( tail ); i != head; ++i ) {
+				core::Size const slot( i & slot_mask_ );
+				fxn( attempt_indices_[ slot + 1 ], values_.data() + slot * max_values_per_record, value_counts_[ slot + 1 ] );
+			}
+			tail_.store( head, std::memory_order_release );
+			return head - tail;
+		}
+
+		/// @brief Capacity minus one.
+		core::Size const slot_mask_;
+
+		/// @brief The attempt index of the record in each slot.  Empty until the storage is allocated.
+		utility::vector1< core::Size > attempt_indices_;
+
+		/// @brief The number of values in the record in each slot.
+		utility::vector1< core::Size > value_counts_;
+
+		/// @brief The values of all records, max_values_per_record entries per slot.
+		utility::vector1< core::Real > values_;
+
+		/// @brief Running count of records written.  Only written by the producer.
+		alignas( 64 ) std::atomic< core::Size > head_;
+
+		/// @brief Running count of records consumed.  Only written by the consumer.
+		alignas( 64 ) std::atomic< core::Size > tail_;
+
+		/// @brief Running count of records dropped.  Only written by the producer.
+		alignas( 64 ) std::atomic< core::Size > n_dropped_;
+
+		/// @brief Does the observer that produces into this ring still exist?  Once it does not, and the ring
+		/// has been drained, the ring is discarded.
+		std::atomic< bool > producer_alive_;
+
+	};
+
+	using RingOP = utility::pointer::shared_ptr< Ring >;
+
+	/// @brief The rings of all of the observers in a group, shared by all of them.
+	struct RingGroup {
+
+		/// @brief Guards the list of rings.  Only taken when an observer is added to the group and by the consumer;
+		/// never by producers.
+		std::mutex mutex_;
+
+		/// @brief The rings, in the order in which the observers were created.
+		utility::vector1< RingOP > rings_;
+
+		/// @brief The number of records dropped by rings that have since been discarded.
+		core::Size retired_n_dropped_ = 0;
+
+	};
+
+	using RingGroupOP = utility::pointer::shared_ptr< RingGroup >;
+
+public:
+
+	/// @brief Constructor.
+	/// @param[in] capacity The minimum number of records that the buffer can hold.  Rounded up to
+	/// the next power of two.  Must be nonzero.
+	/// @param[in] max_values_per_record The maximum number of values in a single record.  Must be nonzero.
+	RingBufferEnsembleMetricObserver(
+		core::Size const capacity,
+		core::Size const max_values_per_record
+	);
+
+	/// @brief No default constructor.
+	RingBufferEnsembleMetricObserver() = delete;
+
+	/// @brief No copy constructor (since the buffer indices are atomic and shared between threads).  Use
+	/// observer_for_metric_copy() to get another producer in the same group.
+	RingBufferEnsembleMetricObserver( RingBufferEnsembleMetricObserver const & ) = delete;
+
+	/// @brief No assignment operator.
+	RingBufferEnsembleMetricObserver & operator=( RingBufferEnsembleMetricObserver const & ) = delete;
+
+	/// @brief Destructor.
+	/// @details Frees this observer's ring if it has been drained.  Otherwise, the records still in it are moved to
+	/// a ring just large enough to hold them, which remains available to consume() on other observers in the group.
+	~RingBufferEnsembleMetricObserver() override;
+
+	/// @brief Create a new observer in the same group as this one, with a ring of its own, for use by a copy of an
+	/// EnsembleMetric.
+	protocols::ensemble_metrics::EnsembleMetricObserverOP
+	observer_for_metric_copy() const override;
+
+public: // Producer side
+
+	/// @brief Copy the values measured for one pose into the next free slot in this observer's ring.
+	/// @details Lock-free, and allocation-free except for the first record.  Drops (and counts) the record if the buffer is full or
+	/// if n_values exceeds max_values_per_record().
+	void
+	observe_measurement(
+		protocols::ensemble_metrics::EnsembleMetric const & metric,
+		core::Size const attempt_index,
+		core::Real const * values,
+		core::Size const n_values
+	) override;
+
+public: // Consumer side
+
+	/// @brief Pass every record currently in the rings of all observers in this group, oldest first within each
+	/// ring, to a consumer function, then release the slots for reuse.
+	/// @details The consumer function is called as fxn( attempt_index, values, n_values ), where values
+	/// points into the ring buffer and is only valid for the duration of the call.  Records from different rings
+	/// are not interleaved in any particular order.
+	/// @returns The number of records consumed.
+	template< class ConsumerFunction >
+	core::Size
+	consume(
+		ConsumerFunction && fxn
+	) {
+		std::lock_guard< std::mutex > lock( group_->mutex_ );
+		core::Size n_consumed( 0 );
+		for ( core::Size i( group_->rings_.size() ); i > 0; --i ) { //Backwards, so that retired rings can be erased.
+			Ring & ring( *group_->rings_[i] );
+			bool const retired( !ring.producer_alive_.load( std::memory_order_acquire ) );
+			n_consumed += ring.consume( fxn, max_values_per_record_ );
+			if ( retired ) {
+				group_->retired_n_dropped_ += ring.n_dropped_.load( std::memory_order_relaxed );
+				group_->rings_.erase( group_->rings_.begin() + ( i - 1 ) );
+			}
+		}
+		return n_consumed;
+	}
+
+public: // Getters
+
+	/// @brief The number of records that each ring can hold.
+	inline core::Size capacity() const { return ring_->slot_mask_ + 1; }
+
+	/// @brief The maximum number of values in a single record.
+	inline core::Size max_values_per_record() const { return max_values_per_record_; }
+
+	/// @brief The number of records waiting to be consumed, in the rings of all observers in this group.
+	/// @details Only a snapshot, if producers or the consumer are active.
+	core::Size size() const;
+
+	/// @brief The number of records dropped, by all observers in this group, because a ring was full or the record
+	/// was too large.
+	core::Size n_dropped() const;
+
+	/// @brief The number of rings in this group (including those of observers that no longer exist but whose rings
+	/// have not yet been drained).
+	core::Size n_rings() const;
+
+private: // Private functions
+
+	/// @brief Constructor used by observer_for_metric_copy(), which adds a new ring to an existing group.
+	RingBufferEnsembleMetricObserver(
+		core::Size const slot_mask,
+		core::Size const max_values_per_record,
+		RingGroupOP const & group
+	);
+
+private: // Private data
+
+	/// @brief The maximum number of values in a single record.
+	core::Size const max_values_per_record_;
+
+	/// @brief This observer's ring, to which only it writes.
+	RingOP const ring_;
+
+	/// @brief The group of rings to which this observer's ring belongs.
+	RingGroupOP const group_;
+
+};
+
+} //observers
+} //ensemble_metrics
+} //protocols
+
+#endif //INCLUDED_protocols_ensemble_metrics_observers_RingBufferEnsembleMetricObserver_HH
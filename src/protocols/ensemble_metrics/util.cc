@@ -48,8 +48,28 @@
 #include <basic/datacache/DataMap.hh>
 #include <basic/datacache/BasicDataCache.hh>
 
+#ifdef USEMPI
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryIO.hh>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <chrono>
+#include <thread>
+#endif
+
 static basic::Tracer TR( "protocols.ensemble_metrics.util" );
 
+#ifdef USEMPI
+/// @brief The MPI tag used for ensemble metric summaries sent during a reduction.  This keeps these
+/// messages separate from any other traffic on the same communicator.
+static int const ensemble_metric_summary_mpi_tag( 8151 );
+
+/// @brief The MPI tag used for ensemble metric summaries sent to a root process that gives up waiting after a timeout.
+static int const ensemble_metric_summary_with_timeout_mpi_tag( 8152 );
+#endif
+
 
 namespace protocols {
 namespace ensemble_metrics {
@@ -176,6 +196,426 @@ throw_sm_override_error( std::string const & out_tag, std::string const & metric
 	throw CREATE_EXCEPTION(utility::excn::Exception,  msg);
 }
 
+/// @brief Append the summaries of several EnsembleMetrics to a buffer: a count, followed by the output of pack_summary()
+/// for each metric, in order.
+/// @details This is the format in which processes exchange the data of all of their ensemble metrics at once.  Every
+/// EnsembleMetric must support summary merging.
+void
+append_ensemble_metric_summaries(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	std::string & buffer
+) {
+	EnsembleMetricSummaryWriter writer( buffer );
+	writer.write< std::uint64_t >( static_cast< std::uint64_t >( metrics.size() ) );
+	for ( EnsembleMetricOP const & metric : metrics ) {
+		runtime_assert_string_msg( metric != nullptr, "Error in protocols::ensemble_metrics::append_ensemble_metric_summaries(): Null ensemble metric passed to function." );
+		writer.write_string( metric->pack_summary() );
+	}
+}
+
+/// @brief Read summaries written by append_ensemble_metric_summaries() (or in the same format, with deltas) and merge each
+/// into the EnsembleMetric in the same position in the list.
+/// @details The reader must be positioned at the count.  A count of zero (from a process that never set up its ensemble
+/// metrics) merges nothing.  Any other count must match the number of metrics.  Throws if the count does not match, or
+/// if any data follow the last summary.  The source is a description of where the data came from (e.g. "process 3"),
+/// for error messages.
+/// @returns The number of summaries merged.
+core::Size
+merge_ensemble_metric_summaries(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	EnsembleMetricSummaryReader & reader,
+	std::string const & source
+) {
+	std::string const errmsg( "Error in protocols::ensemble_metrics::merge_ensemble_metric_summaries(): " );
+	core::Size const n_metrics( static_cast< core::Size >( reader.read< std::uint64_t >() ) );
+	runtime_assert_string_msg( n_metrics == 0 || n_metrics == metrics.size(), errmsg + "The data from " + source + " hold summaries for " + std::to_string( n_metrics ) + " ensemble metrics, but there are " + std::to_string( metrics.size() ) + " ensemble metrics to merge them into." );
+	for ( core::Size i(1); i <= n_metrics; ++i ) {
+		core::Size summary_length(0);
+		char const * const summary( reader.read_string_in_place( summary_length ) );
+		metrics[i]->merge_summary( summary, summary_length );
+	}
+	runtime_assert_string_msg( reader.remaining() == 0, errmsg + "Unexpected data at the end of the summaries from " + source + "." );
+	return n_metrics;
+}
+
+#ifdef USEMPI
+/// @brief The largest number of bytes sent in a single point-to-point MPI message.  Larger buffers are sent in chunks
+/// of this size (1 GiB), which keeps counts well within the range of int.
+static core::Size const max_bytes_per_mpi_message( 1073741824 );
+
+/// @brief The number of blocks of block_size bytes needed to hold n_bytes bytes.
+static
+unsigned long long
+n_mpi_blocks(
+	unsigned long long const n_bytes,
+	unsigned long long const block_size
+) {
+	return ( n_bytes + block_size - 1 ) / block_size;
+}
+
+/// @brief The total number of blocks of block_size bytes needed to hold buffers of the given sizes, each padded to a
+/// whole number of blocks.
+static
+unsigned long long
+n_mpi_blocks(
+	utility::vector1< unsigned long long > const & sizes,
+	unsigned long long const block_size
+) {
+	unsigned long long total(0);
+	for ( unsigned long long const size : sizes ) {
+		total += n_mpi_blocks( size, block_size );
+	}
+	return total;
+}
+
+/// @brief Combine the data accumulated by an EnsembleMetric in every process of an MPI communicator in the
+/// copy in the process with rank 0.
+/// @details This uses a binomial reduction tree: in round k, each process with rank r such that bit k is the
+/// lowest set bit of r sends its packed summary to process r - 2^k and then resets its copy of the metric; the
+/// receiving process merges it.  This takes ceil(log2(nprocs)) rounds instead of the nprocs - 1 serial receives
+/// that the root would otherwise have to do, and data always arrive in the root in rank order.
+/// @note The EnsembleMetric must support summary merging.  All processes in the communicator must call this
+/// function (it is collective over comm).  Summaries use native byte order, so all processes are assumed to
+/// run on the same architecture.
+void
+reduce_ensemble_metric_summaries_to_root(
+	EnsembleMetric & metric,
+	MPI_Comm comm
+) {
+	runtime_assert_string_msg( metric.supports_summary_merging(), "Error in protocols::ensemble_metrics::reduce_ensemble_metric_summaries_to_root(): The " + metric.name() + " ensemble metric does not support summary merging." );
+
+	int rank(0), nprocs(1);
+	MPI_Comm_rank( comm, &rank );
+	MPI_Comm_size( comm, &nprocs );
+
+	std::string buffer;
+	for ( int mask(1); mask < nprocs; mask <<= 1 ) {
+		if ( rank & mask ) {
+			// Send everything accumulated so far (including anything merged from children) to the parent, and drop out.
+			std::string const summary( metric.pack_summary() );
+			runtime_assert_string_msg( summary.size() <= static_cast< core::Size >( std::numeric_limits< int >::max() ), "Error in protocols::ensemble_metrics::reduce_ensemble_metric_summaries_to_root(): The summary for the " + metric.name() + " ensemble metric is too large to send in a single MPI message." );
+			MPI_Send( static_cast< const void * >( summary.data() ), static_cast< int >( summary.size() ), MPI_BYTE, rank - mask, ensemble_metric_summary_mpi_tag, comm );
+			TR.Debug << "Process " << rank << " sent summary for " << metric.name() << " ensemble metric to process " << rank - mask << "." << std::endl;
+			metric.reset(); //Suppresses this process from producing a report.
+			break;
+		} else if ( rank + mask < nprocs ) {
+			// Receive and merge the summary of the child subtree.
+			int const source( rank + mask );
+			MPI_Status mystatus;
+			MPI_Probe( source, ensemble_metric_summary_mpi_tag, comm, &mystatus );
+			int n_bytes(0);
+			MPI_Get_count( &mystatus, MPI_BYTE, &n_bytes );
+			buffer.resize( static_cast< core::Size >( n_bytes ) );
+			MPI_Recv( static_cast< void * >( &buffer[0] ), n_bytes, MPI_BYTE, source, ensemble_metric_summary_mpi_tag, comm, &mystatus );
+			metric.merge_summary( buffer.data(), buffer.size() );
+			TR.Debug << "Process " << rank << " merged summary for " << metric.name() << " ensemble metric from process " << source << "." << std::endl;
+		}
+	}
+}
+
+/// @brief Combine the data accumulated by many EnsembleMetrics in every process of an MPI communicator in the
+/// copies in the process with rank root_rank, using a single collective operation for all of the metrics.
+/// @details Each non-root process packs the summaries of all of the metrics into one contiguous buffer.  One
+/// MPI_Gather of buffer sizes and one MPI_Gatherv of the buffers follow, and the root process unpacks each buffer and
+/// merges the summaries in rank order.  Non-root processes then reset their copies of the metrics.  This costs one
+/// pair of collectives in total (plus a broadcast of the block size), rather than one or more messages per metric per
+/// process.  Since MPI_Gatherv takes int counts and displacements, buffers are sent in blocks of a power-of-two number
+/// of bytes, chosen by the root so that the total number of blocks fits in an int.  Buffers of any size can therefore
+/// be gathered.  Unless the total exceeds 2 GiB, the blocks are single bytes, and nothing is padded.
+/// @note Every EnsembleMetric must support summary merging, and all processes in the communicator must call this
+/// function with the same root and the same metrics in the same order (it is collective over comm).  A non-root
+/// process that has no metrics (e.g. one that never ran a job) may pass an empty list, and contributes nothing.
+/// Summaries use native byte order, so all processes are assumed to run on the same architecture.
+void
+gather_ensemble_metric_summaries_to_root(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	int const root_rank,
+	MPI_Comm comm
+) {
+	std::string const errmsg( "Error in protocols::ensemble_metrics::gather_ensemble_metric_summaries_to_root(): " );
+	for ( EnsembleMetricOP const & metric : metrics ) {
+		runtime_assert_string_msg( metric != nullptr, errmsg + "Null ensemble metric passed to function." );
+		runtime_assert_string_msg( metric->supports_summary_merging(), errmsg + "The " + metric->name() + " ensemble metric does not support summary merging." );
+	}
+
+	int rank(0), nprocs(1);
+	MPI_Comm_rank( comm, &rank );
+	MPI_Comm_size( comm, &nprocs );
+	runtime_assert_string_msg( root_rank >= 0 && root_rank < nprocs, errmsg + "The root rank is not in the communicator." );
+	bool const i_am_root( rank == root_rank );
+
+	// Pack everything into one buffer.  The root's own data are already in place, so it sends nothing.
+	std::string buffer;
+	if ( !i_am_root ) {
+		append_ensemble_metric_summaries( metrics, buffer );
+	}
+	unsigned long long const n_my_bytes( static_cast< unsigned long long >( buffer.size() ) );
+
+	// Gather the buffer sizes, as 64-bit integers.
+	utility::vector1< unsigned long long > sizes( i_am_root ? nprocs : 0, 0 );
+	MPI_Gather( static_cast< const void * >( &n_my_bytes ), 1, MPI_UNSIGNED_LONG_LONG, static_cast< void * >( i_am_root ? sizes.data() : nullptr ), 1, MPI_UNSIGNED_LONG_LONG, root_rank, comm );
+
+	// The root picks the smallest block size for which the total number of blocks fits in an int, and tells everyone.
+	unsigned long long block_size(1);
+	if ( i_am_root ) {
+		while ( n_mpi_blocks( sizes, block_size ) > static_cast< unsigned long long >( std::numeric_limits< int >::max() ) ) {
+			block_size <<= 1;
+		}
+	}
+	MPI_Bcast( static_cast< void * >( &block_size ), 1, MPI_UNSIGNED_LONG_LONG, root_rank, comm );
+	runtime_assert( block_size <= static_cast< unsigned long long >( std::numeric_limits< int >::max() ) ); //Should be true.
+	MPI_Datatype block_type( MPI_BYTE );
+	if ( block_size > 1 ) {
+		TR.Debug << "Gathering packed ensemble metric summaries in blocks of " << block_size << " bytes." << std::endl;
+		MPI_Type_contiguous( static_cast< int >( block_size ), MPI_BYTE, &block_type );
+		MPI_Type_commit( &block_type );
+	}
+
+	if ( !i_am_root ) {
+		int const n_my_blocks( static_cast< int >( n_mpi_blocks( n_my_bytes, block_size ) ) );
+		buffer.resize( static_cast< core::Size >( n_my_blocks ) * block_size ); //Pad to a whole number of blocks.
+		MPI_Gatherv( static_cast< const void * >( buffer.data() ), n_my_blocks, block_type, nullptr, nullptr, nullptr, block_type, root_rank, comm );
+		if ( block_size > 1 ) MPI_Type_free( &block_type );
+		TR.Debug << "Process " << rank << " sent summaries for " << metrics.size() << " ensemble metrics to process " << root_rank << "." << std::endl;
+		for ( EnsembleMetricOP const & metric : metrics ) {
+			metric->reset(); //Suppresses this process from producing reports.
+		}
+		return;
+	}
+
+	// Counts and displacements are in blocks.
+	utility::vector1< int > counts( nprocs, 0 ), displacements( nprocs, 0 );
+	core::Size total_blocks(0);
+	for ( core::Size i(1); i <= static_cast< core::Size >( nprocs ); ++i ) {
+		counts[i] = static_cast< int >( n_mpi_blocks( sizes[i], block_size ) );
+		displacements[i] = static_cast< int >( total_blocks );
+		total_blocks += static_cast< core::Size >( counts[i] );
+	}
+	buffer.resize( total_blocks * block_size );
+	MPI_Gatherv( MPI_IN_PLACE, 0, block_type, static_cast< void * >( total_blocks > 0 ? &buffer[0] : nullptr ), counts.data(), displacements.data(), block_type, root_rank, comm );
+	if ( block_size > 1 ) MPI_Type_free( &block_type );
+
+	// Unpack and merge, in rank order.  Padding is ignored.
+	for ( core::Size i(1); i <= static_cast< core::Size >( nprocs ); ++i ) {
+		if ( static_cast< int >( i - 1 ) == root_rank ) continue;
+		EnsembleMetricSummaryReader reader( buffer.data() + static_cast< core::Size >( displacements[i] ) * block_size, static_cast< core::Size >( sizes[i] ) );
+		merge_ensemble_metric_summaries( metrics, reader, "process " + std::to_string( i - 1 ) );
+	}
+	TR.Debug << "Process " << root_rank << " merged summaries for " << metrics.size() << " ensemble metrics from " << nprocs - 1 << " other processes." << std::endl;
+}
+
+/// @brief Combine the data accumulated by many EnsembleMetrics in every process of an MPI communicator in the
+/// copies in the process with rank 0, in two levels: first within each shared-memory node, then across nodes.
+/// @details The communicator is split into one communicator per shared-memory node (MPI_Comm_split_type with
+/// MPI_COMM_TYPE_SHARED), and the lowest-ranked process on each node that has metrics gathers the data of the other
+/// processes on its node with gather_ensemble_metric_summaries_to_root().  These node leaders then gather their merged data
+/// in process 0 in the same way.  The MPI library can carry the node-local transfers over shared memory, and
+/// only one buffer per node (rather than one per process) crosses the network.  Data arrive in process 0 grouped
+/// by node, in rank order within each node.  Non-root processes reset their copies of the metrics.
+/// @note The same requirements as for gather_ensemble_metric_summaries_to_root() apply.  All processes in the
+/// communicator must call this function with the same metrics in the same order (it is collective over comm).  A process
+/// other than process 0 that has no metrics may pass an empty list.
+void
+hierarchically_gather_ensemble_metric_summaries_to_root(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	MPI_Comm comm
+) {
+	int rank(0), nprocs(1);
+	MPI_Comm_rank( comm, &rank );
+	MPI_Comm_size( comm, &nprocs );
+	runtime_assert_string_msg( rank != 0 || !metrics.empty(), "Error in protocols::ensemble_metrics::hierarchically_gather_ensemble_metric_summaries_to_root(): Process 0 has no ensemble metrics to gather data into." );
+
+	// Level 1: within each node.  A node leader merges the data of the other processes on its node, so it needs the
+	// metrics.  Ordering processes that have them first, by rank, makes the lowest-ranked such process on each node its
+	// leader, so process 0 leads its own node.  (If no process on a node has metrics, none has data either.)
+	MPI_Comm node_comm;
+	MPI_Comm_split_type( comm, MPI_COMM_TYPE_SHARED, ( metrics.empty() ? nprocs : 0 ) + rank, MPI_INFO_NULL, &node_comm );
+	int node_rank(0), node_nprocs(1);
+	MPI_Comm_rank( node_comm, &node_rank );
+	MPI_Comm_size( node_comm, &node_nprocs );
+	if ( node_nprocs > 1 ) {
+		gather_ensemble_metric_summaries_to_root( metrics, 0, node_comm );
+	}
+	MPI_Comm_free( &node_comm );
+
+	// Level 2: across node leaders.  Other processes are left out of the leaders' communicator.
+	MPI_Comm leader_comm;
+	MPI_Comm_split( comm, ( node_rank == 0 ? 0 : MPI_UNDEFINED ), rank, &leader_comm );
+	if ( leader_comm == MPI_COMM_NULL ) return;
+	int n_nodes(1);
+	MPI_Comm_size( leader_comm, &n_nodes );
+	if ( n_nodes > 1 ) {
+		gather_ensemble_metric_summaries_to_root( metrics, 0, leader_comm );
+	}
+	MPI_Comm_free( &leader_comm );
+	if ( rank == 0 ) {
+		TR.Debug << "Process 0 merged summaries for " << metrics.size() << " ensemble metrics from " << n_nodes << " nodes." << std::endl;
+	}
+}
+
+/// @brief Send n_bytes bytes (at most INT_MAX) to another process, giving up if the send has not completed within
+/// timeout_seconds.
+/// @details The data are copied, and the send is cancelled on timeout.  If the MPI library cannot cancel it, the request
+/// is released and the copy is deliberately leaked, since the library may still read from it.
+/// @returns True if the send completed.
+static
+bool
+send_with_timeout(
+	char const * const data,
+	core::Size const n_bytes,
+	int const destination,
+	int const tag,
+	MPI_Comm comm,
+	core::Real const timeout_seconds
+) {
+	runtime_assert( n_bytes <= static_cast< core::Size >( std::numeric_limits< int >::max() ) ); //Should be true.
+	std::string * const send_buffer( new std::string( data, n_bytes ) );
+	MPI_Request request;
+	MPI_Isend( static_cast< const void * >( send_buffer->data() ), static_cast< int >( send_buffer->size() ), MPI_BYTE, destination, tag, comm, &request );
+
+	std::chrono::steady_clock::time_point const deadline( std::chrono::steady_clock::now() + std::chrono::duration_cast< std::chrono::steady_clock::duration >( std::chrono::duration< double >( timeout_seconds ) ) );
+	int completed(0);
+	MPI_Status status;
+	MPI_Test( &request, &completed, &status );
+	while ( !completed && std::chrono::steady_clock::now() < deadline ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+		MPI_Test( &request, &completed, &status );
+	}
+	if ( completed ) {
+		delete send_buffer;
+		return true;
+	}
+
+	// Give the cancellation a short, bounded time to take effect.
+	MPI_Cancel( &request );
+	std::chrono::steady_clock::time_point const cancel_deadline( std::chrono::steady_clock::now() + std::chrono::seconds( 1 ) );
+	MPI_Test( &request, &completed, &status );
+	while ( !completed && std::chrono::steady_clock::now() < cancel_deadline ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+		MPI_Test( &request, &completed, &status );
+	}
+	if ( !completed ) {
+		MPI_Request_free( &request );
+		return false; // send_buffer is leaked deliberately.
+	}
+	delete send_buffer;
+	int cancelled(0);
+	MPI_Test_cancelled( &status, &cancelled );
+	return !cancelled;
+}
+
+/// @brief Combine the data accumulated by many EnsembleMetrics in every process of an MPI communicator in the
+/// copies in the process with rank root_rank, without letting a process that has died (or that never arrives) stall the
+/// root indefinitely.
+/// @details Non-root processes pack the summaries of all of the metrics into one buffer (as in
+/// gather_ensemble_metric_summaries_to_root()), send it to the root with point-to-point messages, and reset their copies
+/// of the metrics.  Each buffer is sent as a message holding its size, followed by the buffer in chunks of at most 1 GiB,
+/// so buffers of any size can be sent.  The root polls for these messages until all buffers have arrived in full or
+/// until timeout_seconds have passed, and then merges what it received in rank order.  No collective operations are used, so the root completes even if some
+/// processes never call this function.  Non-root processes likewise give up sending after timeout_seconds.  A process
+/// that has no metrics may pass an empty list.
+/// @note Every EnsembleMetric must support summary merging.  Messages that arrive after the timeout are never received.
+/// Summaries use native byte order, so all processes are assumed to run on the same architecture.
+/// @returns In the root process, the ranks of the processes whose data did not arrive in time (for recovery by other
+/// means, such as EnsembleMetricCheckpointer::recover_from_checkpoints()).  Empty in other processes.
+utility::vector1< int >
+gather_ensemble_metric_summaries_to_root_with_timeout(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	int const root_rank,
+	MPI_Comm comm,
+	core::Real const timeout_seconds
+) {
+	std::string const errmsg( "Error in protocols::ensemble_metrics::gather_ensemble_metric_summaries_to_root_with_timeout(): " );
+	for ( EnsembleMetricOP const & metric : metrics ) {
+		runtime_assert_string_msg( metric != nullptr, errmsg + "Null ensemble metric passed to function." );
+		runtime_assert_string_msg( metric->supports_summary_merging(), errmsg + "The " + metric->name() + " ensemble metric does not support summary merging." );
+	}
+	runtime_assert_string_msg( timeout_seconds >= 0.0, errmsg + "The timeout cannot be negative." );
+
+	int rank(0), nprocs(1);
+	MPI_Comm_rank( comm, &rank );
+	MPI_Comm_size( comm, &nprocs );
+	runtime_assert_string_msg( root_rank >= 0 && root_rank < nprocs, errmsg + "The root rank is not in the communicator." );
+
+	utility::vector1< int > missing_ranks;
+	if ( rank != root_rank ) {
+		std::string buffer;
+		append_ensemble_metric_summaries( metrics, buffer );
+		std::string header;
+		EnsembleMetricSummaryWriter header_writer( header );
+		header_writer.write< std::uint64_t >( static_cast< std::uint64_t >( buffer.size() ) );
+		// The root may have stopped listening, so the sends must not block indefinitely either.  Messages from one process
+		// with one tag arrive in the order sent, so the root can reassemble the chunks.
+		bool sent( send_with_timeout( header.data(), header.size(), root_rank, ensemble_metric_summary_with_timeout_mpi_tag, comm, timeout_seconds ) );
+		for ( core::Size first(0); sent && first < buffer.size(); first += max_bytes_per_mpi_message ) {
+			sent = send_with_timeout( buffer.data() + first, std::min( max_bytes_per_mpi_message, buffer.size() - first ), root_rank, ensemble_metric_summary_with_timeout_mpi_tag, comm, timeout_seconds );
+		}
+		if ( sent ) {
+			TR.Debug << "Process " << rank << " sent summaries for " << metrics.size() << " ensemble metrics to process " << root_rank << "." << std::endl;
+		} else {
+			TR.Warning << "Process " << rank << " could not send summaries for " << metrics.size() << " ensemble metrics to process " << root_rank << " within " << timeout_seconds << " seconds." << std::endl;
+		}
+		for ( EnsembleMetricOP const & metric : metrics ) {
+			metric->reset(); //Suppresses this process from producing reports.
+		}
+		return missing_ranks;
+	}
+
+	// Receive whatever arrives before the deadline.  The first message from each process gives the size of its buffer,
+	// and the rest are appended until the buffer is complete.  Buffers are kept until the end so that merging is in rank
+	// order.
+	std::map< int, core::Size > expected_sizes;
+	std::map< int, std::string > received;
+	core::Size n_complete(0);
+	std::string message;
+	std::chrono::steady_clock::time_point const deadline( std::chrono::steady_clock::now() + std::chrono::duration_cast< std::chrono::steady_clock::duration >( std::chrono::duration< double >( timeout_seconds ) ) );
+	while ( n_complete < static_cast< core::Size >( nprocs - 1 ) ) {
+		int message_waiting(0);
+		MPI_Status status;
+		MPI_Iprobe( MPI_ANY_SOURCE, ensemble_metric_summary_with_timeout_mpi_tag, comm, &message_waiting, &status );
+		if ( !message_waiting ) {
+			if ( std::chrono::steady_clock::now() >= deadline ) break;
+			std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+			continue;
+		}
+		int const source( status.MPI_SOURCE );
+		int n_bytes(0);
+		MPI_Get_count( &status, MPI_BYTE, &n_bytes );
+		message.resize( static_cast< core::Size >( n_bytes ) );
+		MPI_Recv( static_cast< void * >( n_bytes > 0 ? &message[0] : nullptr ), n_bytes, MPI_BYTE, source, ensemble_metric_summary_with_timeout_mpi_tag, comm, MPI_STATUS_IGNORE );
+		std::string & buffer( received[ source ] );
+		std::map< int, core::Size >::const_iterator const expected( expected_sizes.find( source ) );
+		if ( expected == expected_sizes.end() ) {
+			EnsembleMetricSummaryReader reader( message.data(), message.size() );
+			core::Size const expected_size( static_cast< core::Size >( reader.read< std::uint64_t >() ) );
+			expected_sizes[ source ] = expected_size;
+			buffer.reserve( expected_size );
+		} else {
+			runtime_assert_string_msg( buffer.size() + message.size() <= expected->second, errmsg + "Received more ensemble metric data than expected from process " + std::to_string( source ) + "." );
+			buffer.append( message );
+		}
+		if ( buffer.size() == expected_sizes[ source ] ) ++n_complete;
+	}
+
+	for ( int source(0); source < nprocs; ++source ) {
+		if ( source == root_rank ) continue;
+		std::map< int, std::string >::const_iterator const it( received.find( source ) );
+		if ( it == received.end() || it->second.size() != expected_sizes[ source ] ) {
+			missing_ranks.push_back( source );
+			continue;
+		}
+		EnsembleMetricSummaryReader reader( it->second.data(), it->second.size() );
+		// A process that never ran a job never set up its EnsembleMetrics, and sends none.
+		merge_ensemble_metric_summaries( metrics, reader, "process " + std::to_string( source ) );
+	}
+	if ( !missing_ranks.empty() ) {
+		TR.Warning << "Process " << root_rank << " did not receive ensemble metric summaries from " << missing_ranks.size() << " of " << nprocs - 1 << " processes within " << timeout_seconds << " seconds." << std::endl;
+	}
+	TR.Debug << "Process " << root_rank << " merged summaries for " << metrics.size() << " ensemble metrics from " << n_complete << " other processes." << std::endl;
+	return missing_ranks;
+}
+#endif //USEMPI
+
 } //core
 } //ensemble_metrics
 
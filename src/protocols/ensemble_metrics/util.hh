@@ -36,8 +36,10 @@
 #define INCLUDED_protocols_ensemble_metrics_util_hh
 
 #include <protocols/ensemble_metrics/EnsembleMetric.fwd.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryIO.fwd.hh>
 
 #include <core/pose/Pose.fwd.hh>
+#include <core/types.hh>
 
 // Basic headers
 #include <basic/datacache/DataMap.fwd.hh>
@@ -47,6 +49,10 @@
 
 //C++ headers
 
+#ifdef USEMPI
+#include <mpi.h>
+#endif
+
 namespace protocols {
 namespace ensemble_metrics {
 
@@ -93,6 +99,105 @@ throw_sm_override_error(
 	std::string const & metric_name
 );
 
+/// @brief Append the summaries of several EnsembleMetrics to a buffer: a count, followed by the output of pack_summary()
+/// for each metric, in order.
+/// @details This is the format in which processes exchange the data of all of their ensemble metrics at once.  Every
+/// EnsembleMetric must support summary merging.
+void
+append_ensemble_metric_summaries(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	std::string & buffer
+);
+
+/// @brief Read summaries written by append_ensemble_metric_summaries() (or in the same format, with deltas) and merge each
+/// into the EnsembleMetric in the same position in the list.
+/// @details The reader must be positioned at the count.  A count of zero (from a process that never set up its ensemble
+/// metrics) merges nothing.  Any other count must match the number of metrics.  Throws if the count does not match, or
+/// if any data follow the last summary.  The source is a description of where the data came from (e.g. "process 3"),
+/// for error messages.
+/// @returns The number of summaries merged.
+core::Size
+merge_ensemble_metric_summaries(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	EnsembleMetricSummaryReader & reader,
+	std::string const & source
+);
+
+#ifdef USEMPI
+/// @brief Combine the data accumulated by an EnsembleMetric in every process of an MPI communicator in the
+/// copy in the process with rank 0.
+/// @details This uses a binomial reduction tree: in round k, each process with rank r such that bit k is the
+/// lowest set bit of r sends its packed summary to process r - 2^k and then resets its copy of the metric; the
+/// receiving process merges it.  This takes ceil(log2(nprocs)) rounds instead of the nprocs - 1 serial receives
+/// that the root would otherwise have to do, and data always arrive in the root in rank order.
+/// @note The EnsembleMetric must support summary merging.  All processes in the communicator must call this
+/// function (it is collective over comm).  Summaries use native byte order, so all processes are assumed to
+/// run on the same architecture.
+void
+reduce_ensemble_metric_summaries_to_root(
+	EnsembleMetric & metric,
+	MPI_Comm comm
+);
+
+/// @brief Combine the data accumulated by many EnsembleMetrics in every process of an MPI communicator in the
+/// copies in the process with rank root_rank, using a single collective operation for all of the metrics.
+/// @details Each non-root process packs the summaries of all of the metrics into one contiguous buffer.  One
+/// MPI_Gather of buffer sizes and one MPI_Gatherv of the buffers follow, and the root process unpacks each buffer and
+/// merges the summaries in rank order.  Non-root processes then reset their copies of the metrics.  This costs one
+/// pair of collectives in total (plus a broadcast of the block size), rather than one or more messages per metric per
+/// process.  Buffers of any size can be gathered: if the total exceeds 2 GiB, they are sent in blocks of a power-of-two
+/// number of bytes, so that the int counts and displacements of MPI_Gatherv suffice.
+/// @note Every EnsembleMetric must support summary merging, and all processes in the communicator must call this
+/// function with the same root and the same metrics in the same order (it is collective over comm).  A non-root
+/// process that has no metrics (e.g. one that never ran a job) may pass an empty list, and contributes nothing.
+/// Summaries use native byte order, so all processes are assumed to run on the same architecture.
+void
+gather_ensemble_metric_summaries_to_root(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	int const root_rank,
+	MPI_Comm comm
+);
+
+/// @brief Combine the data accumulated by many EnsembleMetrics in every process of an MPI communicator in the
+/// copies in the process with rank 0, in two levels: first within each shared-memory node, then across nodes.
+/// @details The communicator is split into one communicator per shared-memory node (MPI_Comm_split_type with
+/// MPI_COMM_TYPE_SHARED), and the lowest-ranked process on each node that has metrics gathers the data of the other
+/// processes on its node with gather_ensemble_metric_summaries_to_root().  These node leaders then gather their merged data
+/// in process 0 in the same way.  The MPI library can carry the node-local transfers over shared memory, and
+/// only one buffer per node (rather than one per process) crosses the network.  Data arrive in process 0 grouped
+/// by node, in rank order within each node.  Non-root processes reset their copies of the metrics.
+/// @note The same requirements as for gather_ensemble_metric_summaries_to_root() apply.  All processes in the
+/// communicator must call this function with the same metrics in the same order (it is collective over comm).  A process
+/// other than process 0 that has no metrics may pass an empty list.
+void
+hierarchically_gather_ensemble_metric_summaries_to_root(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	MPI_Comm comm
+);
+
+/// @brief Combine the data accumulated by many EnsembleMetrics in every process of an MPI communicator in the
+/// copies in the process with rank root_rank, without letting a process that has died (or that never arrives) stall the
+/// root indefinitely.
+/// @details Non-root processes pack the summaries of all of the metrics into one buffer (as in
+/// gather_ensemble_metric_summaries_to_root()), send it to the root with point-to-point messages, and reset their copies
+/// of the metrics.  Buffers of any size can be sent: each is preceded by its size and sent in chunks of at most 1 GiB.
+/// The root polls for these messages until all buffers have arrived in full or until timeout_seconds have passed, and
+/// then merges what it received in rank order.  No collective operations are used, so the root completes even if some
+/// processes never call this function.  Non-root processes likewise give up sending after timeout_seconds.  A process
+/// that has no metrics may pass an empty list.
+/// @note Every EnsembleMetric must support summary merging.  Messages that arrive after the timeout are never received.
+/// Summaries use native byte order, so all processes are assumed to run on the same architecture.
+/// @returns In the root process, the ranks of the processes whose data did not arrive in time (for recovery by other
+/// means, such as EnsembleMetricCheckpointer::recover_from_checkpoints()).  Empty in other processes.
+utility::vector1< int >
+gather_ensemble_metric_summaries_to_root_with_timeout(
+	utility::vector1< EnsembleMetricOP > const & metrics,
+	int const root_rank,
+	MPI_Comm comm,
+	core::Real const timeout_seconds
+);
+#endif //USEMPI
+
 } //core
 } //ensemble_metrics
 
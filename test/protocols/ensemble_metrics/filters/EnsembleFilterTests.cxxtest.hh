@@ -0,0 +1,308 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleFilterTests.cxxtest.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file  protocols/ensemble_metrics/filters/EnsembleFilterTests.cxxtest.hh
+/// @brief  Unit tests for the EnsembleFilter, including the combination of several criteria.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+
+// Test headers
+#include <cxxtest/TestSuite.h>
+#include <test/core/init_util.hh>
+
+// Project Headers
+#include <protocols/ensemble_metrics/filters/EnsembleFilter.hh>
+#include <protocols/ensemble_metrics/metrics/CentralTendencyEnsembleMetric.hh>
+
+// Core Headers
+#include <core/pose/Pose.hh>
+
+// Utility, etc Headers
+#include <basic/Tracer.hh>
+#include <utility/vector1.hh>
+#include <utility/pointer/memory.hh>
+
+// STL headers
+#include <sstream>
+
+static basic::Tracer TR("EnsembleFilterTests");
+
+/// @brief A central tendency ensemble metric that counts how many times each of its values is fetched, so that
+/// the tests can check which criteria the filter evaluated.
+class CountingCentralTendencyEnsembleMetric : public protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric {
+public:
+	/// @brief How many times has the value with the given name been fetched?
+	core::Size fetch_count( std::string const & metric_name ) const {
+		return fetch_counts_[ real_valued_metric_index( metric_name ) ];
+	}
+
+private:
+	core::Real
+	derived_get_real_metric_value_by_index(
+		core::Size const metric_index
+	) const override {
+		++fetch_counts_[ metric_index ];
+		std::string const & metric_name( real_valued_metric_names()[ metric_index ] );
+		if ( metric_name == "mean" ) return statistics().mean();
+		if ( metric_name == "max" ) return statistics().max();
+		TS_FAIL( "Unexpected value \"" + metric_name + "\" fetched." );
+		return 0.0;
+	}
+
+	mutable utility::vector1< core::Size > fetch_counts_ = utility::vector1< core::Size >( real_valued_metric_names().size(), 0 );
+};
+
+
+class EnsembleFilterTests : public CxxTest::TestSuite {
+	//Define Variables
+
+public:
+
+	void setUp() {
+		core_init();
+	}
+
+	void tearDown() {
+
+	}
+
+	/// @brief Make a central tendency ensemble metric holding the given values.
+	protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetricOP
+	make_metric(
+		utility::vector1< core::Real > const & values
+	) const {
+		protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetricOP metric(
+			utility::pointer::make_shared< protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric >()
+		);
+		metric->add_values( values );
+		return metric;
+	}
+
+	/// @brief Resetting the ensemble metric and accumulating new data must invalidate the filter's cached
+	/// validation, so that the metric is finalized again and the filter sees the new values.
+	void test_metric_reset_invalidates_cached_validation() {
+		TR << "Starting EnsembleFilterTests:test_metric_reset_invalidates_cached_validation." << std::endl;
+		using namespace protocols::ensemble_metrics;
+
+		metrics::CentralTendencyEnsembleMetricOP metric( make_metric( { 1.0, 2.0, 3.0 } ) );
+		filters::EnsembleFilter filter;
+		filter.set_ensemble_metric( metric );
+		filter.set_named_value( "mean" );
+		filter.set_acceptance_mode( filters::EnsembleFilterAcceptanceMode::LESS_THAN );
+		filter.set_threshold( 2.5 );
+
+		core::pose::Pose const pose;
+		TS_ASSERT( !metric->finalized() );
+		TS_ASSERT( filter.apply( pose ) ); //Validates, and finalizes the metric.  Mean is 2.
+		TS_ASSERT( metric->finalized() );
+		core::Size const first_generation( metric->generation() );
+
+		metric->reset();
+		metric->add_values( utility::vector1< core::Real >{ 4.0, 5.0, 6.0 } );
+		TS_ASSERT_DIFFERS( metric->generation(), first_generation );
+		TS_ASSERT( !metric->finalized() );
+		TS_ASSERT( !filter.apply( pose ) ); //Must validate again.  Mean is now 5.
+		TS_ASSERT( metric->finalized() );
+		TS_ASSERT_DELTA( filter.report_sm( pose ), 5.0, 1.0e-6 );
+
+		metric->reset(); //Suppresses the report on destruction.
+		TR << "Completed EnsembleFilterTests:test_metric_reset_invalidates_cached_validation." << std::endl;
+	}
+
+	/// @brief A copy of an ensemble metric holds the same data, so it is in the same generation.  A copy of the
+	/// filter shares the ensemble metric, so it keeps the cached validation, but it is still invalidated by a reset.
+	void test_copies_keep_generation() {
+		TR << "Starting EnsembleFilterTests:test_copies_keep_generation." << std::endl;
+		using namespace protocols::ensemble_metrics;
+
+		metrics::CentralTendencyEnsembleMetricOP metric( make_metric( { 1.0, 2.0, 3.0 } ) );
+		metric->reset(); //Advances the generation past its initial value, so that the comparison below means something.
+		metric->add_values( utility::vector1< core::Real >{ 1.0, 2.0, 3.0 } );
+		metrics::CentralTendencyEnsembleMetric metric_copy( *metric );
+		TS_ASSERT_EQUALS( metric_copy.generation(), metric->generation() );
+
+		filters::EnsembleFilter filter;
+		filter.set_ensemble_metric( metric );
+		filter.set_named_value( "max" );
+		filter.set_acceptance_mode( filters::EnsembleFilterAcceptanceMode::GREATER_THAN_EQ );
+		filter.set_threshold( 3.0 );
+		core::pose::Pose const pose;
+		TS_ASSERT( filter.apply( pose ) );
+
+		filters::EnsembleFilter const filter_copy( filter );
+		TS_ASSERT_EQUALS( filter_copy.ensemble_metric(), metric );
+		TS_ASSERT( filter_copy.apply( pose ) );
+
+		metric->reset();
+		metric->add_values( utility::vector1< core::Real >{ 0.5, 1.5 } );
+		TS_ASSERT( !filter_copy.apply( pose ) );
+		TS_ASSERT( metric->finalized() );
+
+		metric->reset(); //Suppresses the report on destruction.
+		metric_copy.reset();
+		TR << "Completed EnsembleFilterTests:test_copies_keep_generation." << std::endl;
+	}
+
+	/// @brief Make a filter on the given metric with two criteria: mean < mean_threshold, and max >= max_threshold.
+	protocols::ensemble_metrics::filters::EnsembleFilter
+	make_two_criterion_filter(
+		protocols::ensemble_metrics::EnsembleMetricOP const & metric,
+		core::Real const mean_threshold,
+		core::Real const max_threshold,
+		protocols::ensemble_metrics::filters::EnsembleFilterCombinationMode const combination_mode
+	) const {
+		using namespace protocols::ensemble_metrics::filters;
+		EnsembleFilter filter;
+		filter.set_ensemble_metric( metric );
+		filter.add_criterion( "mean", EnsembleFilterAcceptanceMode::LESS_THAN, mean_threshold );
+		filter.add_criterion( "max", EnsembleFilterAcceptanceMode::GREATER_THAN_EQ, max_threshold );
+		filter.set_combination_mode( combination_mode );
+		return filter;
+	}
+
+	/// @brief Under AND, every criterion must pass.  A failing first criterion decides the outcome without the
+	/// second being considered, and vice versa.
+	void test_and_combination() {
+		TR << "Starting EnsembleFilterTests:test_and_combination." << std::endl;
+		using namespace protocols::ensemble_metrics;
+
+		metrics::CentralTendencyEnsembleMetricOP metric( make_metric( { 1.0, 2.0, 6.0 } ) ); //Mean 3, max 6.
+		core::pose::Pose const pose;
+
+		filters::EnsembleFilter const both_pass( make_two_criterion_filter( metric, 4.0, 5.0, filters::EnsembleFilterCombinationMode::AND ) );
+		TS_ASSERT_EQUALS( both_pass.criteria().size(), 2 );
+		TS_ASSERT_EQUALS( both_pass.criteria()[1].named_value, "mean" );
+		TS_ASSERT_EQUALS( both_pass.criteria()[2].named_value, "max" );
+		TS_ASSERT( both_pass.apply( pose ) );
+
+		filters::EnsembleFilter const first_fails( make_two_criterion_filter( metric, 2.0, 5.0, filters::EnsembleFilterCombinationMode::AND ) );
+		TS_ASSERT( !first_fails.apply( pose ) );
+
+		filters::EnsembleFilter const second_fails( make_two_criterion_filter( metric, 4.0, 7.0, filters::EnsembleFilterCombinationMode::AND ) );
+		TS_ASSERT( !second_fails.apply( pose ) );
+
+		filters::EnsembleFilter const both_fail( make_two_criterion_filter( metric, 2.0, 7.0, filters::EnsembleFilterCombinationMode::AND ) );
+		TS_ASSERT( !both_fail.apply( pose ) );
+
+		// The value reported is always the first criterion's, whichever criterion decided the outcome.
+		TS_ASSERT_DELTA( second_fails.report_sm( pose ), 3.0, 1.0e-6 );
+
+		metric->reset(); //Suppresses the report on destruction.
+		TR << "Completed EnsembleFilterTests:test_and_combination." << std::endl;
+	}
+
+	/// @brief Under OR, any one criterion suffices.  A passing first criterion decides the outcome without the
+	/// second being considered, and vice versa.
+	void test_or_combination() {
+		TR << "Starting EnsembleFilterTests:test_or_combination." << std::endl;
+		using namespace protocols::ensemble_metrics;
+
+		metrics::CentralTendencyEnsembleMetricOP metric( make_metric( { 1.0, 2.0, 6.0 } ) ); //Mean 3, max 6.
+		core::pose::Pose const pose;
+
+		filters::EnsembleFilter const both_pass( make_two_criterion_filter( metric, 4.0, 5.0, filters::EnsembleFilterCombinationMode::OR ) );
+		TS_ASSERT( both_pass.apply( pose ) );
+
+		filters::EnsembleFilter const first_passes( make_two_criterion_filter( metric, 4.0, 7.0, filters::EnsembleFilterCombinationMode::OR ) );
+		TS_ASSERT( first_passes.apply( pose ) );
+
+		filters::EnsembleFilter const second_passes( make_two_criterion_filter( metric, 2.0, 5.0, filters::EnsembleFilterCombinationMode::OR ) );
+		TS_ASSERT( second_passes.apply( pose ) );
+
+		filters::EnsembleFilter const both_fail( make_two_criterion_filter( metric, 2.0, 7.0, filters::EnsembleFilterCombinationMode::OR ) );
+		TS_ASSERT( !both_fail.apply( pose ) );
+
+		metric->reset(); //Suppresses the report on destruction.
+		TR << "Completed EnsembleFilterTests:test_or_combination." << std::endl;
+	}
+
+	/// @brief Once an earlier criterion decides the outcome, later criteria are not evaluated: their values are
+	/// never fetched from the ensemble metric, and the summary lists them as not evaluated.
+	void test_short_circuit_evaluation() {
+		TR << "Starting EnsembleFilterTests:test_short_circuit_evaluation." << std::endl;
+		using namespace protocols::ensemble_metrics;
+
+		utility::pointer::shared_ptr< CountingCentralTendencyEnsembleMetric > metric(
+			utility::pointer::make_shared< CountingCentralTendencyEnsembleMetric >()
+		);
+		metric->add_values( utility::vector1< core::Real >{ 1.0, 2.0, 6.0 } ); //Mean 3, max 6.
+		core::pose::Pose const pose;
+
+		// Under AND, a failing first criterion decides the outcome.  The second would pass.
+		filters::EnsembleFilter const and_filter( make_two_criterion_filter( metric, 2.0, 5.0, filters::EnsembleFilterCombinationMode::AND ) );
+		TS_ASSERT( !and_filter.apply( pose ) );
+		TS_ASSERT_EQUALS( metric->fetch_count( "mean" ), 1 );
+		TS_ASSERT_EQUALS( metric->fetch_count( "max" ), 0 );
+
+		// Under OR, a passing first criterion decides the outcome.  The second would fail.
+		filters::EnsembleFilter const or_filter( make_two_criterion_filter( metric, 4.0, 7.0, filters::EnsembleFilterCombinationMode::OR ) );
+		std::ostringstream summary;
+		or_filter.report( summary, pose );
+		TS_ASSERT_EQUALS( metric->fetch_count( "mean" ), 2 );
+		TS_ASSERT_EQUALS( metric->fetch_count( "max" ), 0 );
+		TS_ASSERT( summary.str().find( "max (not evaluated)" ) != std::string::npos );
+		TS_ASSERT( summary.str().find( "PASSES" ) != std::string::npos );
+
+		// When the first criterion does not decide the outcome, the second is evaluated.
+		filters::EnsembleFilter const undecided_filter( make_two_criterion_filter( metric, 2.0, 7.0, filters::EnsembleFilterCombinationMode::OR ) );
+		TS_ASSERT( !undecided_filter.apply( pose ) );
+		TS_ASSERT_EQUALS( metric->fetch_count( "mean" ), 3 );
+		TS_ASSERT_EQUALS( metric->fetch_count( "max" ), 1 );
+
+		metric->reset(); //Suppresses the report on destruction.
+		TR << "Completed EnsembleFilterTests:test_short_circuit_evaluation." << std::endl;
+	}
+
+	/// @brief The combination mode can be set by string, and a single criterion behaves the same under either mode.
+	void test_combination_mode_strings_and_single_criterion() {
+		TR << "Starting EnsembleFilterTests:test_combination_mode_strings_and_single_criterion." << std::endl;
+		using namespace protocols::ensemble_metrics;
+
+		metrics::CentralTendencyEnsembleMetricOP metric( make_metric( { 1.0, 2.0, 6.0 } ) ); //Mean 3, max 6.
+		core::pose::Pose const pose;
+
+		filters::EnsembleFilter filter;
+		filter.set_ensemble_metric( metric );
+		filter.add_criterion( "mean", filters::EnsembleFilterAcceptanceMode::GREATER_THAN, 3.5 );
+		TS_ASSERT_EQUALS( filter.criteria().size(), 1 ); //Replaces the empty default criterion.
+
+		filter.set_combination_mode( "or" );
+		TS_ASSERT_EQUALS( filter.combination_mode(), filters::EnsembleFilterCombinationMode::OR );
+		TS_ASSERT( !filter.apply( pose ) );
+
+		filter.set_combination_mode( "and" );
+		TS_ASSERT_EQUALS( filter.combination_mode(), filters::EnsembleFilterCombinationMode::AND );
+		TS_ASSERT( !filter.apply( pose ) );
+
+		metric->reset(); //Suppresses the report on destruction.
+		TR << "Completed EnsembleFilterTests:test_combination_mode_strings_and_single_criterion." << std::endl;
+	}
+
+};
@@ -0,0 +1,158 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (CentralTendencyStatisticsTests.cxxtest.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/// @file  protocols/ensemble_metrics/metrics/CentralTendencyStatisticsTests.cxxtest.hh
+/// @brief  Unit tests for the pose-independent statistics engine used by the central tendency ensemble metric.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+
+// Test headers
+#include <cxxtest/TestSuite.h>
+#include <test/core/init_util.hh>
+
+// Project Headers
+#include <protocols/ensemble_metrics/metrics/CentralTendencyStatistics.hh>
+#include <protocols/ensemble_metrics/metrics/CentralTendencyEnsembleMetric.hh>
+
+// Utility, etc Headers
+#include <basic/Tracer.hh>
+#include <utility/vector1.hh>
+
+static basic::Tracer TR("CentralTendencyStatisticsTests");
+
+
+class CentralTendencyStatisticsTests : public CxxTest::TestSuite {
+	//Define Variables
+
+public:
+
+	void setUp() {
+		core_init();
+	}
+
+	void tearDown() {
+
+	}
+
+	/// @brief The same three ensembles as in the CentralTendencyEnsembleMetric tests, fed in as
+	/// plain numbers rather than as poses.
+	void test_statistics_from_values() {
+		TR << "Starting CentralTendencyStatisticsTests:test_statistics_from_values." << std::endl;
+
+		protocols::ensemble_metrics::metrics::CentralTendencyStatistics stats;
+
+		// Ensemble 1, added one value at a time:
+		for ( core::Real const val : { 1.0, 1.0, 2.0, 1.0, 0.0 } ) {
+			stats.add_value( val );
+		}
+		TS_ASSERT( !stats.finalized() );
+		TS_ASSERT_EQUALS( stats.n_values(), 5 );
+		stats.finalize();
+		TS_ASSERT( stats.finalized() );
+		TS_ASSERT_DELTA( stats.mean(), 1.0, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.median(), 1.0, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.mode(), 1.0, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.stddev(), 0.632455532033676, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.stderror(), 0.282842712474619, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.max(), 2.0, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.min(), 0.0, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.range(), 2.0, 1.0e-6 );
+
+		stats.reset();
+		TS_ASSERT( !stats.finalized() );
+		TS_ASSERT_EQUALS( stats.n_values(), 0 );
+
+		// Ensemble 2, added as a contiguous block:
+		core::Real const ensemble2[7] = { 3.0, 3.0, 2.0, 2.0, 1.0, 0.0, 4.0 };
+		stats.add_values( ensemble2, 7 );
+		stats.finalize();
+		TS_ASSERT_DELTA( stats.mean(), 2.14285714285714, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.median(), 2.0, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.mode(), 2.5, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.stddev(), 1.24539969815448, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.stderror(), 0.470716840598808, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.range(), 4.0, 1.0e-6 );
+
+		stats.reset();
+
+		// Ensemble 3, added as a vector:
+		utility::vector1< core::Real > const ensemble3{ 7.0, 7.0, 1.0, 2.0, 6.0, 6.0, 3.0, 0.0 };
+		stats.add_values( ensemble3 );
+		stats.finalize();
+		TS_ASSERT_DELTA( stats.mean(), 4.0, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.median(), 4.5, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.mode(), 6.5, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.stddev(), 2.64575131106459, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.stderror(), 0.935414346693485, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.range(), 7.0, 1.0e-6 );
+
+		// Quantiles of ensemble 3 (sorted: 0 1 2 3 6 6 7 7):
+		TS_ASSERT_DELTA( stats.quantile( 0.0 ), 0.0, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.quantile( 0.5 ), 4.5, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.quantile( 0.25 ), 1.75, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.quantile( 0.95 ), 7.0, 1.0e-6 );
+		TS_ASSERT_DELTA( stats.quantile( 1.0 ), 7.0, 1.0e-6 );
+
+		TR << "Completed CentralTendencyStatisticsTests:test_statistics_from_values." << std::endl;
+	}
+
+	/// @brief Feed values directly into the ensemble metric, with no poses and no simple metric.
+	void test_ensemble_metric_from_values() {
+		TR << "Starting CentralTendencyStatisticsTests:test_ensemble_metric_from_values." << std::endl;
+
+		protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric ctmetric;
+		ctmetric.add_values( utility::vector1< core::Real >{ 7.0, 7.0, 1.0, 2.0 } );
+		ctmetric.add_value( 6.0 );
+		core::Real const remaining[3] = { 6.0, 3.0, 0.0 };
+		ctmetric.add_values( remaining, 3 );
+		TS_ASSERT_EQUALS( ctmetric.poses_in_ensemble(), 8 );
+
+		// The raw samples are exposed in place, in the order in which they were added:
+		TS_ASSERT( ctmetric.supports_raw_sample_access() );
+		protocols::ensemble_metrics::EnsembleMetricSampleSpan const samples( ctmetric.raw_samples() );
+		TS_ASSERT_EQUALS( samples.n_samples(), 8 );
+		TS_ASSERT_EQUALS( samples.n_values_per_sample(), 1 );
+		TS_ASSERT_EQUALS( samples.data(), ctmetric.statistics().values().data() );
+		TS_ASSERT_DELTA( samples( 3, 1 ), 1.0, 1.0e-6 );
+		TS_ASSERT_DELTA( samples( 8, 1 ), 0.0, 1.0e-6 );
+
+		ctmetric.produce_final_report();
+		TS_ASSERT( ctmetric.finalized() );
+		TS_ASSERT_DELTA( ctmetric.get_real_metric_value_by_name("mean"), 4.0, 1.0e-6 );
+		TS_ASSERT_DELTA( ctmetric.get_real_metric_value_by_name("mode"), 6.5, 1.0e-6 );
+		TS_ASSERT_DELTA( ctmetric.median(), 4.5, 1.0e-6 );
+
+		ctmetric.reset();
+		TS_ASSERT_EQUALS( ctmetric.poses_in_ensemble(), 0 );
+		TS_ASSERT_EQUALS( ctmetric.statistics().n_values(), 0 );
+
+		TR << "Completed CentralTendencyStatisticsTests:test_ensemble_metric_from_values." << std::endl;
+	}
+
+};
@@ -0,0 +1,236 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (EnsembleMetricSummaryTests.cxxtest.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file  protocols/ensemble_metrics/metrics/EnsembleMetricSummaryTests.cxxtest.hh
+/// @brief  Unit tests for packing the data accumulated by ensemble metrics into summaries and merging them back.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+
+// Test headers
+#include <cxxtest/TestSuite.h>
+#include <test/core/init_util.hh>
+
+// Project Headers
+#include <protocols/ensemble_metrics/metrics/CentralTendencyEnsembleMetric.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricSummaryIO.hh>
+#include <protocols/ensemble_metrics/util.hh>
+
+// Utility, etc Headers
+#include <basic/Tracer.hh>
+#include <utility/excn/Exceptions.hh>
+#include <utility/vector1.hh>
+
+// STL headers
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+static basic::Tracer TR("EnsembleMetricSummaryTests");
+
+
+class EnsembleMetricSummaryTests : public CxxTest::TestSuite {
+	//Define Variables
+
+public:
+
+	void setUp() {
+		core_init();
+	}
+
+	void tearDown() {
+
+	}
+
+	/// @brief Split ensemble 1 of the CentralTendencyEnsembleMetric tests over two metrics, pack one, and merge it
+	/// into the other.  The result should be the same as for the whole ensemble.
+	void test_pack_and_merge_round_trip() {
+		TR << "Starting EnsembleMetricSummaryTests:test_pack_and_merge_round_trip." << std::endl;
+
+		using protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric;
+		CentralTendencyEnsembleMetric first, second;
+		TS_ASSERT( first.supports_summary_merging() );
+		first.add_values( utility::vector1< core::Real >{ 1.0, 1.0, 2.0 } );
+		second.add_values( utility::vector1< core::Real >{ 1.0, 0.0 } );
+
+		std::string const summary( second.pack_summary() );
+		TS_ASSERT( !summary.empty() );
+		first.merge_summary( summary );
+		TS_ASSERT_EQUALS( first.poses_in_ensemble(), 5 );
+		TS_ASSERT_EQUALS( first.statistics().n_values(), 5 );
+
+		// Packing does not consume the data:
+		TS_ASSERT_EQUALS( second.poses_in_ensemble(), 2 );
+		second.reset();
+
+		first.produce_final_report();
+		TS_ASSERT_DELTA( first.get_real_metric_value_by_name("mean"), 1.0, 1.0e-6 );
+		TS_ASSERT_DELTA( first.get_real_metric_value_by_name("median"), 1.0, 1.0e-6 );
+		TS_ASSERT_DELTA( first.get_real_metric_value_by_name("stddev"), 0.632455532033676, 1.0e-6 );
+		TS_ASSERT_DELTA( first.get_real_metric_value_by_name("min"), 0.0, 1.0e-6 );
+		TS_ASSERT_DELTA( first.get_real_metric_value_by_name("max"), 2.0, 1.0e-6 );
+
+		// A finalized metric accepts no more data:
+		TS_ASSERT_THROWS_ANYTHING( first.merge_summary( summary ) );
+
+		TR << "Completed EnsembleMetricSummaryTests:test_pack_and_merge_round_trip." << std::endl;
+	}
+
+	/// @brief Truncated or corrupted summaries are rejected.
+	void test_bad_summaries_rejected() {
+		TR << "Starting EnsembleMetricSummaryTests:test_bad_summaries_rejected." << std::endl;
+
+		using protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric;
+		CentralTendencyEnsembleMetric source, destination;
+		source.add_values( utility::vector1< core::Real >{ 3.0, 4.0, 5.0 } );
+		std::string const summary( source.pack_summary() );
+		source.reset();
+
+		TS_ASSERT_THROWS_ANYTHING( destination.merge_summary( summary.substr( 0, summary.size() - 1 ) ) );
+		TS_ASSERT_THROWS_ANYTHING( destination.merge_summary( summary + "x" ) );
+		std::string corrupted( summary );
+		corrupted[0] = static_cast< char >( ~corrupted[0] );
+		TS_ASSERT_THROWS_ANYTHING( destination.merge_summary( corrupted ) );
+		destination.reset();
+
+		TR << "Completed EnsembleMetricSummaryTests:test_bad_summaries_rejected." << std::endl;
+	}
+
+	/// @brief Pack the summaries of two metrics into one buffer, as processes do when they exchange data, and merge
+	/// them into two other metrics.
+	void test_pack_and_merge_batch_round_trip() {
+		TR << "Starting EnsembleMetricSummaryTests:test_pack_and_merge_batch_round_trip." << std::endl;
+
+		using namespace protocols::ensemble_metrics;
+		using protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric;
+		utility::vector1< EnsembleMetricOP > const sources{ utility::pointer::make_shared< CentralTendencyEnsembleMetric >(), utility::pointer::make_shared< CentralTendencyEnsembleMetric >() };
+		utility::vector1< EnsembleMetricOP > const destinations{ utility::pointer::make_shared< CentralTendencyEnsembleMetric >(), utility::pointer::make_shared< CentralTendencyEnsembleMetric >() };
+		utility::pointer::static_pointer_cast< CentralTendencyEnsembleMetric >( sources[1] )->add_values( utility::vector1< core::Real >{ 1.0, 0.0 } );
+		utility::pointer::static_pointer_cast< CentralTendencyEnsembleMetric >( sources[2] )->add_values( utility::vector1< core::Real >{ 10.0, 20.0, 30.0 } );
+		utility::pointer::static_pointer_cast< CentralTendencyEnsembleMetric >( destinations[1] )->add_values( utility::vector1< core::Real >{ 1.0, 1.0, 2.0 } );
+
+		std::string buffer;
+		append_ensemble_metric_summaries( sources, buffer );
+		for ( EnsembleMetricOP const & source : sources ) {
+			source->reset();
+		}
+
+		{
+			EnsembleMetricSummaryReader reader( buffer.data(), buffer.size() );
+			TS_ASSERT_EQUALS( merge_ensemble_metric_summaries( destinations, reader, "the test" ), 2 );
+		}
+		TS_ASSERT_EQUALS( destinations[1]->poses_in_ensemble(), 5 );
+		TS_ASSERT_EQUALS( destinations[2]->poses_in_ensemble(), 3 );
+
+		for ( EnsembleMetricOP const & destination : destinations ) {
+			destination->produce_final_report();
+		}
+		TS_ASSERT_DELTA( destinations[1]->get_real_metric_value_by_name("mean"), 1.0, 1.0e-6 );
+		TS_ASSERT_DELTA( destinations[1]->get_real_metric_value_by_name("stddev"), 0.632455532033676, 1.0e-6 );
+		TS_ASSERT_DELTA( destinations[2]->get_real_metric_value_by_name("mean"), 20.0, 1.0e-6 );
+		TS_ASSERT_DELTA( destinations[2]->get_real_metric_value_by_name("max"), 30.0, 1.0e-6 );
+
+		// A buffer holding no summaries merges nothing:
+		std::string empty_buffer;
+		append_ensemble_metric_summaries( utility::vector1< EnsembleMetricOP >{}, empty_buffer );
+		utility::vector1< EnsembleMetricOP > const unfinalized{ utility::pointer::make_shared< CentralTendencyEnsembleMetric >() };
+		{
+			EnsembleMetricSummaryReader reader( empty_buffer.data(), empty_buffer.size() );
+			TS_ASSERT_EQUALS( merge_ensemble_metric_summaries( unfinalized, reader, "the test" ), 0 );
+		}
+
+		// A count that matches neither zero nor the number of metrics, or trailing data, is rejected:
+		std::string const padded_buffer( buffer + "x" );
+		{
+			EnsembleMetricSummaryReader reader( buffer.data(), buffer.size() );
+			TS_ASSERT_THROWS_ANYTHING( merge_ensemble_metric_summaries( unfinalized, reader, "the test" ) );
+		}
+		{
+			utility::vector1< EnsembleMetricOP > const fresh{ utility::pointer::make_shared< CentralTendencyEnsembleMetric >(), utility::pointer::make_shared< CentralTendencyEnsembleMetric >() };
+			EnsembleMetricSummaryReader reader( padded_buffer.data(), padded_buffer.size() );
+			TS_ASSERT_THROWS_ANYTHING( merge_ensemble_metric_summaries( fresh, reader, "the test" ) );
+			for ( EnsembleMetricOP const & metric : fresh ) {
+				metric->reset();
+			}
+		}
+
+		TR << "Completed EnsembleMetricSummaryTests:test_pack_and_merge_batch_round_trip." << std::endl;
+	}
+
+	/// @brief Save a metric's state to a file, read it back, and merge it into a metric of the same type with the
+	/// label prefix and suffix recovered from the file.
+	void test_state_file_round_trip() {
+		TR << "Starting EnsembleMetricSummaryTests:test_state_file_round_trip." << std::endl;
+
+		using namespace protocols::ensemble_metrics;
+		using protocols::ensemble_metrics::metrics::CentralTendencyEnsembleMetric;
+		std::string const filename( "EnsembleMetricSummaryTests_state.bin" );
+
+		CentralTendencyEnsembleMetric source;
+		source.set_label_prefix( "first_prefix" );
+		source.set_label_suffix( "suffix" );
+		source.add_values( utility::vector1< core::Real >{ 1.0, 1.0, 2.0, 1.0, 0.0 } );
+		source.save_state_to_file( filename );
+		source.reset();
+
+		std::string label;
+		std::string const summary( EnsembleMetric::read_state_file( filename, label ) );
+		TS_ASSERT_EQUALS( label, "first_prefix_" + source.name() + "_suffix" );
+		TS_ASSERT_EQUALS( EnsembleMetric::ensemble_metric_name_from_summary( summary ), source.name() );
+
+		CentralTendencyEnsembleMetric destination;
+		destination.set_label_prefix_and_suffix_from_label( label );
+		TS_ASSERT_EQUALS( destination.get_ensemble_metric_label(), label );
+		destination.merge_summary( summary );
+		TS_ASSERT_EQUALS( destination.poses_in_ensemble(), 5 );
+		destination.produce_final_report();
+		TS_ASSERT_DELTA( destination.get_real_metric_value_by_name("mean"), 1.0, 1.0e-6 );
+		TS_ASSERT_DELTA( destination.get_real_metric_value_by_name("stddev"), 0.632455532033676, 1.0e-6 );
+
+		// Labels without a prefix or suffix, and labels not produced by this metric:
+		CentralTendencyEnsembleMetric unlabelled;
+		unlabelled.set_label_prefix_and_suffix_from_label( unlabelled.name() );
+		TS_ASSERT_EQUALS( unlabelled.get_ensemble_metric_label(), unlabelled.name() );
+		TS_ASSERT_THROWS_ANYTHING( unlabelled.set_label_prefix_and_suffix_from_label( "prefix_" + unlabelled.name() + "x" ) );
+
+		// A truncated file is rejected:
+		{
+			std::ifstream infile( filename, std::ios::in | std::ios::binary );
+			std::string const contents( ( std::istreambuf_iterator< char >( infile ) ), std::istreambuf_iterator< char >() );
+			infile.close();
+			std::ofstream outfile( filename, std::ios::out | std::ios::binary | std::ios::trunc );
+			outfile.write( contents.data(), static_cast< std::streamsize >( contents.size() - 1 ) );
+		}
+		TS_ASSERT_THROWS_ANYTHING( EnsembleMetric::read_state_file( filename, label ) );
+		std::remove( filename.c_str() );
+
+		TR << "Completed EnsembleMetricSummaryTests:test_state_file_round_trip." << std::endl;
+	}
+
+};
@@ -0,0 +1,143 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (ColumnarDumpEnsembleMetricObserverTests.cxxtest.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file  protocols/ensemble_metrics/observers/ColumnarDumpEnsembleMetricObserverTests.cxxtest.hh
+/// @brief  Unit tests for the columnar dump observer of ensemble metric measurements, read back with the
+/// EnsembleMetricColumnarDumpReader.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+
+// Test headers
+#include <cxxtest/TestSuite.h>
+#include <test/core/init_util.hh>
+
+// Project Headers
+#include <protocols/ensemble_metrics/observers/ColumnarDumpEnsembleMetricObserver.hh>
+#include <protocols/ensemble_metrics/EnsembleMetricColumnarDumpReader.hh>
+#include <protocols/ensemble_metrics/metrics/CentralTendencyEnsembleMetric.hh>
+
+// Utility, etc Headers
+#include <basic/Tracer.hh>
+#include <utility/vector1.hh>
+#include <utility/pointer/memory.hh>
+
+// STL headers
+#include <cstdio>
+#include <vector>
+
+static basic::Tracer TR("ColumnarDumpEnsembleMetricObserverTests");
+
+
+class ColumnarDumpEnsembleMetricObserverTests : public CxxTest::TestSuite {
+	//Define Variables
+
+public:
+
+	void setUp() {
+		core_init();
+	}
+
+	void tearDown() {
+
+	}
+
+	/// @brief Write records through two requests for the same file (as two re-parses of an ensemble metric would
+	/// make), and check that the reader gets every record back, in order, from one file.
+	void write_and_read_back( std::string const & filename, bool const compress ) {
+		using namespace protocols::ensemble_metrics;
+		metrics::CentralTendencyEnsembleMetric metric; //Only passed to the observer, for the column names.
+
+		observers::ColumnarDumpEnsembleMetricObserverOP const first_observer( observers::ColumnarDumpEnsembleMetricObserver::observer_for_file( filename, 3, compress ) );
+		for ( core::Size i( 1 ); i <= 5; ++i ) {
+			core::Real const value( 0.5 * static_cast< core::Real >( i ) );
+			first_observer->observe_measurement( metric, i, &value, 1 );
+		}
+		first_observer->flush();
+
+		// A second request for the same file continues it, rather than truncating it.
+		observers::ColumnarDumpEnsembleMetricObserverOP const second_observer( observers::ColumnarDumpEnsembleMetricObserver::observer_for_file( filename, 3, compress ) );
+		TS_ASSERT_EQUALS( first_observer, second_observer );
+		for ( core::Size i( 6 ); i <= 8; ++i ) {
+			core::Real const value( 0.5 * static_cast< core::Real >( i ) );
+			second_observer->observe_measurement( metric, i, &value, 1 );
+		}
+		second_observer->flush();
+		TS_ASSERT_EQUALS( second_observer->n_records_written(), 8 );
+		TS_ASSERT_EQUALS( second_observer->n_dropped(), 0 );
+
+		EnsembleMetricColumnarDumpReader const reader( filename );
+		TS_ASSERT_EQUALS( reader.n_value_columns(), 1 );
+		TS_ASSERT_EQUALS( reader.column_names()[1], "value" );
+		TS_ASSERT_EQUALS( reader.job_names().size(), 1 );
+		TS_ASSERT_EQUALS( reader.n_records(), 8 );
+		TS_ASSERT_EQUALS( reader.n_blocks(), 3 ); //3 records, 2 (flushed early), then 3.
+		if ( !compress ) {
+			TS_ASSERT_EQUALS( reader.n_compressed_blocks(), 0 );
+		}
+
+		std::vector< core::Size > attempts;
+		std::vector< core::Real > values;
+		reader.for_each_block( [&attempts, &values]( EnsembleMetricColumnarDumpBlockView const & view ) {
+			for ( core::Size i( 0 ); i < view.n_records(); ++i ) {
+				attempts.push_back( view.attempt_indices()[i] );
+				values.push_back( view.values( 1 )[i] );
+				TS_ASSERT_EQUALS( view.job_indices()[i], 0 );
+			}
+		} );
+		TS_ASSERT_EQUALS( attempts.size(), 8 );
+		for ( core::Size i( 1 ); i <= attempts.size(); ++i ) {
+			TS_ASSERT_EQUALS( attempts[i-1], i );
+			TS_ASSERT_DELTA( values[i-1], 0.5 * static_cast< core::Real >( i ), 1e-12 );
+		}
+
+		// The values can be fed straight into an ensemble metric.
+		metrics::CentralTendencyEnsembleMetric ingesting_metric;
+		TS_ASSERT_EQUALS( reader.add_column_to_metric( ingesting_metric ), 8 );
+		TS_ASSERT_EQUALS( ingesting_metric.poses_in_ensemble(), 8 );
+		ingesting_metric.reset(); //Suppresses the report on destruction.
+
+		std::remove( filename.c_str() );
+	}
+
+	/// @brief Round trip with compressed blocks.
+	void test_round_trip_compressed() {
+		TR << "Starting ColumnarDumpEnsembleMetricObserverTests:test_round_trip_compressed." << std::endl;
+		write_and_read_back( "ColumnarDumpEnsembleMetricObserverTests_compressed.emcd", true );
+		TR << "Completed ColumnarDumpEnsembleMetricObserverTests:test_round_trip_compressed." << std::endl;
+	}
+
+	/// @brief Round trip with uncompressed blocks, which the reader uses in place.
+	void test_round_trip_uncompressed() {
+		TR << "Starting ColumnarDumpEnsembleMetricObserverTests:test_round_trip_uncompressed." << std::endl;
+		write_and_read_back( "ColumnarDumpEnsembleMetricObserverTests_uncompressed.emcd", false );
+		TR << "Completed ColumnarDumpEnsembleMetricObserverTests:test_round_trip_uncompressed." << std::endl;
+	}
+
+};
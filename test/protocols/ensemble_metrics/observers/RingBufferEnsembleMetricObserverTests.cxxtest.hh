@@ -0,0 +1,195 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// THE FOLLOWING LICENSE APPLIES ONLY TO THIS FILE (RingBufferEnsembleMetricObserverTests.cxxtest.hh), WHICH WAS MADE
+// PUBLICLY AVAILABLE IN THE FOLLOWING GITHUB REPOSITORY PRIOR TO ITS INCLUSION IN
+// THE ROSETTA SOFTWARE SUITE: git@github.com:vmullig/ensemble_metrics.git
+//
+// MIT License
+//
+// Copyright (c) 2022 Vikram K. Mulligan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/// @file  protocols/ensemble_metrics/observers/RingBufferEnsembleMetricObserverTests.cxxtest.hh
+/// @brief  Unit tests for the lock-free ring buffer observer of ensemble metric measurements.
+/// @author Vikram K. Mulligan (vmulligan@flatironinstitute.org)
+
+
+// Test headers
+#include <cxxtest/TestSuite.h>
+#include <test/core/init_util.hh>
+
+// Project Headers
+#include <protocols/ensemble_metrics/observers/RingBufferEnsembleMetricObserver.hh>
+#include <protocols/ensemble_metrics/metrics/CentralTendencyEnsembleMetric.hh>
+
+// Utility, etc Headers
+#include <basic/Tracer.hh>
+#include <utility/vector1.hh>
+#include <utility/pointer/memory.hh>
+
+static basic::Tracer TR("RingBufferEnsembleMetricObserverTests");
+
+
+class RingBufferEnsembleMetricObserverTests : public CxxTest::TestSuite {
+	//Define Variables
+
+public:
+
+	void setUp() {
+		core_init();
+	}
+
+	void tearDown() {
+
+	}
+
+	/// @brief Push and pop enough records that the running indices wrap around the ring several times.
+	void test_wraparound() {
+		TR << "Starting RingBufferEnsembleMetricObserverTests:test_wraparound." << std::endl;
+
+		using namespace protocols::ensemble_metrics;
+		metrics::CentralTendencyEnsembleMetric metric; //Only passed to the observer; not used by it.
+		observers::RingBufferEnsembleMetricObserver observer( 3, 2 ); //Rounded up to a capacity of 4.
+		TS_ASSERT_EQUALS( observer.capacity(), 4 );
+		TS_ASSERT_EQUALS( observer.max_values_per_record(), 2 );
+
+		core::Size next_attempt( 1 );
+		for ( core::Size round( 1 ); round <= 5; ++round ) {
+			for ( core::Size i( 1 ); i <= 3; ++i, ++next_attempt ) {
+				core::Real const values[2] = { static_cast< core::Real >( next_attempt ), -static_cast< core::Real >( next_attempt ) };
+				observer.observe_measurement( metric, next_attempt, values, ( next_attempt % 2 == 0 ? 2 : 1 ) );
+			}
+			TS_ASSERT_EQUALS( observer.size(), 3 );
+
+			utility::vector1< core::Size > attempts;
+			core::Size const n_consumed( observer.consume(
+				[&attempts]( core::Size const attempt_index, core::Real const * values, core::Size const n_values ) {
+					attempts.push_back( attempt_index );
+					TS_ASSERT_EQUALS( n_values, ( attempt_index % 2 == 0 ? 2 : 1 ) );
+					TS_ASSERT_DELTA( values[0], static_cast< core::Real >( attempt_index ), 1.0e-12 );
+					if ( n_values == 2 ) TS_ASSERT_DELTA( values[1], -static_cast< core::Real >( attempt_index ), 1.0e-12 );
+				}
+			) );
+			TS_ASSERT_EQUALS( n_consumed, 3 );
+			TS_ASSERT_EQUALS( attempts, ( utility::vector1< core::Size >{ next_attempt - 3, next_attempt - 2, next_attempt - 1 } ) );
+			TS_ASSERT_EQUALS( observer.size(), 0 );
+		}
+		TS_ASSERT_EQUALS( observer.n_dropped(), 0 );
+
+		TR << "Completed RingBufferEnsembleMetricObserverTests:test_wraparound." << std::endl;
+	}
+
+	/// @brief Records that do not fit, because the ring is full or the record is too large, are dropped and counted.
+	void test_overflow() {
+		TR << "Starting RingBufferEnsembleMetricObserverTests:test_overflow." << std::endl;
+
+		using namespace protocols::ensemble_metrics;
+		metrics::CentralTendencyEnsembleMetric metric;
+		observers::RingBufferEnsembleMetricObserver observer( 4, 1 );
+
+		for ( core::Size i( 1 ); i <= 6; ++i ) {
+			core::Real const value( i );
+			observer.observe_measurement( metric, i, &value, 1 );
+		}
+		TS_ASSERT_EQUALS( observer.size(), 4 );
+		TS_ASSERT_EQUALS( observer.n_dropped(), 2 );
+
+		core::Real const too_many[2] = { 1.0, 2.0 };
+		observer.observe_measurement( metric, 7, too_many, 2 );
+		TS_ASSERT_EQUALS( observer.n_dropped(), 3 );
+
+		// The oldest records are kept:
+		utility::vector1< core::Size > attempts;
+		observer.consume( [&attempts]( core::Size const attempt_index, core::Real const *, core::Size const ) { attempts.push_back( attempt_index ); } );
+		TS_ASSERT_EQUALS( attempts, ( utility::vector1< core::Size >{ 1, 2, 3, 4 } ) );
+
+		// Once drained, the ring accepts records again:
+		core::Real const value( 8.0 );
+		observer.observe_measurement( metric, 8, &value, 1 );
+		TS_ASSERT_EQUALS( observer.size(), 1 );
+		TS_ASSERT_EQUALS( observer.n_dropped(), 3 );
+
+		TR << "Completed RingBufferEnsembleMetricObserverTests:test_overflow." << std::endl;
+	}
+
+	/// @brief Copies of an ensemble metric each get a ring of their own, and the consumer drains all of them.
+	void test_one_producer_per_metric_copy() {
+		TR << "Starting RingBufferEnsembleMetricObserverTests:test_one_producer_per_metric_copy." << std::endl;
+
+		using namespace protocols::ensemble_metrics;
+		observers::RingBufferEnsembleMetricObserverOP observer( utility::pointer::make_shared< observers::RingBufferEnsembleMetricObserver >( 8, 1 ) );
+		metrics::CentralTendencyEnsembleMetric metric;
+		metric.add_observer( observer );
+		TS_ASSERT_EQUALS( observer->n_rings(), 1 );
+
+		{
+			metrics::CentralTendencyEnsembleMetric copy( metric );
+			TS_ASSERT_EQUALS( observer->n_rings(), 2 );
+			metric.add_value( 1.0 );
+			copy.add_value( 2.0 );
+			copy.add_value( 3.0 );
+			TS_ASSERT_EQUALS( observer->size(), 3 );
+			copy.reset();
+		}
+		// The copy's records outlive the copy until they have been drained (in a ring just large enough for them):
+		TS_ASSERT_EQUALS( observer->n_rings(), 2 );
+		TS_ASSERT_EQUALS( observer->size(), 3 );
+
+		core::Real sum( 0.0 );
+		TS_ASSERT_EQUALS( observer->consume( [&sum]( core::Size const, core::Real const * values, core::Size const ) { sum += values[0]; } ), 3 );
+		TS_ASSERT_DELTA( sum, 6.0, 1.0e-12 );
+		TS_ASSERT_EQUALS( observer->n_rings(), 1 );
+		metric.reset();
+
+		TR << "Completed RingBufferEnsembleMetricObserverTests:test_one_producer_per_metric_copy." << std::endl;
+	}
+
+	/// @brief The ring of a copy that is destroyed with nothing left to consume is freed at once, without waiting
+	/// for a consume() call.
+	void test_drained_rings_freed_without_consume() {
+		TR << "Starting RingBufferEnsembleMetricObserverTests:test_drained_rings_freed_without_consume." << std::endl;
+
+		using namespace protocols::ensemble_metrics;
+		observers::RingBufferEnsembleMetricObserverOP observer( utility::pointer::make_shared< observers::RingBufferEnsembleMetricObserver >( 8, 1 ) );
+		metrics::CentralTendencyEnsembleMetric metric;
+		metric.add_observer( observer );
+
+		for ( core::Size i( 1 ); i <= 4; ++i ) {
+			metrics::CentralTendencyEnsembleMetric copy( metric ); //Never measures anything.
+			TS_ASSERT_EQUALS( observer->n_rings(), 2 );
+		}
+		TS_ASSERT_EQUALS( observer->n_rings(), 1 );
+
+		{
+			metrics::CentralTendencyEnsembleMetric copy( metric );
+			copy.add_value( 1.0 );
+			TS_ASSERT_EQUALS( observer->consume( []( core::Size const, core::Real const *, core::Size const ) {} ), 1 );
+			TS_ASSERT_EQUALS( observer->n_rings(), 2 ); //The copy still exists.
+			copy.reset();
+		}
+		TS_ASSERT_EQUALS( observer->n_rings(), 1 ); //Drained, so freed with the copy.
+		TS_ASSERT_EQUALS( observer->size(), 0 );
+
+		TR << "Completed RingBufferEnsembleMetricObserverTests:test_drained_rings_freed_without_consume." << std::endl;
+	}
+
+};